@@ -82,6 +82,21 @@ typedef enum {
    primme_adaptive
 } primme_convergencetest;
 
+/* placement of the pages of the workspace allocated by the solver */
+typedef enum {
+   primme_placement_default,    /* plain malloc, placed where first used     */
+   primme_placement_firsttouch, /* touched by the threads splitting the rows */
+   primme_placement_interleave  /* interleaved among the NUMA nodes          */
+} primme_placement;
+
+/* events reported to monitorFun */
+typedef enum {
+   primme_event_outer_iteration,    /* after computing the block residual norms */
+   primme_event_restart,            /* after restarting the basis */
+   primme_event_converged,          /* some pairs in the block have converged */
+   primme_event_locked              /* some pairs have been locked */
+} primme_event;
+
 
 typedef struct primme_stats {
    PRIMME_INT numOuterIterations;
@@ -96,11 +111,25 @@ typedef struct primme_stats {
    double timePrecond;              /* time expend by applyPreconditioner */
    double timeOrtho;                /* time expend by ortho  */
    double timeGlobalSum;            /* time expend by globalSumReal  */
+   double timeSolveH;               /* time expend by solve_H (out of restart) */
+   double timeRestart;              /* time expend by restart */
+   double timeResetUpdateVWXR;      /* time expend by Num_reset_update_VWXR (part of timeRestart) */
+   double timeLocking;              /* time expend by restart_locking (part of timeRestart) */
+   double timeUpdateVWXR;           /* time expend by Num_update_VWXR (out of restart) */
+   double timeInnerSolve;           /* time expend by the JDQMR inner solver */
+   double timeConvergence;          /* time expend by check_convergence (out of restart) */
+   double estimateFlops;            /* flops done by solve_H and Num_update_VWXR */
+   double estimateBytes;            /* bytes moved by solve_H and Num_update_VWXR */
    double estimateMinEVal;          /* the leftmost Ritz value seen */
    double estimateMaxEVal;          /* the rightmost Ritz value seen */
    double estimateLargestSVal;      /* absolute value of the farthest to zero Ritz value seen */
    double maxConvTol;               /* largest norm residual of a locked eigenpair */
    double estimateResidualError;    /* accumulated error in V and W */
+   PRIMME_INT workspacePlacement;   /* primme_placement applied to realWork */
+   PRIMME_INT workspaceHugePages;   /* 1 if realWork was advised huge pages */
+   PRIMME_INT workspaceNumaNodes;   /* NUMA nodes holding pages of realWork */
+   PRIMME_INT numFactorizations;    /* times called precondFactorize */
+   double timeFactorize;            /* time expend by precondFactorize */
 } primme_stats;
 
 typedef struct JD_projectors {
@@ -114,6 +143,7 @@ typedef struct JD_projectors {
 
 typedef struct projection_params {
    primme_projection projection;
+   int distMinSize;        /* smallest basis solved in slices among processes */
 } projection_params;
 
 typedef struct correction_params {
@@ -131,6 +161,27 @@ typedef struct restarting_params {
    int maxPrevRetain;
 } restarting_params;
 
+typedef struct workspace_params {
+   primme_placement placement;
+   int hugePages;
+} workspace_params;
+
+/* reuse of the factorizations computed by precondFactorize */
+typedef struct precond_params {
+   int cacheSize;          /* factorizations kept, the least recently used */
+                           /* is replaced                                  */
+   double shiftQuantum;    /* shifts are rounded to multiples of this      */
+                           /* times ||A||                                  */
+   double maxShiftDrift;   /* use factors with a shift this close (times   */
+                           /* ||A||) without refactoring                   */
+   double maxTimeRatio;    /* refactor only while the time factorizing is  */
+                           /* under this times the time applying           */
+   int async;              /* refactor on a background thread              */
+} precond_params;
+
+
+/* Workspace that can be reused among calls (see primme_arena_create) */
+typedef struct primme_arena primme_arena;
 
 /*--------------------------------------------------------------------------*/
 typedef struct primme_params {
@@ -181,15 +232,28 @@ typedef struct primme_params {
    PRIMME_INT iseed[4];
    int *intWork;
    void *realWork;
+   primme_arena *arena;              /* Provides intWork and realWork       */
    double aNorm;
    double eps;
 
    int printLevel;
    FILE *outputFile;
+   FILE *traceFile;                  /* Chrome trace events (optional)      */
+   void *traceBuffer;                /* Internal: events not written yet    */
 
    void *matrix;
    void *preconditioner;
    double *ShiftsForPreconditioner;
+
+   /* Shift-dependent preconditioner: factors for A - shift*I kept by PRIMME */
+   void (*precondFactorize)(double *shift, void **factors,
+         struct primme_params *primme, int *ierr);
+   void (*precondApplyFactors)(void *x, PRIMME_INT *ldx, void *y,
+         PRIMME_INT *ldy, int *blockSize, void *factors,
+         struct primme_params *primme, int *ierr);
+   void (*precondFreeFactors)(void *factors, struct primme_params *primme,
+         int *ierr);
+   void *precondCache;               /* Internal: factors not freed yet     */
    primme_init initBasisMode;
    PRIMME_INT ldevecs;
    PRIMME_INT ldOPs;
@@ -197,10 +261,19 @@ typedef struct primme_params {
    struct projection_params projectionParams; 
    struct restarting_params restartingParams;
    struct correction_params correctionParams;
+   struct workspace_params workspaceParams;
+   struct precond_params precondParams;
    struct primme_stats stats;
 
    void (*convTestFun)(double *eval, void *evec, double *rNorm, int *isconv, 
          struct primme_params *primme, int *ierr);
+
+   /* Report progress; set *stop to finish as if maxMatvecs were reached */
+   void (*monitorFun)(void *basisEvals, int *basisSize, int *basisFlags,
+         int *iblock, int *blockSize, void *blockNorms, int *numConverged,
+         void *lockedEvals, int *numLocked, void *lockedNorms,
+         primme_event *event, int *stop, struct primme_params *primme,
+         int *ierr);
 } primme_params;
 /*---------------------------------------------------------------------------*/
 
@@ -235,7 +308,10 @@ int zprimme(double *evals, PRIMME_COMPLEX_DOUBLE *evecs, double *resNorms,
 void primme_initialize(primme_params *primme);
 int  primme_set_method(primme_preset_method method, primme_params *params);
 void primme_display_params(primme_params primme);
+void primme_display_stats(primme_params primme);
 void primme_free(primme_params *primme);
+primme_arena* primme_arena_create(void);
+void primme_arena_free(primme_arena *arena);
 
 #ifdef __cplusplus
 }
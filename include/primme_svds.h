@@ -68,7 +68,18 @@ typedef struct primme_svds_stats {
    PRIMME_INT numRestarts;
    PRIMME_INT numMatvecs;
    PRIMME_INT numPreconds;
+   PRIMME_INT numGlobalSum;         /* times called globalSumReal */
+   PRIMME_INT bytesGlobalSum;       /* bytes reduced by globalSumReal */
+   PRIMME_INT numMatvecsA;          /* vectors multiplied by A */
+   PRIMME_INT numMatvecsAt;         /* vectors multiplied by A' */
+   double numOrthoInnerProds;       /* number of inner prods done by ortho */
    double elapsedTime;
+   double timeMatvec;               /* time expend by the eigensolver matvec */
+   double timeMatvecA;              /* time expend by products with A */
+   double timeMatvecAt;             /* time expend by products with A' */
+   double timePrecond;              /* time expend by applyPreconditioner */
+   double timeOrtho;                /* time expend by ortho  */
+   double timeGlobalSum;            /* time expend by globalSumReal  */
 } primme_svds_stats;
 
 typedef struct primme_svds_params {
@@ -89,6 +100,12 @@ typedef struct primme_svds_params {
       (void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize,
        int *transpose, struct primme_svds_params *primme_svds, int *ierr);
 
+   /* Streaming access to the rows of A, instead of matrixMatvec (AtA only) */
+   void (*readRowBlock)
+      (PRIMME_INT *firstRow, int *numRows, void *A, PRIMME_INT *ldA,
+       struct primme_svds_params *primme_svds, int *ierr);
+   int rowBlockSize;
+
    /* Input for the following is only required for parallel programs */
    int numProcs;
    int procID;
@@ -112,6 +129,7 @@ typedef struct primme_svds_params {
    size_t realWorkSize;
    int *intWork;
    void *realWork;
+   primme_arena *arena;    /* Provides intWork and realWork, if set */
 
    /* These pointers may be used for users to provide matrix/preconditioner */
    void *matrix;
@@ -133,6 +151,13 @@ typedef struct primme_svds_params {
    FILE *outputFile;
    struct primme_svds_stats stats;
 
+   /* Report progress; set *stop to finish as if maxMatvecs were reached */
+   void (*monitorFun)(void *basisSvals, int *basisSize, int *basisFlags,
+         int *iblock, int *blockSize, void *blockNorms, int *numConverged,
+         void *lockedSvals, int *numLocked, void *lockedNorms,
+         primme_event *event, int *stop, int *stage,
+         struct primme_svds_params *primme_svds, int *ierr);
+
 } primme_svds_params;
 
 int sprimme_svds(float *svals, float *svecs, float *resNorms,
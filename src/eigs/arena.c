@@ -0,0 +1,380 @@
+/*******************************************************************************
+ * Copyright (c) 2016, College of William & Mary
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the College of William & Mary nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COLLEGE OF WILLIAM & MARY BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * PRIMME: https://github.com/primme/primme
+ * Contact: Andreas Stathopoulos, a n d r e a s _at_ c s . w m . e d u
+ *******************************************************************************
+ * File: arena.c
+ *
+ * Purpose - Keep the workspace of the solver among calls. A primme_arena
+ *           attached to primme.arena or primme_svds.arena provides realWork
+ *           and intWork, and it only grows when a call needs more than the
+ *           previous ones. It also remembers the workspace sizes of the
+ *           last PRIMME_ARENA_PLANS configurations, so that a repeated
+ *           call skips the query to every subroutine.
+ *
+ *           The workspace allocated by the solver is placed on the NUMA
+ *           nodes as requested in primme.workspaceParams: pages first
+ *           touched by the threads that work on the same rows of V and W in
+ *           the tiled kernels and in the matvec, or pages interleaved among
+ *           the nodes. The placement uses the Linux system calls directly,
+ *           so libnuma is not required.
+ *
+ ******************************************************************************/
+
+#ifdef __linux__
+#  ifndef _GNU_SOURCE
+#    define _GNU_SOURCE
+#  endif
+#  include <unistd.h>
+#  include <sys/mman.h>
+#  include <sys/syscall.h>
+#endif
+#include <stdlib.h>   /* mallocs, free */
+#include <string.h>   /* memcmp, memset */
+#ifdef _OPENMP
+#  include <omp.h>
+#endif
+#include "template.h"
+#include "arena.h"
+
+/* Values of the Linux NUMA memory policy interface (see numaif.h) */
+#define PRIMME_MPOL_INTERLEAVE 3
+#define PRIMME_MPOL_MF_MOVE    (1<<1)
+
+/* Only define these functions ones */
+#ifdef USE_DOUBLE
+#include "notemplate.h"
+
+/*******************************************************************************
+ * Function primme_arena_create - Return an empty arena, or NULL if it cannot
+ *    be allocated. The workspace is allocated by the first call that uses it.
+ ******************************************************************************/
+
+primme_arena* primme_arena_create(void) {
+
+   primme_arena *arena;
+
+   if (MALLOC_PRIMME(1, &arena)) return NULL;
+   arena->realWork = NULL;
+   arena->realWorkSize = 0;
+   arena->placement = primme_placement_default;
+   arena->hugePages = 0;
+   arena->params.placement = primme_placement_default;
+   arena->params.hugePages = 0;
+   arena->intWork = NULL;
+   arena->intWorkSize = 0;
+   arena->numPlans = 0;
+   arena->nextPlan = 0;
+   return arena;
+}
+
+/*******************************************************************************
+ * Subroutine primme_arena_free - Free the arena and its workspace. No
+ *    primme_params or primme_svds_params should use it afterwards.
+ ******************************************************************************/
+
+void primme_arena_free(primme_arena *arena) {
+
+   if (arena == NULL) return;
+   free(arena->realWork);
+   free(arena->intWork);
+   free(arena);
+}
+
+/*******************************************************************************
+ * Function primme_arena_find_plan - Look for the workspace sizes of a
+ *    configuration already seen.
+ *
+ * INPUT
+ * -----
+ * key           parameters of the configuration; unused bytes should be zero
+ *
+ * OUTPUT
+ * ------
+ * realWorkSize  bytes of real workspace, if found
+ * intWorkSize   bytes of integer workspace, if found
+ *
+ * RETURN VALUE
+ * ------------
+ * 1 if found, 0 otherwise
+ ******************************************************************************/
+
+int primme_arena_find_plan(primme_arena *arena, primme_arena_key *key,
+      size_t *realWorkSize, int *intWorkSize) {
+
+   int i;
+
+   for (i=0; i<arena->numPlans; i++) {
+      if (memcmp(&arena->plans[i].key, key, sizeof(*key)) == 0) {
+         *realWorkSize = arena->plans[i].realWorkSize;
+         *intWorkSize = arena->plans[i].intWorkSize;
+         return 1;
+      }
+   }
+   return 0;
+}
+
+/*******************************************************************************
+ * Subroutine primme_arena_add_plan - Remember the workspace sizes of a
+ *    configuration, replacing the oldest one if there is no free entry.
+ ******************************************************************************/
+
+void primme_arena_add_plan(primme_arena *arena, primme_arena_key *key,
+      size_t realWorkSize, int intWorkSize) {
+
+   primme_arena_plan *plan;
+
+   if (arena->numPlans < PRIMME_ARENA_PLANS) {
+      plan = &arena->plans[arena->numPlans++];
+   }
+   else {
+      plan = &arena->plans[arena->nextPlan];
+      arena->nextPlan = (arena->nextPlan+1) % PRIMME_ARENA_PLANS;
+   }
+   plan->key = *key;
+   plan->realWorkSize = realWorkSize;
+   plan->intWorkSize = intWorkSize;
+}
+
+/*******************************************************************************
+ * Function primme_arena_reserve - Make the workspace at least of the given
+ *    sizes in bytes. The content is not preserved when the workspace grows,
+ *    or when the real workspace is allocated again because params asks for
+ *    another placement or huge pages than the current one.
+ *
+ * INPUT
+ * -----
+ * ldBytes   bytes in a column of V (see primme_workspace_alloc)
+ * params    placement of the real workspace
+ *
+ * RETURN VALUE
+ * ------------
+ * error code
+ ******************************************************************************/
+
+int primme_arena_reserve(primme_arena *arena, size_t realWorkSize,
+      int intWorkSize, size_t ldBytes, struct workspace_params *params) {
+
+   if (arena->realWorkSize < realWorkSize || (realWorkSize > 0
+            && (arena->params.placement != params->placement
+               || arena->params.hugePages != params->hugePages))) {
+      size_t size = max(realWorkSize, arena->realWorkSize);
+      free(arena->realWork);
+      arena->realWork = NULL;
+      arena->realWorkSize = 0;
+      if (primme_workspace_alloc(size, ldBytes, params, &arena->realWork,
+               &arena->placement, &arena->hugePages)) {
+         return -1;
+      }
+      arena->realWorkSize = size;
+      arena->params = *params;
+   }
+
+   if (arena->intWorkSize < intWorkSize) {
+      free(arena->intWork);
+      arena->intWorkSize = 0;
+      if (MALLOC_PRIMME(intWorkSize/sizeof(int), &arena->intWork)) return -1;
+      arena->intWorkSize = intWorkSize;
+   }
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Function page_size - Return the size of the pages of the system, or
+ *    PRIMME_PAGE_SIZE if it does not tell.
+ ******************************************************************************/
+
+static size_t page_size(void) {
+
+#if defined(__linux__) && defined(_SC_PAGESIZE)
+   long size = sysconf(_SC_PAGESIZE);
+   if (size > 0) return (size_t)size;
+#endif
+   return PRIMME_PAGE_SIZE;
+}
+
+/*******************************************************************************
+ * Subroutine first_touch - Zero the buffer, seen as a matrix with columns of
+ *    ldBytes bytes, so that every thread touches first the same rows of all
+ *    columns. With a static partition of the rows, as in the threaded BLAS
+ *    and usually in the matvec, every thread works then on local pages.
+ ******************************************************************************/
+
+static void first_touch(char *ptr, size_t size, size_t ldBytes) {
+
+   if (ldBytes == 0 || ldBytes > size) ldBytes = size;
+
+#ifdef _OPENMP
+   #pragma omp parallel
+#endif
+   {
+      int t = 0, nt = 1;
+      size_t j, i0, i1, ncols = size/ldBytes, tail = size - ncols*ldBytes;
+#ifdef _OPENMP
+      t = omp_get_thread_num();
+      nt = omp_get_num_threads();
+#endif
+      i0 = ldBytes/nt*t + (ldBytes%nt)*t/nt;
+      i1 = ldBytes/nt*(t+1) + (ldBytes%nt)*(t+1)/nt;
+      for (j=0; j<ncols; j++) {
+         memset(&ptr[j*ldBytes+i0], 0, i1-i0);
+      }
+      if (t == nt-1 && tail > 0) {
+         memset(&ptr[ncols*ldBytes], 0, tail);
+      }
+   }
+}
+
+/*******************************************************************************
+ * Function primme_workspace_alloc - Allocate a workspace that can be released
+ *    with free(), placing its pages as asked in params.
+ *
+ * INPUT
+ * -----
+ * size      bytes to allocate
+ * ldBytes   bytes in a column of V, that is, ldOPs*sizeof(SCALAR); the
+ *           first touch splits every column of this size among the threads
+ * params    placement and huge pages requested
+ *
+ * OUTPUT
+ * ------
+ * ptr       the workspace
+ * placement primme_placement applied, which is primme_placement_default if
+ *           the requested one is not supported
+ * hugePages 1 if the system accepted the advice of using huge pages
+ *
+ * RETURN VALUE
+ * ------------
+ * error code
+ ******************************************************************************/
+
+int primme_workspace_alloc(size_t size, size_t ldBytes,
+      struct workspace_params *params, void **ptr, int *placement,
+      int *hugePages) {
+
+   size_t pageSize = page_size();
+   size_t alignment = params->hugePages ? max(PRIMME_HUGE_PAGE_SIZE, pageSize)
+                                        : pageSize;
+
+   *placement = primme_placement_default;
+   *hugePages = 0;
+
+   if (params->placement == primme_placement_default && !params->hugePages) {
+      return MALLOC_PRIMME(size, (char**)ptr);
+   }
+
+#ifdef __linux__
+   if (posix_memalign(ptr, alignment, size) != 0) {
+      *ptr = NULL;
+      return -1;
+   }
+
+   /* Apply the advice only on whole pages of the allocation */
+
+   if (size >= pageSize) {
+      size_t pagesBytes = size/pageSize*pageSize;
+#  ifdef MADV_HUGEPAGE
+      if (params->hugePages
+            && madvise(*ptr, pagesBytes, MADV_HUGEPAGE) == 0) {
+         *hugePages = 1;
+      }
+#  endif
+#  ifdef SYS_mbind
+      if (params->placement == primme_placement_interleave) {
+         /* Interleave among all nodes that the process is allowed to use */
+         unsigned long nodemask = ~0UL;
+         if (syscall(SYS_mbind, *ptr, pagesBytes, PRIMME_MPOL_INTERLEAVE,
+                  &nodemask, sizeof(nodemask)*8, PRIMME_MPOL_MF_MOVE) == 0) {
+            *placement = primme_placement_interleave;
+         }
+      }
+#  endif
+   }
+#else
+   (void)alignment;
+   if (MALLOC_PRIMME(size, (char**)ptr)) return -1;
+#endif
+
+   if (params->placement == primme_placement_firsttouch) {
+      first_touch((char*)*ptr, size, ldBytes);
+      *placement = primme_placement_firsttouch;
+   }
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Function primme_workspace_numa_nodes - Return the number of NUMA nodes
+ *    holding some of the pages of the buffer, looking up to
+ *    PRIMME_NUMA_SAMPLE_PAGES pages evenly spaced. Return 0 if the system
+ *    does not tell.
+ ******************************************************************************/
+
+int primme_workspace_numa_nodes(void *ptr, size_t size) {
+
+#if defined(__linux__) && defined(SYS_move_pages)
+   void *pages[PRIMME_NUMA_SAMPLE_PAGES];
+   int status[PRIMME_NUMA_SAMPLE_PAGES];
+   unsigned long nodes = 0;    /* bit i is set if node i has some page */
+   size_t pageSize = page_size(), numPages = size/pageSize, step;
+   int i, count, numNodes = 0;
+   char *first;
+
+   if (ptr == NULL || numPages == 0) return 0;
+
+   first = (char*)(((size_t)ptr + pageSize - 1)/pageSize*pageSize);
+   numPages = ((char*)ptr + size - first)/pageSize;
+   count = (int)(numPages < PRIMME_NUMA_SAMPLE_PAGES ? numPages
+                                                     : PRIMME_NUMA_SAMPLE_PAGES);
+   if (count == 0) return 0;
+   step = numPages/count;
+   for (i=0; i<count; i++) {
+      pages[i] = first + i*step*pageSize;
+   }
+
+   /* With no target nodes, move_pages returns the node of every page */
+
+   if (syscall(SYS_move_pages, 0, (unsigned long)count, pages, NULL, status,
+            0) != 0) {
+      return 0;
+   }
+   for (i=0; i<count; i++) {
+      if (status[i] >= 0 && status[i] < (int)sizeof(nodes)*8
+            && !(nodes & (1UL << status[i]))) {
+         nodes |= 1UL << status[i];
+         numNodes++;
+      }
+   }
+   return numNodes;
+#else
+   (void)ptr; (void)size;
+   return 0;
+#endif
+}
+
+#endif /* USE_DOUBLE */
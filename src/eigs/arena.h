@@ -0,0 +1,100 @@
+/*******************************************************************************
+ * Copyright (c) 2016, College of William & Mary
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the College of William & Mary nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COLLEGE OF WILLIAM & MARY BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * PRIMME: https://github.com/primme/primme
+ * Contact: Andreas Stathopoulos, a n d r e a s _at_ c s . w m . e d u
+ *******************************************************************************
+ * File: arena.h
+ *
+ * Purpose - Definitions of the workspace reused among calls to the solver
+ *           (see arena.c).
+ *
+ ******************************************************************************/
+
+#ifndef ARENA_H
+#define ARENA_H
+
+/* Number of workspace sizes remembered by an arena */
+#define PRIMME_ARENA_PLANS 8
+
+/* Alignment of the workspace with placement other than the default, and  */
+/* with huge pages; the page size is asked to the system, and             */
+/* PRIMME_PAGE_SIZE is used if it does not tell                           */
+#ifndef PRIMME_PAGE_SIZE
+#define PRIMME_PAGE_SIZE 4096
+#endif
+#ifndef PRIMME_HUGE_PAGE_SIZE
+#define PRIMME_HUGE_PAGE_SIZE (2*1024*1024)
+#endif
+
+/* Maximum number of pages whose NUMA node is queried by                  */
+/* primme_workspace_numa_nodes                                            */
+#define PRIMME_NUMA_SAMPLE_PAGES 256
+
+/* Parameters that determine the workspace required by Sprimme */
+typedef struct {
+   int scalarSize, realSize;
+   PRIMME_INT n, nLocal, ldOPs;
+   int numEvals, numOrthoConst, initSize;
+   int maxBasisSize, minRestartSize, maxBlockSize;
+   int locking, dynamicMethodSwitch, target, numTargetShifts, numProcs;
+   int projection, scheme, maxPrevRetain;
+   int precondition, maxInnerIterations, robustShifts, convTest;
+   int LeftQ, LeftX, RightQ, RightX, SkewQ, SkewX;
+   int massMatrix;
+} primme_arena_key;
+
+typedef struct {
+   primme_arena_key key;
+   size_t realWorkSize;       /* bytes of real workspace */
+   int intWorkSize;           /* bytes of integer workspace */
+} primme_arena_plan;
+
+struct primme_arena {
+   void *realWork;            /* real workspace shared by the calls */
+   size_t realWorkSize;       /* its size in bytes */
+   int placement;             /* primme_placement applied to realWork */
+   int hugePages;             /* if realWork was advised huge pages */
+   struct workspace_params params; /* placement asked for realWork */
+   int *intWork;              /* integer workspace shared by the calls */
+   int intWorkSize;           /* its size in bytes */
+   primme_arena_plan plans[PRIMME_ARENA_PLANS];
+   int numPlans;              /* number of valid plans */
+   int nextPlan;              /* plan to replace when all are valid */
+};
+
+int primme_arena_find_plan(primme_arena *arena, primme_arena_key *key,
+      size_t *realWorkSize, int *intWorkSize);
+void primme_arena_add_plan(primme_arena *arena, primme_arena_key *key,
+      size_t realWorkSize, int intWorkSize);
+int primme_arena_reserve(primme_arena *arena, size_t realWorkSize,
+      int intWorkSize, size_t ldBytes, struct workspace_params *params);
+int primme_workspace_alloc(size_t size, size_t ldBytes,
+      struct workspace_params *params, void **ptr, int *placement,
+      int *hugePages);
+int primme_workspace_numa_nodes(void *ptr, size_t size);
+
+#endif
@@ -40,6 +40,8 @@
 #include "globalsum.h"
 #include "auxiliary_eigs.h"
 #include "wtime.h"
+#include "trace.h"
+#include "precond_cache.h"
 
 /******************************************************************************
  * Function Num_compute_residual - This subroutine performs the next operation
@@ -128,12 +130,15 @@ int Num_update_VWXR_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT mV, int nV,
    int nXb, nXe, nYb, nYe, ldX, ldY;
    SCALAR *X, *Y;
    REAL *tmp, *tmp0;
+   double t0;
 
    /* Return memory requirements */
    if (V == NULL) {
       return 2*m*nV;
    }
 
+   t0 = primme_wTimer(0);
+
    /* R or Rnorms or rnorms imply W */
    assert(!(R || Rnorms || rnorms) || W);
 
@@ -219,9 +224,73 @@ int Num_update_VWXR_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT mV, int nV,
       if (rnorms) for (i=nrb; i<nre; i++) rnorms[i-nrb] = sqrt(rnorms[i-nrb]);
    }
 
+   /* The cost is dominated by reading V and W and computing X and Y */
+
+   primme->stats.timeUpdateVWXR += primme_wTimer(0) - t0;
+   primme->stats.estimateFlops += 2.0*FLOPS_SCALAR*mV*nV*(max(0,nXe-nXb)+max(0,nYe-nYb));
+   primme->stats.estimateBytes += (double)sizeof(SCALAR)*mV*(nV*(nYb<nYe?2:1)
+         + (X0?nX0e-nX0b:0) + (X1?nX1e-nX1b:0) + (X2?nX2e-nX2b:0)
+         + (Wo?nWoe-nWob:0) + (R?nRe-nRb:0));
+
    return 0; 
 }
 
+/*******************************************************************************
+ * Subroutine apply_precond_factors - apply primme.precondApplyFactors to V
+ *    with the factors kept for the shift of each column (see precond_cache.c).
+ *    Consecutive columns that share the factors are applied together.
+ *
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * V          The orthonormal basis
+ * ldV        The leading dimension of V
+ * ldW        The leading dimension of W
+ * blockSize  The number of columns of V and W.
+ * 
+ * INPUT/OUTPUT ARRAYS
+ * -------------------
+ * W          M*V
+ ******************************************************************************/
+
+static int apply_precond_factors(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
+      PRIMME_INT ldW, int blockSize, primme_params *primme) {
+
+   int i, j, n, ONE=1, ierr=0;
+   double *shifts = primme->ShiftsForPreconditioner, t0;
+   void *factors, *next=NULL;
+
+   CHKERR(primme_precond_cache_begin(primme), -1);
+   CHKERR(primme_precond_cache_factors(shifts ? &shifts[0] : NULL, &factors,
+            primme), -1);
+   for (i=0; i<blockSize; i+=n) {
+      for (n=1; i+n<blockSize; n++) {
+         CHKERR(primme_precond_cache_factors(shifts ? &shifts[i+n] : NULL,
+                  &next, primme), -1);
+         if (next != factors) break;
+      }
+
+      t0 = primme_wTimer(0);
+      if (primme->ldOPs == 0
+            || (ldV == primme->ldOPs && ldW == primme->ldOPs)) {
+         CHKERRM((primme->precondApplyFactors(&V[ldV*i], &ldV, &W[ldW*i],
+                     &ldW, &n, factors, primme, &ierr), ierr), -1,
+               "Error returned by 'precondApplyFactors' %d", ierr);
+      }
+      else {
+         for (j=i; j<i+n; j++) {
+            CHKERRM((primme->precondApplyFactors(&V[ldV*j], &primme->ldOPs,
+                        &W[ldW*j], &primme->ldOPs, &ONE, factors, primme,
+                        &ierr), ierr), -1,
+                  "Error returned by 'precondApplyFactors' %d", ierr);
+         }
+      }
+      primme_precond_cache_end(primme_wTimer(0) - t0, primme);
+      factors = next;
+   }
+
+   return 0;
+}
+
 /*******************************************************************************
  * Subroutine applyPreconditioner - apply preconditioner to V
  *
@@ -249,9 +318,13 @@ int applyPreconditioner_Sprimme(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
    assert(primme->nLocal == nLocal);
 
    t0 = primme_wTimer(0);
+   TRACE_BEGIN("precond", primme);
 
    if (primme->correctionParams.precondition) {
-      if (primme->ldOPs == 0
+      if (primme->precondFactorize) {
+         CHKERR(apply_precond_factors(V, ldV, W, ldW, blockSize, primme), -1);
+      }
+      else if (primme->ldOPs == 0
             || (ldV == primme->ldOPs && ldW == primme->ldOPs)) {
          CHKERRM((primme->applyPreconditioner(V, &ldV, W, &ldW, &blockSize,
                      primme, &ierr), ierr), -1,
@@ -270,6 +343,7 @@ int applyPreconditioner_Sprimme(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
       Num_copy_matrix_Sprimme(V, nLocal, blockSize, ldV, W, ldW);
    }
 
+   TRACE_END("precond", primme);
    primme->stats.timePrecond += primme_wTimer(0) - t0;
 
    return 0;
@@ -303,3 +377,46 @@ int convTestFun_Sprimme(REAL eval, SCALAR *evec, REAL rNorm, int *isconv,
 
    return 0;
 }
+
+/*******************************************************************************
+ * Subroutine monitorFun - wrapper around primme.monitorFun; report the current
+ *    state of the solver if the user set a monitor.
+ *
+ * INPUT PARAMETERS
+ * ----------------
+ * basisEvals   the Ritz values of the basis
+ * basisSize    size of the basis
+ * basisFlags   convergence flags of the Ritz pairs of the basis
+ * iblock       indices in the basis of the pairs in the block
+ * blockSize    size of the block
+ * blockNorms   residual norms of the pairs in the block
+ * numConverged number of converged pairs, including the locked ones
+ * lockedEvals  the locked eigenvalues
+ * numLocked    number of locked pairs
+ * lockedNorms  residual norms of the locked pairs
+ * event        the event being reported
+ *
+ * OUTPUT
+ * ------
+ * stop         set to one if the monitor asks to stop the solver
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+int monitorFun_Sprimme(REAL *basisEvals, int basisSize, int *basisFlags,
+      int *iblock, int blockSize, REAL *blockNorms, int numConverged,
+      REAL *lockedEvals, int numLocked, REAL *lockedNorms, primme_event event,
+      int *stop, primme_params *primme) {
+
+   int ierr=0, stopRequested=0;
+
+   if (!primme->monitorFun) return 0;
+
+   CHKERRM((primme->monitorFun(basisEvals, &basisSize, basisFlags, iblock,
+               &blockSize, blockNorms, &numConverged, lockedEvals, &numLocked,
+               lockedNorms, &event, &stopRequested, primme, &ierr), ierr), -1,
+         "Error returned by 'monitorFun' %d", ierr);
+
+   if (stopRequested) *stop = 1;
+
+   return 0;
+}
@@ -72,6 +72,16 @@ int applyPreconditioner_dprimme(double *V, int64_t nLocal, int64_t ldV,
 #endif
 int convTestFun_dprimme(double eval, double *evec, double rNorm, int *isconv,
       struct primme_params *primme);
+#if !defined(CHECK_TEMPLATE) && !defined(monitorFun_Sprimme)
+#  define monitorFun_Sprimme CONCAT(monitorFun_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(monitorFun_Rprimme)
+#  define monitorFun_Rprimme CONCAT(monitorFun_,REAL_SUF)
+#endif
+int monitorFun_dprimme(double *basisEvals, int basisSize, int *basisFlags,
+      int *iblock, int blockSize, double *blockNorms, int numConverged,
+      double *lockedEvals, int numLocked, double *lockedNorms, primme_event event,
+      int *stop, primme_params *primme);
 void Num_compute_residual_zprimme(int64_t n, PRIMME_COMPLEX_DOUBLE eval, PRIMME_COMPLEX_DOUBLE *x,
    PRIMME_COMPLEX_DOUBLE *Ax, PRIMME_COMPLEX_DOUBLE *r);
 int Num_update_VWXR_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_COMPLEX_DOUBLE *W, int64_t mV, int nV,
@@ -87,6 +97,10 @@ int applyPreconditioner_zprimme(PRIMME_COMPLEX_DOUBLE *V, int64_t nLocal, int64_
       PRIMME_COMPLEX_DOUBLE *W, int64_t ldW, int blockSize, primme_params *primme);
 int convTestFun_zprimme(double eval, PRIMME_COMPLEX_DOUBLE *evec, double rNorm, int *isconv,
       struct primme_params *primme);
+int monitorFun_zprimme(double *basisEvals, int basisSize, int *basisFlags,
+      int *iblock, int blockSize, double *blockNorms, int numConverged,
+      double *lockedEvals, int numLocked, double *lockedNorms, primme_event event,
+      int *stop, primme_params *primme);
 void Num_compute_residual_sprimme(int64_t n, float eval, float *x,
    float *Ax, float *r);
 int Num_update_VWXR_sprimme(float *V, float *W, int64_t mV, int nV,
@@ -102,6 +116,10 @@ int applyPreconditioner_sprimme(float *V, int64_t nLocal, int64_t ldV,
       float *W, int64_t ldW, int blockSize, primme_params *primme);
 int convTestFun_sprimme(float eval, float *evec, float rNorm, int *isconv,
       struct primme_params *primme);
+int monitorFun_sprimme(float *basisEvals, int basisSize, int *basisFlags,
+      int *iblock, int blockSize, float *blockNorms, int numConverged,
+      float *lockedEvals, int numLocked, float *lockedNorms, primme_event event,
+      int *stop, primme_params *primme);
 void Num_compute_residual_cprimme(int64_t n, PRIMME_COMPLEX_FLOAT eval, PRIMME_COMPLEX_FLOAT *x,
    PRIMME_COMPLEX_FLOAT *Ax, PRIMME_COMPLEX_FLOAT *r);
 int Num_update_VWXR_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_COMPLEX_FLOAT *W, int64_t mV, int nV,
@@ -117,4 +135,8 @@ int applyPreconditioner_cprimme(PRIMME_COMPLEX_FLOAT *V, int64_t nLocal, int64_t
       PRIMME_COMPLEX_FLOAT *W, int64_t ldW, int blockSize, primme_params *primme);
 int convTestFun_cprimme(float eval, PRIMME_COMPLEX_FLOAT *evec, float rNorm, int *isconv,
       struct primme_params *primme);
+int monitorFun_cprimme(float *basisEvals, int basisSize, int *basisFlags,
+      int *iblock, int blockSize, float *blockNorms, int numConverged,
+      float *lockedEvals, int numLocked, float *lockedNorms, primme_event event,
+      int *stop, primme_params *primme);
 #endif
@@ -37,6 +37,7 @@
 #include <math.h>
 #include <assert.h>
 #include "const.h"
+#include "wtime.h"
 #include "numerical.h"
 #include "convergence.h"
 #include "ortho.h"
@@ -94,6 +95,7 @@ int check_convergence_Sprimme(SCALAR *X, PRIMME_INT nLocal, PRIMME_INT ldX,
    double attainableTol=0; /* Used in locking to check near convergence problem  */
    int isConv;             /* return of convTestFun                              */
    double targetShift;     /* target shift */
+   double t0;              /* Timing variable */
 
    /* -------------------------- */
    /* Return memory requirements */
@@ -106,6 +108,8 @@ int check_convergence_Sprimme(SCALAR *X, PRIMME_INT nLocal, PRIMME_INT ldX,
       return 0;
    }
  
+   t0 = primme_wTimer(0);
+
    /* Check enough space for toProject */
    assert(iworkSize >= right-left);
 
@@ -200,6 +204,8 @@ int check_convergence_Sprimme(SCALAR *X, PRIMME_INT nLocal, PRIMME_INT ldX,
                -1);
    }
 
+   primme->stats.timeConvergence += primme_wTimer(0) - t0;
+
    return 0;
 
 }
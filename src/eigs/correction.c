@@ -37,11 +37,13 @@
 #include <math.h>
 #include <assert.h>
 #include "const.h"
+#include "wtime.h"
 #include "numerical.h"
 #include "correction.h"
 #include "inner_solve.h"
 #include "globalsum.h"
 #include "auxiliary_eigs.h"
+#include "trace.h"
 
 static REAL computeRobustShift(int blockIndex, double resNorm, 
    REAL *prevRitzVals, int numPrevRitzVals, REAL *sortedRitzVals, 
@@ -54,13 +56,15 @@ static void mergeSort(REAL *lockedEvals, int numLocked, REAL *ritzVals,
 static int Olsen_preconditioner_block(SCALAR *r, PRIMME_INT ldr, SCALAR *x,
       PRIMME_INT ldx, int blockSize, SCALAR *rwork, primme_params *primme);
 
-static int setup_JD_projectors(SCALAR *x, SCALAR *evecs, PRIMME_INT ldevecs,
-      SCALAR *evecsHat, PRIMME_INT ldevecsHat, SCALAR *Kinvx, SCALAR *xKinvx, 
-      SCALAR **Lprojector, PRIMME_INT *ldLprojector, SCALAR **RprojectorQ,
+static int setup_JD_projectors(SCALAR *x, PRIMME_INT ldx, int blockSize,
+      SCALAR *evecs, PRIMME_INT ldevecs, SCALAR *evecsHat,
+      PRIMME_INT ldevecsHat, SCALAR *Kinvx, SCALAR *xKinvx,
+      SCALAR **LprojectorQ, PRIMME_INT *ldLprojectorQ, SCALAR **LprojectorX,
+      PRIMME_INT *ldLprojectorX, SCALAR **RprojectorQ,
       PRIMME_INT *ldRprojectorQ, SCALAR **RprojectorX,
-      PRIMME_INT *ldRprojectorX,  int *sizeLprojector, int *sizeRprojectorQ,
-      int *sizeRprojectorX, int numLocked, int numConverged,
-      primme_params *primme);
+      PRIMME_INT *ldRprojectorX, int *sizeLprojectorQ, int *sizeLprojectorX,
+      int *sizeRprojectorQ, int *sizeRprojectorX, int numLocked,
+      int numConverged, primme_params *primme);
 
 
 /*******************************************************************************
@@ -106,10 +110,11 @@ static int setup_JD_projectors(SCALAR *x, SCALAR *evecs, PRIMME_INT ldevecs,
  *                3*maxEvecsSize + 2*primme->maxBlockSize 
  *                + (primme->numEvals+primme->maxBasisSize)
  *                        *----------------------------------------------------*
- *                        | The following are optional and mutually exclusive: |
+ *                        | The following are optional:                        |
  *                        *------------------------------+                     |
- *                + 4*primme->nLocal + primme->nLocal    | For QMR work and sol|
- *                + primme->nLocal*primme->maxBlockSize  | OLSEN for Kinvx     |
+ *                + primme->ldOPs*primme->maxBlockSize   | For sol             |
+ *                + the workspace of inner_solve         | For QMR work        |
+ *                + primme->ldOPs*primme->maxBlockSize   | OLSEN/skew for Kinvx|
  *                                                       *---------------------*
  *
  * rworkSize      the size of rwork. If less than needed, func returns needed.
@@ -164,9 +169,10 @@ int solve_correction_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
    int *ilev;              /* Array of size blockSize.  Maps the target Ritz */
                            /* values to their positions in the sortedEvals   */
                            /* array.                                         */
-   int sizeLprojector;     /* Sizes of the various left/right projectors     */
-   int sizeRprojectorQ;    /* These will be 0/1/or numOrthConstr+numLocked   */
-   int sizeRprojectorX;    /* or numOrthConstr+numConvergedStored w/o locking*/
+   int sizeLprojectorQ;    /* Sizes of the various left/right projectors     */
+   int sizeLprojectorX;    /* These will be 0/1/or numOrthConstr+numLocked   */
+   int sizeRprojectorQ;    /* or numOrthConstr+numConvergedStored w/o locking*/
+   int sizeRprojectorX;
 
    SCALAR *r, *x, *sol;  /* Residual, Ritz vector, and correction.         */
    SCALAR *linSolverRWork;/* Workspace needed by linear solver.            */
@@ -175,16 +181,20 @@ int solve_correction_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
    double *blockOfShifts;  /* Shifts for (A-shiftI) or (if needed) (K-shiftI)*/
    REAL *approxOlsenEps; /* Shifts for approximate Olsen implementation    */
    SCALAR *Kinvx;         /* Workspace to store K^{-1}x                     */
-   SCALAR *Lprojector;   /* Q pointer for (I-Q*Q'). Usually points to evecs*/
+   SCALAR *LprojectorQ;  /* Q pointer for (I-Q*Q'). Usually points to evecs*/
+   SCALAR *LprojectorX;  /* x pointer for (I-x*x'). Points to x or NULL    */
    SCALAR *RprojectorQ;  /* May point to evecs/evecsHat depending on skewQ */
    SCALAR *RprojectorX;  /* May point to x/Kinvx depending on skewX        */
-   PRIMME_INT ldLprojector;  /* The leading dimension of Lprojector     */
+   PRIMME_INT ldLprojectorQ; /* The leading dimension of LprojectorQ    */
+   PRIMME_INT ldLprojectorX; /* The leading dimension of LprojectorX    */
    PRIMME_INT ldRprojectorQ; /* The leading dimension of RprojectorQ    */
    PRIMME_INT ldRprojectorX; /* The leading dimension of RprojectorL    */
 
 
-   SCALAR xKinvx;                        /* Stores x'*K^{-1}x if needed    */
-   REAL eval, shift, robustShift;       /* robust shift values.           */
+   SCALAR *xKinvx;       /* Stores x'*K^{-1}x for every x if needed        */
+   REAL *blockEvals;     /* Ritz values of the block vectors               */
+   REAL eval, robustShift;              /* robust shift values.           */
+   double t0;                           /* Timing variable                */
 
    /*------------------------------------------------------------*/
    /* Subdivide the workspace with pointers, and figure out      */
@@ -198,15 +208,8 @@ int solve_correction_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
    if (primme->correctionParams.projectors.RightX &&  
        primme->correctionParams.projectors.SkewX ) { 
 
-      /* OLSEN's method requires a block, but JDQMR is vector by vector */
-      if (primme->correctionParams.maxInnerIterations == 0) {    
-         sol = Kinvx + primme->ldOPs*blockSize;
-         neededRsize = neededRsize + primme->ldOPs*blockSize;
-      }
-      else {
-         sol = Kinvx + primme->nLocal;
-         neededRsize = neededRsize + primme->nLocal;
-      }
+      sol = Kinvx + primme->ldOPs*blockSize;
+      neededRsize = neededRsize + primme->ldOPs*blockSize;
    }
    else {
       sol = Kinvx + 0;
@@ -216,19 +219,25 @@ int solve_correction_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
       linSolverRWorkSize = 0;                     /* No inner solver used  */
    }
    else {
-      linSolverRWork = sol + primme->nLocal;      /* sol needed in innerJD */
-      neededRsize = neededRsize + primme->nLocal;
-      linSolverRWorkSize =                        /* Inner solver worksize */
-              4*primme->nLocal + 2*(primme->numOrthoConst+primme->numEvals);
+      /* The correction equations of the block are solved together */
+      linSolverRWork = sol + primme->ldOPs*blockSize;
+      neededRsize = neededRsize + primme->ldOPs*blockSize;
+      linSolverRWorkSize = 0;                     /* Inner solver worksize */
+      CHKERR(inner_solve_Sprimme(blockSize, NULL, 0, NULL, 0, NULL, NULL, 0,
+               NULL, NULL, NULL, NULL, 0, NULL, 0, NULL, 0, NULL, 0, 0, 0, 0,
+               0, NULL, 0, NULL, NULL, 0.0, NULL, &linSolverRWorkSize,
+               primme), -1);
       neededRsize = neededRsize + linSolverRWorkSize;
    }
-   sortedRitzVals = (REAL *)(linSolverRWork + linSolverRWorkSize);
+   xKinvx = linSolverRWork + linSolverRWorkSize;  /* local and global sums */
+   sortedRitzVals = (REAL *)(xKinvx + 2*blockSize);
    #define ALIGN(ptr,T) (((uintptr_t)(ptr)+sizeof(T)-1) & -sizeof(T))
    blockOfShifts  = (double*)ALIGN(sortedRitzVals + (numLocked+basisSize), double);
    approxOlsenEps = (REAL*)ALIGN(blockOfShifts  + blockSize, REAL);
+   blockEvals     = approxOlsenEps + blockSize;
    #undef ALIGN
-   neededRsize = neededRsize + numLocked+basisSize
-      + blockSize*(1+sizeof(double)/sizeof(REAL)) + 2;
+   neededRsize = neededRsize + 2*blockSize + numLocked+basisSize
+      + blockSize*(2+sizeof(double)/sizeof(REAL)) + 2;
 
    /* Return memory requirements */
    if (V == NULL) {
@@ -419,43 +428,49 @@ int solve_correction_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
    /* ------------------------------------------------------------ */
    else {  /* maxInnerIterations > 0  We perform inner-outer JDQMR */
 
-      /* Solve the correction for each block vector. */
-
-      for (blockIndex = 0; blockIndex < blockSize; blockIndex++) {
+      /* Solve the corrections for all block vectors together. */
 
-         r = &W[ldW*(basisSize+blockIndex)];
-         x = &V[ldV*(basisSize+blockIndex)];
+      r = &W[ldW*basisSize];    /* All the block residuals    */
+      x = &V[ldV*basisSize];    /* All the block Ritz vectors */
 
-         /* Set up the left/right/skew projectors for JDQMR.        */
-         /* The pointers Lprojector, Rprojector(Q/X) point to the   */
-         /* appropriate arrays for use in the projection step       */
+      /* Set up the left/right/skew projectors for JDQMR.        */
+      /* The pointers Lprojector(Q/X), Rprojector(Q/X) point to  */
+      /* the appropriate arrays for use in the projection step   */
 
-         CHKERR(setup_JD_projectors(x, evecs, ldevecs, evecsHat, ldevecsHat,
-                  Kinvx, &xKinvx, &Lprojector, &ldLprojector, &RprojectorQ,
-                  &ldRprojectorQ, &RprojectorX, &ldRprojectorX, &sizeLprojector,
-                  &sizeRprojectorQ, &sizeRprojectorX, numLocked,
-                  numConvergedStored, primme), -1);
+      CHKERR(setup_JD_projectors(x, ldV, blockSize, evecs, ldevecs, evecsHat,
+               ldevecsHat, Kinvx, xKinvx, &LprojectorQ, &ldLprojectorQ,
+               &LprojectorX, &ldLprojectorX, &RprojectorQ, &ldRprojectorQ,
+               &RprojectorX, &ldRprojectorX, &sizeLprojectorQ,
+               &sizeLprojectorX, &sizeRprojectorQ, &sizeRprojectorX,
+               numLocked, numConvergedStored, primme), -1);
 
-         /* Map the index of the block vector to its corresponding eigenvalue */
-         /* index, and the shift for the correction equation. Also make the   */
-         /* shift available to primme, in case (K-shift I)^-1 is needed       */
+      /* Map the index of the block vector to its corresponding eigenvalue */
+      /* index. The shifts for the correction equations are blockOfShifts  */
 
+      for (blockIndex = 0; blockIndex < blockSize; blockIndex++) {
          ritzIndex = iev[blockIndex];
-         shift = blockOfShifts[blockIndex];
-         primme->ShiftsForPreconditioner = &blockOfShifts[blockIndex];
+         blockEvals[blockIndex] = ritzVals[ritzIndex];
+      }
+
+      t0 = primme_wTimer(0);
+      TRACE_BEGIN("inner-solve", primme);
+      CHKERR(inner_solve_Sprimme(blockSize, x, ldV, r, ldW, blockNorms, evecs,
+               ldevecs, UDU, ipivot, xKinvx, LprojectorQ, ldLprojectorQ,
+               LprojectorX, ldLprojectorX, RprojectorQ, ldRprojectorQ,
+               RprojectorX, ldRprojectorX, sizeLprojectorQ, sizeLprojectorX,
+               sizeRprojectorQ, sizeRprojectorX, sol, primme->ldOPs,
+               blockEvals, blockOfShifts, machEps, linSolverRWork,
+               &linSolverRWorkSize, primme), -1);
+      TRACE_END("inner-solve", primme);
+      primme->stats.timeInnerSolve += primme_wTimer(0) - t0;
 
-         CHKERR(inner_solve_Sprimme(x, r, &blockNorms[blockIndex], evecs,
-                  ldevecs, UDU, ipivot, &xKinvx,
-                  Lprojector, ldLprojector, RprojectorQ, ldRprojectorQ,
-                  RprojectorX, ldRprojectorX, sizeLprojector, sizeRprojectorQ,
-                  sizeRprojectorX, sol, ritzVals[ritzIndex], shift,
-                  machEps, linSolverRWork, linSolverRWorkSize,
-                  primme), -1);
+      /* The inner solver passes the shifts of the unfinished vectors only */
 
-         Num_copy_Sprimme(primme->nLocal, sol, 1, 
-            &V[ldV*(basisSize+blockIndex)], 1);
+      primme->ShiftsForPreconditioner = blockOfShifts;
+
+      Num_copy_matrix_Sprimme(sol, primme->nLocal, blockSize, primme->ldOPs,
+            &V[ldV*basisSize], ldV);
 
-      } /* end for each block vector */
    } /* JDqmr variants */
 
    return 0;
@@ -762,7 +777,9 @@ static int Olsen_preconditioner_block(SCALAR *r, PRIMME_INT ldr, SCALAR *x,
  *
  *  INPUT
  *  -----
- *   x                The Ritz vector
+ *   x                The Ritz vectors of the block
+ *   ldx              The leading dimension of x
+ *   blockSize        The number of Ritz vectors
  *   evecs            Converged locked eigenvectors (denoted as Q herein)
  *   evecsHat         K^{-1}*evecs
  *   numLocked        Number of locked eigenvectors (if locking)
@@ -779,12 +796,16 @@ static int Olsen_preconditioner_block(SCALAR *r, PRIMME_INT ldr, SCALAR *x,
  *  OUTPUT
  *  ------
  *  *Kinvx            The result of K^{-1}x (if needed, otherwise NULL)
- * **Lprojector       Pointer to the left projector for [Q x] (could be NULL)
+ *  *xKinvx           The values x_i'*K^{-1}x_i (if needed, otherwise 1).
+ *                    Array of size 2*blockSize; the second half is workspace.
+ * **LprojectorQ      Pointer to the left projector for Q (could be NULL)
+ * **LprojectorX      Pointer to the left projector for x (could be NULL)
  * **RprojectorQ      Pointer to the right projector for Q (could be NULL)
  * **RprojectorX      Pointer to the right projector for X (could be NULL)
- *   sizeLprojector   Size of the left projector(numConverged/numLocked)/+1 or 0
+ *   sizeLprojectorQ  Size of the Q left projector(numConverged/numLocked or 0)
+ *   sizeLprojectorX  Size of the x left projector per Ritz vector (1 or 0)
  *   sizeRprojectorQ  Size of the Q right projectr (numConverged/numLocked or 0)
- *   sizeRprojectorX  Size of the X right projectr (1 or 0)
+ *   sizeRprojectorX  Size of the X right projectr per Ritz vector (1 or 0)
  *
  * ============================================================================
  * Functionality:
@@ -823,61 +844,58 @@ static int Olsen_preconditioner_block(SCALAR *r, PRIMME_INT ldr, SCALAR *x,
  *                    Researchers can experiment with other projection schemes,
  *                    although our experience says they are rarely beneficial
  *
- * The left orthogonal projector for x and Q can be performed as one block
- * containing [Q x]. However, the right projections (if either is skew)
+ * The left orthogonal projector for x and Q is performed as one block
+ * containing [Q x_i] for every Ritz vector x_i. However, the right projections (if either is skew)
  * are performed separately for Q and x. There are memory reasons for 
  * doing so, but also we do not have to factor (Q'KQ) at every outer step;
  * only when an eval converges. 
  *
  ******************************************************************************/
 
-static int setup_JD_projectors(SCALAR *x, SCALAR *evecs, PRIMME_INT ldevecs,
-      SCALAR *evecsHat, PRIMME_INT ldevecsHat, SCALAR *Kinvx, SCALAR *xKinvx, 
-      SCALAR **Lprojector, PRIMME_INT *ldLprojector, SCALAR **RprojectorQ,
+static int setup_JD_projectors(SCALAR *x, PRIMME_INT ldx, int blockSize,
+      SCALAR *evecs, PRIMME_INT ldevecs, SCALAR *evecsHat,
+      PRIMME_INT ldevecsHat, SCALAR *Kinvx, SCALAR *xKinvx,
+      SCALAR **LprojectorQ, PRIMME_INT *ldLprojectorQ, SCALAR **LprojectorX,
+      PRIMME_INT *ldLprojectorX, SCALAR **RprojectorQ,
       PRIMME_INT *ldRprojectorQ, SCALAR **RprojectorX,
-      PRIMME_INT *ldRprojectorX,  int *sizeLprojector, int *sizeRprojectorQ,
-      int *sizeRprojectorX, int numLocked, int numConverged,
-      primme_params *primme) {
+      PRIMME_INT *ldRprojectorX, int *sizeLprojectorQ, int *sizeLprojectorX,
+      int *sizeRprojectorQ, int *sizeRprojectorX, int numLocked,
+      int numConverged, primme_params *primme) {
 
-   int n, sizeEvecs;
-   SCALAR xKinvx_local;
+   int i, sizeEvecs;
+   SCALAR *xKinvx_local;
 
-   *sizeLprojector  = 0;
+   *sizeLprojectorQ = 0;
+   *sizeLprojectorX = 0;
    *sizeRprojectorQ = 0;
    *sizeRprojectorX = 0;
-   *ldLprojector  = 0;
+   *ldLprojectorQ = 0;
+   *ldLprojectorX = 0;
    *ldRprojectorQ = 0;
    *ldRprojectorX = 0;
-   *Lprojector  = NULL;
+   *LprojectorQ = NULL;
+   *LprojectorX = NULL;
    *RprojectorQ = NULL;
    *RprojectorX = NULL;
 
-   n = primme->nLocal;
    if (primme->locking) 
       sizeEvecs = primme->numOrthoConst+numLocked;
    else
       sizeEvecs = primme->numOrthoConst+numConverged;
    
    /* --------------------------------------------------------*/
-   /* Set up the left projector arrays. Make x adjacent to Q. */
+   /* Set up the left projector arrays. Q and x separately    */
    /* --------------------------------------------------------*/
    
    if (primme->correctionParams.projectors.LeftQ) {
-   
-         *sizeLprojector = sizeEvecs;
-         *Lprojector = evecs;
-         *ldLprojector = ldevecs;
-         if (primme->correctionParams.projectors.LeftX) {
-            Num_copy_Sprimme(n, x, 1, &evecs[sizeEvecs*ldevecs], 1);
-            *sizeLprojector = *sizeLprojector + 1;
-         }
+         *sizeLprojectorQ = sizeEvecs;
+         *LprojectorQ = evecs;
+         *ldLprojectorQ = ldevecs;
    }
-   else {
-      if (primme->correctionParams.projectors.LeftX) {
-         *Lprojector = x;
-         *ldLprojector = n;
-         *sizeLprojector = 1;
-      }
+   if (primme->correctionParams.projectors.LeftX) {
+         *sizeLprojectorX = 1;
+         *LprojectorX = x;
+         *ldLprojectorX = ldx;
    }
       
    /* --------------------------------------------------------*/
@@ -910,28 +928,37 @@ static int setup_JD_projectors(SCALAR *x, SCALAR *evecs, PRIMME_INT ldevecs,
    /* ------------*/
    /* Then for x  */
    /* ------------*/
+
+   for (i=0; i<blockSize; i++) {
+      xKinvx[i] = 1.0;
+   }
+   xKinvx_local = &xKinvx[blockSize];
+
    if (primme->correctionParams.projectors.RightX) {
    
       if (primme->correctionParams.precondition   &&
           primme->correctionParams.projectors.SkewX) {
-         CHKERR(applyPreconditioner_Sprimme(x, primme->nLocal, primme->nLocal,
-                  Kinvx, primme->nLocal, 1, primme), -1);
-         primme->stats.numPreconds += 1;
+         CHKERR(applyPreconditioner_Sprimme(x, primme->nLocal, ldx,
+                  Kinvx, primme->ldOPs, blockSize, primme), -1);
+         primme->stats.numPreconds += blockSize;
          *RprojectorX  = Kinvx;
-         xKinvx_local = Num_dot_Sprimme(primme->nLocal, x, 1, Kinvx, 1);
-         CHKERR(globalSum_Sprimme(&xKinvx_local, xKinvx, 1, primme), -1);
+         *ldRprojectorX  = primme->ldOPs;
+         for (i=0; i<blockSize; i++) {
+            xKinvx_local[i] = Num_dot_Sprimme(primme->nLocal, &x[ldx*i], 1,
+                  &Kinvx[primme->ldOPs*i], 1);
+         }
+         CHKERR(globalSum_Sprimme(xKinvx_local, xKinvx, blockSize, primme),
+               -1);
       }      
       else {
          *RprojectorX = x;
-         *xKinvx = 1.0;
+         *ldRprojectorX  = ldx;
       }
       *sizeRprojectorX = 1;
-      *ldRprojectorX  = n;
    }
    else { 
          *RprojectorX = NULL;
          *sizeRprojectorX = 0;
-         *xKinvx = 1.0;
    }
 
    return 0;
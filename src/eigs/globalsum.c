@@ -36,6 +36,7 @@
 #include "numerical.h"
 #include "globalsum.h"
 #include "wtime.h"
+#include "trace.h"
 
 TEMPLATE_PLEASE
 int globalSum_Sprimme(SCALAR *sendBuf, SCALAR *recvBuf, int count, 
@@ -46,6 +47,7 @@ int globalSum_Sprimme(SCALAR *sendBuf, SCALAR *recvBuf, int count,
 
    if (primme && primme->globalSumReal) {
       t0 = primme_wTimer(0);
+      TRACE_BEGIN("globalSum", primme);
 
       /* If it is a complex type, count real and imaginary part */
 #ifdef USE_COMPLEX
@@ -55,7 +57,9 @@ int globalSum_Sprimme(SCALAR *sendBuf, SCALAR *recvBuf, int count,
                ierr), -1,
             "Error returned by 'globalSumReal' %d", ierr);
 
+      TRACE_END("globalSum", primme);
       primme->stats.timeGlobalSum += primme_wTimer(0) - t0;
+      primme->stats.numGlobalSum++;
       primme->stats.volumeGlobalSum += count;
    }
    else {
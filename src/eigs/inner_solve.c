@@ -29,13 +29,15 @@
  *******************************************************************************
  * File: inner_solve.c
  *
- * Purpose - Solves the correction equation using hermitian simplified QMR.
+ * Purpose - Solves the correction equations of a block of Ritz vectors using
+ *           hermitian simplified QMR.
  *  
  ******************************************************************************/
 
 #include <stdio.h>
 #include <math.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <assert.h>
 #include "wtime.h"
 #include "numerical.h"
@@ -45,36 +47,63 @@
 #include "globalsum.h"
 #include "auxiliary_eigs.h"
 
-static int apply_projected_preconditioner(SCALAR *v, SCALAR *Q, PRIMME_INT ldQ,
-      SCALAR *RprojectorQ, PRIMME_INT ldRprojectorQ, SCALAR *x,
-      SCALAR *RprojectorX,  PRIMME_INT ldRprojectorX, int sizeRprojectorQ,
-      int sizeRprojectorX, SCALAR *xKinvx, SCALAR *UDU, int *ipivot,
-      SCALAR *result, SCALAR *rwork, primme_params *primme);
+/* State of the QMR recurrences of a block member */
+
+typedef struct {
+   REAL eval, shift;            /* Ritz value and correction eq. shift       */
+   REAL rho_prev, sigma_prev, alpha_prev;
+   REAL Theta_prev, Theta, tau_init, tau_prev, tau;
+   REAL gamma, eta;             /* delta = gamma*delta + eta*d               */
+   REAL Beta, Delta, Psi, Phi, Gamma;  /* Dynamic update of the eigenpair    */
+   REAL Beta_prev, Delta_prev, Psi_prev, Phi_prev, Gamma_prev;
+   REAL dot_sol, eval_prev, eres_updated, ETolerance;
+   int pending;                 /* if delta and sol are not updated with d   */
+} qmr_state;
+
+static int apply_projected_preconditioner(SCALAR *v, PRIMME_INT ldv,
+      int blockSize, SCALAR *Q, PRIMME_INT ldQ, SCALAR *RprojectorQ,
+      PRIMME_INT ldRprojectorQ, int sizeRprojectorQ, SCALAR *UDU, int *ipivot,
+      SCALAR *x, PRIMME_INT ldx, SCALAR *RprojectorX, PRIMME_INT ldRprojectorX,
+      int sizeRprojectorX, SCALAR *xKinvx, int *perm, double *shifts,
+      SCALAR *result, PRIMME_INT ldresult, SCALAR *rwork,
+      primme_params *primme);
+
+static int apply_projected_matrix(SCALAR *v, PRIMME_INT ldv, int blockSize,
+      double *shifts, SCALAR *Q, PRIMME_INT ldQ, int dimQ, SCALAR *x,
+      PRIMME_INT ldx, int dimX, int *perm, SCALAR *result,
+      PRIMME_INT ldresult, SCALAR *rwork, primme_params *primme);
 
-static int apply_skew_projector(SCALAR *Q, PRIMME_INT ldQ, SCALAR *Qhat,
-      PRIMME_INT ldQhat, SCALAR *UDU, int *ipivot, int numCols, SCALAR *v,
+static int apply_block_projector(SCALAR *Q, PRIMME_INT ldQ, SCALAR *Qhat,
+      PRIMME_INT ldQhat, SCALAR *UDU, int *ipivot, int numQ, SCALAR *X,
+      PRIMME_INT ldX, SCALAR *Xhat, PRIMME_INT ldXhat, SCALAR *xKinvx,
+      int numX, int *perm, SCALAR *v, PRIMME_INT ldv, int blockSize,
       SCALAR *rwork, primme_params *primme);
 
-static int apply_projected_matrix(SCALAR *v, REAL shift, SCALAR *Q, 
-      PRIMME_INT ldQ, int dimQ, SCALAR *result, SCALAR *rwork,
+static int deflate_members(int *done, int numActive, int *perm,
+      qmr_state *state, SCALAR *g, SCALAR *d, SCALAR *w, PRIMME_INT ld,
+      SCALAR *delta, SCALAR *sol, PRIMME_INT ldsol, double *shifts,
       primme_params *primme);
 
-static int apply_projector(SCALAR *Q, PRIMME_INT ldQ, int numCols, SCALAR *v, 
-   SCALAR *rwork, primme_params *primme);
-
-static int dist_dot(SCALAR *x, int incx,
-   SCALAR *y, int incy, primme_params *primme, SCALAR *result);
+static int dist_dots_real(SCALAR *x, PRIMME_INT ldx, SCALAR *y,
+      PRIMME_INT ldy, int n, REAL *result, SCALAR *rwork,
+      primme_params *primme);
 
-static int dist_dot_real(SCALAR *x, int incx,
-   SCALAR *y, int incy, primme_params *primme, REAL *result);
+static int dist_sums_real(SCALAR *local, int n, REAL *result, SCALAR *rwork,
+      primme_params *primme);
 
 
 /*******************************************************************************
- * Function inner_solve - This subroutine solves the correction equation
+ * Function inner_solve - This subroutine solves the correction equations
  *    
- *           (I-QQ')(I-xx')(A-shift*I)(I-xx')(I-QQ')sol = -r 
+ *           (I-QQ')(I-x_ix_i')(A-shift_i*I)(I-x_ix_i')(I-QQ')sol_i = -r_i
+ *
+ *    with Q = evecs, for every Ritz vector x_i in the block, using hermitian
+ *    simplified QMR. The QMR iterations of all members advance together: every
+ *    step calls the matrix-vector product and the preconditioner once for the
+ *    block, and every inner product of the recurrences is reduced among
+ *    processes with a single global sum for the block. A member leaves the
+ *    block as soon as its stopping criterion is met, and the rest continue.
  *
- *    with Q = evecs, using hermitian simplified QMR.
  *    A preconditioner may be applied to this system to accelerate convergence.
  *    The preconditioner is assumed to approximate (A-shift*I)^{-1}.  The
  *    classical JD method as described in Templates for the Solution of 
@@ -87,22 +116,28 @@ static int dist_dot_real(SCALAR *x, int incx,
  *
  * Input parameters
  * ----------------
- * x           The current Ritz vector for which the correction is being solved.
+ * blockSize   The number of correction equations
  *
- * r           The residual with respect to the Ritz vector.
+ * x           The current Ritz vectors for which the correction is being
+ *             solved.
  *
- * evecs       The converged Ritz vectors
+ * ldx         The leading dimension of x
  *
- * evecsHat    K^{-1}*evecs where K is a hermitian preconditioner.
+ * r           The residuals with respect to the Ritz vectors.
+ *
+ * ldr         The leading dimension of r
+ *
+ * evecs       The converged Ritz vectors
  *
  * UDU         The factors of the hermitian projection (evecs'*evecsHat). 
  *
  * ipivot      The pivoting for the UDU factorization
  *
- * xKinvx      The value x'*Kinv*x needed if skew-X projection
+ * xKinvx      The values x_i'*Kinv*x_i needed if skew-X projection
  *
- * Lprojector  Points to an array that includes all the left projector.
- *             Can be any combination of [evecs x], [evecs], [x], NULL.
+ * LprojectorQ Points to the left projector for Q: [evecs] or NULL
+ *
+ * LprojectorX Points to the left projector for x: [x] or NULL
  *
  * RprojectorQ Points to an array that includes the right skew projector for Q:
  *             It can be [evecsHat] or Null
@@ -110,37 +145,41 @@ static int dist_dot_real(SCALAR *x, int incx,
  * RprojectorX Points to an array that includes the right skew projector for x:
  *             It can be [Kinvx] or Null
  *
- * sizeLprojector   Number of colums of Lprojector
+ * sizeLprojectorQ  Number of colums of LprojectorQ
+ *
+ * sizeLprojectorX  Number of colums of LprojectorX per member (0 or 1)
  *
  * sizeRprojectorQ  Number of colums of RprojectorQ
  *
- * sizeRprojectorX  Number of colums of LprojectorX
+ * sizeRprojectorX  Number of colums of RprojectorX per member (0 or 1)
  *
- * eval        The current Ritz value 
+ * eval        The current Ritz values 
  *
- * shift       Correction eq. shift. The closer the shift is to the target 
+ * shift       Correction eq. shifts. The closer the shift is to the target 
  *             eigenvalue, the more accurate the correction will be.
  *
  * machEps     machine precision
  *
- * rwork       Real workspace of size 
- *             4*primme->nLocal + 2*(primme->numOrthoConst+primme->numEvals)
+ * rwork       Real workspace of size rworkSize
  *
- * rworkSize   Size of the rwork array
+ * rworkSize   Size of the rwork array. If x is NULL, it returns the needed
+ *             size in rworkSize and exits
  *
  * primme      Structure containing various solver parameters
  *
  *
  * Input/Output parameters
  * -----------------------
- * r       The residual with respect to the Ritz vector.  May be altered upon
+ * r       The residuals with respect to the Ritz vectors. May be altered upon
  *         return.
- * rnorm   On input, the 2 norm of r. No need to recompute it initially.
- *         On output, the estimated 2 norm of the updated eigenvalue residual
+ * rnorm   On input, the 2 norms of r. No need to recompute them initially.
+ *         On output, the estimated 2 norms of the updated eigenvalue residuals
  * 
  * Output parameters
  * -----------------
- * sol   The solution (correction) of the correction equation
+ * sol     The solutions (corrections) of the correction equations
+ *
+ * ldsol   The leading dimension of sol
  *
  * Return Value
  * ------------
@@ -150,34 +189,41 @@ static int dist_dot_real(SCALAR *x, int incx,
  ******************************************************************************/
 
 TEMPLATE_PLEASE
-int inner_solve_Sprimme(SCALAR *x, SCALAR *r, REAL *rnorm, SCALAR *evecs,
-      PRIMME_INT ldevecs, SCALAR *UDU, int *ipivot, SCALAR *xKinvx,
-      SCALAR *Lprojector, PRIMME_INT ldLprojector, SCALAR *RprojectorQ,
-      PRIMME_INT ldRprojectorQ, SCALAR *RprojectorX, PRIMME_INT ldRprojectorX,
-      int sizeLprojector, int sizeRprojectorQ, int sizeRprojectorX, SCALAR *sol,
-      REAL eval, REAL shift, double machEps, SCALAR *rwork, size_t rworkSize,
-      primme_params *primme) {
-
-   int i;             /* loop variable                                       */
+int inner_solve_Sprimme(int blockSize, SCALAR *x, PRIMME_INT ldx, SCALAR *r,
+      PRIMME_INT ldr, REAL *rnorm, SCALAR *evecs, PRIMME_INT ldevecs,
+      SCALAR *UDU, int *ipivot, SCALAR *xKinvx, SCALAR *LprojectorQ,
+      PRIMME_INT ldLprojectorQ, SCALAR *LprojectorX, PRIMME_INT ldLprojectorX,
+      SCALAR *RprojectorQ, PRIMME_INT ldRprojectorQ, SCALAR *RprojectorX,
+      PRIMME_INT ldRprojectorX, int sizeLprojectorQ, int sizeLprojectorX,
+      int sizeRprojectorQ, int sizeRprojectorX, SCALAR *sol, PRIMME_INT ldsol,
+      REAL *eval, double *shift, double machEps, SCALAR *rwork,
+      size_t *rworkSize, primme_params *primme) {
+
+   int i, j;          /* Loop variables                                      */
    int numIts;        /* Number of inner iterations                          */
    int maxIterations; /* The maximum # iterations allowed. Depends on primme */
+   int numActive;     /* Number of members still iterating                   */
+   int *perm;         /* perm[j] is the member in the j-th column of g, d, w */
+   int *done;         /* done[j] if the member in the j-th column finished   */
+   PRIMME_INT ld;     /* Leading dimension of g, d, w and delta              */
+   size_t neededSize; /* Needed size for rwork                               */
+   qmr_state *state;  /* QMR state of every member                           */
+   qmr_state *s;      /* QMR state of the current member                     */
+   double *shifts;    /* Shifts of the members in the columns of g, d, w     */
+   REAL *sums;        /* Inner products reduced among processes              */
 
    SCALAR *workSpace; /* Workspace needed by UDU routine */
 
    /* QMR parameters */
 
    SCALAR *g, *d, *delta, *w, *ptmp;
-   REAL alpha_prev, beta, rho_prev, rho;
-   REAL Theta_prev, Theta, c, sigma_prev, tau_init, tau_prev, tau; 
+   REAL c, rho;
 
    /* Parameters used to dynamically update eigenpair */
-   REAL Beta=0.0, Delta=0.0, Psi=0.0, Beta_prev, Delta_prev, Psi_prev, eta;
-   REAL dot_sol, eval_updated, eval_prev, eres2_updated, eres_updated=0.0, R;
-   REAL Gamma_prev, Phi_prev;
-   REAL Gamma=0.0, Phi=0.0;
-   REAL gamma;
+   REAL eval_updated, eres2_updated, R;
+   int adaptive;       /* if the eigenpair is monitored by the recurrences  */
 
-   REAL LTolerance, ETolerance, LTolerance_factor, ETolerance_factor;
+   REAL LTolerance, LTolerance_factor, ETolerance_factor;
    int isConv;
    double aNorm;
 
@@ -185,27 +231,52 @@ int inner_solve_Sprimme(SCALAR *x, SCALAR *r, REAL *rnorm, SCALAR *evecs,
    /* Subdivide the workspace into needed arrays */
    /* -------------------------------------------*/
 
+   ld = primme->ldOPs;
+   i = primme->numOrthoConst + primme->numEvals + 1;
+   neededSize = (size_t)ld*blockSize*4 + (size_t)i*blockSize*2
+      + (blockSize*(sizeof(qmr_state) + sizeof(double) + 2*sizeof(int))
+            + blockSize*sizeof(REAL) + 2*sizeof(double))/sizeof(SCALAR) + 1;
+   if (x == NULL) {
+      *rworkSize = max(*rworkSize, neededSize);
+      return 0;
+   }
+   assert(*rworkSize >= neededSize);
+
    g      = rwork;
-   d      = g + primme->nLocal;
-   delta  = d + primme->nLocal;
-   w      = delta + primme->nLocal;
-   workSpace = w + primme->nLocal; /* This needs at least 2*numOrth+NumEvals) */
-   assert(rworkSize >= (size_t)primme->nLocal*4
-                       + 2*(primme->numOrthoConst+primme->numEvals));
+   d      = g + ld*blockSize;
+   delta  = d + ld*blockSize;
+   w      = delta + ld*blockSize;
+   workSpace = w + ld*blockSize; /* 2*(numOrth+NumEvals+1)*blockSize */
+   #define ALIGN(ptr,T) (((uintptr_t)(ptr)+sizeof(T)-1) & -sizeof(T))
+   state  = (qmr_state*)ALIGN(workSpace + i*blockSize*2, double);
+   shifts = (double*)ALIGN(state + blockSize, double);
+   sums   = (REAL*)(shifts + blockSize);
+   perm   = (int*)ALIGN(sums + blockSize, int);
+   done   = perm + blockSize;
+   #undef ALIGN
 
    /* -----------------------------------------*/
    /* Set up convergence criteria by Tolerance */
    /* -----------------------------------------*/
 
    aNorm = max(primme->stats.estimateLargestSVal, primme->aNorm);
-   tau_prev = tau_init = *rnorm;       /* Assumes zero initial guess */
 
    /* NOTE: In any case stop when linear system residual is less than         */
    /*       max(machEps,eps)*aNorm.                                           */
    LTolerance = machEps*aNorm;
    LTolerance_factor = 1.0;
-   ETolerance = 0.0;
    ETolerance_factor = 0.0;
+   adaptive = 0;
+
+   for (i=0; i<blockSize; i++) {
+      s = &state[i];
+      s->eval = s->eval_prev = eval[i];
+      s->shift = shift[i];
+      s->tau_prev = s->tau_init = rnorm[i]; /* Assumes zero initial guess */
+      s->ETolerance = 0.0;
+      s->eres_updated = 0.0;
+      s->pending = 0;
+   }
 
    switch(primme->correctionParams.convTest) {
    case primme_full_LTolerance:
@@ -228,60 +299,68 @@ int inner_solve_Sprimme(SCALAR *x, SCALAR *r, REAL *rnorm, SCALAR *evecs,
       /* residual norm is less than aNorm*eps/1.8.                            */
       LTolerance_factor = 1.0/1.8;
       ETolerance_factor = 1.0/1.8;
+      adaptive = 1;
       break; 
    case primme_adaptive_ETolerance:
       /* Besides the primme_adaptive criteria, stop when estimate eigenvalue  */
       /* residual norm is less than tau_init*0.1                              */
       LTolerance_factor = 1.0/1.8;
       ETolerance_factor = 1.0/1.8;
-      ETolerance = tau_init*0.1;
+      adaptive = 1;
+      for (i=0; i<blockSize; i++) {
+         state[i].ETolerance = state[i].tau_init*0.1;
+      }
      }
    
    /* --------------------------------------------------------*/
    /* Set up convergence criteria by max number of iterations */
    /* --------------------------------------------------------*/
 
-   /* compute first total number of remaining matvecs */
+   /* The remaining matvecs are checked before every step, because every  */
+   /* active member consumes one                                          */
 
-   if (primme->maxMatvecs > 0) {
-      maxIterations = primme->maxMatvecs - primme->stats.numMatvecs;
+   if (primme->correctionParams.maxInnerIterations > 0) {
+      maxIterations = primme->correctionParams.maxInnerIterations;
    }
    else {
       maxIterations = INT_MAX;
    }
 
-   /* Perform primme.maxInnerIterations, but do not exceed total remaining */
-   if (primme->correctionParams.maxInnerIterations > 0) {
-
-      maxIterations = min(primme->correctionParams.maxInnerIterations, 
-                          maxIterations);
-   }
-
    /* --------------------------------------------------------*/
    /* Rest of initializations                                 */
    /* --------------------------------------------------------*/
 
+   numActive = blockSize;
+   for (i=0; i<blockSize; i++) {
+      perm[i] = i;
+      shifts[i] = shift[i];
+   }
+
    /* Assume zero initial guess */
-   Num_copy_Sprimme(primme->nLocal, r, 1, g, 1);
+   Num_copy_matrix_Sprimme(r, primme->nLocal, blockSize, ldr, g, ld);
 
-   CHKERR(apply_projected_preconditioner(g, evecs, ldevecs, RprojectorQ,
-           ldRprojectorQ, x, RprojectorX, ldRprojectorX, sizeRprojectorQ,
-           sizeRprojectorX, xKinvx, UDU, ipivot, d, workSpace, primme), -1);
+   CHKERR(apply_projected_preconditioner(g, ld, numActive, evecs, ldevecs,
+            RprojectorQ, ldRprojectorQ, sizeRprojectorQ, UDU, ipivot, x, ldx,
+            RprojectorX, ldRprojectorX, sizeRprojectorX, xKinvx, perm, shifts,
+            d, ld, workSpace, primme), -1);
 
-   Theta_prev = 0.0L;
-   eval_prev = eval;
-   CHKERR(dist_dot_real(g, 1, d, 1, primme, &rho_prev), -1);
+   CHKERR(dist_dots_real(g, ld, d, ld, numActive, sums, workSpace, primme),
+         -1);
 
    /* Initialize recurrences used to dynamically update the eigenpair */
 
-   Beta_prev = Delta_prev = Psi_prev = 0.0L;
-   Gamma_prev = Phi_prev = 0.0L;
+   for (i=0; i<blockSize; i++) {
+      s = &state[i];
+      s->rho_prev = sums[i];
+      s->Theta_prev = 0.0L;
+      s->Beta_prev = s->Delta_prev = s->Psi_prev = 0.0L;
+      s->Gamma_prev = s->Phi_prev = 0.0L;
+      s->Beta = s->Delta = s->Psi = s->Gamma = s->Phi = 0.0L;
+   }
 
    /* other initializations */
-   for (i = 0; i < primme->nLocal; i++) {
-      delta[i] = 0.0;
-      sol[i] = 0.0;
-   }
+   Num_zero_matrix_Sprimme(delta, primme->nLocal, blockSize, ld);
+   Num_zero_matrix_Sprimme(sol, primme->nLocal, blockSize, ldsol);
 
    numIts = 0;
       
@@ -291,243 +370,427 @@ int inner_solve_Sprimme(SCALAR *x, SCALAR *r, REAL *rnorm, SCALAR *evecs,
 
    while (numIts < maxIterations) {
 
-      CHKERR(apply_projected_matrix(d, shift, Lprojector, ldLprojector,
-               sizeLprojector, w, workSpace, primme), -1);
-      CHKERR(dist_dot_real(d, 1, w, 1, primme, &sigma_prev), -1);
+      /* Stop the members that exceed the remaining matvecs */
 
-      if (sigma_prev == 0.0L) {
-         if (primme->printLevel >= 5 && primme->procID == 0) {
-            fprintf(primme->outputFile,"Exiting because SIGMA %e\n",sigma_prev);
+      if (primme->maxMatvecs > 0) {
+         for (j=0; j<numActive; j++) {
+            done[j] = primme->stats.numMatvecs + j >= primme->maxMatvecs;
          }
-         break;
+         numActive = deflate_members(done, numActive, perm, state, g, d, NULL,
+               ld, delta, sol, ldsol, shifts, primme);
       }
+      if (numActive == 0) break;
+
+      CHKERR(apply_projected_matrix(d, ld, numActive, shifts, LprojectorQ,
+               ldLprojectorQ, sizeLprojectorQ, LprojectorX, ldLprojectorX,
+               sizeLprojectorX, perm, w, ld, workSpace, primme), -1);
+      CHKERR(dist_dots_real(d, ld, w, ld, numActive, sums, workSpace, primme),
+            -1);
 
-      alpha_prev = rho_prev/sigma_prev;
-      if (fabs(alpha_prev) < machEps || fabs(alpha_prev) > 1.0L/machEps){
-         if (primme->printLevel >= 5 && primme->procID == 0) {
-            fprintf(primme->outputFile,"Exiting because ALPHA %e\n",alpha_prev);
+      for (j=0; j<numActive; j++) {
+         s = &state[perm[j]];
+         s->sigma_prev = sums[j];
+         done[j] = 0;
+
+         if (s->sigma_prev == 0.0L) {
+            if (primme->printLevel >= 5 && primme->procID == 0) {
+               fprintf(primme->outputFile,"Exiting because SIGMA %e\n",
+                     s->sigma_prev);
+            }
+            done[j] = 1;
+            continue;
          }
-         break;
-      }
 
-      Num_axpy_Sprimme(primme->nLocal, -alpha_prev, w, 1, g, 1);
+         s->alpha_prev = s->rho_prev/s->sigma_prev;
+         if (fabs(s->alpha_prev) < machEps
+               || fabs(s->alpha_prev) > 1.0L/machEps){
+            if (primme->printLevel >= 5 && primme->procID == 0) {
+               fprintf(primme->outputFile,"Exiting because ALPHA %e\n",
+                     s->alpha_prev);
+            }
+            done[j] = 1;
+         }
+      }
+      numActive = deflate_members(done, numActive, perm, state, g, d, w, ld,
+            delta, sol, ldsol, shifts, primme);
+      if (numActive == 0) break;
 
-      CHKERR(dist_dot_real(g, 1, g, 1, primme, &Theta), -1);
-      Theta = sqrt(Theta);
-      Theta = Theta/tau_prev;
-      c = 1.0L/sqrt(1+Theta*Theta);
-      tau = tau_prev*Theta*c;
+      /* g = g - alpha_prev*w; Theta = ||g||^2 */
 
-      gamma = c*c*Theta_prev*Theta_prev;
-      eta = alpha_prev*c*c;
-      for (i = 0; i < primme->nLocal; i++) {
-          delta[i] = gamma*delta[i] + eta*d[i];
-          sol[i] = delta[i]+sol[i];
+      for (j=0; j<numActive; j++) {
+         workSpace[j] = Num_axpy_sqnorm_Sprimme(primme->nLocal,
+               -state[perm[j]].alpha_prev, &w[ld*j], &g[ld*j]);
+      }
+      CHKERR(dist_sums_real(workSpace, numActive, sums, workSpace+numActive,
+               primme), -1);
+
+      for (j=0; j<numActive; j++) {
+         s = &state[perm[j]];
+         s->Theta = sqrt(sums[j]);
+         s->Theta = s->Theta/s->tau_prev;
+         c = 1.0L/sqrt(1+s->Theta*s->Theta);
+         s->tau = s->tau_prev*s->Theta*c;
+
+         s->gamma = c*c*s->Theta_prev*s->Theta_prev;
+         s->eta = s->alpha_prev*c*c;
+
+         /* delta = gamma*delta + eta*d; sol = sol + delta. The adaptive   */
+         /* stopping needs ||sol||^2 now; otherwise the update is delayed  */
+         /* to the pass that computes the next d                           */
+
+         if (adaptive) {
+            workSpace[j] = Num_axpby_accum_Sprimme(primme->nLocal, s->eta,
+                  &d[ld*j], s->gamma, &delta[ld*perm[j]], &sol[ldsol*perm[j]]);
+         }
+         else {
+            s->pending = 1;
+         }
       }
       numIts++;
 
-      if (fabs(rho_prev) == 0.0L ) {
-         if (primme->printLevel >= 5 && primme->procID == 0) {
-            fprintf(primme->outputFile,"Exiting because abs(rho) %e\n",
-               fabs(rho_prev));
-         }
-         break;
+      if (adaptive) {
+         CHKERR(dist_sums_real(workSpace, numActive, sums,
+                  workSpace+numActive, primme), -1);
       }
+
+      for (j=0; j<numActive; j++) {
+         s = &state[perm[j]];
+         done[j] = 1;
+
+         if (fabs(s->rho_prev) == 0.0L ) {
+            if (primme->printLevel >= 5 && primme->procID == 0) {
+               fprintf(primme->outputFile,"Exiting because abs(rho) %e\n",
+                  fabs(s->rho_prev));
+            }
+            continue;
+         }
       
-      if (numIts > 1 && tau < LTolerance) {
-         if (primme->printLevel >= 5 && primme->procID == 0) {
-            fprintf(primme->outputFile, " tau < LTol %e %e\n",tau, LTolerance);
+         if (numIts > 1 && s->tau < LTolerance) {
+            if (primme->printLevel >= 5 && primme->procID == 0) {
+               fprintf(primme->outputFile, " tau < LTol %e %e\n",s->tau,
+                     LTolerance);
+            }
+            continue;
          }
-         break;
-      }
-      if (ETolerance > 0.0 || ETolerance_factor > 0.0) {
-         /* --------------------------------------------------------*/
-         /* Adaptive stopping based on dynamic monitoring of eResid */
-         /* --------------------------------------------------------*/
+         if (adaptive) {
+            /* --------------------------------------------------------*/
+            /* Adaptive stopping based on dynamic monitoring of eResid */
+            /* --------------------------------------------------------*/
 
-         /* Update the Ritz value and eigenresidual using the */
-         /* following recurrences.                            */
+            /* Update the Ritz value and eigenresidual using the */
+            /* following recurrences.                            */
       
-         Delta = gamma*Delta_prev + eta*rho_prev;
-         Beta = Beta_prev - Delta;
-         Phi = gamma*gamma*Phi_prev + eta*eta*sigma_prev;
-         Psi = gamma*Psi_prev + gamma*Phi_prev;
-         Gamma = Gamma_prev + 2.0L*Psi + Phi;
+            s->Delta = s->gamma*s->Delta_prev + s->eta*s->rho_prev;
+            s->Beta = s->Beta_prev - s->Delta;
+            s->Phi = s->gamma*s->gamma*s->Phi_prev
+               + s->eta*s->eta*s->sigma_prev;
+            s->Psi = s->gamma*s->Psi_prev + s->gamma*s->Phi_prev;
+            s->Gamma = s->Gamma_prev + 2.0L*s->Psi + s->Phi;
         
-         /* Perform the update: update the eigenvalue and the square of the  */
-         /* residual norm.                                                   */
+            /* Perform the update: update the eigenvalue and the square of */
+            /* the residual norm.                                          */
          
-         CHKERR(dist_dot_real(sol, 1, sol, 1, primme, &dot_sol), -1);
-         eval_updated = shift + (eval - shift + 2*Beta + Gamma)/(1 + dot_sol);
-         eres2_updated = (tau*tau)/(1 + dot_sol) + 
-            ((eval - shift + Beta)*(eval - shift + Beta))/(1 + dot_sol) - 
-            (eval_updated - shift)*(eval_updated - shift);
-
-         /* If numerical problems, let eres about the same as tau */
-         if (eres2_updated < 0){
-            eres_updated = sqrt( (tau*tau)/(1 + dot_sol) );
-         }
-         else 
-            eres_updated = sqrt(eres2_updated);
+            s->dot_sol = sums[j];
+            eval_updated = s->shift + (s->eval - s->shift + 2*s->Beta
+                  + s->Gamma)/(1 + s->dot_sol);
+            eres2_updated = (s->tau*s->tau)/(1 + s->dot_sol) + 
+               ((s->eval - s->shift + s->Beta)*(s->eval - s->shift + s->Beta))
+                  /(1 + s->dot_sol)
+               - (eval_updated - s->shift)*(eval_updated - s->shift);
+
+            /* If numerical problems, let eres about the same as tau */
+            if (eres2_updated < 0){
+               s->eres_updated = sqrt( (s->tau*s->tau)/(1 + s->dot_sol) );
+            }
+            else 
+               s->eres_updated = sqrt(eres2_updated);
 
-         /* --------------------------------------------------------*/
-         /* Stopping criteria                                       */
-         /* --------------------------------------------------------*/
+            /* --------------------------------------------------------*/
+            /* Stopping criteria                                       */
+            /* --------------------------------------------------------*/
 
-         R = max(0.9878, sqrt(tau/tau_prev))*sqrt(1+dot_sol);
+            R = max(0.9878, sqrt(s->tau/s->tau_prev))*sqrt(1+s->dot_sol);
         
-         if (numIts > 1 && (tau <= R*eres_updated || eres_updated <= tau*R) ) {
-            if (primme->printLevel >= 5 && primme->procID == 0) {
-               fprintf(primme->outputFile, " tau < R eres \n");
+            if (numIts > 1 && (s->tau <= R*s->eres_updated
+                     || s->eres_updated <= s->tau*R) ) {
+               if (primme->printLevel >= 5 && primme->procID == 0) {
+                  fprintf(primme->outputFile, " tau < R eres \n");
+               }
+               continue;
             }
-            break;
-         }
 
-         if (primme->target == primme_smallest && eval_updated > eval_prev) {
-            if (primme->printLevel >= 5 && primme->procID == 0) {
-               fprintf(primme->outputFile, "eval_updated > eval_prev\n");
+            if (primme->target == primme_smallest
+                  && eval_updated > s->eval_prev) {
+               if (primme->printLevel >= 5 && primme->procID == 0) {
+                  fprintf(primme->outputFile, "eval_updated > eval_prev\n");
+               }
+               continue;
             }
-            break;
-         }
-         else if (primme->target == primme_largest && eval_updated < eval_prev){
-            if (primme->printLevel >= 5 && primme->procID == 0) {
-               fprintf(primme->outputFile, "eval_updated < eval_prev\n");
+            else if (primme->target == primme_largest
+                  && eval_updated < s->eval_prev){
+               if (primme->printLevel >= 5 && primme->procID == 0) {
+                  fprintf(primme->outputFile, "eval_updated < eval_prev\n");
+               }
+               continue;
             }
-            break;
-         }
          
-         if (numIts > 1 && eres_updated < ETolerance) {
-            if (primme->printLevel >= 5 && primme->procID == 0) {
-               fprintf(primme->outputFile, "eres < eresTol %e \n",eres_updated);
+            if (numIts > 1 && s->eres_updated < s->ETolerance) {
+               if (primme->printLevel >= 5 && primme->procID == 0) {
+                  fprintf(primme->outputFile, "eres < eresTol %e \n",
+                        s->eres_updated);
+               }
+               continue;
             }
-            break;
-         }
 
-         /* Check if some of the next conditions is satisfied:                */
-         /* a) estimate eigenvalue residual norm (eres_updated) is less       */
-         /*    than eps*aNorm*Etolerance_factor                               */
-         /* b) linear system residual norm is less                            */
-         /*    than eps*aNorm*LTolerance_factor                               */
-         /* The result is to check if eps*aNorm is less than                  */
-         /* max(tau/LTolerance_factor, eres_updated/ETolerance_factor).       */
+            /* Check if some of the next conditions is satisfied:             */
+            /* a) estimate eigenvalue residual norm (eres_updated) is less    */
+            /*    than eps*aNorm*Etolerance_factor                            */
+            /* b) linear system residual norm is less                         */
+            /*    than eps*aNorm*LTolerance_factor                            */
+            /* The result is to check if eps*aNorm is less than               */
+            /* max(tau/LTolerance_factor, eres_updated/ETolerance_factor).    */
+
+            double tol = min(s->tau/LTolerance_factor,
+                  s->eres_updated/ETolerance_factor);
+            CHKERR(convTestFun_Sprimme(eval_updated, NULL, tol, &isConv,
+                     primme), -1);
+
+            if (numIts > 1 && isConv) {
+               if (primme->printLevel >= 5 && primme->procID == 0) {
+                  fprintf(primme->outputFile, " eigenvalue and residual norm "
+                        "passed convergence criterion \n");
+               }
+               continue;
+            }
 
-         double tol = min(tau/LTolerance_factor, eres_updated/ETolerance_factor);
-         CHKERR(convTestFun_Sprimme(eval_updated, NULL, tol, &isConv, primme),
-               -1);
+            s->eval_prev = eval_updated;
 
-         if (numIts > 1 && isConv) {
-            if (primme->printLevel >= 5 && primme->procID == 0) {
-               fprintf(primme->outputFile, " eigenvalue and residual norm "
-                     "passed convergence criterion \n");
+            if (primme->printLevel >= 4 && primme->procID == 0) {
+               fprintf(primme->outputFile,
+                     "INN MV %" PRIMME_INT_P " Sec %e Eval %e Lin|r| %.3e EV|r| %.3e\n",
+                     primme->stats.numMatvecs, primme_wTimer(0), eval_updated,
+                     s->tau, s->eres_updated);
+               fflush(primme->outputFile);
             }
-            break;
-         }
 
-         eval_prev = eval_updated;
+           /* --------------------------------------------------------*/
+         } /* End of if adaptive JDQMR section                        */
+           /* --------------------------------------------------------*/
+         else {
+            /* Check if the linear system residual norm (tau) is less         */
+            /* than eps*aNorm*LTolerance_factor                               */
+
+            CHKERR(convTestFun_Sprimme(s->eval, NULL, s->tau/LTolerance_factor,
+                     &isConv, primme), -1);
+
+            if (numIts > 1 && isConv) {
+               if (primme->printLevel >= 5 && primme->procID == 0) {
+                  fprintf(primme->outputFile, " eigenvalue and residual norm "
+                        "passed convergence criterion \n");
+               }
+               continue;
+            }
 
-         if (primme->printLevel >= 4 && primme->procID == 0) {
-            fprintf(primme->outputFile,
-                  "INN MV %" PRIMME_INT_P " Sec %e Eval %e Lin|r| %.3e EV|r| %.3e\n",
-                  primme->stats.numMatvecs, primme_wTimer(0), eval_updated,
-                  tau, eres_updated);
-            fflush(primme->outputFile);
+            else if (primme->printLevel >= 4 && primme->procID == 0) {
+               /* Report for non adaptive inner iterations */
+               fprintf(primme->outputFile,
+                     "INN MV %" PRIMME_INT_P " Sec %e Lin|r| %e\n",
+                     primme->stats.numMatvecs, primme_wTimer(0),s->tau);
+               fflush(primme->outputFile);
+            }
          }
 
-        /* --------------------------------------------------------*/
-      } /* End of if adaptive JDQMR section                        */
-        /* --------------------------------------------------------*/
-      else {
-         /* Check if the linear system residual norm (tau) is less            */
-         /* than eps*aNorm*LTolerance_factor                                  */
+         done[j] = 0;
+      }
+      numActive = deflate_members(done, numActive, perm, state, g, d, NULL, ld,
+            delta, sol, ldsol, shifts, primme);
 
-         CHKERR(convTestFun_Sprimme(eval, NULL, tau/LTolerance_factor, &isConv,
+      if (numIts < maxIterations && numActive > 0) {
+
+         CHKERR(apply_projected_preconditioner(g, ld, numActive, evecs,
+                  ldevecs, RprojectorQ, ldRprojectorQ, sizeRprojectorQ, UDU,
+                  ipivot, x, ldx, RprojectorX, ldRprojectorX, sizeRprojectorX,
+                  xKinvx, perm, shifts, w, ld, workSpace, primme), -1);
+
+         CHKERR(dist_dots_real(g, ld, w, ld, numActive, sums, workSpace,
                   primme), -1);
 
-         if (numIts > 1 && isConv) {
-            if (primme->printLevel >= 5 && primme->procID == 0) {
-               fprintf(primme->outputFile, " eigenvalue and residual norm "
-                     "passed convergence criterion \n");
+         for (j=0; j<numActive; j++) {
+            s = &state[perm[j]];
+            rho = sums[j];
+            if (s->pending) {
+               /* delta = gamma*delta + eta*d; sol = sol + delta;  */
+               /* w = w + beta*d                                   */
+               Num_update_qmr_Sprimme(primme->nLocal, s->gamma, s->eta,
+                     rho/s->rho_prev, &d[ld*j], &delta[ld*perm[j]],
+                     &sol[ldsol*perm[j]], &w[ld*j]);
+               s->pending = 0;
             }
-            break;
-         }
-
-         else if (primme->printLevel >= 4 && primme->procID == 0) {
-            /* Report for non adaptive inner iterations */
-            fprintf(primme->outputFile,
-                  "INN MV %" PRIMME_INT_P " Sec %e Lin|r| %e\n",
-                  primme->stats.numMatvecs, primme_wTimer(0),tau);
-            fflush(primme->outputFile);
+            else {
+               Num_axpy_Sprimme(primme->nLocal, rho/s->rho_prev, &d[ld*j], 1,
+                     &w[ld*j], 1);
+            }
+      
+            s->rho_prev = rho; 
+            s->tau_prev = s->tau;
+            s->Theta_prev = s->Theta;
+
+            s->Delta_prev = s->Delta;
+            s->Beta_prev = s->Beta;
+            s->Phi_prev = s->Phi;
+            s->Psi_prev = s->Psi;
+            s->Gamma_prev = s->Gamma;
          }
-      }
-
-      if (numIts < maxIterations) {
-
-         CHKERR(apply_projected_preconditioner(g, evecs, ldevecs, RprojectorQ, 
-            ldRprojectorQ, x, RprojectorX, ldRprojectorX, sizeRprojectorQ,
-            sizeRprojectorX, xKinvx, UDU, ipivot, w, workSpace, primme), -1);
 
-         CHKERR(dist_dot_real(g, 1, w, 1, primme, &rho), -1);
-         beta = rho/rho_prev;
-         Num_axpy_Sprimme(primme->nLocal, beta, d, 1, w, 1);
          /* Alternate between w and d buffers in successive iterations
           * This saves a memory copy. */
          ptmp = d; d = w; w = ptmp;
-      
-         rho_prev = rho; 
-         tau_prev = tau;
-         Theta_prev = Theta;
-
-         Delta_prev = Delta;
-         Beta_prev = Beta;
-         Phi_prev = Phi;
-         Psi_prev = Psi;
-         Gamma_prev = Gamma;
+      }
+      else {
+         break;
       }
 
      /* --------------------------------------------------------*/
    } /* End of QMR main while loop                              */
      /* --------------------------------------------------------*/
 
-   *rnorm = eres_updated;
+   /* Finish the members still iterating */
+
+   for (j=0; j<numActive; j++) done[j] = 1;
+   deflate_members(done, numActive, perm, state, g, d, NULL, ld, delta, sol,
+         ldsol, shifts, primme);
+
+   for (i=0; i<blockSize; i++) {
+      rnorm[i] = state[i].eres_updated;
+   }
+
    return 0;
 }
    
 
+/*******************************************************************************
+ * Function deflate_members - Remove from the block the members that finished
+ *    their inner iterations. The delayed updates of their delta and sol are
+ *    performed, and the columns of g, d and w of the last members are moved
+ *    into the freed columns, so the remaining members are the first ones.
+ *
+ * Input Parameters
+ * ----------------
+ * done      done[j] is nonzero if the member in the j-th column finished
+ *
+ * numActive The number of members in the block
+ *
+ * state     The QMR state of all members
+ *
+ * ld        The leading dimension of g, d, w and delta
+ *
+ * ldsol     The leading dimension of sol
+ *
+ * Input/Output Parameters
+ * -----------------------
+ * perm      perm[j] is the member in the j-th column of g, d, w
+ *
+ * g, d, w   The QMR vectors of the members, one per column. w may be NULL
+ *
+ * delta, sol The QMR vectors of all members, indexed by member
+ *
+ * shifts    The shifts of the members in the columns of g, d and w
+ *
+ * Return Value
+ * ------------
+ * The number of members still in the block
+ *
+ ******************************************************************************/
+
+static int deflate_members(int *done, int numActive, int *perm,
+      qmr_state *state, SCALAR *g, SCALAR *d, SCALAR *w, PRIMME_INT ld,
+      SCALAR *delta, SCALAR *sol, PRIMME_INT ldsol, double *shifts,
+      primme_params *primme) {
+
+   int j, last;
+   qmr_state *s;
+
+   for (j=0; j<numActive; ) {
+      if (!done[j]) {
+         j++;
+         continue;
+      }
+
+      /* Finish the member */
+
+      s = &state[perm[j]];
+      if (s->pending) {
+         Num_axpby_accum_Sprimme(primme->nLocal, s->eta, &d[ld*j], s->gamma,
+               &delta[ld*perm[j]], &sol[ldsol*perm[j]]);
+         s->pending = 0;
+      }
+
+      /* Move the last member into its columns */
+
+      last = --numActive;
+      if (j != last) {
+         Num_copy_matrix_Sprimme(&g[ld*last], primme->nLocal, 1, ld, &g[ld*j],
+               ld);
+         Num_copy_matrix_Sprimme(&d[ld*last], primme->nLocal, 1, ld, &d[ld*j],
+               ld);
+         if (w) {
+            Num_copy_matrix_Sprimme(&w[ld*last], primme->nLocal, 1, ld,
+                  &w[ld*j], ld);
+         }
+         perm[j] = perm[last];
+         shifts[j] = shifts[last];
+         done[j] = done[last];
+      }
+   }
+
+   return numActive;
+}
+
+
 /*******************************************************************************
  * Function apply_projected_preconditioner - This routine applies the
- *    projected preconditioner to a vector v by computing:
+ *    projected preconditioner to every column v_j of v by computing:
  *
- *         result = (I-Kinvx/xKinvx*x') (I - Qhat (Q'*Qhat)^{-1}Q') Kinv*v
+ *         result_j = (I-Kinvx/xKinvx*x') (I - Qhat (Q'*Qhat)^{-1}Q') Kinv*v_j
  *
- *    First we apply the preconditioner Kinv*v, and then the two projectors 
- *    are computed one after the other.
+ *    where x is the Ritz vector of the member in the column. First we apply
+ *    the preconditioner Kinv*v, and then the two projectors are computed one
+ *    after the other.
  *    
  * Input Parameters
  * ----------------
- * v      The vector the projected preconditioner will be applied to.
+ * v      The vectors the projected preconditioner will be applied to.
+ *
+ * ldv    The leading dimension of v
+ *
+ * blockSize The number of columns of v
  *
  * Q      The matrix evecs where evecs are the locked/converged eigenvectors
  *
  * RprojectorQ     The matrix K^{-1}Q (often called Qhat), Q, or nothing,
  *                 as determined by setup_JD_projectors.
  *
- * x               The current Ritz vector.
- *
- * RprojectorX     The matrix K^{-1}x (if needed)
- *
  * sizeRprojectorQ The number of columns in RprojectorQ
  *
- * sizeRprojectorX The number of columns in RprojectorX
- *
- * xKinvx The value x^T (Kinv*x). It is computed in the setup_JD_projectors
- *
  * UDU    The UDU decomposition of (Q'*K^{-1}*Q).  See LAPACK routine dsytrf
  *        for more details
  *
  * ipivot Permutation array indicating how the rows of the UDU decomposition
  *        have been pivoted.
  *
- * rwork  Real work array of size 2*sizeRprojectorQ=(2*orthoConst+2*numEvals)
+ * x               The current Ritz vectors of all members.
+ *
+ * RprojectorX     The matrix K^{-1}x (if needed)
+ *
+ * sizeRprojectorX The number of columns in RprojectorX per member
+ *
+ * xKinvx The values x^T (Kinv*x). It is computed in the setup_JD_projectors
+ *
+ * perm   perm[j] is the member of the column j of v
+ *
+ * shifts The shifts of the columns of v for the preconditioner
+ *
+ * rwork  Real work array of size 2*(sizeRprojectorQ+1)*blockSize
  *
  * primme   Structure containing various solver parameters.
  *
@@ -538,112 +801,152 @@ int inner_solve_Sprimme(SCALAR *x, SCALAR *r, REAL *rnorm, SCALAR *evecs,
  *
  ******************************************************************************/
 
-static int apply_projected_preconditioner(SCALAR *v, SCALAR *Q, PRIMME_INT ldQ,
-      SCALAR *RprojectorQ, PRIMME_INT ldRprojectorQ, SCALAR *x,
-      SCALAR *RprojectorX,  PRIMME_INT ldRprojectorX, int sizeRprojectorQ,
-      int sizeRprojectorX, SCALAR *xKinvx, SCALAR *UDU, int *ipivot,
-      SCALAR *result, SCALAR *rwork, primme_params *primme) {  
+static int apply_projected_preconditioner(SCALAR *v, PRIMME_INT ldv,
+      int blockSize, SCALAR *Q, PRIMME_INT ldQ, SCALAR *RprojectorQ,
+      PRIMME_INT ldRprojectorQ, int sizeRprojectorQ, SCALAR *UDU, int *ipivot,
+      SCALAR *x, PRIMME_INT ldx, SCALAR *RprojectorX, PRIMME_INT ldRprojectorX,
+      int sizeRprojectorX, SCALAR *xKinvx, int *perm, double *shifts,
+      SCALAR *result, PRIMME_INT ldresult, SCALAR *rwork,
+      primme_params *primme) {
 
    /* Place K^{-1}v in result */
-   CHKERR(applyPreconditioner_Sprimme(v, primme->nLocal, primme->nLocal, result,
-            primme->nLocal, 1, primme), -1);
+   primme->ShiftsForPreconditioner = shifts;
+   CHKERR(applyPreconditioner_Sprimme(v, primme->nLocal, ldv, result,
+            ldresult, blockSize, primme), -1);
 
-   CHKERR(apply_skew_projector(Q, ldQ, RprojectorQ, ldRprojectorQ, UDU, ipivot,
-            sizeRprojectorQ, result, rwork, primme), -1);
+   CHKERR(apply_block_projector(Q, ldQ, RprojectorQ, ldRprojectorQ, UDU,
+            ipivot, sizeRprojectorQ, NULL, 0, NULL, 0, NULL, 0, perm, result,
+            ldresult, blockSize, rwork, primme), -1);
 
-   CHKERR(apply_skew_projector(x, primme->nLocal, RprojectorX, ldRprojectorX,
-            xKinvx, ipivot, sizeRprojectorX, result, rwork, primme), -1);
+   CHKERR(apply_block_projector(NULL, 0, NULL, 0, NULL, NULL, 0, x, ldx,
+            RprojectorX, ldRprojectorX, xKinvx, sizeRprojectorX, perm, result,
+            ldresult, blockSize, rwork, primme), -1);
 
    return 0;
 }
 
 /*******************************************************************************
- * Subroutine apply_skew_projector - Apply the skew projector to a vector v:
+ * Subroutine apply_block_projector - Apply the skew projectors to every
+ *    column v_j of v:
  *
- *     v = (I-Qhat*inv(Q'Qhat)*Q') v
+ *     v_j = (I - Qhat*inv(Q'Qhat)*Q' - xhat*inv(x'xhat)*x') v_j
  *
- *   The result is placed back in v.  Q is the matrix of converged Ritz 
- *   vectors or the current Ritz vector.
+ *   where x and xhat are the columns perm[j] of X and Xhat. Both projections
+ *   are computed from the same overlaps, so they are orthogonal when
+ *   x is orthogonal to Q. The overlaps of all columns are added up among
+ *   processes with a single global sum.
  *
  * Input Parameters
  * ----------------
- * Q       The matrix of converged Ritz vectors and the current Ritz vector
+ * Q       The matrix of converged Ritz vectors
  *
  * Qhat    The matrix of K^{-1}Q
  *
- * UDU     The factorization of the (Q'*Qhat) matrix
+ * UDU     The factorization of the (Q'*Qhat) matrix. If NULL, Q'Qhat = I
  *
  * ipivot  The pivot array for the UDU factorization
  *
- * numCols Number of columns of Q and Qhat
+ * numQ    Number of columns of Q and Qhat
+ *
+ * X       The Ritz vectors of all members
+ *
+ * Xhat    The matrix of K^{-1}X
  *
- * rwork   Work array of size 2*numCols
+ * xKinvx  The values x'*xhat for every member. If NULL, x'xhat = 1
+ *
+ * numX    Number of columns of X per member (0 or 1)
+ *
+ * perm    perm[j] is the member of the column j of v
+ *
+ * blockSize The number of columns of v
+ *
+ * rwork   Work array of size 2*(numQ+numX)*blockSize
  *
  * Input/Output Parameters
  * -----------------------
- * v       The vector to be skewed orthogonalized 
+ * v       The vectors to be skewed orthogonalized 
  * 
  ******************************************************************************/
 
-static int apply_skew_projector(SCALAR *Q, PRIMME_INT ldQ, SCALAR *Qhat,
-      PRIMME_INT ldQhat, SCALAR *UDU, int *ipivot, int numCols, SCALAR *v,
+static int apply_block_projector(SCALAR *Q, PRIMME_INT ldQ, SCALAR *Qhat,
+      PRIMME_INT ldQhat, SCALAR *UDU, int *ipivot, int numQ, SCALAR *X,
+      PRIMME_INT ldX, SCALAR *Xhat, PRIMME_INT ldXhat, SCALAR *xKinvx,
+      int numX, int *perm, SCALAR *v, PRIMME_INT ldv, int blockSize,
       SCALAR *rwork, primme_params *primme) {
 
-   if (numCols > 0) {    /* there is a projector to be applied */
+   int j;
+   int ldo = numQ + numX;  /* leading dimension of overlaps                */
+   SCALAR *overlaps;       /* overlaps of v with columns of Q and X        */
+   SCALAR *workSpace;      /* Used for computing local overlaps            */
+
+   if (ldo == 0 || blockSize == 0) return 0;
+
+   overlaps = rwork;
+   workSpace = overlaps + ldo*blockSize;
+
+   /* Compute workspace = [Q x]'*v. With a single column use BLAS 2, */
+   /* which is faster than xGEMM in some libraries                    */
 
-      SCALAR *overlaps;  /* overlaps of v with columns of Q   */
-      SCALAR *workSpace; /* Used for computing local overlaps */
+   if (numQ > 0 && blockSize == 1) {
+      Num_gemv_Sprimme("C", primme->nLocal, numQ, 1.0, Q, ldQ, v, 1, 0.0,
+            workSpace, 1);
+   }
+   else if (numQ > 0) {
+      Num_gemm_Sprimme("C", "N", numQ, blockSize, primme->nLocal, 1.0, Q, ldQ,
+            v, ldv, 0.0, workSpace, ldo);
+   }
+   if (numX > 0) {
+      for (j=0; j<blockSize; j++) {
+         workSpace[ldo*j+numQ] = Num_dot_Sprimme(primme->nLocal,
+               &X[ldX*perm[j]], 1, &v[ldv*j], 1);
+      }
+   }
 
-      overlaps = rwork;
-      workSpace = overlaps + numCols;
+   /* Global sum: overlaps = [Q x]'*v */
+   CHKERR(globalSum_Sprimme(workSpace, overlaps, ldo*blockSize, primme), -1);
 
-      /* --------------------------------------------------------*/
-      /* Treat the one vector case with BLAS 1 calls             */
-      /* --------------------------------------------------------*/
-      if (numCols == 1) {
-         /* Compute workspace = Q'*v */
-         CHKERR(dist_dot(Q, 1, v, 1, primme, &overlaps[0]), -1);
+   if (numQ > 0) {
+      SCALAR *coefs = overlaps;   /* coefficients of v in Qhat */
 
-         /* Backsolve only if there is a skew projector */
-         if (UDU != NULL) {
-            CHKERRM(ABS(UDU[0]) == 0.0, -1, "Failure factorizing UDU.");
-            overlaps[0] = overlaps[0]/UDU[0];
+      /* --------------------------------------------*/
+      /* Backsolve only if there is a skew projector */
+      /* --------------------------------------------*/
+      if (UDU != NULL) {
+         /* Solve (Q'Qhat)^{-1}*workSpace = overlaps = Q'*v for alpha by */
+         /* backsolving  with the UDU decomposition.                 */
+
+         CHKERRM(numQ == 1 && ABS(UDU[0]) == 0.0, -1,
+               "Failure factorizing UDU.");
+         for (j=0; j<blockSize; j++) {
+            CHKERR(UDUSolve_Sprimme(UDU, ipivot, numQ, &overlaps[ldo*j],
+                     &workSpace[ldo*j], primme), -1);
          }
-         /* Compute v=v-Qhat*overlaps */
-         Num_axpy_Sprimme(primme->nLocal, -overlaps[0], Qhat, 1, v, 1);
+         coefs = workSpace;
+      }
+
+      /* Compute v=v-Qhat*coefs */
+      if (blockSize == 1) {
+         Num_gemv_Sprimme("N", primme->nLocal, numQ, -1.0, Qhat, ldQhat,
+               coefs, 1, 1.0, v, 1);
       }
       else {
-         /* ------------------------------------------------------*/
-         /* More than one vectors. Use BLAS 2.                    */
-         /* ------------------------------------------------------*/
-         /* Compute workspace = Q'*v */
-         Num_gemv_Sprimme("C", primme->nLocal, numCols, 1.0, Q, ldQ, v, 1, 0.0,
-               workSpace, 1);
-
-         /* Global sum: overlaps = Q'*v */
-         CHKERR(globalSum_Sprimme(workSpace, overlaps, numCols, primme), -1);
-
-         /* --------------------------------------------*/
-         /* Backsolve only if there is a skew projector */
-         /* --------------------------------------------*/
-         if (UDU != NULL) {
-            /* Solve (Q'Qhat)^{-1}*workSpace = overlaps = Q'*v for alpha by */
-            /* backsolving  with the UDU decomposition.                 */
-   
-            CHKERR(UDUSolve_Sprimme(UDU, ipivot, numCols, overlaps,
-                     workSpace, primme), -1);
+         Num_gemm_Sprimme("N", "N", primme->nLocal, blockSize, numQ, -1.0,
+               Qhat, ldQhat, coefs, ldo, 1.0, v, ldv);
+      }
+   }
 
-            /* Compute v=v-Qhat*workspace */
-            Num_gemv_Sprimme("N", primme->nLocal, numCols, -1.0, Qhat, ldQhat,
-                  workSpace, 1, 1.0, v, 1);
+   if (numX > 0) {
+      /* Compute v_j=v_j-xhat*(x'v_j/x'xhat) */
+      for (j=0; j<blockSize; j++) {
+         if (xKinvx != NULL) {
+            CHKERRM(ABS(xKinvx[perm[j]]) == 0.0, -1,
+                  "Failure factorizing UDU.");
+            overlaps[ldo*j+numQ] /= xKinvx[perm[j]];
          }
-         else  {
-            /* Compute v=v-Qhat*overlaps  */
-            Num_gemv_Sprimme("N", primme->nLocal, numCols, -1.0, Qhat, ldQhat,
-                  overlaps, 1, 1.0, v, 1);
-         } /* UDU==null */
-      } /* numCols != 1 */
-   } /* numCols > 0 */
+         Num_axpy_Sprimme(primme->nLocal, -overlaps[ldo*j+numQ],
+               &Xhat[ldXhat*perm[j]], 1, &v[ldv*j], 1);
+      }
+   }
 
    return 0;
 }
@@ -651,20 +954,31 @@ static int apply_skew_projector(SCALAR *Q, PRIMME_INT ldQ, SCALAR *Qhat,
 
 /*******************************************************************************
  * Subroutine apply_projected_matrix - This subroutine applies the 
- *    projected matrix (I-Q*Q')*(A-shift*I) to a vector v by computing 
- *    (A-shift*I)v then orthogonalizing the result with Q.
+ *    projected matrix (I-[Q x]*[Q x]')*(A-shift*I) to every column of v by
+ *    computing (A-shift*I)v then orthogonalizing the result with Q and the
+ *    Ritz vector x of the member in the column.
  *
  * Input Parameters
  * ----------------
- * v      The vector the projected matrix will be applied to
+ * v      The vectors the projected matrix will be applied to
+ *
+ * ldv    The leading dimension of v
+ *
+ * blockSize The number of columns of v
  *
- * shift  The amount the matrix is shifted by.
+ * shifts The amounts the matrix is shifted by for every column.
  *
- * Q      The converged Ritz vectors and the current Ritz vector
+ * Q      The converged Ritz vectors
  *
  * dimQ   The number of columns of Q
+ *
+ * x      The current Ritz vectors of all members
+ *
+ * dimX   The number of columns of x per member (0 or 1)
+ *
+ * perm   perm[j] is the member of the column j of v
  * 
- * rwork  Workspace of size 2*dimQ
+ * rwork  Workspace of size 2*(dimQ+dimX)*blockSize
  *
  * primme   Structure containing various solver parameters
  *
@@ -675,120 +989,96 @@ static int apply_skew_projector(SCALAR *Q, PRIMME_INT ldQ, SCALAR *Qhat,
  *
  ******************************************************************************/
 
-static int apply_projected_matrix(SCALAR *v, REAL shift, SCALAR *Q, 
-      PRIMME_INT ldQ, int dimQ, SCALAR *result, SCALAR *rwork,
-      primme_params *primme) {
+static int apply_projected_matrix(SCALAR *v, PRIMME_INT ldv, int blockSize,
+      double *shifts, SCALAR *Q, PRIMME_INT ldQ, int dimQ, SCALAR *x,
+      PRIMME_INT ldx, int dimX, int *perm, SCALAR *result,
+      PRIMME_INT ldresult, SCALAR *rwork, primme_params *primme) {
+
+   int j;
 
-   CHKERR(matrixMatvec_Sprimme(v, primme->nLocal, primme->nLocal, result,
-         primme->nLocal, 0, 1, primme), -1);
-   Num_axpy_Sprimme(primme->nLocal, -shift, v, 1, result, 1); 
-   if (dimQ > 0)
-      CHKERR(apply_projector(Q, ldQ, dimQ, result, rwork, primme), -1);
+   CHKERR(matrixMatvec_Sprimme(v, primme->nLocal, ldv, result, ldresult, 0,
+            blockSize, primme), -1);
+   for (j=0; j<blockSize; j++) {
+      Num_axpy_Sprimme(primme->nLocal, -shifts[j], &v[ldv*j], 1,
+            &result[ldresult*j], 1); 
+   }
+   CHKERR(apply_block_projector(Q, ldQ, Q, ldQ, NULL, NULL, dimQ, x, ldx, x,
+            ldx, NULL, dimX, perm, result, ldresult, blockSize, rwork, primme),
+         -1);
 
    return 0;
 }
    
 
 /*******************************************************************************
- * Subroutine apply_projector - Apply the projector (I-Q*Q') to a vector v and
- *   place the result in v.  Q is the matrix of converged Ritz vectors and the
- *   current Ritz vector.
+ * Function dist_dots_real - Computes the dot products of the columns of x and
+ *    y in parallel, and return the real parts. All dot products are added up
+ *    among processes with a single global sum.
  *
  * Input Parameters
  * ----------------
- * Q       The matrix of converged Ritz vectors and the current Ritz vector
- *
- * nLocal  The number of rows of Q and v the process has
- * 
- * numCols Number of columns of Q
- *
- * rwork   Work array of size 2*numCols
+ * x, y  Operands of the dot product operation
  *
- * Input/Output Parameters
- * -----------------------
- * v       The vector to be orthogonalized against Q
- * 
- ******************************************************************************/
-
-static int apply_projector(SCALAR *Q, PRIMME_INT ldQ, int numCols, SCALAR *v, 
-   SCALAR *rwork, primme_params *primme) {
-
-   SCALAR *overlaps;  /* overlaps of v with columns of Q   */
-   SCALAR *workSpace; /* Used for computing local overlaps */
-
-   overlaps = rwork;
-   workSpace = overlaps + numCols;
-
-   Num_gemv_Sprimme("C", primme->nLocal, numCols, 1.0, Q, ldQ, v, 1, 0.0,
-         workSpace, 1);
-   CHKERR(globalSum_Sprimme(workSpace, overlaps, numCols, primme), -1);
-   Num_gemv_Sprimme("N", primme->nLocal, numCols, -1.0, Q, ldQ, overlaps,
-         1, 1.0, v, 1);
-
-   return 0;
-}
-
-
-/*******************************************************************************
- * Function dist_dot - Computes dot products in parallel.
+ * ldx   The leading dimension of x
  *
- * Input Parameters
- * ----------------
- * x, y  Operands of the dot product operation
+ * ldy   The leading dimension of y
  *
- * incx  Array increment for x.  A value of 1 implies the elements are
- *       contiguous in memory.
+ * n     The number of columns of x and y
  *
- * incy  Array increment for y.  A value of 1 implies the elements are
- *       contiguous in memory.
+ * rwork Workspace of size 2*n
  *
  * primme  Structure containing various solver parameters
  *
- * result The inner product
+ * Output Parameter
+ * ----------------
+ * result The real part of the inner products
  *
  ******************************************************************************/
 
-static int dist_dot(SCALAR *x, int incx,
-   SCALAR *y, int incy, primme_params *primme, SCALAR *result) {
-                                                                                
-   SCALAR temp;
-                                                                                
-   temp = Num_dot_Sprimme(primme->nLocal, x, incx, y, incy);
-   CHKERR(globalSum_Sprimme(&temp, result, 1, primme), -1);
+static int dist_dots_real(SCALAR *x, PRIMME_INT ldx, SCALAR *y,
+      PRIMME_INT ldy, int n, REAL *result, SCALAR *rwork,
+      primme_params *primme) {
+
+   int j;
+
+   for (j=0; j<n; j++) {
+      rwork[j] = Num_dot_Sprimme(primme->nLocal, &x[ldx*j], 1, &y[ldy*j], 1);
+   }
+   CHKERR(dist_sums_real(rwork, n, result, rwork+n, primme), -1);
 
    return 0;
 }
 
 /*******************************************************************************
- * Function dist_dot_real - Computes dot products in parallel and return the
- *    real part.
-*
+ * Function dist_sums_real - Sum values computed by every process, such as the
+ *    local parts of the squared norms returned by a fused kernel, and return
+ *    the real parts.
+ *
  * Input Parameters
  * ----------------
- * x, y  Operands of the dot product operation
+ * local   The values on this process
  *
- * incx  Array increment for x.  A value of 1 implies the elements are
- *       contiguous in memory.
+ * n       The number of values
  *
- * incy  Array increment for y.  A value of 1 implies the elements are
- *       contiguous in memory.
+ * rwork   Workspace of size n
  *
  * primme  Structure containing various solver parameters
  *
  * Output Parameter
  * ----------------
- * result The real part of the inner product
+ * result  The real part of the sums among all processes
  *
  ******************************************************************************/
 
-static int dist_dot_real(SCALAR *x, int incx,
-   SCALAR *y, int incy, primme_params *primme, REAL *result) {
-                                                                                
-   SCALAR temp, product;
-                                                                                
-   temp = Num_dot_Sprimme(primme->nLocal, x, incx, y, incy);
-   CHKERR(globalSum_Sprimme(&temp, &product, 1, primme), -1);
-   *result = REAL_PART(product);
+static int dist_sums_real(SCALAR *local, int n, REAL *result, SCALAR *rwork,
+      primme_params *primme) {
+
+   int j;
+
+   CHKERR(globalSum_Sprimme(local, rwork, n, primme), -1);
+   for (j=0; j<n; j++) {
+      result[j] = REAL_PART(rwork[j]);
+   }
 
    return 0;
 }
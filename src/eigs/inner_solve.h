@@ -39,32 +39,40 @@
 #if !defined(CHECK_TEMPLATE) && !defined(inner_solve_Rprimme)
 #  define inner_solve_Rprimme CONCAT(inner_solve_,REAL_SUF)
 #endif
-int inner_solve_dprimme(double *x, double *r, double *rnorm, double *evecs,
-      int64_t ldevecs, double *UDU, int *ipivot, double *xKinvx,
-      double *Lprojector, int64_t ldLprojector, double *RprojectorQ,
-      int64_t ldRprojectorQ, double *RprojectorX, int64_t ldRprojectorX,
-      int sizeLprojector, int sizeRprojectorQ, int sizeRprojectorX, double *sol,
-      double eval, double shift, double machEps, double *rwork, size_t rworkSize,
-      primme_params *primme);
-int inner_solve_zprimme(PRIMME_COMPLEX_DOUBLE *x, PRIMME_COMPLEX_DOUBLE *r, double *rnorm, PRIMME_COMPLEX_DOUBLE *evecs,
-      int64_t ldevecs, PRIMME_COMPLEX_DOUBLE *UDU, int *ipivot, PRIMME_COMPLEX_DOUBLE *xKinvx,
-      PRIMME_COMPLEX_DOUBLE *Lprojector, int64_t ldLprojector, PRIMME_COMPLEX_DOUBLE *RprojectorQ,
-      int64_t ldRprojectorQ, PRIMME_COMPLEX_DOUBLE *RprojectorX, int64_t ldRprojectorX,
-      int sizeLprojector, int sizeRprojectorQ, int sizeRprojectorX, PRIMME_COMPLEX_DOUBLE *sol,
-      double eval, double shift, double machEps, PRIMME_COMPLEX_DOUBLE *rwork, size_t rworkSize,
-      primme_params *primme);
-int inner_solve_sprimme(float *x, float *r, float *rnorm, float *evecs,
-      int64_t ldevecs, float *UDU, int *ipivot, float *xKinvx,
-      float *Lprojector, int64_t ldLprojector, float *RprojectorQ,
-      int64_t ldRprojectorQ, float *RprojectorX, int64_t ldRprojectorX,
-      int sizeLprojector, int sizeRprojectorQ, int sizeRprojectorX, float *sol,
-      float eval, float shift, double machEps, float *rwork, size_t rworkSize,
-      primme_params *primme);
-int inner_solve_cprimme(PRIMME_COMPLEX_FLOAT *x, PRIMME_COMPLEX_FLOAT *r, float *rnorm, PRIMME_COMPLEX_FLOAT *evecs,
-      int64_t ldevecs, PRIMME_COMPLEX_FLOAT *UDU, int *ipivot, PRIMME_COMPLEX_FLOAT *xKinvx,
-      PRIMME_COMPLEX_FLOAT *Lprojector, int64_t ldLprojector, PRIMME_COMPLEX_FLOAT *RprojectorQ,
-      int64_t ldRprojectorQ, PRIMME_COMPLEX_FLOAT *RprojectorX, int64_t ldRprojectorX,
-      int sizeLprojector, int sizeRprojectorQ, int sizeRprojectorX, PRIMME_COMPLEX_FLOAT *sol,
-      float eval, float shift, double machEps, PRIMME_COMPLEX_FLOAT *rwork, size_t rworkSize,
-      primme_params *primme);
+int inner_solve_dprimme(int blockSize, double *x, int64_t ldx, double *r,
+      int64_t ldr, double *rnorm, double *evecs, int64_t ldevecs,
+      double *UDU, int *ipivot, double *xKinvx, double *LprojectorQ,
+      int64_t ldLprojectorQ, double *LprojectorX, int64_t ldLprojectorX,
+      double *RprojectorQ, int64_t ldRprojectorQ, double *RprojectorX,
+      int64_t ldRprojectorX, int sizeLprojectorQ, int sizeLprojectorX,
+      int sizeRprojectorQ, int sizeRprojectorX, double *sol, int64_t ldsol,
+      double *eval, double *shift, double machEps, double *rwork,
+      size_t *rworkSize, primme_params *primme);
+int inner_solve_zprimme(int blockSize, PRIMME_COMPLEX_DOUBLE *x, int64_t ldx, PRIMME_COMPLEX_DOUBLE *r,
+      int64_t ldr, double *rnorm, PRIMME_COMPLEX_DOUBLE *evecs, int64_t ldevecs,
+      PRIMME_COMPLEX_DOUBLE *UDU, int *ipivot, PRIMME_COMPLEX_DOUBLE *xKinvx, PRIMME_COMPLEX_DOUBLE *LprojectorQ,
+      int64_t ldLprojectorQ, PRIMME_COMPLEX_DOUBLE *LprojectorX, int64_t ldLprojectorX,
+      PRIMME_COMPLEX_DOUBLE *RprojectorQ, int64_t ldRprojectorQ, PRIMME_COMPLEX_DOUBLE *RprojectorX,
+      int64_t ldRprojectorX, int sizeLprojectorQ, int sizeLprojectorX,
+      int sizeRprojectorQ, int sizeRprojectorX, PRIMME_COMPLEX_DOUBLE *sol, int64_t ldsol,
+      double *eval, double *shift, double machEps, PRIMME_COMPLEX_DOUBLE *rwork,
+      size_t *rworkSize, primme_params *primme);
+int inner_solve_sprimme(int blockSize, float *x, int64_t ldx, float *r,
+      int64_t ldr, float *rnorm, float *evecs, int64_t ldevecs,
+      float *UDU, int *ipivot, float *xKinvx, float *LprojectorQ,
+      int64_t ldLprojectorQ, float *LprojectorX, int64_t ldLprojectorX,
+      float *RprojectorQ, int64_t ldRprojectorQ, float *RprojectorX,
+      int64_t ldRprojectorX, int sizeLprojectorQ, int sizeLprojectorX,
+      int sizeRprojectorQ, int sizeRprojectorX, float *sol, int64_t ldsol,
+      float *eval, double *shift, double machEps, float *rwork,
+      size_t *rworkSize, primme_params *primme);
+int inner_solve_cprimme(int blockSize, PRIMME_COMPLEX_FLOAT *x, int64_t ldx, PRIMME_COMPLEX_FLOAT *r,
+      int64_t ldr, float *rnorm, PRIMME_COMPLEX_FLOAT *evecs, int64_t ldevecs,
+      PRIMME_COMPLEX_FLOAT *UDU, int *ipivot, PRIMME_COMPLEX_FLOAT *xKinvx, PRIMME_COMPLEX_FLOAT *LprojectorQ,
+      int64_t ldLprojectorQ, PRIMME_COMPLEX_FLOAT *LprojectorX, int64_t ldLprojectorX,
+      PRIMME_COMPLEX_FLOAT *RprojectorQ, int64_t ldRprojectorQ, PRIMME_COMPLEX_FLOAT *RprojectorX,
+      int64_t ldRprojectorX, int sizeLprojectorQ, int sizeLprojectorX,
+      int sizeRprojectorQ, int sizeRprojectorX, PRIMME_COMPLEX_FLOAT *sol, int64_t ldsol,
+      float *eval, double *shift, double machEps, PRIMME_COMPLEX_FLOAT *rwork,
+      size_t *rworkSize, primme_params *primme);
 #endif
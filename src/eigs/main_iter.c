@@ -52,6 +52,7 @@
 #include "update_W.h"
 #include "globalsum.h"
 #include "auxiliary_eigs.h"
+#include "trace.h"
 
 static int verify_norms(SCALAR *V, PRIMME_INT ldV, SCALAR *W, PRIMME_INT ldW,
       REAL *hVals, int basisSize, REAL *resNorms, int *flags, int *converged,
@@ -158,6 +159,8 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
    int converged;           /* True when all required Ritz vals. converged   */
    int LockingProblem;      /* Flag==1 if practically converged pairs locked */
    int restartLimitReached; /* True when maximum restarts performed          */
+   int stop=0;              /* True when monitorFun asked to stop            */
+   int numPrevLocked;       /* numLocked before the last restart             */
    int numPrevRetained;     /* Number of vectors retained using recurrence-  */
                             /* based restarting.                             */
    int numArbitraryVecs;    /* Columns in hVecs computed with RR instead of  */
@@ -196,6 +199,11 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
    SCALAR *R = NULL;        /* projection: (A-target[i])*V = QR              */
    SCALAR *QtV = NULL;      /* Q'*V                                          */
    SCALAR *hVecsRot=NULL;   /* transformation of hVecs in arbitrary vectors  */
+   SCALAR *hCache=NULL;     /* Eigendecomposition of the last H solved by RR */
+   int hCacheSize=0;        /* Dimension of the H stored in hCache           */
+   SCALAR *VRot=NULL;       /* Rotation deferred by restart: the basis is    */
+                            /* V(:,0:nVRot-1)*VRot followed by V(:,nVRot:)   */
+   int nVRot=0;             /* Number of columns of V affected by VRot       */
 
    REAL *hVals;           /* Eigenvalues of H                              */
    REAL *hSVals=NULL;     /* Singular values of R                          */
@@ -212,6 +220,8 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
    primme_CostModel CostModel; /* Structure holding the runtime estimates of */
                             /* the parameters of the model.Only visible here */
    double tstart=0.0;       /* Timing variable for accumulative time spent   */
+   double t0;               /* Timing variable for restart                   */
+   double tPhases[3];       /* Phase times before restart, see below         */
 
    /* -------------------------------------------------------------- */
    /* Subdivide the workspace                                        */
@@ -246,6 +256,14 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
        || primme->projectionParams.projection == primme_proj_harmonic) {
       hVecsRot   = rwork; rwork += primme->maxBasisSize*primme->maxBasisSize*numQR;
    }
+   if (primme->projectionParams.projection == primme_proj_RR) {
+      hCache     = rwork; rwork += primme->maxBasisSize*primme->maxBasisSize*2
+                                   + primme->maxBasisSize;
+   }
+   if (primme->projectionParams.projection == primme_proj_RR
+         && !primme->locking) {
+      VRot       = rwork; rwork += primme->maxBasisSize*primme->maxBasisSize;
+   }
 
    if (primme->correctionParams.precondition && 
          primme->correctionParams.maxInnerIterations != 0 &&
@@ -291,8 +309,20 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
    primme->stats.elapsedTime = 0.0;
    primme->stats.timeMatvec = 0.0;
    primme->stats.timePrecond = 0.0;
+   primme->stats.numFactorizations = 0;
+   primme->stats.timeFactorize = 0.0;
    primme->stats.timeOrtho = 0.0;
    primme->stats.timeGlobalSum = 0.0;
+   primme->stats.numGlobalSum = 0;
+   primme->stats.timeSolveH = 0.0;
+   primme->stats.timeRestart = 0.0;
+   primme->stats.timeResetUpdateVWXR = 0.0;
+   primme->stats.timeLocking = 0.0;
+   primme->stats.timeUpdateVWXR = 0.0;
+   primme->stats.timeInnerSolve = 0.0;
+   primme->stats.timeConvergence = 0.0;
+   primme->stats.estimateFlops = 0.0;
+   primme->stats.estimateBytes = 0.0;
    primme->stats.volumeGlobalSum = 0.0;
    primme->stats.numOrthoInnerProds = 0.0;
    primme->stats.estimateMaxEVal   = -HUGE_VAL;
@@ -367,7 +397,7 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
    /* Without locking, restarting can cause converged Ritz values to become  */
    /* unconverged. Keep performing JD iterations until they remain converged */
    /* ---------------------------------------------------------------------- */
-   while (!converged &&
+   while (!converged && !stop &&
           ( primme->maxMatvecs == 0 || 
             primme->stats.numMatvecs < primme->maxMatvecs ) &&
           ( primme->maxOuterIterations == 0 ||
@@ -386,18 +416,16 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
                primme->maxBasisSize, primme->targetShifts[targetShiftIndex], 0,
                basisSize, rwork, &rworkSize, machEps, primme), -1);
 
-      if (H) CHKERR(update_projection_Sprimme(V, ldV, W, ldW, H,
-               primme->maxBasisSize, primme->nLocal, 0, basisSize, rwork,
-               &rworkSize, 1/*symmetric*/, primme), -1);
-
-      if (QtV) CHKERR(update_projection_Sprimme(Q, ldQ, V, ldV, QtV,
-               primme->maxBasisSize, primme->nLocal, 0, basisSize, rwork,
-               &rworkSize, 0/*unsymmetric*/, primme), -1);
+      if (H) CHKERR(update_projections_Sprimme(V, ldV, W, ldW, Q, ldQ, H,
+               primme->maxBasisSize, QtV, primme->maxBasisSize, VRot,
+               primme->maxBasisSize, nVRot, primme->nLocal, 0, basisSize,
+               rwork, &rworkSize, primme), -1);
 
       CHKERR(solve_H_Sprimme(H, basisSize, primme->maxBasisSize, R,
                primme->maxBasisSize, QtV, primme->maxBasisSize, hU, basisSize,
-               hVecs, basisSize, hVals, hSVals, numConverged, machEps,
-               &rworkSize, rwork, iworkSize, iwork, primme), -1);
+               hVecs, basisSize, hVals, hSVals, hCache, &hCacheSize,
+               numConverged, machEps, &rworkSize, rwork, iworkSize, iwork,
+               primme), -1);
       
       numArbitraryVecs = 0;
       maxRecentlyConverged = availableBlockSize = blockSize = 0;
@@ -407,7 +435,7 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
       /* Begin the iterative process.  Keep restarting until all of the */
       /* required eigenpairs have been found (no verification)          */
       /* -------------------------------------------------------------- */
-      while (numConverged < primme->numEvals &&
+      while (numConverged < primme->numEvals && !stop &&
              ( primme->maxMatvecs == 0 || 
                primme->stats.numMatvecs < primme->maxMatvecs ) &&
              ( primme->maxOuterIterations == 0 ||
@@ -422,6 +450,7 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
          /* ----------------------------------------------------------------- */
          while (basisSize < primme->maxBasisSize &&
                 basisSize < primme->n - primme->numOrthoConst - numLocked &&
+                !stop &&
                 ( primme->maxMatvecs == 0 || 
                   primme->stats.numMatvecs < primme->maxMatvecs) &&
                 ( primme->maxOuterIterations == 0 ||
@@ -464,8 +493,8 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
                   availableBlockSize, evecs, numLocked, ldevecs, evals,
                   resNorms, targetShiftIndex, machEps, iev, &blockSize,
                   &recentlyConverged, &numArbitraryVecs, &smallestResNorm,
-                  hVecsRot, primme->maxBasisSize, &reset, rwork, &rworkSize,
-                  iwork, iworkSize, primme);
+                  hVecsRot, primme->maxBasisSize, VRot, primme->maxBasisSize,
+                  nVRot, &reset, rwork, &rworkSize, iwork, iworkSize, primme);
             }
             else {
                blockSize = recentlyConverged = 0;
@@ -474,6 +503,9 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
             /* print residuals */
             print_residuals(hVals, blockNorms, numConverged, numLocked, iev, blockSize,
                   primme);
+            CHKERR(monitorFun_Sprimme(hVals, basisSize, flags, iev, blockSize,
+                     blockNorms, numConverged, evals, numLocked, resNorms,
+                     primme_event_outer_iteration, &stop, primme), -1);
 
             /* If the total number of converged pairs, including the     */
             /* recentlyConverged ones, are greater than or equal to the  */
@@ -485,6 +517,12 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
 
             numConverged += recentlyConverged;
 
+            if (recentlyConverged > 0) {
+               CHKERR(monitorFun_Sprimme(hVals, basisSize, flags, iev,
+                        blockSize, blockNorms, numConverged, evals, numLocked,
+                        resNorms, primme_event_converged, &stop, primme), -1);
+            }
+
             if (numConverged >= primme->numEvals ||
                 (primme->locking && recentlyConverged > 0
                   && primme->target != primme_smallest
@@ -564,10 +602,11 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
 
             /* Orthogonalize the corrections with respect to each other */
             /* and the current basis.                                   */
-            CHKERR(ortho_Sprimme(V, ldV, NULL, 0, basisSize, 
-               basisSize+blockSize-1, evecs, ldevecs, 
-               primme->numOrthoConst+numLocked, primme->nLocal, primme->iseed, 
-               machEps, rwork, &rworkSize, primme), -1);
+            CHKERR(ortho_rotated_Sprimme(V, ldV, NULL, 0, VRot,
+               primme->maxBasisSize, nVRot, basisSize, basisSize+blockSize-1,
+               evecs, ldevecs, primme->numOrthoConst+numLocked,
+               primme->nLocal, primme->iseed, machEps, rwork, &rworkSize,
+               primme), -1);
 
             /* Compute W = A*V for the orthogonalized corrections */
 
@@ -582,13 +621,10 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
             /* Extend H by blockSize columns and rows and solve the */
             /* eigenproblem for the new H.                          */
 
-            if (H) CHKERR(update_projection_Sprimme(V, ldV, W, ldW, H,
-                     primme->maxBasisSize, primme->nLocal, basisSize, blockSize,
-                     rwork, &rworkSize, 1/*symmetric*/, primme), -1);
-
-            if (QtV) CHKERR(update_projection_Sprimme(Q, ldQ, V, ldV, QtV,
-                     primme->maxBasisSize, primme->nLocal, basisSize, blockSize,
-                     rwork, &rworkSize, 0/*unsymmetric*/, primme), -1);
+            if (H) CHKERR(update_projections_Sprimme(V, ldV, W, ldW, Q, ldQ, H,
+                     primme->maxBasisSize, QtV, primme->maxBasisSize, VRot,
+                     primme->maxBasisSize, nVRot, primme->nLocal, basisSize,
+                     blockSize, rwork, &rworkSize, primme), -1);
 
             if (basisSize+blockSize >= primme->maxBasisSize) {
                CHKERR(retain_previous_coefficients_Sprimme(hVecs,
@@ -604,8 +640,9 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
 
             CHKERR(solve_H_Sprimme(H, basisSize, primme->maxBasisSize, R,
                      primme->maxBasisSize, QtV, primme->maxBasisSize, hU,
-                     basisSize, hVecs, basisSize, hVals, hSVals, numConverged,
-                     machEps, &rworkSize, rwork, iworkSize, iwork, primme), -1);
+                     basisSize, hVecs, basisSize, hVals, hSVals, hCache,
+                     &hCacheSize, numConverged, machEps, &rworkSize, rwork,
+                     iworkSize, iwork, primme), -1);
 
             numArbitraryVecs = 0;
 
@@ -711,8 +748,8 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
                   availableBlockSize, evecs, numLocked, ldevecs, evals,
                   resNorms, targetShiftIndex, machEps, iev, &blockSize,
                   &recentlyConverged, &numArbitraryVecs, dummySmallestResNorm,
-                  hVecsRot, primme->maxBasisSize, &reset, rwork, &rworkSize,
-                  iwork, iworkSize, primme);
+                  hVecsRot, primme->maxBasisSize, VRot, primme->maxBasisSize,
+                  nVRot, &reset, rwork, &rworkSize, iwork, iworkSize, primme);
 
             /* Updated the number of converged pairs */
             /* Intentionally we include the pairs flagged SKIP_UNTIL_RESTART */
@@ -766,6 +803,17 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
          /* ------------------ */
 
          assert(ldV == ldW); /* this function assumes ldV == ldW */
+         numPrevLocked = numLocked;
+
+         /* The calls to solve_H, Num_update_VWXR and check_convergence   */
+         /* done while restarting are counted only in timeRestart, so the */
+         /* phase times do not overlap                                    */
+
+         tPhases[0] = primme->stats.timeSolveH;
+         tPhases[1] = primme->stats.timeUpdateVWXR;
+         tPhases[2] = primme->stats.timeConvergence;
+         t0 = primme_wTimer(0);
+         TRACE_BEGIN("restart", primme);
          restart_Sprimme(V, W, primme->nLocal, basisSize, ldV, hVals, hSVals,
                flags, iev, &blockSize, blockNorms, evecs, ldevecs, perm,
                evals, resNorms, evecsHat, primme->nLocal, M, maxEvecsSize, UDU,
@@ -775,8 +823,23 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
                primme->maxBasisSize, Q, ldQ, R, primme->maxBasisSize,
                QtV, primme->maxBasisSize, hU, basisSize, 0, hVecs, basisSize, 0,
                &basisSize, &targetShiftIndex, &numArbitraryVecs, hVecsRot,
-               primme->maxBasisSize, &restartsSinceReset, &reset, machEps,
-               rwork, &rworkSize, iwork, iworkSize, primme);
+               primme->maxBasisSize, VRot, primme->maxBasisSize, &nVRot,
+               &restartsSinceReset, &reset, machEps, rwork, &rworkSize, iwork,
+               iworkSize, primme);
+         TRACE_END("restart", primme);
+         primme->stats.timeRestart += primme_wTimer(0) - t0;
+         primme->stats.timeSolveH = tPhases[0];
+         primme->stats.timeUpdateVWXR = tPhases[1];
+         primme->stats.timeConvergence = tPhases[2];
+
+         CHKERR(monitorFun_Sprimme(hVals, basisSize, flags, NULL, 0, NULL,
+                  numConverged, evals, numLocked, resNorms,
+                  primme_event_restart, &stop, primme), -1);
+         if (numLocked > numPrevLocked) {
+            CHKERR(monitorFun_Sprimme(hVals, basisSize, flags, NULL, 0, NULL,
+                     numConverged, evals, numLocked, resNorms,
+                     primme_event_locked, &stop, primme), -1);
+         }
 
          /* If there are any initial guesses remaining, then copy it */
          /* into the basis.                                          */
@@ -790,9 +853,11 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
             nextGuess += numNew;
             numGuesses -= numNew;
 
-            CHKERR(ortho_Sprimme(V, ldV, NULL, 0, basisSize, basisSize+numNew-1,
-                     evecs, ldevecs, numLocked, primme->nLocal, primme->iseed,
-                     machEps, rwork, &rworkSize, primme), -1);
+            CHKERR(ortho_rotated_Sprimme(V, ldV, NULL, 0, VRot,
+                     primme->maxBasisSize, nVRot, basisSize,
+                     basisSize+numNew-1, evecs, ldevecs, numLocked,
+                     primme->nLocal, primme->iseed, machEps, rwork,
+                     &rworkSize, primme), -1);
 
             /* Compute W = A*V for the orthogonalized corrections */
 
@@ -807,17 +872,16 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
             /* Extend H by numNew columns and rows and solve the */
             /* eigenproblem for the new H.                       */
 
-            if (H) CHKERR(update_projection_Sprimme(V, ldV, W, ldW, H,
-                     primme->maxBasisSize, primme->nLocal, basisSize, numNew,
-                     rwork, &rworkSize, 1/*symmetric*/, primme), -1);
-            if (QtV) CHKERR(update_projection_Sprimme(Q, ldQ, V, ldV, QtV,
-                     primme->maxBasisSize, primme->nLocal, basisSize, numNew,
-                     rwork, &rworkSize, 0/*unsymmetric*/, primme), -1);
+            if (H) CHKERR(update_projections_Sprimme(V, ldV, W, ldW, Q, ldQ, H,
+                     primme->maxBasisSize, QtV, primme->maxBasisSize, VRot,
+                     primme->maxBasisSize, nVRot, primme->nLocal, basisSize,
+                     numNew, rwork, &rworkSize, primme), -1);
             basisSize += numNew;
             CHKERR(solve_H_Sprimme(H, basisSize, primme->maxBasisSize, R,
                   primme->maxBasisSize, QtV, primme->maxBasisSize, hU,
-                  basisSize, hVecs, basisSize, hVals, hSVals, numConverged,
-                  machEps, &rworkSize, rwork, iworkSize, iwork, primme), -1);
+                  basisSize, hVecs, basisSize, hVals, hSVals, hCache,
+                  &hCacheSize, numConverged, machEps, &rworkSize, rwork,
+                  iworkSize, iwork, primme), -1);
 
          }
  
@@ -844,6 +908,21 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
       } /* while ((numConverged < primme->numEvals)  (restarting loop)
          * ----------------------------------------------------------- */
 
+      /* Apply the rotation deferred by the restarts on V and W */
+
+      if (nVRot > 0) {
+         CHKERR(Num_update_VWXR_Sprimme(V, W, primme->nLocal, nVRot, ldV,
+                  VRot, nVRot, primme->maxBasisSize, NULL,
+                  V, 0, nVRot, ldV,
+                  NULL, 0, 0, 0,
+                  NULL, 0, 0, 0,
+                  W, 0, nVRot, ldW,
+                  NULL, 0, 0, 0, NULL,
+                  NULL, 0, 0,
+                  rwork, TO_INT(rworkSize), primme), -1);
+         nVRot = 0;
+      }
+
       /* ------------------------------------------------------------ */
       /* If locking is enabled, check to make sure the required       */
       /* number of eigenvalues have been computed, else make sure the */
@@ -873,6 +952,9 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
             if (primme->aNorm <= 0.0L) primme->aNorm = primme->stats.estimateLargestSVal;
             return 0;
          }
+         else if (stop) {
+            CHKERRM(-1, -1, "Stopped by 'monitorFun'");
+         }
          else {
             CHKERRM(-1, -1, "Maximum iterations or matvecs reached");
          }
@@ -882,8 +964,9 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
 
          /* Determine if the maximum number of matvecs has been reached */
 
-         restartLimitReached = primme->maxMatvecs > 0 && 
-                               primme->stats.numMatvecs >= primme->maxMatvecs;
+         restartLimitReached = (primme->maxMatvecs > 0 && 
+                               primme->stats.numMatvecs >= primme->maxMatvecs)
+                               || stop;
 
          /* ---------------------------------------------------------- */
          /* The norms of the converged Ritz vectors must be recomputed */
@@ -934,6 +1017,9 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
                if (primme->aNorm <= 0.0L) primme->aNorm = primme->stats.estimateLargestSVal;
                return 0;
             }
+            else if (stop) {
+               CHKERRM(-1, -1, "Stopped by 'monitorFun'");
+            }
             else {
 	       CHKERRM(-1, -1, "Maximum iterations or matvecs reached");
             }
@@ -1008,6 +1094,10 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
  * evecs          Converged eigenvectors
  * evecsSize      The size of evecs
  * numLocked      The number of vectors currently locked (if locking)
+ * VRot           If not NULL, the actual basis is V(:,0:nVRot-1)*VRot
+ *                followed by V(:,nVRot:), and similarly for W
+ * ldVRot         The leading dimension of VRot
+ * nVRot          The number of columns of V affected by VRot
  * rwork          Real work array, used by check_convergence and Num_update_VWXR
  * primme         Structure containing various solver parameters
  *
@@ -1037,8 +1127,9 @@ int prepare_candidates_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
       PRIMME_INT ldevecs, REAL *evals, REAL *resNorms, int targetShiftIndex,
       double machEps, int *iev, int *blockSize, int *recentlyConverged,
       int *numArbitraryVecs, double *smallestResNorm, SCALAR *hVecsRot,
-      int ldhVecsRot, int *reset, SCALAR *rwork, size_t *rworkSize, int *iwork,
-      int iworkSize, primme_params *primme) {
+      int ldhVecsRot, SCALAR *VRot, int ldVRot, int nVRot, int *reset,
+      SCALAR *rwork, size_t *rworkSize, int *iwork, int iworkSize,
+      primme_params *primme) {
 
    int i, blki;         /* loop variables */
    REAL *hValsBlock;    /* contiguous copy of the hVals to be tested */
@@ -1046,6 +1137,7 @@ int prepare_candidates_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
    int *flagsBlock;     /* contiguous copy of the flags to be tested */
    REAL *hValsBlock0;   /* workspace for hValsBlock */
    SCALAR *hVecsBlock0; /* workspace for hVecsBlock */
+   SCALAR *hVecsBlockRot=NULL; /* hVecsBlock with the rows rotated by VRot */
    double targetShift;  /* current target shift */
    size_t rworkSize0;   /* current size of rwork */
 
@@ -1075,7 +1167,8 @@ int prepare_candidates_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
                NULL, NULL, NULL, 0, 0, NULL, 0.0, NULL, 0, NULL, 0, 0.0, &lrw,
                NULL, 0, &liw, primme), -1);
       *rworkSize = max(*rworkSize,
-            (size_t)maxBlockSize+(size_t)maxBlockSize*(size_t)basisSize+lrw);
+            (size_t)maxBlockSize+(size_t)maxBlockSize*(size_t)basisSize
+            *(VRot?2:1)+lrw);
       *iwork = max(*iwork, liw + basisSize);
       return 0;
    }
@@ -1086,6 +1179,12 @@ int prepare_candidates_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
    rwork += maxBlockSize + ldhVecs*maxBlockSize;
    assert(*rworkSize >= (size_t)(maxBlockSize + ldhVecs*maxBlockSize));
    rworkSize0 = *rworkSize - maxBlockSize - ldhVecs*maxBlockSize;
+   if (VRot && nVRot > 0) {
+      hVecsBlockRot = rwork;
+      rwork += ldhVecs*maxBlockSize;
+      assert(rworkSize0 >= (size_t)(ldhVecs*maxBlockSize));
+      rworkSize0 -= ldhVecs*maxBlockSize;
+   }
    flagsBlock = iwork;
    iwork += maxBlockSize;
    iworkSize -= maxBlockSize;
@@ -1217,6 +1316,16 @@ int prepare_candidates_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
       hVecsBlock = Num_compact_vecs_Sprimme(hVecs, basisSize, blockNormsSize, ldhVecs, &iev[*blockSize],
          hVecsBlock0, ldhVecs, 1 /* avoid copy */);
 
+      /* Express the coefficients in terms of V instead of the actual basis */
+
+      if (hVecsBlockRot) {
+         Num_gemm_Sprimme("N", "N", nVRot, blockNormsSize, nVRot, 1.0, VRot,
+               ldVRot, hVecsBlock, ldhVecs, 0.0, hVecsBlockRot, ldhVecs);
+         Num_copy_matrix_Sprimme(&hVecsBlock[nVRot], basisSize-nVRot,
+               blockNormsSize, ldhVecs, &hVecsBlockRot[nVRot], ldhVecs);
+         hVecsBlock = hVecsBlockRot;
+      }
+
       /* Compute X, R and residual norms for the next candidates                                   */
       /* X(basisSize:) = V*hVecs(*blockSize:*blockSize+blockNormsize)                              */
       /* R(basisSize:) = W*hVecs(*blockSize:*blockSize+blockNormsize) - X(basisSize:)*diag(hVals)  */
@@ -71,6 +71,7 @@
 #include "const.h"
 #include "globalsum.h"
 #include "wtime.h"
+#include "trace.h"
  
 
 /**********************************************************************
@@ -123,6 +124,35 @@ int ortho_Sprimme(SCALAR *basis, PRIMME_INT ldBasis, SCALAR *R,
       PRIMME_INT ldR, int b1, int b2, SCALAR *locked, PRIMME_INT ldLocked,
       int numLocked, PRIMME_INT nLocal, PRIMME_INT *iseed, double machEps,
       SCALAR *rwork, size_t *rworkSize, primme_params *primme) {
+
+   return ortho_rotated_Sprimme(basis, ldBasis, R, ldR, NULL, 0, 0, b1, b2,
+         locked, ldLocked, numLocked, nLocal, iseed, machEps, rwork, rworkSize,
+         primme);
+}
+
+/**********************************************************************
+ * Function ortho_rotated - Like ortho, but the first nRot vectors of
+ * basis are basis(:,0:nRot-1)*rot instead of basis(:,0:nRot-1), which
+ * are not orthonormal. This is the representation of V after a
+ * deferred restart, see restart_soft_locking.
+ *
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * rot        nRot x nRot matrix such that basis(:,0:nRot-1)*rot is
+ *            orthonormal (optional)
+ * ldRot      Leading dimension of rot
+ * nRot       Number of columns of basis affected by rot; b1 >= nRot
+ *
+ * The rest of parameters are as in ortho. R should be NULL if nRot > 0.
+ *
+ **********************************************************************/
+
+TEMPLATE_PLEASE
+int ortho_rotated_Sprimme(SCALAR *basis, PRIMME_INT ldBasis, SCALAR *R,
+      PRIMME_INT ldR, SCALAR *rot, int ldRot, int nRot, int b1, int b2,
+      SCALAR *locked, PRIMME_INT ldLocked, int numLocked, PRIMME_INT nLocal,
+      PRIMME_INT *iseed, double machEps, SCALAR *rwork, size_t *rworkSize,
+      primme_params *primme) {
               
    int i, j;                /* Loop indices */
    size_t minWorkSize;         
@@ -138,13 +168,14 @@ int ortho_Sprimme(SCALAR *basis, PRIMME_INT ldBasis, SCALAR *R,
    double tol = sqrt(2.0L)/2.0L; /* We set Daniel et al. test to .707 */
    REAL s0=0.0, s02=0.0, s1=0.0, s12=0.0, s00=0.0;
    REAL temp;
-   SCALAR *overlaps;
+   SCALAR *overlaps, *rotOverlaps;
    double t0;
 
    messages = (primme && primme->procID == 0 && primme->printLevel >= 3
          && primme->outputFile);
 
-   minWorkSize = 2*(numLocked + b2 + 1);
+   if (rot == NULL) nRot = 0;
+   minWorkSize = 2*(numLocked + b2 + 1) + nRot;
 
    /* Return memory requirement */
    if (basis == NULL) {
@@ -157,7 +188,7 @@ int ortho_Sprimme(SCALAR *basis, PRIMME_INT ldBasis, SCALAR *R,
    /*----------------------------------*/
    assert(nLocal >= 0 && numLocked >= 0 && *rworkSize >= minWorkSize &&
           ldBasis >= nLocal && (numLocked == 0 || ldLocked >= nLocal) &&
-          (R == NULL || ldR >= b2));
+          (R == NULL || ldR >= b2) && b1 >= nRot && (nRot == 0 || R == NULL));
 
    tol = sqrt(2.0L)/2.0L;
 
@@ -172,6 +203,7 @@ int ortho_Sprimme(SCALAR *basis, PRIMME_INT ldBasis, SCALAR *R,
    /*---------------------------------------------------*/
 
    t0 = primme_wTimer(0);
+   TRACE_BEGIN("ortho", primme);
 
    for(i=b1; i <= b2; i++) {
     
@@ -217,6 +249,7 @@ int ortho_Sprimme(SCALAR *basis, PRIMME_INT ldBasis, SCALAR *R,
 
          rwork[i+numLocked] = s02;
          overlaps = &rwork[i+numLocked+1];
+         rotOverlaps = &overlaps[i+numLocked+1];
          CHKERR(globalSum_Sprimme(rwork, overlaps, i + numLocked + 1,
                   primme), -1);
 
@@ -224,6 +257,15 @@ int ortho_Sprimme(SCALAR *basis, PRIMME_INT ldBasis, SCALAR *R,
              Num_axpy_Sprimme(i, 1.0, overlaps, 1, &R[ldR*i], 1);
          }
 
+         /* The projector on the rotated columns is basis*rot*rot'*basis' */
+
+         if (nRot > 0) {
+            Num_gemv_Sprimme("C", nRot, nRot, 1.0, rot, ldRot, overlaps, 1,
+                  0.0, rotOverlaps, 1);
+            Num_gemv_Sprimme("N", nRot, nRot, 1.0, rot, ldRot, rotOverlaps, 1,
+                  0.0, overlaps, 1);
+         }
+
          if (numLocked > 0) { /* locked array most recently accessed */
             Num_gemv_Sprimme("N", nLocal, numLocked, -1.0, locked, ldLocked, 
                &overlaps[i], 1, 1.0, &basis[ldBasis*i], 1); 
@@ -240,9 +282,18 @@ int ortho_Sprimme(SCALAR *basis, PRIMME_INT ldBasis, SCALAR *R,
             s00 = s0 = sqrt(s02 = REAL_PART(overlaps[i+numLocked]));
          }
 
-         /* Compute the norm of the resulting vector implicitly */
+         /* Compute the norm of the resulting vector implicitly. The      */
+         /* overlaps with the rotated columns are rot'*overlaps(0:nRot-1) */
          
-         temp = REAL_PART(Num_dot_Sprimme(i+numLocked,overlaps,1,overlaps,1));
+         if (nRot > 0) {
+            temp = REAL_PART(Num_dot_Sprimme(nRot, rotOverlaps, 1,
+                     rotOverlaps, 1));
+         }
+         else {
+            temp = 0.0;
+         }
+         temp += REAL_PART(Num_dot_Sprimme(i+numLocked-nRot, &overlaps[nRot],
+                  1, &overlaps[nRot], 1));
          s1 = sqrt(s12 = max(0.0L, s02-temp));
          
          /* s1 decreased too much. Numerical problems expected   */
@@ -296,6 +347,7 @@ int ortho_Sprimme(SCALAR *basis, PRIMME_INT ldBasis, SCALAR *R,
       }
    }
 
+   TRACE_END("ortho", primme);
    if (primme) primme->stats.timeOrtho += primme_wTimer(0) - t0;
 
    /* Check orthogonality */
@@ -43,6 +43,17 @@ int ortho_dprimme(double *basis, int64_t ldBasis, double *R,
       int64_t ldR, int b1, int b2, double *locked, int64_t ldLocked,
       int numLocked, int64_t nLocal, int64_t *iseed, double machEps,
       double *rwork, size_t *rworkSize, primme_params *primme);
+#if !defined(CHECK_TEMPLATE) && !defined(ortho_rotated_Sprimme)
+#  define ortho_rotated_Sprimme CONCAT(ortho_rotated_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(ortho_rotated_Rprimme)
+#  define ortho_rotated_Rprimme CONCAT(ortho_rotated_,REAL_SUF)
+#endif
+int ortho_rotated_dprimme(double *basis, int64_t ldBasis, double *R,
+      int64_t ldR, double *rot, int ldRot, int nRot, int b1, int b2,
+      double *locked, int64_t ldLocked, int numLocked, int64_t nLocal,
+      int64_t *iseed, double machEps, double *rwork, size_t *rworkSize,
+      primme_params *primme);
 #if !defined(CHECK_TEMPLATE) && !defined(ortho_single_iteration_Sprimme)
 #  define ortho_single_iteration_Sprimme CONCAT(ortho_single_iteration_,SCALAR_SUF)
 #endif
@@ -57,6 +68,11 @@ int ortho_zprimme(PRIMME_COMPLEX_DOUBLE *basis, int64_t ldBasis, PRIMME_COMPLEX_
       int64_t ldR, int b1, int b2, PRIMME_COMPLEX_DOUBLE *locked, int64_t ldLocked,
       int numLocked, int64_t nLocal, int64_t *iseed, double machEps,
       PRIMME_COMPLEX_DOUBLE *rwork, size_t *rworkSize, primme_params *primme);
+int ortho_rotated_zprimme(PRIMME_COMPLEX_DOUBLE *basis, int64_t ldBasis, PRIMME_COMPLEX_DOUBLE *R,
+      int64_t ldR, PRIMME_COMPLEX_DOUBLE *rot, int ldRot, int nRot, int b1, int b2,
+      PRIMME_COMPLEX_DOUBLE *locked, int64_t ldLocked, int numLocked, int64_t nLocal,
+      int64_t *iseed, double machEps, PRIMME_COMPLEX_DOUBLE *rwork, size_t *rworkSize,
+      primme_params *primme);
 int ortho_single_iteration_zprimme(PRIMME_COMPLEX_DOUBLE *Q, int64_t mQ, int64_t nQ,
       int64_t ldQ, PRIMME_COMPLEX_DOUBLE *X, int *inX, int nX, int64_t ldX,
       double *overlaps, double *norms, PRIMME_COMPLEX_DOUBLE *rwork, size_t *lrwork,
@@ -65,6 +81,11 @@ int ortho_sprimme(float *basis, int64_t ldBasis, float *R,
       int64_t ldR, int b1, int b2, float *locked, int64_t ldLocked,
       int numLocked, int64_t nLocal, int64_t *iseed, double machEps,
       float *rwork, size_t *rworkSize, primme_params *primme);
+int ortho_rotated_sprimme(float *basis, int64_t ldBasis, float *R,
+      int64_t ldR, float *rot, int ldRot, int nRot, int b1, int b2,
+      float *locked, int64_t ldLocked, int numLocked, int64_t nLocal,
+      int64_t *iseed, double machEps, float *rwork, size_t *rworkSize,
+      primme_params *primme);
 int ortho_single_iteration_sprimme(float *Q, int64_t mQ, int64_t nQ,
       int64_t ldQ, float *X, int *inX, int nX, int64_t ldX,
       float *overlaps, float *norms, float *rwork, size_t *lrwork,
@@ -73,6 +94,11 @@ int ortho_cprimme(PRIMME_COMPLEX_FLOAT *basis, int64_t ldBasis, PRIMME_COMPLEX_F
       int64_t ldR, int b1, int b2, PRIMME_COMPLEX_FLOAT *locked, int64_t ldLocked,
       int numLocked, int64_t nLocal, int64_t *iseed, double machEps,
       PRIMME_COMPLEX_FLOAT *rwork, size_t *rworkSize, primme_params *primme);
+int ortho_rotated_cprimme(PRIMME_COMPLEX_FLOAT *basis, int64_t ldBasis, PRIMME_COMPLEX_FLOAT *R,
+      int64_t ldR, PRIMME_COMPLEX_FLOAT *rot, int ldRot, int nRot, int b1, int b2,
+      PRIMME_COMPLEX_FLOAT *locked, int64_t ldLocked, int numLocked, int64_t nLocal,
+      int64_t *iseed, double machEps, PRIMME_COMPLEX_FLOAT *rwork, size_t *rworkSize,
+      primme_params *primme);
 int ortho_single_iteration_cprimme(PRIMME_COMPLEX_FLOAT *Q, int64_t mQ, int64_t nQ,
       int64_t ldQ, PRIMME_COMPLEX_FLOAT *X, int *inX, int nX, int64_t ldX,
       float *overlaps, float *norms, PRIMME_COMPLEX_FLOAT *rwork, size_t *lrwork,
@@ -0,0 +1,414 @@
+/*******************************************************************************
+ * Copyright (c) 2016, College of William & Mary
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the College of William & Mary nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COLLEGE OF WILLIAM & MARY BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * PRIMME: https://github.com/primme/primme
+ * Contact: Andreas Stathopoulos, a n d r e a s _at_ c s . w m . e d u
+ *******************************************************************************
+ * File: precond_cache.c
+ *
+ * Purpose - Keep the factorizations of a shift-dependent preconditioner.
+ *           When primme.precondFactorize is set, the solver asks for the
+ *           factors of A - shift*I for the shift of every vector it
+ *           preconditions, and the factors are reused as long as
+ *           primme.precondParams allows it:
+ *
+ *           - Shifts are rounded to multiples of shiftQuantum*||A||, and at
+ *             most cacheSize factorizations are kept; the least recently
+ *             used one is freed when a new one is needed.
+ *           - Factors whose shift is within maxShiftDrift*||A|| of the
+ *             requested shift are used without refactoring.
+ *           - Otherwise a new factorization is computed only while the time
+ *             spent factorizing stays under maxTimeRatio times the time
+ *             spent applying the factors; until then the closest factors
+ *             are used.
+ *           - With async, the new factorization is computed on a background
+ *             thread, and the closest factors are used until it finishes.
+ *             This requires building PRIMME with -DPRIMME_WITH_PTHREADS;
+ *             otherwise the factorization is computed right away.
+ *
+ *           The factors change only in the first block preconditioned in
+ *           each outer iteration. So the preconditioner stays the same while
+ *           the correction equations of the iteration are solved, as the
+ *           inner solver and the skew projectors require.
+ *
+ ******************************************************************************/
+
+#include <stdlib.h>   /* mallocs, free */
+#include <math.h>     /* fabs, floor */
+#include "template.h"
+#include "wtime.h"
+#include "precond_cache.h"
+
+/* Only define these functions ones */
+#ifdef USE_DOUBLE
+#include "notemplate.h"
+
+static int find_replaceable(primme_precond_cache *cache);
+static int insert_factors(int i, double shift, void *factors, double time,
+      primme_params *primme);
+static int free_factors(void *factors, primme_params *primme);
+#ifdef PRIMME_WITH_PTHREADS
+static void* build_factors(void *arg);
+static int collect_factors(primme_params *primme);
+#endif
+
+/*******************************************************************************
+ * Function primme_precond_cache_begin - Prepare the cache before looking up
+ *    the factors for a block of vectors. Allocate the cache in the first
+ *    call. In the first block of an outer iteration, take the factors
+ *    computed by the background thread if it has finished. The factors used
+ *    by the block are not freed until the next call.
+ *
+ * RETURN VALUE
+ * ------------
+ * error code
+ ******************************************************************************/
+
+int primme_precond_cache_begin(primme_params *primme) {
+
+   primme_precond_cache *cache = (primme_precond_cache*)primme->precondCache;
+   primme_precond_entry *entries;
+
+   if (cache == NULL) {
+      CHKERR(MALLOC_PRIMME(primme->precondParams.cacheSize, &entries), -1);
+      if (MALLOC_PRIMME(1, &cache)) {
+         free(entries);
+         CHKERR(-1, -1);
+      }
+      cache->entries = entries;
+      cache->numEntries = 0;
+      cache->maxEntries = primme->precondParams.cacheSize;
+      cache->block = 0;
+      cache->iteration = -1;
+      cache->lastTime = 0.0;
+      cache->timeApply = 0.0;
+#ifdef PRIMME_WITH_PTHREADS
+      pthread_mutex_init(&cache->mutex, NULL);
+      cache->building = 0;
+      cache->built = 0;
+      cache->buildFactors = NULL;
+      cache->primme = primme;
+#endif
+      primme->precondCache = cache;
+   }
+
+   cache->block++;
+   cache->canRefactor = cache->iteration != primme->stats.numOuterIterations;
+   cache->iteration = primme->stats.numOuterIterations;
+#ifdef PRIMME_WITH_PTHREADS
+   if (cache->canRefactor) CHKERR(collect_factors(primme), -1);
+#endif
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Function primme_precond_cache_factors - Return the factors to apply to a
+ *    vector with the given shift, computing them if the policy in
+ *    primme.precondParams asks for it.
+ *
+ * INPUT
+ * -----
+ * shift     shift of the vector; if NULL, the factors used last are returned,
+ *           or the ones for the first target shift or zero in the first call
+ *
+ * OUTPUT
+ * ------
+ * factors   the factors to pass to primme.precondApplyFactors
+ *
+ * RETURN VALUE
+ * ------------
+ * error code
+ ******************************************************************************/
+
+int primme_precond_cache_factors(double *shift, void **factors,
+      primme_params *primme) {
+
+   primme_precond_cache *cache = (primme_precond_cache*)primme->precondCache;
+   primme_precond_entry *e = cache->entries;
+   precond_params *params = &primme->precondParams;
+   int i, nearest=-1, replaceable, ierr=0;
+   double s, scale, quantum, drift=HUGE_VAL, t0;
+   void *newFactors=NULL;
+
+   /* Without a shift, use the factors used last */
+
+   if (shift == NULL) {
+      for (i=0; i<cache->numEntries; i++) {
+         if (nearest < 0 || e[i].lastUse > e[nearest].lastUse) nearest = i;
+      }
+      if (nearest >= 0) {
+         e[nearest].lastUse = cache->block;
+         *factors = e[nearest].factors;
+         return 0;
+      }
+      s = primme->numTargetShifts > 0 ? primme->targetShifts[0] : 0.0;
+   }
+   else {
+      s = *shift;
+   }
+
+   /* Round the shift; the tolerances are relative to the estimate of ||A|| */
+
+   scale = max(primme->aNorm, primme->stats.estimateLargestSVal);
+   if (scale <= 0.0) scale = fabs(s) > 0.0 ? fabs(s) : 1.0;
+   quantum = params->shiftQuantum*scale;
+   if (quantum > 0.0) s = floor(s/quantum + 0.5)*quantum;
+
+   /* Find the factors with the closest shift */
+
+   for (i=0; i<cache->numEntries; i++) {
+      if (nearest < 0 || fabs(e[i].shift - s) < drift) {
+         nearest = i;
+         drift = fabs(e[i].shift - s);
+      }
+   }
+
+   /* Use them if the shift is close enough, if refactoring is not allowed */
+   /* in this block or does not fit in the time budget yet, or if all      */
+   /* factors are used by this block                                       */
+
+   replaceable = find_replaceable(cache);
+   if (nearest >= 0 && (drift <= quantum/2.0
+            || !cache->canRefactor
+            || drift <= params->maxShiftDrift*scale
+            || primme->stats.timeFactorize + cache->lastTime
+                  > params->maxTimeRatio*cache->timeApply
+            || replaceable < 0)) {
+      e[nearest].lastUse = cache->block;
+      *factors = e[nearest].factors;
+      return 0;
+   }
+
+#ifdef PRIMME_WITH_PTHREADS
+   /* Start computing the new factors in the background, and use the       */
+   /* closest ones until they are ready                                    */
+
+   if (nearest >= 0 && params->async) {
+      if (!cache->building) {
+         cache->buildShift = s;
+         cache->built = 0;
+         if (pthread_create(&cache->thread, NULL, build_factors, cache) == 0) {
+            cache->building = 1;
+         }
+      }
+      if (cache->building) {
+         e[nearest].lastUse = cache->block;
+         *factors = e[nearest].factors;
+         return 0;
+      }
+   }
+#endif
+
+   /* Compute the new factors now */
+
+   t0 = primme_wTimer(0);
+   CHKERRM((primme->precondFactorize(&s, &newFactors, primme, &ierr), ierr),
+         -1, "Error returned by 'precondFactorize' %d", ierr);
+   CHKERR(insert_factors(replaceable, s, newFactors, primme_wTimer(0) - t0,
+            primme), -1);
+   *factors = newFactors;
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Subroutine primme_precond_cache_end - Account the seconds spent applying
+ *    the factors to a block of vectors.
+ ******************************************************************************/
+
+void primme_precond_cache_end(double time, primme_params *primme) {
+
+   ((primme_precond_cache*)primme->precondCache)->timeApply += time;
+}
+
+/*******************************************************************************
+ * Function primme_precond_cache_free - Free all factors kept and the cache,
+ *    waiting for the background thread if it is running.
+ *
+ * RETURN VALUE
+ * ------------
+ * error code
+ ******************************************************************************/
+
+int primme_precond_cache_free(primme_params *primme) {
+
+   primme_precond_cache *cache = (primme_precond_cache*)primme->precondCache;
+   int i;
+
+   if (cache == NULL) return 0;
+   primme->precondCache = NULL;
+
+#ifdef PRIMME_WITH_PTHREADS
+   if (cache->building) {
+      pthread_join(cache->thread, NULL);
+      if (cache->buildErr == 0) {
+         primme->stats.numFactorizations++;
+         primme->stats.timeFactorize += cache->buildTime;
+         CHKERR(free_factors(cache->buildFactors, primme), -1);
+      }
+   }
+   pthread_mutex_destroy(&cache->mutex);
+#endif
+
+   for (i=0; i<cache->numEntries; i++) {
+      CHKERR(free_factors(cache->entries[i].factors, primme), -1);
+   }
+   free(cache->entries);
+   free(cache);
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Function find_replaceable - Return the entry to store new factors: a free
+ *    one, or the least recently used one if it is not used by the current
+ *    block, or -1 otherwise.
+ ******************************************************************************/
+
+static int find_replaceable(primme_precond_cache *cache) {
+
+   int i, lru;
+
+   if (cache->numEntries < cache->maxEntries) return cache->numEntries;
+   for (i=1, lru=0; i<cache->numEntries; i++) {
+      if (cache->entries[i].lastUse < cache->entries[lru].lastUse) lru = i;
+   }
+   return cache->entries[lru].lastUse < cache->block ? lru : -1;
+}
+
+/*******************************************************************************
+ * Function insert_factors - Store the factors of the given shift in the entry
+ *    i, freeing the factors in it, and account the factorization in
+ *    primme.stats.
+ *
+ * RETURN VALUE
+ * ------------
+ * error code
+ ******************************************************************************/
+
+static int insert_factors(int i, double shift, void *factors, double time,
+      primme_params *primme) {
+
+   primme_precond_cache *cache = (primme_precond_cache*)primme->precondCache;
+
+   if (i == cache->numEntries) {
+      cache->numEntries++;
+   }
+   else {
+      CHKERR(free_factors(cache->entries[i].factors, primme), -1);
+   }
+   cache->entries[i].shift = shift;
+   cache->entries[i].factors = factors;
+   cache->entries[i].time = time;
+   cache->entries[i].lastUse = cache->block;
+   cache->lastTime = time;
+   primme->stats.numFactorizations++;
+   primme->stats.timeFactorize += time;
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Function free_factors - Call primme.precondFreeFactors if it is set.
+ *
+ * RETURN VALUE
+ * ------------
+ * error code
+ ******************************************************************************/
+
+static int free_factors(void *factors, primme_params *primme) {
+
+   int ierr=0;
+
+   if (primme->precondFreeFactors == NULL) return 0;
+   CHKERRM((primme->precondFreeFactors(factors, primme, &ierr), ierr), -1,
+         "Error returned by 'precondFreeFactors' %d", ierr);
+
+   return 0;
+}
+
+#ifdef PRIMME_WITH_PTHREADS
+
+/*******************************************************************************
+ * Function build_factors - Body of the background thread: compute the factors
+ *    for cache.buildShift and publish them in the cache.
+ ******************************************************************************/
+
+static void* build_factors(void *arg) {
+
+   primme_precond_cache *cache = (primme_precond_cache*)arg;
+   primme_params *primme = cache->primme;
+   double shift = cache->buildShift, t0;
+   void *factors = NULL;
+   int ierr = 0;
+
+   t0 = primme_get_wtime();
+   primme->precondFactorize(&shift, &factors, primme, &ierr);
+
+   pthread_mutex_lock(&cache->mutex);
+   cache->buildFactors = factors;
+   cache->buildTime = primme_get_wtime() - t0;
+   cache->buildErr = ierr;
+   cache->built = 1;
+   pthread_mutex_unlock(&cache->mutex);
+
+   return NULL;
+}
+
+/*******************************************************************************
+ * Function collect_factors - Store the factors computed by the background
+ *    thread if it has finished.
+ *
+ * RETURN VALUE
+ * ------------
+ * error code
+ ******************************************************************************/
+
+static int collect_factors(primme_params *primme) {
+
+   primme_precond_cache *cache = (primme_precond_cache*)primme->precondCache;
+   int built;
+
+   if (!cache->building) return 0;
+   pthread_mutex_lock(&cache->mutex);
+   built = cache->built;
+   pthread_mutex_unlock(&cache->mutex);
+   if (!built) return 0;
+
+   pthread_join(cache->thread, NULL);
+   cache->building = 0;
+   CHKERRM(cache->buildErr, -1, "Error returned by 'precondFactorize' %d",
+         cache->buildErr);
+   CHKERR(insert_factors(find_replaceable(cache), cache->buildShift,
+            cache->buildFactors, cache->buildTime, primme), -1);
+
+   return 0;
+}
+
+#endif /* PRIMME_WITH_PTHREADS */
+
+#endif /* USE_DOUBLE */
@@ -0,0 +1,80 @@
+/*******************************************************************************
+ * Copyright (c) 2016, College of William & Mary
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the College of William & Mary nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COLLEGE OF WILLIAM & MARY BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * PRIMME: https://github.com/primme/primme
+ * Contact: Andreas Stathopoulos, a n d r e a s _at_ c s . w m . e d u
+ *******************************************************************************
+ * File: precond_cache.h
+ *
+ * Purpose - Definitions of the cache of factorizations of a shift-dependent
+ *           preconditioner (see precond_cache.c).
+ *
+ ******************************************************************************/
+
+#ifndef PRECOND_CACHE_H
+#define PRECOND_CACHE_H
+
+#ifdef PRIMME_WITH_PTHREADS
+#  include <pthread.h>
+#endif
+
+typedef struct {
+   double shift;              /* shift of the factorization */
+   void *factors;             /* returned by precondFactorize */
+   double time;               /* seconds spent computing it */
+   PRIMME_INT lastUse;        /* block that used it last */
+} primme_precond_entry;
+
+typedef struct {
+   primme_precond_entry *entries;
+   int numEntries;            /* number of valid entries */
+   int maxEntries;            /* precondParams.cacheSize */
+   PRIMME_INT block;          /* number of blocks applied */
+   PRIMME_INT iteration;      /* outer iteration of the last block */
+   int canRefactor;           /* if factors may change in this block */
+   double lastTime;           /* seconds spent in the last factorization */
+   double timeFactorize;      /* seconds spent in precondFactorize */
+   double timeApply;          /* seconds spent in precondApplyFactors */
+#ifdef PRIMME_WITH_PTHREADS
+   pthread_t thread;          /* computes the factors in the background */
+   pthread_mutex_t mutex;     /* protects the following fields */
+   int building;              /* 1 if the thread has been started */
+   int built;                 /* 1 if the thread has finished */
+   double buildShift;         /* shift passed to the thread */
+   void *buildFactors;        /* factors returned by the thread */
+   double buildTime;          /* seconds spent by the thread */
+   int buildErr;              /* error code returned by the thread */
+   primme_params *primme;     /* passed to precondFactorize by the thread */
+#endif
+} primme_precond_cache;
+
+int primme_precond_cache_begin(primme_params *primme);
+int primme_precond_cache_factors(double *shift, void **factors,
+      primme_params *primme);
+void primme_precond_cache_end(double time, primme_params *primme);
+int primme_precond_cache_free(primme_params *primme);
+
+#endif
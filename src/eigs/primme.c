@@ -56,6 +56,7 @@
 
 #include <stdlib.h>   /* mallocs, free */
 #include <stdio.h>    
+#include <string.h>   /* memset */
 #include "const.h"
 #include "wtime.h"
 #include "numerical.h"
@@ -67,12 +68,21 @@
 #include "correction.h"
 #include "update_projection.h"
 #include "primme_interface.h"
+#include "trace.h"
+#include "arena.h"
+#include "precond_cache.h"
 
 #define ALLOCATE_WORKSPACE_FAILURE -1
 #define MALLOC_FAILURE             -2
 #define MAIN_ITER_FAILURE          -3
 
 static int allocate_workspace(primme_params *primme, int allocate);
+static int workspace_size(primme_params *primme, size_t *rworkByteSize,
+      int *intWorkByteSize);
+static void set_arena_key(primme_arena_key *key, primme_params *primme);
+static void release_workspace(primme_params *primme);
+static int call_main_iter(REAL *evals, SCALAR *evecs, REAL *resNorms,
+      double machEps, primme_params *primme);
 static int check_input(REAL *evals, SCALAR *evecs, REAL *resNorms,
                        primme_params *primme);
 static void convTestFunAbsolute(double *eval, void *evec, double *rNorm, int *isConv,
@@ -119,7 +129,6 @@ int Sprimme(REAL *evals, SCALAR *evecs, REAL *resNorms,
             primme_params *primme) {
       
    int ret;
-   int *perm;
    double machEps;
 
    /* ------------------ */
@@ -179,6 +188,30 @@ int Sprimme(REAL *evals, SCALAR *evecs, REAL *resNorms,
    /* ----------------------------------------------------------------------- */
 
    CHKERR(allocate_workspace(primme, TRUE), ALLOCATE_WORKSPACE_FAILURE);
+   ret = call_main_iter(evals, evecs, resNorms, machEps, primme);
+   CHKERR(primme_trace_end(primme), MAIN_ITER_FAILURE);
+   release_workspace(primme);
+   CHKERR(primme_precond_cache_free(primme), MAIN_ITER_FAILURE);
+   return ret;
+}
+
+
+/******************************************************************************
+ * Function call_main_iter - Call main_iter with the workspace already
+ *    allocated and sort the converged pairs.
+ *
+ * Return Value
+ * ------------
+ * The same as Sprimme
+ *
+ ******************************************************************************/
+
+static int call_main_iter(REAL *evals, SCALAR *evecs, REAL *resNorms,
+      double machEps, primme_params *primme) {
+
+   int *perm;
+
+   CHKERR(primme_trace_init(primme), ALLOCATE_WORKSPACE_FAILURE);
 
    /* --------------------------------------------------------- */
    /* Allocate workspace that will be needed locally by Sprimme */
@@ -207,6 +240,8 @@ int Sprimme(REAL *evals, SCALAR *evecs, REAL *resNorms,
 
    free(perm);
 
+   primme->stats.workspaceNumaNodes = primme_workspace_numa_nodes(
+         primme->realWork, primme->realWorkSize);
    primme->stats.elapsedTime = primme_wTimer(0);
    return(0);
 }
@@ -241,8 +276,118 @@ int Sprimme(REAL *evals, SCALAR *evecs, REAL *resNorms,
 
 static int allocate_workspace(primme_params *primme, int allocate) {
 
-   size_t realWorkSize=0;  /* Size of real work space.                  */
    size_t rworkByteSize=0; /* Size of all real data in bytes            */
+   int intWorkByteSize=0;  /* Size of integer work space in bytes       */
+   primme_arena_key key;   /* Configuration looked up in primme.arena   */
+   int placement, hugePages; /* Placement applied to realWork           */
+   size_t ldBytes = (size_t)primme->ldOPs*sizeof(SCALAR); /* V's column */
+
+   /*----------------------------------------------------------------------*/
+   /* Compute the workspace sizes, unless the arena has seen the same      */
+   /* configuration before                                                 */
+   /*----------------------------------------------------------------------*/
+
+   if (primme->arena) set_arena_key(&key, primme);
+   if (primme->arena == NULL || !primme_arena_find_plan(primme->arena, &key,
+            &rworkByteSize, &intWorkByteSize)) {
+      CHKERR(workspace_size(primme, &rworkByteSize, &intWorkByteSize), -1);
+      if (primme->arena) {
+         primme_arena_add_plan(primme->arena, &key, rworkByteSize,
+               intWorkByteSize);
+      }
+   }
+
+   /*----------------------------------------------------------------------*/
+   /* If only the amount of required workspace is needed return it in bytes*/
+   /*----------------------------------------------------------------------*/
+
+   if (!allocate) {
+      primme->intWorkSize  = intWorkByteSize;
+      primme->realWorkSize = rworkByteSize;
+      return 1;
+   }
+
+   /*----------------------------------------------------------------------*/
+   /* Allocate the required workspace, if the user did not provide enough  */
+   /*----------------------------------------------------------------------*/
+   if (primme->realWork != NULL && primme->realWorkSize < rworkByteSize) {
+      return -35;
+   }
+   if (primme->intWork != NULL && primme->intWorkSize < intWorkByteSize) {
+      return -36;
+   }
+
+   /* The placement of a workspace given by the user is unknown */
+
+   primme->stats.workspacePlacement = primme_placement_default;
+   primme->stats.workspaceHugePages = 0;
+
+   /* Take the missing workspace from the arena, growing it if needed */
+
+   if (primme->arena && (primme->realWork == NULL || primme->intWork == NULL)) {
+      CHKERRM(primme_arena_reserve(primme->arena,
+               primme->realWork == NULL ? rworkByteSize : 0,
+               primme->intWork == NULL ? intWorkByteSize : 0, ldBytes,
+               &primme->workspaceParams), MALLOC_FAILURE,
+            "Failed to allocate %zd bytes\n", rworkByteSize);
+      if (primme->realWork == NULL) {
+         primme->realWork = primme->arena->realWork;
+         primme->realWorkSize = primme->arena->realWorkSize;
+         primme->stats.workspacePlacement = primme->arena->placement;
+         primme->stats.workspaceHugePages = primme->arena->hugePages;
+      }
+      if (primme->intWork == NULL) {
+         primme->intWork = primme->arena->intWork;
+         primme->intWorkSize = primme->arena->intWorkSize;
+      }
+   }
+
+   if (primme->realWork == NULL) {
+      primme->realWorkSize = rworkByteSize;
+      if (primme->printLevel >= 5) fprintf(primme->outputFile, 
+         "Allocating real workspace: %zd bytes\n", primme->realWorkSize);
+      CHKERRM(primme_workspace_alloc(rworkByteSize, ldBytes,
+               &primme->workspaceParams, &primme->realWork, &placement,
+               &hugePages), MALLOC_FAILURE,
+            "Failed to allocate %zd bytes\n", rworkByteSize);
+      primme->stats.workspacePlacement = placement;
+      primme->stats.workspaceHugePages = hugePages;
+   }
+
+   if (primme->intWork == NULL) {
+      primme->intWorkSize = intWorkByteSize;
+      if (primme->printLevel >= 5) fprintf(primme->outputFile, 
+         "Allocating integer workspace: %d bytes\n", primme->intWorkSize);
+      CHKERRM(MALLOC_PRIMME(intWorkByteSize/sizeof(int), &primme->intWork),
+            MALLOC_FAILURE, "Failed to allocate %d bytes\n",
+            primme->intWorkSize);
+   }
+
+   return 0;
+
+  /***************************************************************************/
+} /* end of allocate workspace
+  ****************************************************************************/
+
+
+/******************************************************************************
+ * Function workspace_size - Compute the amount of integer and real workspace
+ *    in bytes needed by main_iter and its subordinates.
+ *
+ * Output
+ *  rworkByteSize     Size of the real workspace in bytes
+ *  intWorkByteSize   Size of the integer workspace in bytes
+ *
+ * Return value
+ * ------------
+ * error code
+ *
+ ******************************************************************************/
+
+static int workspace_size(primme_params *primme, size_t *rworkByteSize,
+      int *intWorkByteSize) {
+
+   size_t realWorkSize=0;  /* Size of real work space.                  */
    int intWorkSize=0;/* Size of integer work space in bytes             */
 
    int dataSize;     /* Number of SCALAR positions allocated, excluding */
@@ -251,6 +396,7 @@ static int allocate_workspace(primme_params *primme, int allocate) {
                      /* double arrays: hVals, prevRitzVals, blockNorms  */
    int maxEvecsSize; /* Maximum number of vectors in evecs and evecsHat */
    SCALAR *evecsHat=NULL;/* not NULL when evecsHat will be used        */
+   SCALAR *VRot=NULL;    /* not NULL when restarts may be deferred      */
    SCALAR t;        /* dummy variable */
 
    maxEvecsSize = primme->numOrthoConst + primme->numEvals;
@@ -280,6 +426,17 @@ static int allocate_workspace(primme_params *primme, int allocate) {
          + primme->maxBasisSize*primme->maxBasisSize;    /* Size of hVecsRot */
       doubleSize += primme->maxBasisSize;                /* Size of hSVals */
    }
+   if (primme->projectionParams.projection == primme_proj_RR) {
+      /* Cached H, its eigenvectors and eigenvalues for incremental RR */
+      dataSize += 2*primme->maxBasisSize*primme->maxBasisSize
+         + primme->maxBasisSize;                         /* Size of hCache */
+   }
+   if (primme->projectionParams.projection == primme_proj_RR
+         && !primme->locking) {
+      /* Rotation of V deferred by restart */
+      dataSize += primme->maxBasisSize*primme->maxBasisSize; /* Size of VRot */
+      VRot = &t; /* set not NULL */
+   }
    if (primme->projectionParams.projection == primme_proj_harmonic) {
       /* Stored QtV = Q'*V */
       dataSize +=
@@ -324,8 +481,8 @@ static int allocate_workspace(primme_params *primme, int allocate) {
    /*----------------------------------------------------------------------*/
 
    CHKERR(solve_H_Sprimme(NULL, primme->maxBasisSize, 0, NULL, 0, NULL, 0,
-            NULL, 0, NULL, 0, NULL, NULL, 0, 0.0, &realWorkSize, NULL, 0,
-            &intWorkSize, primme), -1);
+            NULL, 0, NULL, 0, NULL, NULL, NULL, NULL, 0, 0.0, &realWorkSize,
+            NULL, 0, &intWorkSize, primme), -1);
 
    /*----------------------------------------------------------------------*/
    /* Determine workspace required by solve_correction and its children    */
@@ -347,8 +504,8 @@ static int allocate_workspace(primme_params *primme, int allocate) {
             &primme->restartingParams.maxPrevRetain, primme->maxBasisSize,
             primme->initSize, NULL, &primme->maxBasisSize, NULL,
             primme->maxBasisSize, NULL, 0, NULL, 0, NULL, 0, NULL, 0, 0, NULL,
-            0, 0, NULL, NULL, NULL, NULL, 0, NULL, NULL, 0.0, NULL,
-            &realWorkSize, &intWorkSize, 0, primme), -1);
+            0, 0, NULL, NULL, NULL, NULL, 0, VRot, 0, NULL, NULL, NULL, 0.0,
+            NULL, &realWorkSize, &intWorkSize, 0, primme), -1);
 
    /*----------------------------------------------------------------------*/
    /* Determine workspace required by main_iter and its children           */
@@ -357,12 +514,16 @@ static int allocate_workspace(primme_params *primme, int allocate) {
    CHKERR(update_projection_Sprimme(NULL, 0, NULL, 0, NULL, 0, 0, 0,
             primme->maxBasisSize, NULL, &realWorkSize, 0, primme), -1);
 
+   CHKERR(update_projections_Sprimme(NULL, 0, NULL, 0, NULL, 0, NULL, 0, NULL,
+            0, NULL, 0, 0, 0, 0, primme->maxBasisSize, NULL, &realWorkSize,
+            primme), -1);
+
    CHKERR(prepare_candidates_Sprimme(NULL, 0, NULL, 0, primme->nLocal, NULL, 0,
             primme->maxBasisSize, NULL, NULL, NULL, 0, NULL, NULL, NULL,
             primme->numEvals, NULL, 0, primme->maxBlockSize,
             NULL, primme->numEvals, 0, NULL, NULL, 0, 0.0, NULL,
-            &primme->maxBlockSize, NULL, NULL, NULL, NULL, 0, NULL, NULL,
-            &realWorkSize, &intWorkSize, 0, primme), -1);
+            &primme->maxBlockSize, NULL, NULL, NULL, NULL, 0, VRot, 0, 0, NULL,
+            NULL, &realWorkSize, &intWorkSize, 0, primme), -1);
 
    CHKERR(retain_previous_coefficients_Sprimme(NULL, 0, NULL, 0, NULL, 0,
             0, 0, NULL, primme->maxBlockSize, NULL,
@@ -395,50 +556,66 @@ static int allocate_workspace(primme_params *primme, int allocate) {
    /* byte sizes:                                                          */
    /*----------------------------------------------------------------------*/
    
-   rworkByteSize = (dataSize + realWorkSize)*sizeof(SCALAR)
+   *rworkByteSize = (dataSize + realWorkSize)*sizeof(SCALAR)
                                 + doubleSize*sizeof(REAL); 
+   *intWorkByteSize = intWorkSize*sizeof(int);
+   return 0;
+}
 
-   /*----------------------------------------------------------------------*/
-   /* If only the amount of required workspace is needed return it in bytes*/
-   /*----------------------------------------------------------------------*/
-
-   if (!allocate) {
-      primme->intWorkSize  = intWorkSize*sizeof(int);
-      primme->realWorkSize = rworkByteSize;
-      return 1;
-   }
+/******************************************************************************
+ * Subroutine set_arena_key - Gather the parameters that determine the
+ *    workspace required by Sprimme.
+ ******************************************************************************/
 
-   /*----------------------------------------------------------------------*/
-   /* Allocate the required workspace, if the user did not provide enough  */
-   /*----------------------------------------------------------------------*/
-   if (primme->realWork != NULL && primme->realWorkSize < rworkByteSize) {
-      return -35;
-   }
-   else if (primme->realWork == NULL) {
-      primme->realWorkSize = rworkByteSize;
-      if (primme->printLevel >= 5) fprintf(primme->outputFile, 
-         "Allocating real workspace: %zd bytes\n", primme->realWorkSize);
-      CHKERRM(MALLOC_PRIMME(rworkByteSize, (char**)&primme->realWork), MALLOC_FAILURE,
-            "Failed to allocate %zd bytes\n", rworkByteSize);
-   }
+static void set_arena_key(primme_arena_key *key, primme_params *primme) {
+
+   /* Zero also the padding, the keys are compared with memcmp */
+   memset(key, 0, sizeof(*key));
+
+   key->scalarSize = sizeof(SCALAR);
+   key->realSize = sizeof(REAL);
+   key->n = primme->n;
+   key->nLocal = primme->nLocal;
+   key->ldOPs = primme->ldOPs;
+   key->numEvals = primme->numEvals;
+   key->numOrthoConst = primme->numOrthoConst;
+   key->initSize = primme->initSize;
+   key->maxBasisSize = primme->maxBasisSize;
+   key->minRestartSize = primme->minRestartSize;
+   key->maxBlockSize = primme->maxBlockSize;
+   key->locking = primme->locking;
+   key->dynamicMethodSwitch = primme->dynamicMethodSwitch;
+   key->target = primme->target;
+   key->numTargetShifts = primme->numTargetShifts;
+   key->numProcs = primme->numProcs;
+   key->projection = primme->projectionParams.projection;
+   key->scheme = primme->restartingParams.scheme;
+   key->maxPrevRetain = primme->restartingParams.maxPrevRetain;
+   key->precondition = primme->correctionParams.precondition;
+   key->maxInnerIterations = primme->correctionParams.maxInnerIterations;
+   key->robustShifts = primme->correctionParams.robustShifts;
+   key->convTest = primme->correctionParams.convTest;
+   key->LeftQ = primme->correctionParams.projectors.LeftQ;
+   key->LeftX = primme->correctionParams.projectors.LeftX;
+   key->RightQ = primme->correctionParams.projectors.RightQ;
+   key->RightX = primme->correctionParams.projectors.RightX;
+   key->SkewQ = primme->correctionParams.projectors.SkewQ;
+   key->SkewX = primme->correctionParams.projectors.SkewX;
+   key->massMatrix = primme->massMatrixMatvec != NULL;
+}
 
-   if (primme->intWork != NULL
-         && primme->intWorkSize < intWorkSize*(int)sizeof(int)) {
-      return -36;
-   }
-   else if (primme->intWork == NULL) {
-      primme->intWorkSize = intWorkSize*sizeof(int);
-      if (primme->printLevel >= 5) fprintf(primme->outputFile, 
-         "Allocating integer workspace: %d bytes\n", primme->intWorkSize);
-      CHKERRM(MALLOC_PRIMME(intWorkSize, &primme->intWork), MALLOC_FAILURE,
-            "Failed to allocate %d bytes\n", primme->intWorkSize);
-   }
+/******************************************************************************
+ * Subroutine release_workspace - Detach the workspace taken from
+ *    primme.arena, so that primme_free does not free it and later calls take
+ *    it again from the arena, which may have been grown by other calls.
+ ******************************************************************************/
 
-   return 0;
+static void release_workspace(primme_params *primme) {
 
-  /***************************************************************************/
-} /* end of allocate workspace
-  ****************************************************************************/
+   if (primme->arena == NULL) return;
+   if (primme->realWork == primme->arena->realWork) primme->realWork = NULL;
+   if (primme->intWork == primme->arena->intWork) primme->intWork = NULL;
+}
 
 /******************************************************************************
  *
@@ -468,9 +645,13 @@ static int check_input(REAL *evals, SCALAR *evecs, REAL *resNorms,
    else if (primme->matrixMatvec == NULL) 
       ret = -7;
    else if (primme->applyPreconditioner == NULL && 
+            primme->precondFactorize == NULL &&
             primme->correctionParams.precondition > 0 ) 
       ret = -8;
-   /* ret = -9 is free */
+   else if (primme->precondFactorize != NULL &&
+            (primme->precondApplyFactors == NULL ||
+             primme->precondParams.cacheSize < 1))
+      ret = -9;
    else if (primme->numEvals > primme->n)
       ret = -10;
    else if (primme->numEvals < 0)
@@ -231,6 +231,9 @@ void AS_FORTRAN(primme_set_member)(primme_params **primme, int *label,
       case PRIMMEF77_outputFile:
               (*primme)->outputFile = v.file_v;
       break;
+      case PRIMMEF77_traceFile:
+              (*primme)->traceFile = v.file_v;
+      break;
       case PRIMMEF77_matrix:
               (*primme)->matrix = v.ptr_v;
       break;
@@ -322,6 +325,9 @@ void AS_FORTRAN(primme_set_member)(primme_params **primme, int *label,
       case PRIMMEF77_convTestFun:
               (*primme)->convTestFun = v.convTestFun_v;
       break;
+      case PRIMMEF77_monitorFun:
+              (*primme)->monitorFun = v.monitorFun_v;
+      break;
       case PRIMMEF77_ldevecs:
               (*primme)->ldevecs = *v.int_v;
       break;
@@ -465,6 +471,9 @@ void AS_FORTRAN(primme_get_member)(primme_params *primme, int *label,
       case PRIMMEF77_outputFile:
               v->file_v = primme->outputFile;
       break;
+      case PRIMMEF77_traceFile:
+              v->file_v = primme->traceFile;
+      break;
       case PRIMMEF77_matrix:
               v->ptr_v = primme->matrix;
       break;
@@ -100,6 +100,8 @@
 #define PRIMMEF77_convTestFun  51
 #define PRIMMEF77_ldevecs  52
 #define PRIMMEF77_ldOPs  53
+#define PRIMMEF77_traceFile  54
+#define PRIMMEF77_monitorFun  55
 
 #include "template.h"
 #include "primme_interface.h" /* for Sprimme */
@@ -116,6 +118,7 @@ union f77_value {
    void *ptr_v;
    void (*globalSumRealFunc_v) (void *,void *,int *,struct primme_params *,int*);
    void (*convTestFun_v)(double *,void*,double*,int*,struct primme_params*,int*);
+   void (*monitorFun_v)(void *,int *,int *,int *,int *,void *,int *,void *,int *,void *,primme_event *,int *,struct primme_params *,int *);
    primme_target *target_v;
    double *double_v;
    FILE *file_v;
@@ -130,6 +133,7 @@ union f77_value_ptr {
    void *ptr_v;
    void (*globalSumRealFunc_v) (void *,void *,int *,struct primme_params *,int*);
    void (*convTestFun_v)(double *,void*,double*,int*,struct primme_params*,int*);
+   void (*monitorFun_v)(void *,int *,int *,int *,int *,void *,int *,void *,int *,void *,primme_event *,int *,struct primme_params *,int *);
    primme_target target_v;
    double double_v;
    FILE *file_v;
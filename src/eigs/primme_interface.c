@@ -46,6 +46,8 @@
 #include "template.h"
 #include "primme_interface.h"
 #include "const.h"
+#include "trace.h"
+#include "arena.h"
 
 /* Only define these functions ones */
 #ifdef USE_DOUBLE
@@ -68,6 +70,9 @@ void primme_initialize(primme_params *primme) {
    /* Matvec and preconditioner */
    primme->matrixMatvec            = NULL;
    primme->applyPreconditioner     = NULL;
+   primme->precondFactorize        = NULL;
+   primme->precondApplyFactors     = NULL;
+   primme->precondFreeFactors      = NULL;
    primme->massMatrixMatvec        = NULL;
 
    /* Shifts for interior eigenvalues*/
@@ -86,6 +91,7 @@ void primme_initialize(primme_params *primme) {
    primme->numOrthoConst           = 0;
 
    primme->projectionParams.projection = primme_proj_default;
+   primme->projectionParams.distMinSize = 500;
 
    primme->initBasisMode                       = primme_init_default;
 
@@ -113,23 +119,52 @@ void primme_initialize(primme_params *primme) {
    primme->correctionParams.relTolBase         = 0;
    primme->correctionParams.convTest           = primme_adaptive_ETolerance;
 
+   /* workspace parameters */
+   primme->workspaceParams.placement           = primme_placement_default;
+   primme->workspaceParams.hugePages           = 0;
+
+   /* reuse of the preconditioner factorizations */
+   primme->precondParams.cacheSize             = 4;
+   primme->precondParams.shiftQuantum          = 1e-3;
+   primme->precondParams.maxShiftDrift         = 1e-2;
+   primme->precondParams.maxTimeRatio          = 1.0;
+   primme->precondParams.async                 = 0;
+
    /* Printing and reporting */
    primme->outputFile              = stdout;
+   primme->traceFile               = NULL;
+   primme->traceBuffer             = NULL;
+   primme->monitorFun              = NULL;
    primme->printLevel              = 1;
    primme->stats.numOuterIterations= 0;
    primme->stats.numRestarts       = 0;
    primme->stats.numMatvecs        = 0;
    primme->stats.numPreconds       = 0;
+   primme->stats.numGlobalSum      = 0;
    primme->stats.volumeGlobalSum   = 0;
    primme->stats.numOrthoInnerProds= 0.0;
    primme->stats.elapsedTime       = 0.0;
    primme->stats.timeMatvec        = 0.0;
    primme->stats.timePrecond       = 0.0;
    primme->stats.timeGlobalSum     = 0.0;
+   primme->stats.timeSolveH        = 0.0;
+   primme->stats.timeRestart       = 0.0;
+   primme->stats.timeResetUpdateVWXR = 0.0;
+   primme->stats.timeLocking       = 0.0;
+   primme->stats.timeUpdateVWXR    = 0.0;
+   primme->stats.timeInnerSolve    = 0.0;
+   primme->stats.timeConvergence   = 0.0;
+   primme->stats.estimateFlops     = 0.0;
+   primme->stats.estimateBytes     = 0.0;
    primme->stats.estimateMaxEVal   = -HUGE_VAL;
    primme->stats.estimateMinEVal   = HUGE_VAL;
    primme->stats.estimateLargestSVal = -HUGE_VAL;
    primme->stats.maxConvTol        = 0.0L;
+   primme->stats.workspacePlacement = primme_placement_default;
+   primme->stats.workspaceHugePages = 0;
+   primme->stats.workspaceNumaNodes = 0;
+   primme->stats.numFactorizations = 0;
+   primme->stats.timeFactorize     = 0.0;
 
    /* Optional user defined structures */
    primme->matrix                  = NULL;
@@ -144,7 +179,9 @@ void primme_initialize(primme_params *primme) {
    primme->realWorkSize            = 0;
    primme->intWork                 = NULL;
    primme->realWork                = NULL;
+   primme->arena                   = NULL;
    primme->ShiftsForPreconditioner = NULL;
+   primme->precondCache            = NULL;
    primme->convTestFun             = NULL;
    primme->ldevecs                 = 0;
    primme->ldOPs                   = 0;
@@ -153,8 +190,14 @@ void primme_initialize(primme_params *primme) {
 
 void primme_free(primme_params *params) {
 
-   free(params->intWork);
-   free(params->realWork);
+   primme_trace_free(params);
+   /* The workspace taken from an arena is freed by primme_arena_free */
+   if (params->arena == NULL || params->intWork != params->arena->intWork)
+      free(params->intWork);
+   if (params->arena == NULL || params->realWork != params->arena->realWork)
+      free(params->realWork);
+   params->intWork = NULL;
+   params->realWork = NULL;
    params->intWorkSize  = 0;
    params->realWorkSize = 0;
 
@@ -259,7 +302,8 @@ int primme_set_method(primme_preset_method method, primme_params *params) {
       params->maxBlockSize = 1;
    }
    if (params->correctionParams.precondition == -1) {
-      params->correctionParams.precondition = params->applyPreconditioner ? 1 : 0;
+      params->correctionParams.precondition =
+         (params->applyPreconditioner || params->precondFactorize) ? 1 : 0;
    }
 
    if (method == PRIMME_Arnoldi) {
@@ -588,6 +632,7 @@ void primme_display_params_prefix(const char* prefix, primme_params primme) {
    PRINTParamsIF(projection, projection, primme_proj_RR);
    PRINTParamsIF(projection, projection, primme_proj_harmonic);
    PRINTParamsIF(projection, projection, primme_proj_refined);
+   PRINTParams(projection, distMinSize, %d);
 
    PRINTIF(initBasisMode, primme_init_default);
    PRINTIF(initBasisMode, primme_init_krylov);
@@ -639,15 +684,95 @@ void primme_display_params_prefix(const char* prefix, primme_params primme) {
    PRINTParams(correction, projectors.SkewQ , %d);
    PRINTParams(correction, projectors.RightX, %d);
    PRINTParams(correction, projectors.SkewX , %d);
+
+   fprintf(outputFile, "\n// Workspace\n");
+   PRINTParamsIF(workspace, placement, primme_placement_default);
+   PRINTParamsIF(workspace, placement, primme_placement_firsttouch);
+   PRINTParamsIF(workspace, placement, primme_placement_interleave);
+   PRINTParams(workspace, hugePages, %d);
+
+   fprintf(outputFile, "\n// Preconditioner factorizations\n");
+   PRINTParams(precond, cacheSize, %d);
+   PRINTParams(precond, shiftQuantum, %g);
+   PRINTParams(precond, maxShiftDrift, %g);
+   PRINTParams(precond, maxTimeRatio, %g);
+   PRINTParams(precond, async, %d);
    fprintf(outputFile, "// ---------------------------------------------------\n");
 
 #undef PRINT
 #undef PRINTIF
 #undef PRINTParams
 #undef PRINTParamsIF
+#undef PRINT_PRIMME_INT
 
   /**************************************************************************/
 } /* end of display params */
   /**************************************************************************/
 
+/******************************************************************************
+ *
+ * void primme_display_stats(primme_params primme);
+ *
+ *    Displays the counters and the time spent in each phase of the last call
+ *    to primme. The top-level phases do not overlap; nested phases are
+ *    indented under the phase that contains them. The times of the
+ *    operations (matvec, preconditioner, ortho, global sums) are shown apart
+ *    because they are also counted in the phases that call them.
+ *
+ *****************************************************************************/
+void primme_display_stats(primme_params primme) {
+
+   FILE *outputFile = primme.outputFile;
+
+#define PRINT(P,L) fprintf(outputFile, "primme.stats." #P " = " #L "\n", primme.stats. P);
+#define PRINTNESTED(P,L) fprintf(outputFile, "   primme.stats." #P " = " #L "\n", primme.stats. P);
+#define PRINT_PRIMME_INT(P) fprintf(outputFile, "primme.stats." #P " = %" PRIMME_INT_P "\n", primme.stats. P);
+
+   fprintf(outputFile,
+           "// ---------------------------------------------------\n"
+           "//                 primme statistics                  \n"
+           "// ---------------------------------------------------\n");
+
+   PRINT_PRIMME_INT(numOuterIterations);
+   PRINT_PRIMME_INT(numRestarts);
+   PRINT_PRIMME_INT(numMatvecs);
+   PRINT_PRIMME_INT(numPreconds);
+   PRINT_PRIMME_INT(numFactorizations);
+   PRINT_PRIMME_INT(numGlobalSum);
+   PRINT_PRIMME_INT(volumeGlobalSum);
+   PRINT(numOrthoInnerProds, %g);
+   PRINT(estimateFlops, %g);
+   PRINT(estimateBytes, %g);
+
+   fprintf(outputFile, "\n// Workspace\n");
+   PRINT_PRIMME_INT(workspacePlacement);
+   PRINT_PRIMME_INT(workspaceHugePages);
+   PRINT_PRIMME_INT(workspaceNumaNodes);
+
+   fprintf(outputFile, "\n// Time in seconds\n");
+   PRINT(elapsedTime, %g);
+
+   fprintf(outputFile, "\n// Phases, not overlapping\n");
+   PRINT(timeSolveH, %g);
+   PRINT(timeUpdateVWXR, %g);
+   PRINT(timeConvergence, %g);
+   PRINT(timeInnerSolve, %g);
+   PRINT(timeRestart, %g);
+   PRINTNESTED(timeLocking, %g);
+   PRINTNESTED(timeResetUpdateVWXR, %g);
+
+   fprintf(outputFile, "\n// Operations, also counted in the phases\n");
+   PRINT(timeMatvec, %g);
+   PRINT(timePrecond, %g);
+   PRINTNESTED(timeFactorize, %g);
+   PRINT(timeOrtho, %g);
+   PRINT(timeGlobalSum, %g);
+   fprintf(outputFile, "// ---------------------------------------------------\n");
+   fflush(outputFile);
+
+#undef PRINT
+#undef PRINTNESTED
+#undef PRINT_PRIMME_INT
+}
+
 #endif /* USE_DOUBLE */
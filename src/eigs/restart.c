@@ -37,6 +37,7 @@
 #include <math.h>
 #include <assert.h>
 #include "const.h"
+#include "wtime.h"
 #include "numerical.h"
 #include "auxiliary_eigs.h"
 #include "restart.h"
@@ -48,6 +49,15 @@
 #include "update_W.h"
 #include "convergence.h"
 #include "globalsum.h"
+#include "trace.h"
+
+/* Largest condition number in the 1-norm, as estimated by xGECON, of the    */
+/* rotation VRot accumulated by deferred restarts before V and W are         */
+/* restarted explicitly                                                      */
+
+#ifndef PRIMME_DEFERRED_RESTART_MAXCOND
+#  define PRIMME_DEFERRED_RESTART_MAXCOND 100
+#endif
 
 static int restart_soft_locking_Sprimme(int *restartSize, SCALAR *V,
        SCALAR *W, PRIMME_INT nLocal, int basisSize, PRIMME_INT ldV, SCALAR **X,
@@ -56,8 +66,21 @@ static int restart_soft_locking_Sprimme(int *restartSize, SCALAR *V,
        SCALAR *evecs, REAL *evals, REAL *resNorms, SCALAR *evecsHat,
        PRIMME_INT ldevecsHat, SCALAR *M, int ldM, int *numConverged,
        int *numConvergedStored, int numPrevRetained, int *indexOfPreviousVecs,
-       int *hVecsPerm, int reset, double machEps, SCALAR *rwork,
-       size_t *rworkSize, int *iwork, int iworkSize, primme_params *primme);
+       int *hVecsPerm, SCALAR *VRot, int ldVRot, int *nVRot, int reset,
+       double machEps, SCALAR *rwork, size_t *rworkSize, int *iwork,
+       int iworkSize, primme_params *primme);
+
+static int restart_deferred_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT nLocal,
+      int basisSize, PRIMME_INT ldV, SCALAR *hVecs, int ldhVecs, REAL *hVals,
+      int restartSize, SCALAR *X, SCALAR *R, int nXb, int nXe,
+      REAL *blockNorms, SCALAR *VRot, int ldVRot, int *nVRot, int deferred,
+      int reset, double machEps, SCALAR *rwork, size_t *rworkSize, int *iwork,
+      int iworkSize, primme_params *primme);
+
+static int update_VWXR_deferred_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT mV,
+      int nV, PRIMME_INT ldV, int *perm, SCALAR *Z, int nZ, int ldZ, SCALAR *h,
+      int ldh, REAL *hVals, SCALAR *X, SCALAR *R, int nXb, int nXe,
+      REAL *Rnorms, SCALAR *rwork, size_t lrwork, primme_params *primme);
 
 static int restart_projection_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
       PRIMME_INT ldW, SCALAR *H, int ldH, SCALAR *Q, PRIMME_INT ldQ,
@@ -227,6 +250,14 @@ static int ortho_coefficient_vectors_Sprimme(SCALAR *hVecs, int basisSize,
  *
  * ldhVecsRot       The leading dimension of hVecsRot
  *
+ * VRot             If not NULL, V and W may be restarted deferring part of the
+ *                  update. Then the actual basis is V(:,0:nVRot-1)*VRot
+ *                  followed by V(:,nVRot:), and similarly for W
+ *
+ * ldVRot           The leading dimension of VRot
+ *
+ * nVRot            The number of columns of V affected by VRot
+ *
  * restartsSinceReset Number of restarts since last reset of V and W
  *
  * reset            flag to reset V and W at this restart
@@ -254,9 +285,9 @@ int restart_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT nLocal, int basisSize,
        int ldQtV, SCALAR *hU, int ldhU, int newldhU, SCALAR *hVecs,
        int ldhVecs, int newldhVecs, int *restartSizeOutput,
        int *targetShiftIndex, int *numArbitraryVecs, SCALAR *hVecsRot,
-       int ldhVecsRot, int *restartsSinceReset, int *reset,
-       double machEps, SCALAR *rwork, size_t *rworkSize, int *iwork,
-       int iworkSize, primme_params *primme) {
+       int ldhVecsRot, SCALAR *VRot, int ldVRot, int *nVRot,
+       int *restartsSinceReset, int *reset, double machEps, SCALAR *rwork,
+       size_t *rworkSize, int *iwork, int iworkSize, primme_params *primme) {
 
    int i;                   /* Loop indices */
    int restartSize;         /* Basis size after restarting                   */
@@ -287,8 +318,8 @@ int restart_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT nLocal, int basisSize,
          CHKERR(restart_soft_locking_Sprimme(&basisSize, NULL, NULL,
                nLocal, basisSize, 0, NULL, NULL, NULL, 0, NULL, NULL, NULL,
                NULL, ievSize, NULL, NULL, NULL, NULL, evecsHat, 0, NULL, 0,
-               numConverged, numConverged, *numPrevRetained, NULL, NULL, 0, 0.0,
-               NULL, rworkSize, &iworkSize0, 0, primme), -1);
+               numConverged, numConverged, *numPrevRetained, NULL, NULL, VRot,
+               0, NULL, 0, 0.0, NULL, rworkSize, &iworkSize0, 0, primme), -1);
       }
 
       CHKERR(restart_projection_Sprimme(NULL, 0, NULL, 0, NULL, 0, NULL, 0, 0,
@@ -448,17 +479,22 @@ int restart_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT nLocal, int basisSize,
                basisSize, ldV, &X, &Res, hVecs, ldhVecs, restartPerm, hVals,
                flags, iev, ievSize, blockNorms, evecs, evals, resNorms,
                evecsHat, ldevecsHat, M, ldM, numConverged, numConvergedStored,
-               *numPrevRetained, &indexOfPreviousVecs, hVecsPerm, *reset,
-               machEps, rwork, rworkSize, iwork0, iworkSize0, primme), -1);
+               *numPrevRetained, &indexOfPreviousVecs, hVecsPerm, VRot, ldVRot,
+               nVRot, *reset, machEps, rwork, rworkSize, iwork0, iworkSize0,
+               primme), -1);
    }
    else {
       SCALAR *X, *Res;
+      double t0 = primme_wTimer(0);
+      TRACE_BEGIN("lock", primme);
       CHKERR(restart_locking_Sprimme(&restartSize, V, W, nLocal, basisSize,
                ldV, &X, &Res, hVecs, ldhVecs, restartPerm, hVals, flags, iev,
                ievSize, blockNorms, evecs, ldevecs, evals, numConverged,
                numLocked, resNorms, evecsPerm, *numPrevRetained,
                &indexOfPreviousVecs, hVecsPerm, *reset, machEps, rwork,
                rworkSize, iwork0, iworkSize0, primme), -1);
+      TRACE_END("lock", primme);
+      primme->stats.timeLocking += primme_wTimer(0) - t0;
    }
 
    *reset = 0;
@@ -491,11 +527,18 @@ int restart_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT nLocal, int basisSize,
          -1);
 
    /* If all request eigenpairs converged, force the converged vectors at the */
-   /* beginning of V                                                          */
+   /* beginning of V. If the restart was deferred, permuting VRot is enough.  */
 
    if (*numConverged >= primme->numEvals && !primme->locking) {
-      permute_vecs_Sprimme(V, nLocal, restartSize, ldV, hVecsPerm, rwork,
-            iwork0);
+      if (VRot && *nVRot > 0) {
+         assert(*nVRot == restartSize);
+         permute_vecs_Sprimme(VRot, *nVRot, restartSize, ldVRot, hVecsPerm,
+               rwork, iwork0);
+      }
+      else {
+         permute_vecs_Sprimme(V, nLocal, restartSize, ldV, hVecsPerm, rwork,
+               iwork0);
+      }
    }
 
    *restartSizeOutput = restartSize; 
@@ -592,6 +635,11 @@ int restart_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT nLocal, int basisSize,
  *
  * hVecsPerm        The permutation that orders the output hVals and hVecs as primme.target
  *
+ * VRot, ldVRot     If not NULL, the rotation that V(:,0:nVRot-1) and
+ *                  W(:,0:nVRot-1) are pending to be applied
+ *
+ * nVRot            The number of columns of V affected by VRot
+ *
  * 
  * OUTPUT ARRAYS AND PARAMETERS
  * ----------------------------
@@ -614,8 +662,9 @@ static int restart_soft_locking_Sprimme(int *restartSize, SCALAR *V,
        SCALAR *evecs, REAL *evals, REAL *resNorms, SCALAR *evecsHat,
        PRIMME_INT ldevecsHat, SCALAR *M, int ldM, int *numConverged,
        int *numConvergedStored, int numPrevRetained, int *indexOfPreviousVecs,
-       int *hVecsPerm, int reset, double machEps, SCALAR *rwork,
-       size_t *rworkSize, int *iwork, int iworkSize, primme_params *primme) {
+       int *hVecsPerm, SCALAR *VRot, int ldVRot, int *nVRot, int reset,
+       double machEps, SCALAR *rwork, size_t *rworkSize, int *iwork,
+       int iworkSize, primme_params *primme) {
 
    int i, j, k;               /* loop indices */
    int wholeSpace=0;          /* if all pairs in V are marked as converged */
@@ -636,6 +685,12 @@ static int restart_soft_locking_Sprimme(int *restartSize, SCALAR *V,
             &t, *numConverged, *numConverged+*ievSize, 0, &d,
             NULL, 0, 0,
             0, 0.0, NULL, rworkSize, primme), -1);
+      if (VRot) {
+         CHKERR(restart_deferred_Sprimme(NULL, NULL, nLocal, basisSize, 0,
+                  NULL, 0, NULL, *restartSize, NULL, NULL, *numConverged,
+                  *numConverged+*ievSize, NULL, NULL, 0, NULL, 0, 0, 0.0,
+                  NULL, rworkSize, iwork, 0, primme), -1);
+      }
       /* if evecsHat, permutation matrix & compute_submatrix workspace */
       if (evecsHat) {
          *rworkSize = max(*rworkSize, 
@@ -735,15 +790,28 @@ static int restart_soft_locking_Sprimme(int *restartSize, SCALAR *V,
    *X = &V[*restartSize*ldV];
    *R = &W[*restartSize*ldV];
 
-   CHKERR(Num_reset_update_VWXR_Sprimme(V, W, nLocal, basisSize, ldV,
-            hVecs, *restartSize, ldhVecs, hVals,
-            V, 0, *restartSize, ldV,
-            *X, *numConverged, *numConverged+*ievSize, ldV,
-            NULL, 0, 0, 0, 0,
-            W, 0, *restartSize, ldV,
-            *R, *numConverged, *numConverged+*ievSize, ldV, blockNorms,
-            NULL, 0, 0,
-            reset, machEps, rwork, rworkSize, primme), -1);
+   if (VRot) {
+      /* Defer the update only if V is not going to be used explicitly:  */
+      /* resetting V and W, checking convergence for the whole space, or  */
+      /* using skew projectors                                            */
+
+      CHKERR(restart_deferred_Sprimme(V, W, nLocal, basisSize, ldV, hVecs,
+               ldhVecs, hVals, *restartSize, *X, *R, *numConverged,
+               *numConverged+*ievSize, blockNorms, VRot, ldVRot, nVRot,
+               !evecsHat && !wholeSpace && !reset, reset, machEps, rwork,
+               rworkSize, iwork, iworkSize, primme), -1);
+   }
+   else {
+      CHKERR(Num_reset_update_VWXR_Sprimme(V, W, nLocal, basisSize, ldV,
+               hVecs, *restartSize, ldhVecs, hVals,
+               V, 0, *restartSize, ldV,
+               *X, *numConverged, *numConverged+*ievSize, ldV,
+               NULL, 0, 0, 0, 0,
+               W, 0, *restartSize, ldV,
+               *R, *numConverged, *numConverged+*ievSize, ldV, blockNorms,
+               NULL, 0, 0,
+               reset, machEps, rwork, rworkSize, primme), -1);
+   }
 
    if (!wholeSpace) {
       /* ----------------------------------------------------------------- */
@@ -854,6 +922,312 @@ static int restart_soft_locking_Sprimme(int *restartSize, SCALAR *V,
    return 0;
 }
 
+/*******************************************************************************
+ * Subroutine: restart_deferred - This routine restarts V and W as
+ *    restart_soft_locking does with Num_reset_update_VWXR, but it may defer
+ *    part of the update. Let B be [V(:,0:nVRot-1) V(:,nVRot:basisSize-1)]
+ *    and D = [VRot 0; 0 I]*hVecs, so that the restarted basis is B*D.
+ *    A LU factorization with partial pivoting of D(:,0:restartSize-1) selects
+ *    restartSize rows P such that D = [I; Z]*D(P,:) in that row order. Then
+ *
+ *       V(:,0:restartSize-1) = B(:,P) + B(:,~P)*Z,  VRot = D(P,:),
+ *
+ *    and similarly for W. That costs nLocal*(basisSize-restartSize)*
+ *    restartSize instead of nLocal*basisSize*restartSize, and the cost of
+ *    applying VRot later is proportional to the new columns only. If
+ *    deferring is not possible or VRot becomes ill-conditioned, V and W are
+ *    updated with D explicitly and nVRot is set to zero.
+ *
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * nLocal           Number of rows of V and W assigned to the node
+ *
+ * basisSize        Number of columns of V and W
+ *
+ * ldV              The leading dimension of V, W, X and R
+ *
+ * hVecs, ldhVecs   The coefficient vectors and their leading dimension
+ *
+ * hVals            The Ritz values
+ *
+ * restartSize      The number of columns to restart with
+ *
+ * nXb, nXe         Range of columns of hVecs to compute X and R
+ *
+ * deferred         Whether to defer the update
+ *
+ * reset            Flag to reset V and W, see Num_reset_update_VWXR
+ *
+ * INPUT/OUTPUT ARRAYS AND PARAMETERS
+ * ----------------------------------
+ * V, W             The basis and A*V
+ *
+ * VRot, ldVRot     The rotation pending to be applied on V and W, and its
+ *                  leading dimension
+ *
+ * nVRot            The number of columns affected by VRot
+ *
+ * OUTPUT ARRAYS AND PARAMETERS
+ * ----------------------------
+ * X, R             The Ritz vectors and the residual vectors of
+ *                  hVecs(:,nXb:nXe-1)
+ *
+ * blockNorms       The norms of R
+ *
+ ******************************************************************************/
+
+static int restart_deferred_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT nLocal,
+      int basisSize, PRIMME_INT ldV, SCALAR *hVecs, int ldhVecs, REAL *hVals,
+      int restartSize, SCALAR *X, SCALAR *R, int nXb, int nXe,
+      REAL *blockNorms, SCALAR *VRot, int ldVRot, int *nVRot, int deferred,
+      int reset, double machEps, SCALAR *rwork, size_t *rworkSize, int *iwork,
+      int iworkSize, primme_params *primme) {
+
+   int i, j;               /* loop indices */
+   int nD;                 /* number of columns of D */
+   int info;               /* LAPACK error code */
+   int *ipivot, *perm;     /* pivots from getrf and row permutation of D */
+   SCALAR *D, *LU, *aux;   /* D, its LU factors and auxiliary space */
+   size_t rworkSize0;      /* size of the workspace after D, LU and aux */
+   REAL normT, rcond;      /* 1-norm of D(P,:) and its reciprocal condition */
+
+   nD = max(restartSize, nXe);
+
+   /* Return memory requirement */
+
+   if (V == NULL) {
+      SCALAR t;
+      REAL d;
+      size_t lrw = 0;
+      int m = (int)min(PRIMME_BLOCK_SIZE, nLocal);
+
+      CHKERR(Num_reset_update_VWXR_Sprimme(NULL, NULL, nLocal, basisSize, 0,
+            &t, nD, 0, NULL,
+            &t, 0, restartSize, 0,
+            &t, nXb, nXe, 0,
+            NULL, 0, 0, 0, 0,
+            &t, 0, restartSize, 0,
+            &t, nXb, nXe, 0, &d,
+            NULL, 0, 0,
+            0, 0.0, NULL, &lrw, primme), -1);
+      lrw = max(lrw, (size_t)m*basisSize + 2*(size_t)max(0, nXe-nXb));
+      *rworkSize = max(*rworkSize, (size_t)basisSize*nD
+            + (size_t)basisSize*restartSize
+            + (size_t)max(4*restartSize, basisSize) + lrw);
+      *iwork = max(*iwork, 2*restartSize+basisSize);
+      return 0;
+   }
+
+   /* Quick exit if there is no rotation pending nor deferring */
+
+   if (*nVRot == 0 && !deferred) {
+      CHKERR(Num_reset_update_VWXR_Sprimme(V, W, nLocal, basisSize, ldV,
+               hVecs, restartSize, ldhVecs, hVals,
+               V, 0, restartSize, ldV,
+               X, nXb, nXe, ldV,
+               NULL, 0, 0, 0, 0,
+               W, 0, restartSize, ldV,
+               R, nXb, nXe, ldV, blockNorms,
+               NULL, 0, 0,
+               reset, machEps, rwork, rworkSize, primme), -1);
+      return 0;
+   }
+
+   /* D = [VRot 0; 0 I]*hVecs(:,0:nD-1) */
+
+   D = rwork;
+   LU = D + (size_t)basisSize*nD;
+   aux = LU + (size_t)basisSize*restartSize;
+   assert(*rworkSize >= (size_t)basisSize*nD + (size_t)basisSize*restartSize
+         + (size_t)max(4*restartSize, basisSize));
+   rworkSize0 = *rworkSize - (size_t)basisSize*nD
+         - (size_t)basisSize*restartSize
+         - (size_t)max(4*restartSize, basisSize);
+   Num_gemm_Sprimme("N", "N", *nVRot, nD, *nVRot, 1.0, VRot, ldVRot, hVecs,
+         ldhVecs, 0.0, D, basisSize);
+   Num_copy_matrix_Sprimme(&hVecs[*nVRot], basisSize-*nVRot, nD, ldhVecs,
+         &D[*nVRot], basisSize);
+   *nVRot = 0;
+
+   if (deferred && restartSize < basisSize) {
+      ipivot = iwork;
+      perm = &iwork[restartSize];
+      assert(iworkSize >= 2*restartSize+basisSize);
+
+      /* [L1; L2]*U = D(P,0:restartSize-1) */
+
+      Num_copy_matrix_Sprimme(D, basisSize, restartSize, basisSize, LU,
+            basisSize);
+      Num_getrf_Sprimme(basisSize, restartSize, LU, basisSize, ipivot, &info);
+      CHKERRM(info < 0, -1, "Error in getrf with info %d\n", info);
+      for (i=0; i<basisSize; i++) perm[i] = i;
+      for (i=0; i<restartSize; i++) {
+         j = perm[i];
+         perm[i] = perm[ipivot[i]-1];
+         perm[ipivot[i]-1] = j;
+      }
+
+      /* Estimate the condition number of D(P,:) = L1*U in the 1-norm */
+
+      for (j=0, normT=0.0; j<restartSize; j++) {
+         REAL colNorm = 0.0;
+         for (i=0; i<restartSize; i++) {
+            colNorm += ABS(D[basisSize*j+perm[i]]);
+         }
+         normT = max(normT, colNorm);
+      }
+      rcond = 0.0;
+      if (info == 0) {
+         Num_gecon_Sprimme("1", restartSize, LU, basisSize, normT, &rcond,
+               aux, &iwork[restartSize+basisSize], &info);
+         CHKERRM(info < 0, -1, "Error in gecon with info %d\n", info);
+      }
+
+      if (info == 0 && rcond*PRIMME_DEFERRED_RESTART_MAXCOND >= 1.0) {
+
+         /* Z = L2*inv(L1) */
+
+         Num_trsm_Sprimme("R", "L", "N", "U", basisSize-restartSize,
+               restartSize, 1.0, LU, basisSize, &LU[restartSize], basisSize);
+
+         /* D = D(P,:) */
+
+         for (j=0; j<nD; j++) {
+            for (i=0; i<basisSize; i++)
+               aux[i] = D[basisSize*j+perm[i]];
+            Num_copy_Sprimme(basisSize, aux, 1, &D[basisSize*j], 1);
+         }
+
+         CHKERR(update_VWXR_deferred_Sprimme(V, W, nLocal, basisSize, ldV,
+                  perm, &LU[restartSize], restartSize, basisSize, D,
+                  basisSize, hVals, X, R, nXb, nXe, blockNorms,
+                  aux+max(4*restartSize, basisSize), rworkSize0,
+                  primme), -1);
+
+         Num_copy_matrix_Sprimme(D, restartSize, restartSize, basisSize, VRot,
+               ldVRot);
+         *nVRot = restartSize;
+         return 0;
+      }
+   }
+
+   /* Restart V and W explicitly with D */
+
+   rworkSize0 = *rworkSize - (size_t)basisSize*nD;
+   CHKERR(Num_reset_update_VWXR_Sprimme(V, W, nLocal, basisSize, ldV,
+            D, nD, basisSize, hVals,
+            V, 0, restartSize, ldV,
+            X, nXb, nXe, ldV,
+            NULL, 0, 0, 0, 0,
+            W, 0, restartSize, ldV,
+            R, nXb, nXe, ldV, blockNorms,
+            NULL, 0, 0,
+            reset, machEps, LU, &rworkSize0, primme), -1);
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Subroutine: update_VWXR_deferred - This subroutine performs the next
+ *    operations in a cache-friendly way:
+ *
+ *    X = V(:,perm)*h(:,nXb:nXe-1),
+ *    R = W(:,perm)*h(:,nXb:nXe-1) - X*diag(hVals(nXb:nXe-1)),
+ *    Rnorms = norms(R),
+ *    V(:,0:nZ-1) = V(:,perm(0:nZ-1)) + V(:,perm(nZ:nV-1))*Z,
+ *    W(:,0:nZ-1) = W(:,perm(0:nZ-1)) + W(:,perm(nZ:nV-1))*Z
+ *
+ * X and R may be columns of V and W beyond nZ.
+ *
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * mV, nV, ldV Number of rows and columns and leading dimension of V and W
+ * perm        Permutation of the columns of V and W
+ * Z           Matrix of size nV-nZ x nZ
+ * nZ, ldZ     Number of columns and leading dimension of Z
+ * h, ldh      Matrix of size nV x nXe and its leading dimension
+ * hVals       Array of values
+ * nXb, nXe    Range of columns of h
+ *
+ * INPUT/OUTPUT ARRAYS AND PARAMETERS
+ * ----------------------------------
+ * V, W        The basis and A*V
+ * X, R        Output matrices with leading dimension ldV
+ * Rnorms      Output array with the norms of R
+ *
+ ******************************************************************************/
+
+static int update_VWXR_deferred_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT mV,
+      int nV, PRIMME_INT ldV, int *perm, SCALAR *Z, int nZ, int ldZ, SCALAR *h,
+      int ldh, REAL *hVals, SCALAR *X, SCALAR *R, int nXb, int nXe,
+      REAL *Rnorms, SCALAR *rwork, size_t lrwork, primme_params *primme) {
+
+   PRIMME_INT i;     /* Loop variables */
+   int j;            /* Loop variables */
+   int m=min(PRIMME_BLOCK_SIZE, mV);   /* Number of rows in the cache */
+   SCALAR *G;        /* Rows of V or W in the order of perm */
+   REAL *tmp, *tmp0;
+   double t0;
+
+   assert((size_t)m*nV + 2*(nXe-nXb) <= lrwork); /* Check workspace */
+
+   t0 = primme_wTimer(0);
+   G = rwork;
+
+   for (j=nXb; j<nXe; j++) Rnorms[j-nXb] = 0.0;
+
+   for (i=0; i < mV; i+=m, m=min(m,mV-i)) {
+      /* G = V(i:i+m-1,perm), X = G*h(:,nXb:nXe-1) */
+      for (j=0; j<nV; j++)
+         Num_copy_Sprimme(m, &V[i+ldV*perm[j]], 1, &G[m*j], 1);
+      Num_gemm_Sprimme("N", "N", m, nXe-nXb, nV, 1.0, G, m, &h[ldh*nXb],
+            ldh, 0.0, &X[i], ldV);
+
+      /* V(i:i+m-1,0:nZ-1) = G(:,0:nZ-1) + G(:,nZ:nV-1)*Z */
+      Num_gemm_Sprimme("N", "N", m, nZ, nV-nZ, 1.0, &G[m*nZ], m, Z, ldZ,
+            1.0, G, m);
+      Num_copy_matrix_Sprimme(G, m, nZ, m, &V[i], ldV);
+
+      /* G = W(i:i+m-1,perm), R = G*h(:,nXb:nXe-1) - X*diag(hVals) */
+      for (j=0; j<nV; j++)
+         Num_copy_Sprimme(m, &W[i+ldV*perm[j]], 1, &G[m*j], 1);
+      Num_gemm_Sprimme("N", "N", m, nXe-nXb, nV, 1.0, G, m, &h[ldh*nXb],
+            ldh, 0.0, &R[i], ldV);
+      for (j=nXb; j<nXe; j++) {
+         Num_compute_residual_Sprimme(m, hVals[j], &X[i+ldV*(j-nXb)],
+               &R[i+ldV*(j-nXb)], &R[i+ldV*(j-nXb)]);
+         Rnorms[j-nXb] += REAL_PART(Num_dot_Sprimme(m, &R[i+ldV*(j-nXb)], 1,
+                  &R[i+ldV*(j-nXb)], 1));
+      }
+
+      /* W(i:i+m-1,0:nZ-1) = G(:,0:nZ-1) + G(:,nZ:nV-1)*Z */
+      Num_gemm_Sprimme("N", "N", m, nZ, nV-nZ, 1.0, &G[m*nZ], m, Z, ldZ,
+            1.0, G, m);
+      Num_copy_matrix_Sprimme(G, m, nZ, m, &W[i], ldV);
+   }
+
+   /* Reduce Rnorms and sqrt the results */
+
+   if (primme->numProcs > 1 && nXb < nXe) {
+      tmp = (REAL*)rwork;
+      for (j=nXb; j<nXe; j++) tmp[j-nXb] = Rnorms[j-nXb];
+      tmp0 = tmp+(nXe-nXb);
+      CHKERR(globalSum_Rprimme(tmp, tmp0, nXe-nXb, primme), -1);
+      for (j=nXb; j<nXe; j++) Rnorms[j-nXb] = sqrt(tmp0[j-nXb]);
+   }
+   else {
+      for (j=nXb; j<nXe; j++) Rnorms[j-nXb] = sqrt(Rnorms[j-nXb]);
+   }
+
+   primme->stats.timeResetUpdateVWXR += primme_wTimer(0) - t0;
+   primme->stats.estimateFlops += 2.0*FLOPS_SCALAR*mV*2*((nV-nZ)*nZ
+         + nV*max(0,nXe-nXb));
+   primme->stats.estimateBytes += (double)sizeof(SCALAR)*mV*2*(nV + nZ
+         + max(0,nXe-nXb));
+
+   return 0; 
+}
+
 /******************************************************************************
  * Function Num_reset_update_VWXR - This subroutine performs the next operations:
  *
@@ -916,6 +1290,7 @@ int Num_reset_update_VWXR_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT mV,
 
    int i, j;         /* Loop variables */
    REAL *tmp, *tmp0;
+   double t0;
 
    /* Return memory requirements */
    if (V == NULL) {
@@ -932,6 +1307,8 @@ int Num_reset_update_VWXR_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT mV,
       return 0;
    }
 
+   t0 = primme_wTimer(0);
+
    /* Quick exit */
    if (reset == 0) {
       CHKERR(Num_update_VWXR_Sprimme(
@@ -943,6 +1320,7 @@ int Num_reset_update_VWXR_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT mV,
                R, nRb, nRe, ldR, Rnorms,
                rnorms, nrb, nre,
                rwork, TO_INT(*lrwork), primme), -1);
+      primme->stats.timeResetUpdateVWXR += primme_wTimer(0) - t0;
       return 0;
    }
 
@@ -1029,6 +1407,8 @@ int Num_reset_update_VWXR_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT mV,
       if (rnorms) for (i=nrb; i<nre; i++) rnorms[i-nrb] = sqrt(rnorms[i-nrb]);
    }
 
+   primme->stats.timeResetUpdateVWXR += primme_wTimer(0) - t0;
+
    return 0; 
 }
 
@@ -1321,8 +1701,8 @@ static int restart_RR(SCALAR *H, int ldH, SCALAR *hVecs, int ldhVecs,
       CHKERR(compute_submatrix_Sprimme(NULL, numPrevRetained, 0, NULL,
                basisSize, 0, NULL, 0, NULL, rworkSize), -1);
       CHKERR(solve_H_Sprimme(NULL, numPrevRetained, 0, NULL, 0, NULL, 0,
-               NULL, 0, NULL, 0, NULL, NULL, numLocked, 0.0, rworkSize, NULL, 0,
-               iwork, primme), -1);
+               NULL, 0, NULL, 0, NULL, NULL, NULL, NULL, numLocked, 0.0,
+               rworkSize, NULL, 0, iwork, primme), -1);
       return 0;
    }
 
@@ -1406,8 +1786,8 @@ static int restart_RR(SCALAR *H, int ldH, SCALAR *hVecs, int ldhVecs,
             &H[ldH*indexOfPreviousVecs+indexOfPreviousVecs], numPrevRetained,
             ldH, NULL, 0, NULL, 0, NULL, 0,
             &hVecs[newldhVecs*orderedIndexOfPreviousVecs+indexOfPreviousVecs],
-            newldhVecs, &hVals[orderedIndexOfPreviousVecs], NULL, numLocked,
-            machEps, rworkSize, rwork, iworkSize, iwork, primme), -1);
+            newldhVecs, &hVals[orderedIndexOfPreviousVecs], NULL, NULL, NULL,
+            numLocked, machEps, rworkSize, rwork, iworkSize, iwork, primme), -1);
 
    return 0;
 }
@@ -1555,8 +1935,8 @@ static int restart_refined(SCALAR *V, PRIMME_INT ldV, SCALAR *W, PRIMME_INT ldW,
                NULL, 0, 0,
                NULL, 0, primme));
       CHKERR(solve_H_Sprimme(NULL, basisSize, 0, NULL, 0, NULL, 0, NULL, 0,
-               NULL, 0, NULL, NULL, numConverged, 0.0, rworkSize, NULL, 0,
-               iwork, primme), -1);
+               NULL, 0, NULL, NULL, NULL, NULL, numConverged, 0.0, rworkSize,
+               NULL, 0, iwork, primme), -1);
       return 0;
    }
 
@@ -1585,8 +1965,9 @@ static int restart_refined(SCALAR *V, PRIMME_INT ldV, SCALAR *W, PRIMME_INT ldW,
                restartSize, rwork, rworkSize, machEps, primme), -1);
 
       CHKERR(solve_H_Sprimme(H, restartSize, ldH, R, ldR, NULL, 0, hU,
-               newldhU, hVecs, newldhVecs, hVals, hSVals, numConverged, machEps,
-               rworkSize, rwork, iworkSize, iwork, primme), -1);
+               newldhU, hVecs, newldhVecs, hVals, hSVals, NULL, NULL,
+               numConverged, machEps, rworkSize, rwork, iworkSize, iwork,
+               primme), -1);
 
       *numArbitraryVecs = 0;
 
@@ -1755,9 +2136,9 @@ static int restart_refined(SCALAR *V, PRIMME_INT ldV, SCALAR *W, PRIMME_INT ldW,
    assert(*rworkSize >= (size_t)restartSize);
    rworkSize0 = *rworkSize - (size_t)restartSize;
    CHKERR(solve_H_Sprimme(H, restartSize, ldH, R, ldR, NULL, 0, hU, newldhU,
-         hVecs, newldhVecs, (REAL*)rwork+restartSize, hSVals, numConverged,
-         machEps, &rworkSize0, rwork+restartSize, iworkSize, iwork, primme),
-         -1);
+         hVecs, newldhVecs, (REAL*)rwork+restartSize, hSVals, NULL, NULL,
+         numConverged, machEps, &rworkSize0, rwork+restartSize, iworkSize,
+         iwork, primme), -1);
 
    permute_vecs_Rprimme(hVals, 1, restartSize, 1, hVecsPerm, (REAL*)rwork, iwork);
 
@@ -1941,8 +2322,8 @@ static int restart_harmonic(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
       CHKERR(update_projection_Sprimme(NULL, 0, NULL, 0, NULL, 0, nLocal,
                0, basisSize, NULL, rworkSize, 0/*unsymmetric*/, primme), -1);
       CHKERR(solve_H_Sprimme(NULL, basisSize, 0, NULL, 0, NULL, 0, NULL, 0,
-               NULL, 0, NULL, NULL, numConverged, 0.0, rworkSize, NULL, 0,
-               iwork, primme), -1);
+               NULL, 0, NULL, NULL, NULL, NULL, numConverged, 0.0, rworkSize,
+               NULL, 0, iwork, primme), -1);
       return 0;
    }
 
@@ -1979,8 +2360,9 @@ static int restart_harmonic(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
    /* ------------------------------- */
 
    CHKERR(solve_H_Sprimme(H, restartSize, ldH, R, ldR, QtV, ldQtV, hU,
-            newldhU, hVecs, newldhVecs, hVals, hSVals, numConverged, machEps,
-            rworkSize, rwork, iworkSize, iwork, primme), -1);
+            newldhU, hVecs, newldhVecs, hVals, hSVals, NULL, NULL,
+            numConverged, machEps, rworkSize, rwork, iworkSize, iwork, primme),
+            -1);
 
    *numArbitraryVecs = 0;
 
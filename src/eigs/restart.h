@@ -51,9 +51,9 @@ int restart_dprimme(double *V, double *W, int64_t nLocal, int basisSize,
        int ldQtV, double *hU, int ldhU, int newldhU, double *hVecs,
        int ldhVecs, int newldhVecs, int *restartSizeOutput,
        int *targetShiftIndex, int *numArbitraryVecs, double *hVecsRot,
-       int ldhVecsRot, int *restartsSinceReset, int *reset,
-       double machEps, double *rwork, size_t *rworkSize, int *iwork,
-       int iworkSize, primme_params *primme);
+       int ldhVecsRot, double *VRot, int ldVRot, int *nVRot,
+       int *restartsSinceReset, int *reset, double machEps, double *rwork,
+       size_t *rworkSize, int *iwork, int iworkSize, primme_params *primme);
 #if !defined(CHECK_TEMPLATE) && !defined(Num_reset_update_VWXR_Sprimme)
 #  define Num_reset_update_VWXR_Sprimme CONCAT(Num_reset_update_VWXR_,SCALAR_SUF)
 #endif
@@ -93,9 +93,9 @@ int restart_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_COMPLEX_DOUBLE *W, int64_t
        int ldQtV, PRIMME_COMPLEX_DOUBLE *hU, int ldhU, int newldhU, PRIMME_COMPLEX_DOUBLE *hVecs,
        int ldhVecs, int newldhVecs, int *restartSizeOutput,
        int *targetShiftIndex, int *numArbitraryVecs, PRIMME_COMPLEX_DOUBLE *hVecsRot,
-       int ldhVecsRot, int *restartsSinceReset, int *reset,
-       double machEps, PRIMME_COMPLEX_DOUBLE *rwork, size_t *rworkSize, int *iwork,
-       int iworkSize, primme_params *primme);
+       int ldhVecsRot, PRIMME_COMPLEX_DOUBLE *VRot, int ldVRot, int *nVRot,
+       int *restartsSinceReset, int *reset, double machEps, PRIMME_COMPLEX_DOUBLE *rwork,
+       size_t *rworkSize, int *iwork, int iworkSize, primme_params *primme);
 int Num_reset_update_VWXR_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_COMPLEX_DOUBLE *W, int64_t mV,
    int nV, int64_t ldV,
    PRIMME_COMPLEX_DOUBLE *h, int nh, int ldh, double *hVals,
@@ -123,9 +123,9 @@ int restart_sprimme(float *V, float *W, int64_t nLocal, int basisSize,
        int ldQtV, float *hU, int ldhU, int newldhU, float *hVecs,
        int ldhVecs, int newldhVecs, int *restartSizeOutput,
        int *targetShiftIndex, int *numArbitraryVecs, float *hVecsRot,
-       int ldhVecsRot, int *restartsSinceReset, int *reset,
-       double machEps, float *rwork, size_t *rworkSize, int *iwork,
-       int iworkSize, primme_params *primme);
+       int ldhVecsRot, float *VRot, int ldVRot, int *nVRot,
+       int *restartsSinceReset, int *reset, double machEps, float *rwork,
+       size_t *rworkSize, int *iwork, int iworkSize, primme_params *primme);
 int Num_reset_update_VWXR_sprimme(float *V, float *W, int64_t mV,
    int nV, int64_t ldV,
    float *h, int nh, int ldh, float *hVals,
@@ -153,9 +153,9 @@ int restart_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_COMPLEX_FLOAT *W, int64_t nL
        int ldQtV, PRIMME_COMPLEX_FLOAT *hU, int ldhU, int newldhU, PRIMME_COMPLEX_FLOAT *hVecs,
        int ldhVecs, int newldhVecs, int *restartSizeOutput,
        int *targetShiftIndex, int *numArbitraryVecs, PRIMME_COMPLEX_FLOAT *hVecsRot,
-       int ldhVecsRot, int *restartsSinceReset, int *reset,
-       double machEps, PRIMME_COMPLEX_FLOAT *rwork, size_t *rworkSize, int *iwork,
-       int iworkSize, primme_params *primme);
+       int ldhVecsRot, PRIMME_COMPLEX_FLOAT *VRot, int ldVRot, int *nVRot,
+       int *restartsSinceReset, int *reset, double machEps, PRIMME_COMPLEX_FLOAT *rwork,
+       size_t *rworkSize, int *iwork, int iworkSize, primme_params *primme);
 int Num_reset_update_VWXR_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_COMPLEX_FLOAT *W, int64_t mV,
    int nV, int64_t ldV,
    PRIMME_COMPLEX_FLOAT *h, int nh, int ldh, float *hVals,
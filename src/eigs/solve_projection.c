@@ -34,16 +34,56 @@
  ******************************************************************************/
 
 #include <math.h>
+#include <string.h>
 #include <assert.h>
 #include "const.h"
+#include "wtime.h"
 #include "numerical.h"
 #include "solve_projection.h"
 #include "ortho.h"
+#include "globalsum.h"
+
+/* Smallest basis and largest number of new columns for which the            */
+/* eigendecomposition of H is updated from the previous one instead of       */
+/* computed from scratch                                                     */
+
+#ifndef PRIMME_INCREMENTAL_RR_MIN
+#  define PRIMME_INCREMENTAL_RR_MIN 32
+#endif
+#ifndef PRIMME_INCREMENTAL_RR_MAXBLOCK
+#  define PRIMME_INCREMENTAL_RR_MAXBLOCK 2
+#endif
+
+/* Gap between eigenvalues, relative to the norm of H, below which the      */
+/* eigenvectors from different slices distributed among processes are       */
+/* reorthogonalized (see projectionParams.distMinSize)                       */
+
+#ifndef PRIMME_DIST_RR_REORTH_GAP
+#  define PRIMME_DIST_RR_REORTH_GAP 1e-2
+#endif
 
 static int solve_H_RR_Sprimme(SCALAR *H, int ldH, SCALAR *hVecs,
-   int ldhVecs, REAL *hVals, int basisSize, int numConverged, size_t *lrwork,
+   int ldhVecs, REAL *hVals, int basisSize, SCALAR *hCache, int *hCacheSize,
+   int numConverged, double machEps, int *numIncremental, size_t *lrwork,
    SCALAR *rwork, int liwork, int *iwork, primme_params *primme);
 
+static int solve_H_RR_incremental_Sprimme(SCALAR *H, int ldH, SCALAR *hCache,
+   int k0, SCALAR *hVecs, int ldhVecs, REAL *hVals, int basisSize,
+   double machEps, size_t *lrwork, SCALAR *rwork, int liwork, int *iwork,
+   primme_params *primme);
+
+static int solve_arrowhead_Sprimme(int n, REAL *d, SCALAR *g, REAL alpha,
+   double machEps, SCALAR *U, int ldU, REAL *vals, REAL *rwork, int *iwork);
+
+#ifndef NUM_ESSL
+static int solve_H_RR_dist_Sprimme(SCALAR *H, int ldH, SCALAR *hVecs,
+   int ldhVecs, REAL *hVals, int basisSize, double machEps, size_t *lrwork,
+   SCALAR *rwork, primme_params *primme);
+
+static int dist_RR_slice_Sprimme(int p, int n, REAL *hVals, REAL gapTol,
+   primme_params *primme);
+#endif
+
 static int solve_H_Harm_Sprimme(SCALAR *H, int ldH, SCALAR *QtV, int ldQtV,
    SCALAR *R, int ldR, SCALAR *hVecs, int ldhVecs, SCALAR *hU, int ldhU,
    REAL *hVals, int basisSize, int numConverged, double machEps,
@@ -82,6 +122,10 @@ static int solve_H_Ref_Sprimme(SCALAR *H, int ldH, SCALAR *hVecs,
  * ldhVecs        The leading dimension of hVecs
  * hVals          The Ritz values
  * hSVals         The singular values of R
+ * hCache         Copy of the last H and its eigendecomposition, used by RR to
+ *                update the eigenpairs when only columns were appended to H;
+ *                it has 2*ldH*ldH+ldH positions. It may be NULL
+ * hCacheSize     Dimension of the H in hCache; zero if hCache is empty
  * rwork          Workspace
  * iwork          Workspace in integers
  *
@@ -94,15 +138,19 @@ static int solve_H_Ref_Sprimme(SCALAR *H, int ldH, SCALAR *hVecs,
 TEMPLATE_PLEASE
 int solve_H_Sprimme(SCALAR *H, int basisSize, int ldH, SCALAR *R, int ldR,
    SCALAR *QtV, int ldQtV, SCALAR *hU, int ldhU, SCALAR *hVecs, int ldhVecs,
-   REAL *hVals, REAL *hSVals, int numConverged, double machEps, size_t *lrwork,
-   SCALAR *rwork, int liwork, int *iwork, primme_params *primme) {
+   REAL *hVals, REAL *hSVals, SCALAR *hCache, int *hCacheSize,
+   int numConverged, double machEps, size_t *lrwork, SCALAR *rwork,
+   int liwork, int *iwork, primme_params *primme) {
 
    int i;
+   int numIncremental = 0;  /* columns of H added by incremental RR */
+   double t0 = primme_wTimer(0);
 
    switch (primme->projectionParams.projection) {
    case primme_proj_RR:
       CHKERR(solve_H_RR_Sprimme(H, ldH, hVecs, ldhVecs, hVals, basisSize,
-               numConverged, lrwork, rwork, liwork, iwork, primme), -1);
+               hCache, hCacheSize, numConverged, machEps, &numIncremental,
+               lrwork, rwork, liwork, iwork, primme), -1);
       break;
 
    case primme_proj_harmonic:
@@ -139,6 +187,15 @@ int solve_H_Sprimme(SCALAR *H, int basisSize, int ldH, SCALAR *R, int ldR,
    primme->stats.estimateLargestSVal = max(fabs(primme->stats.estimateMinEVal),
                                            fabs(primme->stats.estimateMaxEVal));
 
+   /* Estimate the cost as a dense eigendecomposition of size basisSize, */
+   /* or as a product by the eigenvectors per column updated by RR       */
+
+   primme->stats.timeSolveH += primme_wTimer(0) - t0;
+   primme->stats.estimateFlops +=
+      (numIncremental > 0 ? 2.0*numIncremental : 9.0)
+      *FLOPS_SCALAR*basisSize*basisSize*basisSize;
+   primme->stats.estimateBytes += 2.0*sizeof(SCALAR)*basisSize*basisSize;
+
    return 0;
 }
 
@@ -146,6 +203,12 @@ int solve_H_Sprimme(SCALAR *H, int basisSize, int ldH, SCALAR *R, int ldR,
 /*******************************************************************************
  * Subroutine solve_H_RR - This procedure solves the eigenproblem for the
  *            matrix H.
+ *
+ *    If hCache holds the eigendecomposition of the leading submatrix of H
+ *    and only a few columns were appended since then, the decomposition is
+ *    updated with solve_H_RR_incremental. Otherwise, or if the update is not
+ *    accurate enough, it calls LAPACK's heev; or solve_H_RR_dist if there
+ *    are several processes and basisSize is large.
  *        
  * INPUT ARRAYS AND PARAMETERS
  * ---------------------------
@@ -153,6 +216,7 @@ int solve_H_Sprimme(SCALAR *H, int basisSize, int ldH, SCALAR *R, int ldR,
  * basisSize      The dimension of H, R, hU
  * ldH            The leading dimension of H
  * numConverged   Number of eigenvalues converged to determine ordering shift
+ * machEps        Machine precision
  * lrwork         Length of the work array rwork
  * primme         Structure containing various solver parameters
  * 
@@ -161,7 +225,10 @@ int solve_H_Sprimme(SCALAR *H, int basisSize, int ldH, SCALAR *R, int ldR,
  * hVecs          The eigenvectors of H or the right singular vectors
  * ldhVecs        The leading dimension of hVecs
  * hVals          The Ritz values
- * hSVals         The singular values of R
+ * hCache         Copy of the last H and its eigendecomposition, or NULL
+ * hCacheSize     Dimension of the H in hCache
+ * numIncremental Number of columns of H updated incrementally; only set if
+ *                hCache is not NULL
  * rwork          Workspace
  * iwork          Workspace in integers
  *
@@ -172,13 +239,15 @@ int solve_H_Sprimme(SCALAR *H, int basisSize, int ldH, SCALAR *R, int ldR,
  ******************************************************************************/
 
 static int solve_H_RR_Sprimme(SCALAR *H, int ldH, SCALAR *hVecs,
-   int ldhVecs, REAL *hVals, int basisSize, int numConverged, size_t *lrwork,
+   int ldhVecs, REAL *hVals, int basisSize, SCALAR *hCache, int *hCacheSize,
+   int numConverged, double machEps, int *numIncremental, size_t *lrwork,
    SCALAR *rwork, int liwork, int *iwork, primme_params *primme) {
 
    int i, j; /* Loop variables    */
    int info; /* dsyev error value */
    int index;
    int *permu, *permw;
+   int k0;   /* Dimension of the H in hCache, if it can be updated */
    double targetShift;
 
 #ifdef USE_COMPLEX
@@ -194,6 +263,15 @@ static int solve_H_RR_Sprimme(SCALAR *H, int ldH, SCALAR *hVecs,
 
    /* Return memory requirements */
    if (H == NULL) {
+      CHKERR(solve_H_RR_incremental_Sprimme(NULL, 0, NULL, 0, NULL, 0, NULL,
+               basisSize, 0.0, lrwork, NULL, 0, iwork, primme), -1);
+#ifndef NUM_ESSL
+      if (primme->numProcs > 1 && primme->projectionParams.distMinSize > 0
+            && basisSize >= primme->projectionParams.distMinSize) {
+         CHKERR(solve_H_RR_dist_Sprimme(NULL, 0, NULL, 0, NULL, basisSize,
+                  0.0, lrwork, NULL, primme), -1);
+      }
+#endif
 #ifdef NUM_ESSL
       *lrwork = max(*lrwork, (size_t)2*basisSize
                     + (size_t)basisSize*(basisSize + 1)/2);
@@ -219,79 +297,127 @@ static int solve_H_RR_Sprimme(SCALAR *H, int ldH, SCALAR *hVecs,
    permu  = iwork;
    permw = permu + basisSize;
 
-
    /* ------------------------------------------------------------------- */
-   /* Copy the upper triangular portion of H into hvecs.  We need to do   */
-   /* this since DSYEV overwrites the input matrix with the eigenvectors. */  
-   /* Note that H is maxBasisSize-by-maxBasisSize and the basisSize-by-   */
-   /* basisSize submatrix of H is copied into hvecs.                      */
+   /* Update the eigendecomposition in hCache if H only differs from the  */
+   /* cached matrix in a few new columns                                  */
    /* ------------------------------------------------------------------- */
 
-#ifdef NUM_ESSL
-   idx = 0;
+   k0 = hCache ? *hCacheSize : 0;
+   if (k0 <= 0 || basisSize < PRIMME_INCREMENTAL_RR_MIN || basisSize <= k0
+         || basisSize - k0 > PRIMME_INCREMENTAL_RR_MAXBLOCK) {
+      k0 = 0;
+   }
+   for (j=0; j < k0; j++) {
+      if (memcmp(&hCache[ldH*j], &H[ldH*j], sizeof(SCALAR)*(j+1)) != 0) {
+         k0 = 0;
+      }
+   }
+   if (k0 > 0 && solve_H_RR_incremental_Sprimme(H, ldH, hCache, k0, hVecs,
+            ldhVecs, hVals, basisSize, machEps, lrwork, rwork, liwork, iwork,
+            primme) == 0) {
+      *numIncremental = basisSize - k0;
+   }
+#ifndef NUM_ESSL
+   else if (primme->numProcs > 1 && primme->globalSumReal
+         && primme->projectionParams.distMinSize > 0
+         && basisSize >= primme->projectionParams.distMinSize
+         && (info = solve_H_RR_dist_Sprimme(H, ldH, hVecs, ldhVecs, hVals,
+               basisSize, machEps, lrwork, rwork, primme)) <= 0) {
+      CHKERR(info, -1);
+      k0 = 0;
+   }
+#endif
+   else {
+      /* ---------------------------------------------------------------- */
+      /* Copy the upper triangular portion of H into hvecs.  We need to   */
+      /* do this since DSYEV overwrites the input matrix with the         */
+      /* eigenvectors. Note that H is maxBasisSize-by-maxBasisSize and    */
+      /* the basisSize-by-basisSize submatrix of H is copied into hvecs.  */
+      /* ---------------------------------------------------------------- */
 
-   if (primme->target != primme_largest) { /* smallest or any of closest_XXX */
-      for (j=0; j < basisSize; j++) {
-         for (i=0; i <= j; i++) {
-            rwork[idx] = H[ldH*j+i];
-            idx++;
+#ifdef NUM_ESSL
+      idx = 0;
+
+      if (primme->target != primme_largest) { /* smallest or closest_XXX */
+         for (j=0; j < basisSize; j++) {
+            for (i=0; i <= j; i++) {
+               rwork[idx] = H[ldH*j+i];
+               idx++;
+            }
          }
       }
-   }
-   else { /* (primme->target == primme_largest)  */
-      for (j=0; j < basisSize; j++) {
-         for (i=0; i <= j; i++) {
-            rwork[idx] = -H[ldH*j+i];
-            idx++;
+      else { /* (primme->target == primme_largest)  */
+         for (j=0; j < basisSize; j++) {
+            for (i=0; i <= j; i++) {
+               rwork[idx] = -H[ldH*j+i];
+               idx++;
+            }
          }
       }
-   }
-   
-   apSize = basisSize*(basisSize + 1)/2;
-   assert(*lrwork >= (size_t)apSize);
-#  ifdef USE_COMPLEX
-   /* -------------------------------------------------------------------- */
-   /* Assign also 3N double work space after the 2N complex rwork finishes */
-   /* -------------------------------------------------------------------- */
-   doubleWork = (REAL *) (&rwork[apsize + 2*basisSize]);
 
-   CHKERR(Num_hpev_Sprimme(21, rwork, hVals, hVecs, ldhVecs, basisSize, 
-      &rwork[apSize], TO_INT(*lrwork)), -1);
+      apSize = basisSize*(basisSize + 1)/2;
+      assert(*lrwork >= (size_t)apSize);
+#  ifdef USE_COMPLEX
+      /* ------------------------------------------------------------- */
+      /* Assign also 3N double work space after the 2N complex rwork   */
+      /* finishes                                                      */
+      /* ------------------------------------------------------------- */
+      doubleWork = (REAL *) (&rwork[apsize + 2*basisSize]);
+
+      CHKERR(Num_hpev_Sprimme(21, rwork, hVals, hVecs, ldhVecs, basisSize, 
+         &rwork[apSize], TO_INT(*lrwork)), -1);
 #  else
-   CHKERR(Num_hpev_Sprimme(21, rwork, hVals, hVecs, ldhVecs, basisSize, 
-      &rwork[apSize], TO_INT(*lrwork-apSize)), -1);
+      CHKERR(Num_hpev_Sprimme(21, rwork, hVals, hVecs, ldhVecs, basisSize, 
+         &rwork[apSize], TO_INT(*lrwork-apSize)), -1);
 #  endif
 
 #else /* NUM_ESSL */
-   if (primme->target != primme_largest) {
-      for (j=0; j < basisSize; j++) {
-         for (i=0; i <= j; i++) { 
-            hVecs[ldhVecs*j+i] = H[ldH*j+i];
-         }
-      }      
-   }
-   else { /* (primme->target == primme_largest) */
-      for (j=0; j < basisSize; j++) {
-         for (i=0; i <= j; i++) { 
-            hVecs[ldhVecs*j+i] = -H[ldH*j+i];
+      if (primme->target != primme_largest) {
+         for (j=0; j < basisSize; j++) {
+            for (i=0; i <= j; i++) { 
+               hVecs[ldhVecs*j+i] = H[ldH*j+i];
+            }
+         }      
+      }
+      else { /* (primme->target == primme_largest) */
+         for (j=0; j < basisSize; j++) {
+            for (i=0; i <= j; i++) { 
+               hVecs[ldhVecs*j+i] = -H[ldH*j+i];
+            }
          }
       }
-   }
 
 #  ifdef USE_COMPLEX
-   /* -------------------------------------------------------------------- */
-   /* Assign also 3N double work space after the 2N complex rwork finishes */
-   /* -------------------------------------------------------------------- */
-   doubleWork = (REAL *) (rwork+ 2*basisSize);
-
-   CHKERR((Num_heev_Sprimme("V", "U", basisSize, hVecs, ldhVecs, hVals, rwork, 
-                2*basisSize, doubleWork, &info), info), -1);
+      /* ------------------------------------------------------------- */
+      /* Assign also 3N double work space after the 2N complex rwork   */
+      /* finishes                                                      */
+      /* ------------------------------------------------------------- */
+      doubleWork = (REAL *) (rwork+ 2*basisSize);
+
+      CHKERR((Num_heev_Sprimme("V", "U", basisSize, hVecs, ldhVecs, hVals,
+                   rwork, 2*basisSize, doubleWork, &info), info), -1);
 #  else
-   CHKERR((Num_heev_Sprimme("V", "U", basisSize, hVecs, ldhVecs, hVals, rwork, 
-                TO_INT(*lrwork), &info), info), -1);
+      CHKERR((Num_heev_Sprimme("V", "U", basisSize, hVecs, ldhVecs, hVals,
+                   rwork, TO_INT(*lrwork), &info), info), -1);
 #  endif
 #endif /* NUM_ESSL */
 
+      /* Refresh the cache with the whole H */
+      k0 = 0;
+   }
+
+   if (hCache) {
+      for (j=k0; j < basisSize; j++) {
+         memcpy(&hCache[ldH*j], &H[ldH*j], sizeof(SCALAR)*(j+1));
+      }
+      Num_copy_matrix_Sprimme(hVecs, basisSize, basisSize, ldhVecs,
+            &hCache[ldH*ldH], ldH);
+      for (j=0; j < basisSize; j++) {
+         ((REAL*)&hCache[2*ldH*ldH])[j] = hVals[j];
+      }
+      *hCacheSize = basisSize;
+   }
+
    /* ---------------------------------------------------------------------- */
    /* ORDER the eigenvalues and their eigenvectors according to the desired  */
    /* target:  smallest/Largest or interior closest abs/leq/geq to a shift   */
@@ -402,6 +528,654 @@ static int solve_H_RR_Sprimme(SCALAR *H, int ldH, SCALAR *hVecs,
    return 0;   
 }
 
+/*******************************************************************************
+ * Subroutine solve_H_RR_incremental - This procedure updates the
+ *    eigendecomposition of the leading k0-by-k0 submatrix of H, Y*D*Y', stored
+ *    in hCache, into the one of the basisSize-by-basisSize H. For every new
+ *    column [c; alpha] the bordered matrix is transformed as
+ *
+ *       [Y' 0] [Y*D*Y' c    ] [Y 0]   [D    Y'*c ]
+ *       [0  1] [c'     alpha] [0 1] = [c'*Y alpha],
+ *
+ *    which is an arrowhead matrix; then its eigenvectors U are computed with
+ *    solve_arrowhead and Y is updated as [Y 0; 0 1]*U. Every column costs a
+ *    product by Y instead of the dense eigendecomposition of the whole H.
+ *
+ *    NOTE: the eigenproblem solved is the one of -H if primme.target is
+ *    primme_largest, as solve_H_RR does, and hVals and hVecs are returned in
+ *    ascending order.
+ *
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * H              The matrix V'*A*V
+ * ldH            The leading dimension of H
+ * hCache         The eigenvectors in hCache[ldH*ldH] and eigenvalues in
+ *                hCache[2*ldH*ldH] of the leading k0-by-k0 submatrix of H
+ * k0             The dimension of the matrix in hCache
+ * basisSize      The dimension of H
+ * machEps        Machine precision
+ * lrwork         Length of the work array rwork
+ * liwork         Length of the work array iwork
+ * primme         Structure containing various solver parameters
+ * 
+ * OUTPUT ARRAYS
+ * -------------
+ * hVecs          The eigenvectors of H
+ * ldhVecs        The leading dimension of hVecs
+ * hVals          The eigenvalues of H
+ * rwork          Workspace
+ * iwork          Workspace in integers
+ *
+ * Return Value
+ * ------------
+ * int -  0 upon successful return
+ *        1 the update was not accurate enough; hVecs and hVals are not set
+ ******************************************************************************/
+
+static int solve_H_RR_incremental_Sprimme(SCALAR *H, int ldH, SCALAR *hCache,
+   int k0, SCALAR *hVecs, int ldhVecs, REAL *hVals, int basisSize,
+   double machEps, size_t *lrwork, SCALAR *rwork, int liwork, int *iwork,
+   primme_params *primme) {
+
+   int i, j;            /* Loop variables                             */
+   int ldY, ldYnew;     /* Leading dimensions of Y and Ynew           */
+   SCALAR *Y, *Ynew;    /* Current and updated eigenvectors           */
+   SCALAR *U;           /* Eigenvectors of the arrowhead matrix       */
+   SCALAR *g;           /* Y'*c                                       */
+   SCALAR *swap;        /* Auxiliary pointer to swap Y and Ynew       */
+   REAL *D, *vals;      /* Current and updated eigenvalues            */
+   REAL *arrWork;       /* Workspace for solve_arrowhead              */
+   REAL sign;           /* -1 if the eigenproblem of -H is solved     */
+
+   /* Return memory requirements */
+
+   if (H == NULL) {
+      *lrwork = max(*lrwork, (size_t)2*basisSize*basisSize + 12*basisSize);
+      *iwork = max(*iwork, 7*basisSize);
+      return 0;
+   }
+
+   /* Divide the rwork space */
+
+   assert(*lrwork >= (size_t)2*basisSize*basisSize + 12*basisSize
+         && liwork >= 7*basisSize);
+   U = rwork;
+   g = U + basisSize*basisSize;
+   Ynew = g + basisSize;
+   D = (REAL*)(Ynew + basisSize*basisSize);
+   vals = D + basisSize;
+   arrWork = vals + basisSize;
+
+   /* Alternate Y between hVecs and Ynew so that the last update is left */
+   /* in hVecs                                                           */
+
+   if ((basisSize - k0) % 2 == 0) {
+      Y = hVecs; ldY = ldhVecs;
+      ldYnew = basisSize;
+   }
+   else {
+      Y = Ynew; ldY = basisSize;
+      Ynew = hVecs; ldYnew = ldhVecs;
+   }
+   Num_copy_matrix_Sprimme(&hCache[ldH*ldH], k0, k0, ldH, Y, ldY);
+   for (i=0; i < k0; i++) {
+      D[i] = ((REAL*)&hCache[2*ldH*ldH])[i];
+   }
+   sign = primme->target == primme_largest ? -1.0 : 1.0;
+
+   for (j=k0; j < basisSize; j++) {
+
+      /* Compute g = Y'*c and the arrowhead eigendecomposition */
+
+      Num_gemv_Sprimme("C", j, j, sign, Y, ldY, &H[ldH*j], 1, 0.0, g, 1);
+      if (solve_arrowhead_Sprimme(j, D, g, sign*REAL_PART(H[ldH*j+j]),
+               machEps, U, j+1, vals, arrWork, iwork) != 0) {
+         return 1;
+      }
+
+      /* Ynew = [Y 0; 0 1]*U */
+
+      Num_gemm_Sprimme("N", "N", j, j+1, j, 1.0, Y, ldY, U, j+1, 0.0, Ynew,
+            ldYnew);
+      for (i=0; i <= j; i++) {
+         Ynew[ldYnew*i+j] = U[(j+1)*i+j];
+      }
+      for (i=0; i <= j; i++) {
+         D[i] = vals[i];
+      }
+
+      swap = Y; Y = Ynew; Ynew = swap;
+      i = ldY; ldY = ldYnew; ldYnew = i;
+   }
+
+   assert(Y == hVecs);
+   for (i=0; i < basisSize; i++) {
+      hVals[i] = D[i];
+   }
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Subroutine solve_arrowhead - This procedure computes the eigendecomposition
+ *    of the Hermitian arrowhead matrix
+ *
+ *       A = [diag(d) g    ]
+ *           [g'      alpha],
+ *
+ *    with d in ascending order. Writing g = P*z with P diagonal and unitary and
+ *    z real and nonnegative, the eigenvectors of A are diag(P,1) times the ones
+ *    of the real arrowhead matrix with z instead of g.
+ *
+ *    As in LAPACK's xLAED2, the entries of z smaller than 8*machEps*||A|| and
+ *    one of each pair of close entries in d are deflated, the latter by a Givens
+ *    rotation. The other eigenvalues are the roots of the secular equation
+ *
+ *       f(l) = l - alpha - sum_i z_i^2/(l - d_i) = 0,
+ *
+ *    which are found by bisection on the distance to the closest pole, so the
+ *    differences l - d_i are computed accurately. The eigenvectors are computed
+ *    with the vector z^ of Gu and Eisenstat, for which the roots are exact,
+ *    and that makes them numerically orthogonal. Finally the residual of every
+ *    eigenpair is checked against A.
+ *
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * n              The dimension of d and g
+ * d              The diagonal entries, in ascending order
+ * g              The last column of A, without alpha
+ * alpha          The last diagonal entry of A
+ * machEps        Machine precision
+ * ldU            The leading dimension of U
+ * rwork          Workspace of size 9*(n+1)
+ * iwork          Workspace in integers of size 7*(n+1)
+ * 
+ * OUTPUT ARRAYS
+ * -------------
+ * U              The eigenvectors of A
+ * vals           The eigenvalues of A in ascending order
+ *
+ * Return Value
+ * ------------
+ * int -  0 upon successful return
+ *        1 if the residual of some eigenpair is too large
+ ******************************************************************************/
+
+static int solve_arrowhead_Sprimme(int n, REAL *d, SCALAR *g, REAL alpha,
+   double machEps, SCALAR *U, int ldU, REAL *vals, REAL *rwork, int *iwork) {
+
+   int i, j, k, p;      /* Loop variables and indices                 */
+   int r;               /* Number of poles not deflated               */
+   int nrot;            /* Number of Givens rotations                 */
+   int it;              /* Bisection iteration                        */
+   int *defl;           /* Whether d_i is deflated                    */
+   int *nd;             /* Indices of the poles not deflated          */
+   int *org;            /* Closest pole to each root                  */
+   int *rotp, *roti;    /* Entries rotated by each Givens rotation    */
+   int *code, *perm;    /* Origin and sorting of the eigenpairs       */
+   REAL *z, *dw;        /* |g| and d after deflation                  */
+   REAL *dl, *zl, *zh;  /* Poles, z and z^ of the secular equation    */
+   REAL *tau;           /* Distance from each root to its closest pole */
+   REAL *rotc, *rots;   /* Cosine and sine of each Givens rotation    */
+   REAL *cval;          /* Eigenvalues before sorting                 */
+   REAL znorm, anorm, tol, c, s, t, lo, hi, mid, f, x, xnorm, res, lres;
+
+   /* Divide the workspaces */
+
+   z = rwork;
+   dw = z + n;
+   dl = dw + n;
+   zl = dl + n;
+   zh = zl + n;
+   rotc = zh + n;
+   rots = rotc + n;
+   tau = rots + n;
+   cval = tau + n + 1;
+   defl = iwork;
+   nd = defl + n;
+   rotp = nd + n;
+   roti = rotp + n;
+   org = roti + n;
+   code = org + n + 1;
+   perm = code + n + 1;
+
+   /* Compute z = |g|, ||A|| and the deflation tolerance */
+
+   znorm = 0.0;
+   anorm = fabs(alpha);
+   for (i=0; i < n; i++) {
+      z[i] = ABS(g[i]);
+      dw[i] = d[i];
+      znorm += z[i]*z[i];
+      anorm = max(anorm, fabs(d[i]));
+   }
+   znorm = sqrt(znorm);
+   anorm += znorm;
+   tol = 8.0*machEps*anorm;
+
+   /* ------------------------------------------------------------------- */
+   /* Deflate the small z_i, and the pole p if it is close to the next    */
+   /* pole i, after rotating z_p into z_i                                 */
+   /* ------------------------------------------------------------------- */
+
+   for (i=0, r=0, nrot=0, p=-1; i < n; i++) {
+      if (z[i] <= tol) {
+         defl[i] = 1;
+         continue;
+      }
+      defl[i] = 0;
+      if (p >= 0) {
+         t = sqrt(z[p]*z[p] + z[i]*z[i]);
+         c = z[i]/t;
+         s = z[p]/t;
+         if (fabs((dw[i] - dw[p])*c*s) <= tol) {
+            rotp[nrot] = p;
+            roti[nrot] = i;
+            rotc[nrot] = c;
+            rots[nrot] = s;
+            nrot++;
+            z[p] = 0.0;
+            z[i] = t;
+            t = dw[p]*c*c + dw[i]*s*s;
+            dw[i] = dw[p]*s*s + dw[i]*c*c;
+            dw[p] = t;
+            defl[p] = 1;
+            r--;
+         }
+      }
+      nd[r] = i;
+      dl[r] = dw[i];
+      zl[r] = z[i];
+      r++;
+      p = i;
+   }
+
+   /* ------------------------------------------------------------------- */
+   /* Find the root j of the secular equation, l_j = dl[org[j]] + tau[j], */
+   /* where dl[j-1] < l_j < dl[j]                                         */
+   /* ------------------------------------------------------------------- */
+
+   for (j=0; j <= r; j++) {
+      if (r == 0) {
+         org[j] = -1;
+         tau[j] = alpha;
+         continue;
+      }
+
+      /* Choose the closest pole and the interval of tau */
+
+      if (j == 0) {
+         org[j] = 0;
+         lo = min(dl[0], alpha) - znorm - dl[0];
+         hi = 0.0;
+      }
+      else if (j == r) {
+         org[j] = r-1;
+         lo = 0.0;
+         hi = max(dl[r-1], alpha) + znorm - dl[r-1];
+      }
+      else {
+         mid = (dl[j] - dl[j-1])/2.0;
+         for (k=0, f=dl[j-1] + mid - alpha; k < r; k++) {
+            f -= zl[k]*zl[k]/((dl[j-1] - dl[k]) + mid);
+         }
+         if (f > 0.0) {
+            org[j] = j-1;
+            lo = 0.0;
+            hi = mid;
+         }
+         else {
+            org[j] = j;
+            lo = -mid;
+            hi = 0.0;
+         }
+      }
+
+      /* Bisect until tau is accurate relative to its own magnitude */
+
+      p = org[j];
+      for (it=0; it < 300; it++) {
+         mid = (lo + hi)/2.0;
+         if (mid <= lo || mid >= hi
+               || hi - lo <= machEps*min(fabs(lo), fabs(hi))) break;
+         for (k=0, f=dl[p] + mid - alpha; k < r; k++) {
+            f -= zl[k]*zl[k]/((dl[p] - dl[k]) + mid);
+         }
+         if (f > 0.0) hi = mid;
+         else lo = mid;
+      }
+      tau[j] = (lo + hi)/2.0;
+   }
+
+   /* ------------------------------------------------------------------- */
+   /* Compute z^ from the roots:                                          */
+   /*   z^_k^2 = -(l_k-d_k)*(l_{k+1}-d_k) * prod_{i<k} (l_i-d_k)/(d_i-d_k) */
+   /*            * prod_{i>k} (l_{i+1}-d_k)/(d_i-d_k)                     */
+   /* ------------------------------------------------------------------- */
+
+#define ROOT_MINUS_POLE(J, K) ((dl[org[J]] - dl[K]) + tau[J])
+
+   for (k=0; k < r; k++) {
+      t = -ROOT_MINUS_POLE(k, k)*ROOT_MINUS_POLE(k+1, k);
+      for (i=0; i < k; i++) {
+         t *= ROOT_MINUS_POLE(i, k)/(dl[i] - dl[k]);
+      }
+      for (i=k+1; i < r; i++) {
+         t *= ROOT_MINUS_POLE(i+1, k)/(dl[i] - dl[k]);
+      }
+      zh[k] = sqrt(max(t, 0.0));
+   }
+
+   /* ------------------------------------------------------------------- */
+   /* Sort the eigenvalues: code >= 0 are the roots of the secular        */
+   /* equation and code < 0 are the deflated poles -code-1                */
+   /* ------------------------------------------------------------------- */
+
+   for (j=0; j <= r; j++) {
+      code[j] = j;
+      cval[j] = r > 0 ? dl[org[j]] + tau[j] : tau[j];
+   }
+   for (i=0; i < n; i++) {
+      if (defl[i]) {
+         code[j] = -i-1;
+         cval[j++] = dw[i];
+      }
+   }
+   for (j=0; j <= n; j++) {
+      for (i=j; i > 0 && cval[perm[i-1]] > cval[j]; i--) {
+         perm[i] = perm[i-1];
+      }
+      perm[i] = j;
+   }
+
+   /* ------------------------------------------------------------------- */
+   /* Compute the eigenvectors: the vector of the root l_j is             */
+   /* [z^./(l_j-d); 1], normalized; and check the residual                */
+   /*    ||A*x - l_j*x||^2 = ||z - z^||^2 + (z'*x + alpha - l_j)^2        */
+   /* ------------------------------------------------------------------- */
+
+   for (k=0, lres=0.0; k < r; k++) {
+      lres += (zl[k] - zh[k])*(zl[k] - zh[k]);
+   }
+
+   for (j=0; j <= n; j++) {
+      vals[j] = cval[perm[j]];
+      Num_zero_matrix_Sprimme(&U[ldU*j], n+1, 1, ldU);
+      if (code[perm[j]] < 0) {
+         U[ldU*j - code[perm[j]] - 1] = 1.0;
+         continue;
+      }
+      p = code[perm[j]];
+      for (k=0, xnorm=1.0, res=alpha - vals[j]; k < r; k++) {
+         x = zh[k]/ROOT_MINUS_POLE(p, k);
+         U[ldU*j+nd[k]] = x;
+         xnorm += x*x;
+         res += zl[k]*x;
+      }
+      U[ldU*j+n] = 1.0;
+      xnorm = sqrt(xnorm);
+      if (sqrt(lres + res*res)/xnorm > 10.0*(n+1)*machEps*anorm) {
+         return 1;
+      }
+      for (k=0; k < r; k++) {
+         U[ldU*j+nd[k]] /= xnorm;
+      }
+      U[ldU*j+n] /= xnorm;
+   }
+
+#undef ROOT_MINUS_POLE
+
+   /* Undo the Givens rotations in reverse order */
+
+   for (k=nrot-1; k >= 0; k--) {
+      p = rotp[k];
+      i = roti[k];
+      c = rotc[k];
+      s = rots[k];
+      for (j=0; j <= n; j++) {
+         SCALAR up = U[ldU*j+p], ui = U[ldU*j+i];
+         U[ldU*j+p] = c*up + s*ui;
+         U[ldU*j+i] = -s*up + c*ui;
+      }
+   }
+
+   /* Apply diag(P,1) */
+
+   for (i=0; i < n; i++) {
+      if (ABS(g[i]) > 0.0) {
+         Num_scal_Sprimme(n+1, g[i]/ABS(g[i]), &U[i], ldU);
+      }
+   }
+
+   return 0;
+}
+
+#ifndef NUM_ESSL
+
+/*******************************************************************************
+ * Subroutine solve_H_RR_dist - This procedure computes the eigendecomposition
+ *    of H, or -H if primme.target is primme_largest, splitting the work on the
+ *    eigenvectors among the processes.
+ *
+ *    Every process reduces H to tridiagonal form, H = Q*T*Q', takes T from
+ *    process 0, and computes all eigenvalues of T. The eigenpairs are split
+ *    in contiguous slices, one per process, whose boundaries are moved
+ *    forward so that no cluster of eigenvalues closer than sqrt(machEps)*|H|
+ *    is split. Every process computes the eigenvectors of T in its slice with
+ *    xSTEMR and applies Q to them. The slices are gathered with a globalSum
+ *    per nonempty slice.
+ *
+ *    Eigenvectors computed by different processes are only orthogonal up to
+ *    O(machEps*|H|/gap), so the ones with eigenvalues closer than
+ *    PRIMME_DIST_RR_REORTH_GAP*|H| to the other side of a boundary are
+ *    orthogonalized against the ones on the left side.
+ *
+ *    The workspace is proportional to the size of the slices, basisSize times
+ *    1.5*basisSize/numProcs. If a slice is larger than that, because H has
+ *    large clusters, nothing is computed and the function returns 1.
+ *
+ *    NOTE: H may differ among processes by rounding errors, for instance
+ *    after a restart. Sharing T makes all processes agree on the eigenvalues
+ *    and the slices; the rest is only perturbed by O(machEps*|H|).
+ *
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * H              The matrix V'*A*V
+ * ldH            The leading dimension of H
+ * basisSize      The dimension of H
+ * machEps        Machine precision
+ * lrwork         Length of the work array rwork
+ * primme         Structure containing various solver parameters
+ * 
+ * OUTPUT ARRAYS
+ * -------------
+ * hVecs          The eigenvectors of H
+ * ldhVecs        The leading dimension of hVecs
+ * hVals          The eigenvalues of H in ascending order
+ * rwork          Workspace
+ *
+ * Return Value
+ * ------------
+ * int -  0 upon successful return
+ *     -  1 if the slices are too large; then H should be solved by heev
+ *     - -1 a LAPACK function or globalSum was unsuccessful
+ ******************************************************************************/
+
+static int solve_H_RR_dist_Sprimme(SCALAR *H, int ldH, SCALAR *hVecs,
+   int ldhVecs, REAL *hVals, int basisSize, double machEps, size_t *lrwork,
+   SCALAR *rwork, primme_params *primme) {
+
+   int i, j, k, p;      /* Loop variables                              */
+   int n = basisSize;   /* Dimension of H                              */
+   int maxSlice;        /* Largest number of eigenpairs in a slice     */
+   int il, iu;          /* Local eigenpairs are il, il+1, ..., iu-1    */
+   int lo, hi;          /* Eigenpairs around a boundary b, lo <= b < hi */
+   int m;               /* Number of eigenpairs returned by xSTEMR     */
+   int info;            /* LAPACK error value                          */
+   int lwork;           /* Length of work                              */
+   size_t n2;           /* Size of a slice of eigenvectors             */
+   SCALAR *tau;         /* Householder factors of Q                    */
+   SCALAR *Z;           /* Local eigenvectors                          */
+   SCALAR *zero, *recv; /* Zeros and gathered eigenvectors of a slice  */
+   SCALAR *work;        /* Workspace for xHETRD and xUNMTR             */
+   REAL *d, *e;         /* Diagonal and off-diagonal of T              */
+   REAL *d0, *e0;       /* Copies of d and e overwritten by xSTEMR     */
+   REAL *w;             /* Local eigenvalues                           */
+   REAL *rwork0;        /* Workspace for xSTEMR                        */
+   REAL normH;          /* Largest eigenvalue in absolute value        */
+   REAL gapTol;         /* Smallest gap between slices                 */
+   REAL reorthTol;      /* Largest gap between reorthogonalized pairs  */
+
+   k = (n + primme->numProcs - 1)/primme->numProcs;
+   maxSlice = min(n, k + (k+1)/2);
+   n2 = (size_t)n*maxSlice;
+
+   /* Return memory requirements */
+
+   if (H == NULL) {
+      SCALAR work0, work1;
+      CHKERR((Num_hetrd_Sprimme("U", n, NULL, n, NULL, NULL, NULL, &work0, -1,
+                  &info), info), -1);
+      CHKERR((Num_unmtr_Sprimme("L", "U", "N", n, maxSlice, NULL, n, NULL,
+                  NULL, n, &work1, -1, &info), info), -1);
+      *lrwork = max(*lrwork, (size_t)24*n + 3*n2
+            + max((size_t)REAL_PART(work0), (size_t)REAL_PART(work1)));
+      return 0;
+   }
+
+   /* Divide the rwork space */
+
+   tau = rwork;
+   d = (REAL*)(tau + n);
+   e = d + n;
+   d0 = e + n;
+   e0 = d0 + n;
+   w = e0 + n;
+   rwork0 = w + n;
+   Z = tau + (size_t)24*n;
+   zero = Z + n2;
+   recv = zero + n2;
+   work = recv + n2;
+   assert(*lrwork >= (size_t)24*n + 3*n2);
+   lwork = TO_INT(*lrwork - (size_t)24*n - 3*n2);
+
+   /* Copy the upper triangular part of H into hVecs, which xHETRD */
+   /* overwrites with T and the Householder reflectors of Q        */
+
+   for (j=0; j < n; j++) {
+      for (i=0; i <= j; i++) { 
+         hVecs[ldhVecs*j+i] = primme->target != primme_largest ?
+            H[ldH*j+i] : -H[ldH*j+i];
+      }
+   }
+   CHKERR((Num_hetrd_Sprimme("U", n, hVecs, ldhVecs, d, e, tau, work, lwork,
+               &info), info), -1);
+   e[n-1] = 0.0;
+
+   /* Take T from process 0, so that all processes have the same slices */
+
+   for (i=0; i < n; i++) {
+      d0[i] = primme->procID == 0 ? d[i] : 0.0;
+      e0[i] = primme->procID == 0 ? e[i] : 0.0;
+   }
+   CHKERR(globalSum_Rprimme(d0, d, 2*n, primme), -1);
+
+   /* Compute all eigenvalues of T */
+
+   for (i=0; i < n; i++) {
+      d0[i] = d[i];
+      e0[i] = e[i];
+   }
+   CHKERR((Num_stemr_Sprimme("N", "A", n, d0, e0, 0, 0, &m, hVals, NULL, 1,
+               rwork0, 18*n, &info), info), -1);
+   assert(m == n);
+
+   normH = max(fabs(hVals[0]), fabs(hVals[n-1]));
+   gapTol = sqrt(machEps)*normH;
+   reorthTol = PRIMME_DIST_RR_REORTH_GAP*normH;
+
+   /* Give up if a cluster makes a slice larger than the workspace */
+
+   for (p=0, il=0; p < primme->numProcs; p++, il=iu) {
+      iu = dist_RR_slice_Sprimme(p+1, n, hVals, gapTol, primme);
+      if (iu - il > maxSlice) return 1;
+   }
+
+   /* Compute the eigenvectors of T in the local slice and apply Q */
+
+   il = dist_RR_slice_Sprimme(primme->procID, n, hVals, gapTol, primme);
+   iu = dist_RR_slice_Sprimme(primme->procID+1, n, hVals, gapTol, primme);
+   if (il < iu) {
+      for (i=0; i < n; i++) {
+         d0[i] = d[i];
+         e0[i] = e[i];
+      }
+      CHKERR((Num_stemr_Sprimme("V", "I", n, d0, e0, il+1, iu, &m, w, Z, n,
+                  rwork0, 18*n, &info), info), -1);
+      assert(m == iu - il);
+      CHKERR((Num_unmtr_Sprimme("L", "U", "N", n, m, hVecs, ldhVecs, tau, Z, n,
+                  work, lwork, &info), info), -1);
+   }
+
+   /* Gather the slices, every one from the process that computed it */
+
+   Num_zero_matrix_Sprimme(zero, n, maxSlice, n);
+   for (p=0, il=0; p < primme->numProcs; p++, il=iu) {
+      iu = dist_RR_slice_Sprimme(p+1, n, hVals, gapTol, primme);
+      if (il == iu) continue;
+      CHKERR(globalSum_Sprimme(p == primme->procID ? Z : zero, recv,
+               n*(iu-il), primme), -1);
+      Num_copy_matrix_Sprimme(recv, n, iu-il, n, &hVecs[ldhVecs*il], ldhVecs);
+   }
+
+   /* Orthogonalize the eigenvectors right after every boundary b against */
+   /* the ones before b, twice, if their eigenvalues are close            */
+
+   for (p=1, il=0; p < primme->numProcs; p++) {
+      int b = dist_RR_slice_Sprimme(p, n, hVals, gapTol, primme);
+      if (b == il || b == n) continue;
+      il = b;
+      for (lo=b; lo > 0 && hVals[b] - hVals[lo-1] < reorthTol; lo--);
+      for (hi=b; hi < n && hVals[hi] - hVals[b-1] < reorthTol; hi++);
+      if (lo == b || hi == b) continue;
+
+      for (j=b; j < hi; j+=maxSlice) {
+         m = min(maxSlice, hi-j);
+         for (k=0; k < 2; k++) {
+            Num_gemm_Sprimme("C", "N", b-lo, m, n, 1.0, &hVecs[ldhVecs*lo],
+                  ldhVecs, &hVecs[ldhVecs*j], ldhVecs, 0.0, Z, b-lo);
+            Num_gemm_Sprimme("N", "N", n, m, b-lo, -1.0, &hVecs[ldhVecs*lo],
+                  ldhVecs, Z, b-lo, 1.0, &hVecs[ldhVecs*j], ldhVecs);
+         }
+      }
+      for (j=b; j < hi; j++) {
+         Num_scal_Sprimme(n, 1.0/sqrt(REAL_PART(Num_dot_Sprimme(n,
+                        &hVecs[ldhVecs*j], 1, &hVecs[ldhVecs*j], 1))),
+               &hVecs[ldhVecs*j], 1);
+      }
+   }
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Function dist_RR_slice - Return the first eigenpair in the slice of process
+ *    p in solve_H_RR_dist: the one in an even split of the n eigenpairs,
+ *    moved forward while it is closer than gapTol to the previous one.
+ *    Returns n if p is numProcs.
+ ******************************************************************************/
+
+static int dist_RR_slice_Sprimme(int p, int n, REAL *hVals, REAL gapTol,
+   primme_params *primme) {
+
+   int i = (int)((size_t)n*p/primme->numProcs);
+
+   while (i > 0 && i < n && hVals[i] - hVals[i-1] <= gapTol) i++;
+   return i;
+}
+
+#endif /* NUM_ESSL */
+
 /*******************************************************************************
  * Subroutine solve_H_Harm - This procedure implements the harmonic extraction
  *    in a novelty way. In standard harmonic the next eigenproblem is solved:
@@ -461,7 +1235,7 @@ static int solve_H_Harm_Sprimme(SCALAR *H, int ldH, SCALAR *QtV, int ldQtV,
    /* Return memory requirements */
    if (QtV == NULL) {
       CHKERR(solve_H_RR_Sprimme(QtV, ldQtV, hVecs, ldhVecs, hVals, basisSize,
-         0, lrwork, rwork, liwork, iwork, primme), -1);
+         NULL, NULL, 0, 0.0, NULL, lrwork, rwork, liwork, iwork, primme), -1);
       return 0;
    }
 
@@ -490,7 +1264,8 @@ static int solve_H_Harm_Sprimme(SCALAR *H, int ldH, SCALAR *QtV, int ldQtV,
          assert(0);
    }
    ret = solve_H_RR_Sprimme(hVecs, ldhVecs, hVecs, ldhVecs, hVals,
-         basisSize, 0, lrwork, rwork, liwork, iwork, primme);
+         basisSize, NULL, NULL, 0, 0.0, NULL, lrwork, rwork, liwork, iwork,
+         primme);
    primme->targetShifts = oldTargetShifts;
    primme->target = oldTarget;
    CHKERRM(ret, -1, "Error calling solve_H_RR_Sprimme\n");
@@ -730,8 +1505,8 @@ int prepare_vecs_Sprimme(int basisSize, int i0, int blockSize,
       size_t rworkSize0=0;
       CHKERR(compute_submatrix_Sprimme(NULL, basisSize, 0, NULL,
                basisSize, 0, NULL, 0, NULL, &rworkSize0), -1);
-      CHKERR(solve_H_RR_Sprimme(NULL, 0, NULL, 0, NULL, basisSize, 0,
-            &rworkSize0, NULL, 0, iwork, primme), -1);
+      CHKERR(solve_H_RR_Sprimme(NULL, 0, NULL, 0, NULL, basisSize, NULL,
+            NULL, 0, 0.0, NULL, &rworkSize0, NULL, 0, iwork, primme), -1);
       rworkSize0 += (size_t)basisSize*(size_t)basisSize; /* aH */
       *rworkSize = max(*rworkSize, rworkSize0);
       return 0;
@@ -752,7 +1527,8 @@ int prepare_vecs_Sprimme(int basisSize, int i0, int blockSize,
 
       /* Compute and sort eigendecomposition aH*ahVecs = ahVecs*diag(hVals(j:i-1)) */
       CHKERR(solve_H_RR_Sprimme(H, ldH, hVecs, ldhVecs, hVals, basisSize,
-            targetShiftIndex, rworkSize, rwork, iworkSize, iwork, primme), -1);
+            NULL, NULL, targetShiftIndex, 0.0, NULL, rworkSize, rwork,
+            iworkSize, iwork, primme), -1);
 
       *arbitraryVecs = 0;
 
@@ -842,8 +1618,8 @@ int prepare_vecs_Sprimme(int basisSize, int i0, int blockSize,
 
          /* Compute and sort eigendecomposition aH*ahVecs = ahVecs*diag(hVals(j:i-1)) */
          CHKERR(solve_H_RR_Sprimme(aH, aBasisSize, ahVecs, ldhVecsRot,
-               &hVals[j], aBasisSize, targetShiftIndex, &rworkSize0, rwork0,
-               iworkSize, iwork, primme), -1);
+               &hVals[j], aBasisSize, NULL, NULL, targetShiftIndex, 0.0,
+               NULL, &rworkSize0, rwork0, iworkSize, iwork, primme), -1);
 
          /* hVecs(:,j:i-1) = hVecs(:,j:i-1)*ahVecs */
          Num_gemm_Sprimme("N", "N", basisSize, aBasisSize, aBasisSize,
@@ -41,8 +41,9 @@
 #endif
 int solve_H_dprimme(double *H, int basisSize, int ldH, double *R, int ldR,
    double *QtV, int ldQtV, double *hU, int ldhU, double *hVecs, int ldhVecs,
-   double *hVals, double *hSVals, int numConverged, double machEps, size_t *lrwork,
-   double *rwork, int liwork, int *iwork, primme_params *primme);
+   double *hVals, double *hSVals, double *hCache, int *hCacheSize,
+   int numConverged, double machEps, size_t *lrwork, double *rwork,
+   int liwork, int *iwork, primme_params *primme);
 #if !defined(CHECK_TEMPLATE) && !defined(prepare_vecs_Sprimme)
 #  define prepare_vecs_Sprimme CONCAT(prepare_vecs_,SCALAR_SUF)
 #endif
@@ -57,8 +58,9 @@ int prepare_vecs_dprimme(int basisSize, int i0, int blockSize,
       int iworkSize, int *iwork, primme_params *primme);
 int solve_H_zprimme(PRIMME_COMPLEX_DOUBLE *H, int basisSize, int ldH, PRIMME_COMPLEX_DOUBLE *R, int ldR,
    PRIMME_COMPLEX_DOUBLE *QtV, int ldQtV, PRIMME_COMPLEX_DOUBLE *hU, int ldhU, PRIMME_COMPLEX_DOUBLE *hVecs, int ldhVecs,
-   double *hVals, double *hSVals, int numConverged, double machEps, size_t *lrwork,
-   PRIMME_COMPLEX_DOUBLE *rwork, int liwork, int *iwork, primme_params *primme);
+   double *hVals, double *hSVals, PRIMME_COMPLEX_DOUBLE *hCache, int *hCacheSize,
+   int numConverged, double machEps, size_t *lrwork, PRIMME_COMPLEX_DOUBLE *rwork,
+   int liwork, int *iwork, primme_params *primme);
 int prepare_vecs_zprimme(int basisSize, int i0, int blockSize,
       PRIMME_COMPLEX_DOUBLE *H, int ldH, double *hVals, double *hSVals, PRIMME_COMPLEX_DOUBLE *hVecs,
       int ldhVecs, int targetShiftIndex, int *arbitraryVecs,
@@ -67,8 +69,9 @@ int prepare_vecs_zprimme(int basisSize, int i0, int blockSize,
       int iworkSize, int *iwork, primme_params *primme);
 int solve_H_sprimme(float *H, int basisSize, int ldH, float *R, int ldR,
    float *QtV, int ldQtV, float *hU, int ldhU, float *hVecs, int ldhVecs,
-   float *hVals, float *hSVals, int numConverged, double machEps, size_t *lrwork,
-   float *rwork, int liwork, int *iwork, primme_params *primme);
+   float *hVals, float *hSVals, float *hCache, int *hCacheSize,
+   int numConverged, double machEps, size_t *lrwork, float *rwork,
+   int liwork, int *iwork, primme_params *primme);
 int prepare_vecs_sprimme(int basisSize, int i0, int blockSize,
       float *H, int ldH, float *hVals, float *hSVals, float *hVecs,
       int ldhVecs, int targetShiftIndex, int *arbitraryVecs,
@@ -77,8 +80,9 @@ int prepare_vecs_sprimme(int basisSize, int i0, int blockSize,
       int iworkSize, int *iwork, primme_params *primme);
 int solve_H_cprimme(PRIMME_COMPLEX_FLOAT *H, int basisSize, int ldH, PRIMME_COMPLEX_FLOAT *R, int ldR,
    PRIMME_COMPLEX_FLOAT *QtV, int ldQtV, PRIMME_COMPLEX_FLOAT *hU, int ldhU, PRIMME_COMPLEX_FLOAT *hVecs, int ldhVecs,
-   float *hVals, float *hSVals, int numConverged, double machEps, size_t *lrwork,
-   PRIMME_COMPLEX_FLOAT *rwork, int liwork, int *iwork, primme_params *primme);
+   float *hVals, float *hSVals, PRIMME_COMPLEX_FLOAT *hCache, int *hCacheSize,
+   int numConverged, double machEps, size_t *lrwork, PRIMME_COMPLEX_FLOAT *rwork,
+   int liwork, int *iwork, primme_params *primme);
 int prepare_vecs_cprimme(int basisSize, int i0, int blockSize,
       PRIMME_COMPLEX_FLOAT *H, int ldH, float *hVals, float *hSVals, PRIMME_COMPLEX_FLOAT *hVecs,
       int ldhVecs, int targetShiftIndex, int *arbitraryVecs,
@@ -0,0 +1,261 @@
+/*******************************************************************************
+ * Copyright (c) 2016, College of William & Mary
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the College of William & Mary nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COLLEGE OF WILLIAM & MARY BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * PRIMME: https://github.com/primme/primme
+ * Contact: Andreas Stathopoulos, a n d r e a s _at_ c s . w m . e d u
+ *******************************************************************************
+ * File: trace.c
+ *
+ * Purpose - Record the begin and the end of the solver phases (matvec,
+ *           precond, ortho, globalSum, restart, lock and inner-solve) and
+ *           write them into primme.traceFile in the Chrome trace event
+ *           format, which can be loaded in chrome://tracing or Perfetto.
+ *
+ *           Every phase is written as a complete event ("ph":"X") with its
+ *           begin time and duration, so a phase left open by an error path
+ *           is closed when an enclosing phase ends or when the solver
+ *           returns, and the trace never has unmatched events.
+ *
+ *           The events are stored in a buffer of PRIMME_TRACE_BUFFER_SIZE
+ *           entries and they are written all together at the end of the
+ *           solver, or when the buffer is full; in that case the event that
+ *           fills it writes the buffer synchronously. The array of events is
+ *           opened by the first call to the solver and closed by primme_free;
+ *           the times are relative to the opening, so the events of several
+ *           calls are in the same timeline.
+ *
+ ******************************************************************************/
+
+#include <stdlib.h>   /* mallocs, free */
+#include <stdio.h>
+#include <string.h>   /* strcmp */
+#include "template.h"
+#include "wtime.h"
+#include "trace.h"
+
+/* Only define these functions ones */
+#ifdef USE_DOUBLE
+#include "notemplate.h"
+
+typedef struct {
+   const char *name;    /* name of the phase, a static string */
+   double time;         /* seconds since the array was opened */
+   double duration;     /* seconds the phase took             */
+} primme_trace_event_t;
+
+typedef struct {
+   FILE *file;                             /* file where the array was opened */
+   double origin;                          /* wall-clock time of the opening  */
+   int numWritten;                         /* events written into file        */
+   int n;                                  /* number of events recorded       */
+   primme_trace_event_t events[PRIMME_TRACE_BUFFER_SIZE];
+   int depth;                              /* number of phases begun          */
+   primme_trace_event_t open[PRIMME_TRACE_MAX_DEPTH];
+} primme_trace_buffer;
+
+static void close_phases(primme_trace_buffer *buffer, int depth, double time,
+      primme_params *primme);
+static void close_array(primme_trace_buffer *buffer);
+
+/*******************************************************************************
+ * Function primme_trace_init - Allocate the event buffer if primme.traceFile
+ *    is set and write the opening bracket of the array of events. If the
+ *    buffer is kept from a previous call with the same file, the events are
+ *    appended to the same array.
+ *
+ * RETURN VALUE
+ * ------------
+ * error code
+ ******************************************************************************/
+
+int primme_trace_init(primme_params *primme) {
+
+   primme_trace_buffer *buffer = (primme_trace_buffer*)primme->traceBuffer;
+
+   /* Close the array of a previous call if the file has changed */
+
+   if (buffer && buffer->file != primme->traceFile) {
+      primme_trace_free(primme);
+      buffer = NULL;
+   }
+
+   if (primme->traceFile == NULL) return 0;
+
+   if (buffer == NULL) {
+      CHKERR(MALLOC_PRIMME(1, &buffer), -1);
+      primme->traceBuffer = buffer;
+      buffer->file = primme->traceFile;
+      buffer->origin = primme_get_wtime();
+      buffer->numWritten = 0;
+      fprintf(buffer->file, "[\n");
+   }
+   buffer->n = 0;
+   buffer->depth = 0;
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Subroutine primme_trace_event - Record that the phase with the given name
+ *    begins ('B') or ends ('E') now. Use macros TRACE_BEGIN and TRACE_END
+ *    instead, which skip the call if tracing is not active.
+ *
+ *    The end of a phase also ends the phases begun after it that were not
+ *    ended, which happens if an error is returned inside them.
+ ******************************************************************************/
+
+void primme_trace_event(const char *name, char phase, primme_params *primme) {
+
+   primme_trace_buffer *buffer = (primme_trace_buffer*)primme->traceBuffer;
+   int i;
+
+   if (phase == 'B') {
+      /* Phases nested deeper than the limit are not recorded */
+      if (buffer->depth < PRIMME_TRACE_MAX_DEPTH) {
+         buffer->open[buffer->depth].name = name;
+         buffer->open[buffer->depth].time = primme_get_wtime() - buffer->origin;
+      }
+      buffer->depth++;
+   }
+   else {
+      /* Find the innermost phase with that name */
+      for (i=min(buffer->depth, PRIMME_TRACE_MAX_DEPTH)-1; i>=0; i--) {
+         if (strcmp(buffer->open[i].name, name) == 0) break;
+      }
+      if (i < 0) {
+         /* The begin was not recorded; just drop the nesting level */
+         if (buffer->depth > PRIMME_TRACE_MAX_DEPTH) buffer->depth--;
+         return;
+      }
+      close_phases(buffer, i, primme_get_wtime() - buffer->origin, primme);
+   }
+}
+
+/*******************************************************************************
+ * Subroutine close_phases - Record as complete events the begun phases from
+ *    the innermost one to the one at position depth, all ending at time.
+ ******************************************************************************/
+
+static void close_phases(primme_trace_buffer *buffer, int depth, double time,
+      primme_params *primme) {
+
+   primme_trace_event_t *e;
+
+   if (buffer->depth > PRIMME_TRACE_MAX_DEPTH)
+      buffer->depth = PRIMME_TRACE_MAX_DEPTH;
+
+   while (buffer->depth > depth) {
+      if (buffer->n >= PRIMME_TRACE_BUFFER_SIZE) primme_trace_flush(primme);
+      buffer->depth--;
+      e = &buffer->events[buffer->n++];
+      *e = buffer->open[buffer->depth];
+      e->duration = time - e->time;
+   }
+}
+
+/*******************************************************************************
+ * Function primme_trace_flush - Write the recorded events into
+ *    primme.traceFile and empty the buffer. The events have the time in
+ *    microseconds since the array was opened, and procID as process id, so
+ *    that traces from several processes can be merged into one timeline.
+ *
+ * RETURN VALUE
+ * ------------
+ * error code
+ ******************************************************************************/
+
+int primme_trace_flush(primme_params *primme) {
+
+   primme_trace_buffer *buffer = (primme_trace_buffer*)primme->traceBuffer;
+   int i;
+
+   if (buffer == NULL) return 0;
+
+   for (i=0; i<buffer->n; i++) {
+      fprintf(buffer->file,
+            "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+            "\"pid\":%d,\"tid\":0}",
+            buffer->numWritten++ > 0 ? ",\n" : "",
+            buffer->events[i].name, buffer->events[i].time*1e6,
+            buffer->events[i].duration*1e6, primme->procID);
+   }
+   buffer->n = 0;
+   CHKERRM(ferror(buffer->file), -1, "Error writing into 'traceFile'");
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Function primme_trace_end - End the phases left open by an error, and
+ *    write the pending events. Called when the solver returns, either
+ *    successfully or not.
+ *
+ * RETURN VALUE
+ * ------------
+ * error code
+ ******************************************************************************/
+
+int primme_trace_end(primme_params *primme) {
+
+   primme_trace_buffer *buffer = (primme_trace_buffer*)primme->traceBuffer;
+
+   if (buffer == NULL) return 0;
+
+   close_phases(buffer, 0, primme_get_wtime() - buffer->origin, primme);
+   CHKERR(primme_trace_flush(primme), -1);
+   fflush(buffer->file);
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Subroutine close_array - Write the closing bracket of the array of events.
+ ******************************************************************************/
+
+static void close_array(primme_trace_buffer *buffer) {
+
+   fprintf(buffer->file, "%s]\n", buffer->numWritten > 0 ? "\n" : "");
+   fflush(buffer->file);
+}
+
+/*******************************************************************************
+ * Subroutine primme_trace_free - Write the pending events, close the array
+ *    of events and free the buffer.
+ ******************************************************************************/
+
+void primme_trace_free(primme_params *primme) {
+
+   primme_trace_buffer *buffer = (primme_trace_buffer*)primme->traceBuffer;
+
+   if (buffer == NULL) return;
+
+   primme_trace_end(primme);
+   close_array(buffer);
+   free(buffer);
+   primme->traceBuffer = NULL;
+}
+
+#endif /* USE_DOUBLE */
@@ -0,0 +1,60 @@
+/*******************************************************************************
+ * Copyright (c) 2016, College of William & Mary
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the College of William & Mary nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COLLEGE OF WILLIAM & MARY BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * PRIMME: https://github.com/primme/primme
+ * Contact: Andreas Stathopoulos, a n d r e a s _at_ c s . w m . e d u
+ *******************************************************************************
+ * File: trace.h
+ *
+ * Purpose - Definitions to record the begin and end of the solver phases as
+ *           trace events (see trace.c).
+ *
+ ******************************************************************************/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+/* Number of events kept in memory before writing them into traceFile */
+#define PRIMME_TRACE_BUFFER_SIZE 4096
+
+/* Number of nested phases recorded; deeper phases are skipped */
+#define PRIMME_TRACE_MAX_DEPTH 16
+
+/* Record the begin and the end of a phase if tracing is active */
+#define TRACE_BEGIN(NAME, PRIMME) do { \
+   if ((PRIMME) && (PRIMME)->traceBuffer) primme_trace_event(NAME, 'B', PRIMME); \
+} while (0)
+#define TRACE_END(NAME, PRIMME) do { \
+   if ((PRIMME) && (PRIMME)->traceBuffer) primme_trace_event(NAME, 'E', PRIMME); \
+} while (0)
+
+int primme_trace_init(primme_params *primme);
+void primme_trace_event(const char *name, char phase, primme_params *primme);
+int primme_trace_flush(primme_params *primme);
+int primme_trace_end(primme_params *primme);
+void primme_trace_free(primme_params *primme);
+
+#endif
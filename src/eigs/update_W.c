@@ -40,6 +40,7 @@
 #include "auxiliary_eigs.h"
 #include "ortho.h"
 #include "wtime.h"
+#include "trace.h"
 
 
 /*******************************************************************************
@@ -74,6 +75,7 @@ int matrixMatvec_Sprimme(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
    assert(primme->ldOPs == 0 || primme->ldOPs >= nLocal);
 
    t0 = primme_wTimer(0);
+   TRACE_BEGIN("matvec", primme);
 
    /* W(:,c) = A*V(:,c) for c = basisSize:basisSize+blockSize-1 */
    if (primme->ldOPs == 0 || (ldV == primme->ldOPs && ldW == primme->ldOPs)) {
@@ -90,6 +92,7 @@ int matrixMatvec_Sprimme(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
       }
    }
 
+   TRACE_END("matvec", primme);
    primme->stats.timeMatvec += primme_wTimer(0) - t0;
    primme->stats.numMatvecs += blockSize;
 
@@ -149,10 +149,131 @@ int update_projection_Sprimme(SCALAR *X, PRIMME_INT ldX, SCALAR *Y,
 
       CHKERR(globalSum_Sprimme(rwork, &rwork[count], count, primme), -1);
 
-      Num_copy_matrix_Sprimme(&rwork[count], m, blockSize, ldZ, &Z[ldZ*numCols], m);
-      Num_copy_matrix_Sprimme(&rwork[count+m*blockSize], blockSize, numCols, ldZ,
-            &Z[numCols], blockSize);
+      Num_copy_matrix_Sprimme(&rwork[count], m, blockSize, m, &Z[ldZ*numCols],
+            ldZ);
+      Num_copy_matrix_Sprimme(&rwork[count+m*blockSize], blockSize, numCols,
+            blockSize, &Z[numCols], ldZ);
    }
 
    return 0;
 }
+
+/*******************************************************************************
+ * Subroutine update_projections - Adds blockSize new columns and rows to
+ *    H = V'*W and, if QtV is not NULL, to QtV = Q'*V. The new parts of both
+ *    matrices are computed locally and reduced together with a single call
+ *    to globalSum, instead of one call per matrix as update_projection does.
+ *
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * V, W, Q     Matrices with size nLocal x numCols+blockSize
+ * ldV, ldW, ldQ  The leading dimensions of V, W and Q
+ * numCols     The number of columns that haven't changed
+ * blockSize   The number of columns that have changed
+ * rwork       Workspace
+ * lrwork      Size of rwork
+ * 
+ * INPUT/OUTPUT ARRAYS
+ * -------------------
+ * H           Hermitian matrix V'*W; only the upper triangular part of the
+ *             new columns is updated
+ * ldH         The leading dimension of H
+ * QtV         Matrix Q'*V; the new columns and rows are updated
+ * ldQtV       The leading dimension of QtV
+ *
+ * NOTE: if VRot is not NULL, the first nVRot columns of the actual basis
+ *       are V(:,0:nVRot-1)*VRot (see restart_soft_locking), and the rows
+ *       of the new columns of H are rotated accordingly. This is only
+ *       supported without QtV and with nVRot <= numCols.
+ *
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+int update_projections_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
+      PRIMME_INT ldW, SCALAR *Q, PRIMME_INT ldQ, SCALAR *H, PRIMME_INT ldH,
+      SCALAR *QtV, PRIMME_INT ldQtV, SCALAR *VRot, int ldVRot, int nVRot,
+      PRIMME_INT nLocal, int numCols, int blockSize, SCALAR *rwork,
+      size_t *lrwork, primme_params *primme) {
+
+   int count, countH, m;
+
+   /* -------------------------- */
+   /* Return memory requirements */
+   /* -------------------------- */
+
+   if (V == NULL) {
+      m = numCols+blockSize;
+      *lrwork = max(*lrwork,
+            (size_t)m*blockSize*4 + (size_t)blockSize*numCols*2);
+      return 0;
+   }
+
+   /* Without QtV there is nothing to fuse */
+
+   if (QtV == NULL) {
+      CHKERR(update_projection_Sprimme(V, ldV, W, ldW, H, ldH, nLocal,
+            numCols, blockSize, rwork, lrwork, 1/*symmetric*/, primme), -1);
+
+      /* H(0:nVRot-1,numCols:) = VRot'*H(0:nVRot-1,numCols:) */
+
+      if (VRot && nVRot > 0 && blockSize > 0) {
+         assert(nVRot <= numCols && (size_t)nVRot*blockSize <= *lrwork);
+         Num_gemm_Sprimme("C", "N", nVRot, blockSize, nVRot, 1.0, VRot,
+               ldVRot, &H[ldH*numCols], ldH, 0.0, rwork, nVRot);
+         Num_copy_matrix_Sprimme(rwork, nVRot, blockSize, nVRot,
+               &H[ldH*numCols], ldH);
+      }
+      return 0;
+   }
+
+   assert(VRot == NULL || nVRot == 0);
+
+   assert(ldV >= nLocal && ldW >= nLocal && ldQ >= nLocal
+         && ldH >= numCols+blockSize && ldQtV >= numCols+blockSize);
+
+   /* ------------ */
+   /* Quick return */
+   /* ------------ */
+
+   if (blockSize <= 0) return 0;
+
+   /* --------------------------------------------------------------------- */
+   /* Compute locally H(:,numCols:end), QtV(:,numCols:end) and              */
+   /* QtV(numCols:end,0:numCols-1)                                          */
+   /* --------------------------------------------------------------------- */
+
+   m = numCols+blockSize;
+   Num_gemm_Sprimme("C", "N", m, blockSize, nLocal, 1.0, 
+      V, ldV, &W[ldW*numCols], ldW, 0.0, &H[ldH*numCols], ldH);
+   Num_gemm_Sprimme("C", "N", m, blockSize, nLocal, 1.0, 
+      Q, ldQ, &V[ldV*numCols], ldV, 0.0, &QtV[ldQtV*numCols], ldQtV);
+   Num_gemm_Sprimme("C", "N", blockSize, numCols, nLocal, 1.0, 
+         &Q[ldQ*numCols], ldQ, V, ldV, 0.0, &QtV[numCols], ldQtV);
+
+   if (primme->numProcs <= 1) return 0;
+
+   /* --------------------------------------------------------------------- */
+   /* Pack the upper triangular part of the new columns of H and the new    */
+   /* parts of QtV, and reduce all of them at once                          */
+   /* --------------------------------------------------------------------- */
+
+   Num_copy_trimatrix_compact_Sprimme(&H[ldH*numCols], m, blockSize, ldH,
+         numCols, rwork, &countH);
+   Num_copy_matrix_Sprimme(&QtV[ldQtV*numCols], m, blockSize, ldQtV,
+         &rwork[countH], m);
+   Num_copy_matrix_Sprimme(&QtV[numCols], blockSize, numCols, ldQtV,
+         &rwork[countH+m*blockSize], blockSize);
+   count = countH+m*blockSize+blockSize*numCols;
+   assert((size_t)count*2 <= *lrwork);
+
+   CHKERR(globalSum_Sprimme(rwork, &rwork[count], count, primme), -1);
+
+   Num_copy_compact_trimatrix_Sprimme(&rwork[count], m, blockSize, numCols,
+         &H[ldH*numCols], ldH);
+   Num_copy_matrix_Sprimme(&rwork[count+countH], m, blockSize, m,
+         &QtV[ldQtV*numCols], ldQtV);
+   Num_copy_matrix_Sprimme(&rwork[count+countH+m*blockSize], blockSize,
+         numCols, blockSize, &QtV[numCols], ldQtV);
+
+   return 0;
+}
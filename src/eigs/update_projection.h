@@ -43,16 +43,42 @@ int update_projection_dprimme(double *X, int64_t ldX, double *Y,
       int64_t ldY, double *Z, int64_t ldZ, int64_t nLocal, int numCols,
       int blockSize, double *rwork, size_t *lrwork, int isSymmetric,
       primme_params *primme);
+#if !defined(CHECK_TEMPLATE) && !defined(update_projections_Sprimme)
+#  define update_projections_Sprimme CONCAT(update_projections_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(update_projections_Rprimme)
+#  define update_projections_Rprimme CONCAT(update_projections_,REAL_SUF)
+#endif
+int update_projections_dprimme(double *V, int64_t ldV, double *W,
+      int64_t ldW, double *Q, int64_t ldQ, double *H, int64_t ldH,
+      double *QtV, int64_t ldQtV, double *VRot, int ldVRot, int nVRot,
+      int64_t nLocal, int numCols, int blockSize, double *rwork,
+      size_t *lrwork, primme_params *primme);
 int update_projection_zprimme(PRIMME_COMPLEX_DOUBLE *X, int64_t ldX, PRIMME_COMPLEX_DOUBLE *Y,
       int64_t ldY, PRIMME_COMPLEX_DOUBLE *Z, int64_t ldZ, int64_t nLocal, int numCols,
       int blockSize, PRIMME_COMPLEX_DOUBLE *rwork, size_t *lrwork, int isSymmetric,
       primme_params *primme);
+int update_projections_zprimme(PRIMME_COMPLEX_DOUBLE *V, int64_t ldV, PRIMME_COMPLEX_DOUBLE *W,
+      int64_t ldW, PRIMME_COMPLEX_DOUBLE *Q, int64_t ldQ, PRIMME_COMPLEX_DOUBLE *H, int64_t ldH,
+      PRIMME_COMPLEX_DOUBLE *QtV, int64_t ldQtV, PRIMME_COMPLEX_DOUBLE *VRot, int ldVRot, int nVRot,
+      int64_t nLocal, int numCols, int blockSize, PRIMME_COMPLEX_DOUBLE *rwork,
+      size_t *lrwork, primme_params *primme);
 int update_projection_sprimme(float *X, int64_t ldX, float *Y,
       int64_t ldY, float *Z, int64_t ldZ, int64_t nLocal, int numCols,
       int blockSize, float *rwork, size_t *lrwork, int isSymmetric,
       primme_params *primme);
+int update_projections_sprimme(float *V, int64_t ldV, float *W,
+      int64_t ldW, float *Q, int64_t ldQ, float *H, int64_t ldH,
+      float *QtV, int64_t ldQtV, float *VRot, int ldVRot, int nVRot,
+      int64_t nLocal, int numCols, int blockSize, float *rwork,
+      size_t *lrwork, primme_params *primme);
 int update_projection_cprimme(PRIMME_COMPLEX_FLOAT *X, int64_t ldX, PRIMME_COMPLEX_FLOAT *Y,
       int64_t ldY, PRIMME_COMPLEX_FLOAT *Z, int64_t ldZ, int64_t nLocal, int numCols,
       int blockSize, PRIMME_COMPLEX_FLOAT *rwork, size_t *lrwork, int isSymmetric,
       primme_params *primme);
+int update_projections_cprimme(PRIMME_COMPLEX_FLOAT *V, int64_t ldV, PRIMME_COMPLEX_FLOAT *W,
+      int64_t ldW, PRIMME_COMPLEX_FLOAT *Q, int64_t ldQ, PRIMME_COMPLEX_FLOAT *H, int64_t ldH,
+      PRIMME_COMPLEX_FLOAT *QtV, int64_t ldQtV, PRIMME_COMPLEX_FLOAT *VRot, int ldVRot, int nVRot,
+      int64_t nLocal, int numCols, int blockSize, PRIMME_COMPLEX_FLOAT *rwork,
+      size_t *lrwork, primme_params *primme);
 #endif
@@ -114,6 +114,29 @@ double* Num_compact_vecs_dprimme(double *vecs, int64_t m, int n,
 int compute_submatrix_dprimme(double *X, int nX, int ldX,
    double *H, int nH, int ldH, double *R, int ldR,
    double *rwork, size_t *lrwork);
+#if !defined(CHECK_TEMPLATE) && !defined(Num_axpby_accum_Sprimme)
+#  define Num_axpby_accum_Sprimme CONCAT(Num_axpby_accum_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(Num_axpby_accum_Rprimme)
+#  define Num_axpby_accum_Rprimme CONCAT(Num_axpby_accum_,REAL_SUF)
+#endif
+double Num_axpby_accum_dprimme(int64_t m, double alpha, double *x, double beta,
+      double *y, double *z);
+#if !defined(CHECK_TEMPLATE) && !defined(Num_axpy_sqnorm_Sprimme)
+#  define Num_axpy_sqnorm_Sprimme CONCAT(Num_axpy_sqnorm_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(Num_axpy_sqnorm_Rprimme)
+#  define Num_axpy_sqnorm_Rprimme CONCAT(Num_axpy_sqnorm_,REAL_SUF)
+#endif
+double Num_axpy_sqnorm_dprimme(int64_t m, double alpha, double *x, double *y);
+#if !defined(CHECK_TEMPLATE) && !defined(Num_update_qmr_Sprimme)
+#  define Num_update_qmr_Sprimme CONCAT(Num_update_qmr_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(Num_update_qmr_Rprimme)
+#  define Num_update_qmr_Rprimme CONCAT(Num_update_qmr_,REAL_SUF)
+#endif
+void Num_update_qmr_dprimme(int64_t m, double gamma, double eta, double beta,
+      double *d, double *delta, double *sol, double *w);
 void Num_copy_matrix_zprimme(PRIMME_COMPLEX_DOUBLE *x, int64_t m, int64_t n, int64_t
       ldx, PRIMME_COMPLEX_DOUBLE *y, int64_t ldy);
 void Num_copy_matrix_columns_zprimme(PRIMME_COMPLEX_DOUBLE *x, int64_t m, int *xin, int n,
@@ -134,6 +157,11 @@ PRIMME_COMPLEX_DOUBLE* Num_compact_vecs_zprimme(PRIMME_COMPLEX_DOUBLE *vecs, int
 int compute_submatrix_zprimme(PRIMME_COMPLEX_DOUBLE *X, int nX, int ldX,
    PRIMME_COMPLEX_DOUBLE *H, int nH, int ldH, PRIMME_COMPLEX_DOUBLE *R, int ldR,
    PRIMME_COMPLEX_DOUBLE *rwork, size_t *lrwork);
+double Num_axpby_accum_zprimme(int64_t m, double alpha, PRIMME_COMPLEX_DOUBLE *x, double beta,
+      PRIMME_COMPLEX_DOUBLE *y, PRIMME_COMPLEX_DOUBLE *z);
+double Num_axpy_sqnorm_zprimme(int64_t m, double alpha, PRIMME_COMPLEX_DOUBLE *x, PRIMME_COMPLEX_DOUBLE *y);
+void Num_update_qmr_zprimme(int64_t m, double gamma, double eta, double beta,
+      PRIMME_COMPLEX_DOUBLE *d, PRIMME_COMPLEX_DOUBLE *delta, PRIMME_COMPLEX_DOUBLE *sol, PRIMME_COMPLEX_DOUBLE *w);
 void Num_copy_matrix_sprimme(float *x, int64_t m, int64_t n, int64_t
       ldx, float *y, int64_t ldy);
 void Num_copy_matrix_columns_sprimme(float *x, int64_t m, int *xin, int n,
@@ -154,6 +182,11 @@ float* Num_compact_vecs_sprimme(float *vecs, int64_t m, int n,
 int compute_submatrix_sprimme(float *X, int nX, int ldX,
    float *H, int nH, int ldH, float *R, int ldR,
    float *rwork, size_t *lrwork);
+float Num_axpby_accum_sprimme(int64_t m, float alpha, float *x, float beta,
+      float *y, float *z);
+float Num_axpy_sqnorm_sprimme(int64_t m, float alpha, float *x, float *y);
+void Num_update_qmr_sprimme(int64_t m, float gamma, float eta, float beta,
+      float *d, float *delta, float *sol, float *w);
 void Num_copy_matrix_cprimme(PRIMME_COMPLEX_FLOAT *x, int64_t m, int64_t n, int64_t
       ldx, PRIMME_COMPLEX_FLOAT *y, int64_t ldy);
 void Num_copy_matrix_columns_cprimme(PRIMME_COMPLEX_FLOAT *x, int64_t m, int *xin, int n,
@@ -174,4 +207,9 @@ PRIMME_COMPLEX_FLOAT* Num_compact_vecs_cprimme(PRIMME_COMPLEX_FLOAT *vecs, int64
 int compute_submatrix_cprimme(PRIMME_COMPLEX_FLOAT *X, int nX, int ldX,
    PRIMME_COMPLEX_FLOAT *H, int nH, int ldH, PRIMME_COMPLEX_FLOAT *R, int ldR,
    PRIMME_COMPLEX_FLOAT *rwork, size_t *lrwork);
+float Num_axpby_accum_cprimme(int64_t m, float alpha, PRIMME_COMPLEX_FLOAT *x, float beta,
+      PRIMME_COMPLEX_FLOAT *y, PRIMME_COMPLEX_FLOAT *z);
+float Num_axpy_sqnorm_cprimme(int64_t m, float alpha, PRIMME_COMPLEX_FLOAT *x, PRIMME_COMPLEX_FLOAT *y);
+void Num_update_qmr_cprimme(int64_t m, float gamma, float eta, float beta,
+      PRIMME_COMPLEX_FLOAT *d, PRIMME_COMPLEX_FLOAT *delta, PRIMME_COMPLEX_FLOAT *sol, PRIMME_COMPLEX_FLOAT *w);
 #endif
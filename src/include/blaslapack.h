@@ -49,6 +49,15 @@ void Num_copy_dprimme(int64_t n, double *x, int incx, double *y, int incy);
 void Num_gemm_dprimme(const char *transa, const char *transb, int m, int n,
       int k, double alpha, double *a, int lda, double *b, int ldb, double beta,
       double *c, int ldc);
+#if !defined(CHECK_TEMPLATE) && !defined(Num_gemmt_Sprimme)
+#  define Num_gemmt_Sprimme CONCAT(Num_gemmt_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(Num_gemmt_Rprimme)
+#  define Num_gemmt_Rprimme CONCAT(Num_gemmt_,REAL_SUF)
+#endif
+void Num_gemmt_dprimme(const char *uplo, const char *transa,
+      const char *transb, int n, int k, double alpha, double *a, int lda,
+      double *b, int ldb, double beta, double *c, int ldc);
 #if !defined(CHECK_TEMPLATE) && !defined(Num_hemm_Sprimme)
 #  define Num_hemm_Sprimme CONCAT(Num_hemm_,SCALAR_SUF)
 #endif
@@ -130,6 +139,32 @@ void Num_swap_dprimme(int64_t n, double *x, int incx, double *y, int incy);
 #endif
 void Num_heev_dprimme(const char *jobz, const char *uplo, int n, double *a,
       int lda, double *w, double *work, int ldwork, int *info);
+#if !defined(CHECK_TEMPLATE) && !defined(Num_hetrd_Sprimme)
+#  define Num_hetrd_Sprimme CONCAT(Num_hetrd_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(Num_hetrd_Rprimme)
+#  define Num_hetrd_Rprimme CONCAT(Num_hetrd_,REAL_SUF)
+#endif
+void Num_hetrd_dprimme(const char *uplo, int n, double *a, int lda, double *d,
+      double *e, double *tau, double *work, int ldwork, int *info);
+#if !defined(CHECK_TEMPLATE) && !defined(Num_stemr_Sprimme)
+#  define Num_stemr_Sprimme CONCAT(Num_stemr_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(Num_stemr_Rprimme)
+#  define Num_stemr_Rprimme CONCAT(Num_stemr_,REAL_SUF)
+#endif
+void Num_stemr_dprimme(const char *jobz, const char *range, int n, double *d,
+      double *e, int il, int iu, int *m, double *w, double *z, int ldz,
+      double *work, int lwork, int *info);
+#if !defined(CHECK_TEMPLATE) && !defined(Num_unmtr_Sprimme)
+#  define Num_unmtr_Sprimme CONCAT(Num_unmtr_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(Num_unmtr_Rprimme)
+#  define Num_unmtr_Rprimme CONCAT(Num_unmtr_,REAL_SUF)
+#endif
+void Num_unmtr_dprimme(const char *side, const char *uplo, const char *trans,
+      int m, int n, double *a, int lda, double *tau, double *c, int ldc,
+      double *work, int ldwork, int *info);
 #if !defined(CHECK_TEMPLATE) && !defined(Num_gesvd_Sprimme)
 #  define Num_gesvd_Sprimme CONCAT(Num_gesvd_,SCALAR_SUF)
 #endif
@@ -155,6 +190,22 @@ void Num_hetrf_dprimme(const char *uplo, int n, double *a, int lda, int *ipivot,
 #endif
 void Num_hetrs_dprimme(const char *uplo, int n, int nrhs, double *a,
       int lda, int *ipivot, double *b, int ldb, int *info);
+#if !defined(CHECK_TEMPLATE) && !defined(Num_getrf_Sprimme)
+#  define Num_getrf_Sprimme CONCAT(Num_getrf_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(Num_getrf_Rprimme)
+#  define Num_getrf_Rprimme CONCAT(Num_getrf_,REAL_SUF)
+#endif
+void Num_getrf_dprimme(int m, int n, double *a, int lda, int *ipivot,
+      int *info);
+#if !defined(CHECK_TEMPLATE) && !defined(Num_gecon_Sprimme)
+#  define Num_gecon_Sprimme CONCAT(Num_gecon_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(Num_gecon_Rprimme)
+#  define Num_gecon_Rprimme CONCAT(Num_gecon_,REAL_SUF)
+#endif
+void Num_gecon_dprimme(const char *norm, int n, double *a, int lda, double anorm,
+      double *rcond, double *work, int *iwork, int *info);
 #if !defined(CHECK_TEMPLATE) && !defined(Num_trsm_Sprimme)
 #  define Num_trsm_Sprimme CONCAT(Num_trsm_,SCALAR_SUF)
 #endif
@@ -175,6 +226,9 @@ void Num_copy_zprimme(int64_t n, PRIMME_COMPLEX_DOUBLE *x, int incx, PRIMME_COMP
 void Num_gemm_zprimme(const char *transa, const char *transb, int m, int n,
       int k, PRIMME_COMPLEX_DOUBLE alpha, PRIMME_COMPLEX_DOUBLE *a, int lda, PRIMME_COMPLEX_DOUBLE *b, int ldb, PRIMME_COMPLEX_DOUBLE beta,
       PRIMME_COMPLEX_DOUBLE *c, int ldc);
+void Num_gemmt_zprimme(const char *uplo, const char *transa,
+      const char *transb, int n, int k, PRIMME_COMPLEX_DOUBLE alpha, PRIMME_COMPLEX_DOUBLE *a, int lda,
+      PRIMME_COMPLEX_DOUBLE *b, int ldb, PRIMME_COMPLEX_DOUBLE beta, PRIMME_COMPLEX_DOUBLE *c, int ldc);
 void Num_hemm_zprimme(const char *side, const char *uplo, int m, int n,
       PRIMME_COMPLEX_DOUBLE alpha, PRIMME_COMPLEX_DOUBLE *a, int lda, PRIMME_COMPLEX_DOUBLE *b, int ldb, PRIMME_COMPLEX_DOUBLE beta,
       PRIMME_COMPLEX_DOUBLE *c, int ldc);
@@ -196,6 +250,14 @@ void Num_scal_zprimme(int64_t n, PRIMME_COMPLEX_DOUBLE alpha, PRIMME_COMPLEX_DOU
 void Num_swap_zprimme(int64_t n, PRIMME_COMPLEX_DOUBLE *x, int incx, PRIMME_COMPLEX_DOUBLE *y, int incy);
 void Num_heev_zprimme(const char *jobz, const char *uplo, int n, PRIMME_COMPLEX_DOUBLE *a,
       int lda, double *w, PRIMME_COMPLEX_DOUBLE *work, int ldwork, double *rwork, int *info);
+void Num_hetrd_zprimme(const char *uplo, int n, PRIMME_COMPLEX_DOUBLE *a, int lda, double *d,
+      double *e, PRIMME_COMPLEX_DOUBLE *tau, PRIMME_COMPLEX_DOUBLE *work, int ldwork, int *info);
+void Num_stemr_zprimme(const char *jobz, const char *range, int n, double *d,
+      double *e, int il, int iu, int *m, double *w, PRIMME_COMPLEX_DOUBLE *z, int ldz,
+      double *work, int lwork, int *info);
+void Num_unmtr_zprimme(const char *side, const char *uplo, const char *trans,
+      int m, int n, PRIMME_COMPLEX_DOUBLE *a, int lda, PRIMME_COMPLEX_DOUBLE *tau, PRIMME_COMPLEX_DOUBLE *c, int ldc,
+      PRIMME_COMPLEX_DOUBLE *work, int ldwork, int *info);
 void Num_gesvd_zprimme(const char *jobu, const char *jobvt, int m, int n,
    PRIMME_COMPLEX_DOUBLE *a, int lda, double *s, PRIMME_COMPLEX_DOUBLE *u, int ldu, PRIMME_COMPLEX_DOUBLE *vt, int ldvt,
    PRIMME_COMPLEX_DOUBLE *work, int ldwork, double *rwork, int *info);
@@ -203,6 +265,10 @@ void Num_hetrf_zprimme(const char *uplo, int n, PRIMME_COMPLEX_DOUBLE *a, int ld
    PRIMME_COMPLEX_DOUBLE *work, int ldwork, int *info);
 void Num_hetrs_zprimme(const char *uplo, int n, int nrhs, PRIMME_COMPLEX_DOUBLE *a,
       int lda, int *ipivot, PRIMME_COMPLEX_DOUBLE *b, int ldb, int *info);
+void Num_getrf_zprimme(int m, int n, PRIMME_COMPLEX_DOUBLE *a, int lda, int *ipivot,
+      int *info);
+void Num_gecon_zprimme(const char *norm, int n, PRIMME_COMPLEX_DOUBLE *a, int lda, double anorm,
+      double *rcond, PRIMME_COMPLEX_DOUBLE *work, int *iwork, int *info);
 void Num_trsm_zprimme(const char *side, const char *uplo, const char *transa,
       const char *diag, int m, int n, PRIMME_COMPLEX_DOUBLE alpha, PRIMME_COMPLEX_DOUBLE *a, int lda,
       PRIMME_COMPLEX_DOUBLE *b, int ldb);
@@ -210,6 +276,9 @@ void Num_copy_sprimme(int64_t n, float *x, int incx, float *y, int incy);
 void Num_gemm_sprimme(const char *transa, const char *transb, int m, int n,
       int k, float alpha, float *a, int lda, float *b, int ldb, float beta,
       float *c, int ldc);
+void Num_gemmt_sprimme(const char *uplo, const char *transa,
+      const char *transb, int n, int k, float alpha, float *a, int lda,
+      float *b, int ldb, float beta, float *c, int ldc);
 void Num_hemm_sprimme(const char *side, const char *uplo, int m, int n,
       float alpha, float *a, int lda, float *b, int ldb, float beta,
       float *c, int ldc);
@@ -231,6 +300,14 @@ void Num_scal_sprimme(int64_t n, float alpha, float *x, int incx);
 void Num_swap_sprimme(int64_t n, float *x, int incx, float *y, int incy);
 void Num_heev_sprimme(const char *jobz, const char *uplo, int n, float *a,
       int lda, float *w, float *work, int ldwork, int *info);
+void Num_hetrd_sprimme(const char *uplo, int n, float *a, int lda, float *d,
+      float *e, float *tau, float *work, int ldwork, int *info);
+void Num_stemr_sprimme(const char *jobz, const char *range, int n, float *d,
+      float *e, int il, int iu, int *m, float *w, float *z, int ldz,
+      float *work, int lwork, int *info);
+void Num_unmtr_sprimme(const char *side, const char *uplo, const char *trans,
+      int m, int n, float *a, int lda, float *tau, float *c, int ldc,
+      float *work, int ldwork, int *info);
 void Num_gesvd_sprimme(const char *jobu, const char *jobvt, int m, int n,
       float *a, int lda, float *s, float *u, int ldu, float *vt, int ldvt,
       float *work, int ldwork, int *info);
@@ -238,6 +315,10 @@ void Num_hetrf_sprimme(const char *uplo, int n, float *a, int lda, int *ipivot,
    float *work, int ldwork, int *info);
 void Num_hetrs_sprimme(const char *uplo, int n, int nrhs, float *a,
       int lda, int *ipivot, float *b, int ldb, int *info);
+void Num_getrf_sprimme(int m, int n, float *a, int lda, int *ipivot,
+      int *info);
+void Num_gecon_sprimme(const char *norm, int n, float *a, int lda, float anorm,
+      float *rcond, float *work, int *iwork, int *info);
 void Num_trsm_sprimme(const char *side, const char *uplo, const char *transa,
       const char *diag, int m, int n, float alpha, float *a, int lda,
       float *b, int ldb);
@@ -246,6 +327,9 @@ void Num_copy_cprimme(int64_t n, PRIMME_COMPLEX_FLOAT *x, int incx, PRIMME_COMPL
 void Num_gemm_cprimme(const char *transa, const char *transb, int m, int n,
       int k, PRIMME_COMPLEX_FLOAT alpha, PRIMME_COMPLEX_FLOAT *a, int lda, PRIMME_COMPLEX_FLOAT *b, int ldb, PRIMME_COMPLEX_FLOAT beta,
       PRIMME_COMPLEX_FLOAT *c, int ldc);
+void Num_gemmt_cprimme(const char *uplo, const char *transa,
+      const char *transb, int n, int k, PRIMME_COMPLEX_FLOAT alpha, PRIMME_COMPLEX_FLOAT *a, int lda,
+      PRIMME_COMPLEX_FLOAT *b, int ldb, PRIMME_COMPLEX_FLOAT beta, PRIMME_COMPLEX_FLOAT *c, int ldc);
 void Num_hemm_cprimme(const char *side, const char *uplo, int m, int n,
       PRIMME_COMPLEX_FLOAT alpha, PRIMME_COMPLEX_FLOAT *a, int lda, PRIMME_COMPLEX_FLOAT *b, int ldb, PRIMME_COMPLEX_FLOAT beta,
       PRIMME_COMPLEX_FLOAT *c, int ldc);
@@ -267,6 +351,14 @@ void Num_scal_cprimme(int64_t n, PRIMME_COMPLEX_FLOAT alpha, PRIMME_COMPLEX_FLOA
 void Num_swap_cprimme(int64_t n, PRIMME_COMPLEX_FLOAT *x, int incx, PRIMME_COMPLEX_FLOAT *y, int incy);
 void Num_heev_cprimme(const char *jobz, const char *uplo, int n, PRIMME_COMPLEX_FLOAT *a,
       int lda, float *w, PRIMME_COMPLEX_FLOAT *work, int ldwork, float *rwork, int *info);
+void Num_hetrd_cprimme(const char *uplo, int n, PRIMME_COMPLEX_FLOAT *a, int lda, float *d,
+      float *e, PRIMME_COMPLEX_FLOAT *tau, PRIMME_COMPLEX_FLOAT *work, int ldwork, int *info);
+void Num_stemr_cprimme(const char *jobz, const char *range, int n, float *d,
+      float *e, int il, int iu, int *m, float *w, PRIMME_COMPLEX_FLOAT *z, int ldz,
+      float *work, int lwork, int *info);
+void Num_unmtr_cprimme(const char *side, const char *uplo, const char *trans,
+      int m, int n, PRIMME_COMPLEX_FLOAT *a, int lda, PRIMME_COMPLEX_FLOAT *tau, PRIMME_COMPLEX_FLOAT *c, int ldc,
+      PRIMME_COMPLEX_FLOAT *work, int ldwork, int *info);
 void Num_gesvd_cprimme(const char *jobu, const char *jobvt, int m, int n,
    PRIMME_COMPLEX_FLOAT *a, int lda, float *s, PRIMME_COMPLEX_FLOAT *u, int ldu, PRIMME_COMPLEX_FLOAT *vt, int ldvt,
    PRIMME_COMPLEX_FLOAT *work, int ldwork, float *rwork, int *info);
@@ -274,6 +366,10 @@ void Num_hetrf_cprimme(const char *uplo, int n, PRIMME_COMPLEX_FLOAT *a, int lda
    PRIMME_COMPLEX_FLOAT *work, int ldwork, int *info);
 void Num_hetrs_cprimme(const char *uplo, int n, int nrhs, PRIMME_COMPLEX_FLOAT *a,
       int lda, int *ipivot, PRIMME_COMPLEX_FLOAT *b, int ldb, int *info);
+void Num_getrf_cprimme(int m, int n, PRIMME_COMPLEX_FLOAT *a, int lda, int *ipivot,
+      int *info);
+void Num_gecon_cprimme(const char *norm, int n, PRIMME_COMPLEX_FLOAT *a, int lda, float anorm,
+      float *rcond, PRIMME_COMPLEX_FLOAT *work, int *iwork, int *info);
 void Num_trsm_cprimme(const char *side, const char *uplo, const char *transa,
       const char *diag, int m, int n, PRIMME_COMPLEX_FLOAT alpha, PRIMME_COMPLEX_FLOAT *a, int lda,
       PRIMME_COMPLEX_FLOAT *b, int ldb);
@@ -123,6 +123,15 @@
 #  define CONJ(x) (x)
 #endif
 
+/* Number of real flops in a SCALAR multiplication-addition divided by two;   */
+/* used to estimate the cost of the dense kernels in primme_stats             */
+
+#ifdef USE_COMPLEX
+#  define FLOPS_SCALAR 4.0
+#else
+#  define FLOPS_SCALAR 1.0
+#endif
+
 /* complex.h may be defined in primme.h or here; so undefine I */
 #ifdef I
 #   undef I
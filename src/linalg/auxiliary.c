@@ -31,6 +31,14 @@
  *
  * Purpose - Miscellanea functions to copy and permuting matrices.
  *
+ *    Copies and zeroing of columns are done with memcpy, memmove and memset,
+ *    whose vectorized versions are selected at runtime by the C library.
+ *    The elementwise updates have AVX2 and AVX-512 versions on x86, chosen
+ *    at runtime when the CPU supports them. They view complex vectors as
+ *    real vectors of twice the length, and do the same operations in the
+ *    same order as the scalar code, so the results do not depend on the
+ *    version used.
+ *
  ******************************************************************************/
 
 
@@ -42,6 +50,162 @@
 #include "auxiliary.h"
 #include "blaslapack.h"
 
+/* Number of partial sums in the kernels returning a squared norm, which  */
+/* is the number of REALs in an AVX-512 vector. Every version adds entry i */
+/* to the partial sum i%SUM_LANES and adds up the partial sums in the same */
+/* order, so all of them return the same value.                           */
+
+#define SUM_LANES (64/(int)sizeof(REAL))
+
+/* Compile the x86 SIMD kernels, unless PRIMME_WITHOUT_SIMD is defined */
+
+#if !defined(PRIMME_WITHOUT_SIMD) && defined(__GNUC__) && \
+      (defined(__x86_64__) || defined(__i386__)) && \
+      (defined(__clang__) || __GNUC__ >= 5)
+#  define USE_SIMD_X86
+#  include <immintrin.h>
+#endif
+
+#ifdef USE_SIMD_X86
+
+/* Vector types and intrinsics on REAL */
+
+#if defined(USE_DOUBLE) || defined(USE_DOUBLECOMPLEX)
+#  define V256               __m256d
+#  define V256_WIDTH         4
+#  define V256_SET1          _mm256_set1_pd
+#  define V256_LOAD          _mm256_loadu_pd
+#  define V256_STORE         _mm256_storeu_pd
+#  define V256_ADD           _mm256_add_pd
+#  define V256_MUL           _mm256_mul_pd
+#  define V512               __m512d
+#  define V512_WIDTH         8
+#  define V512_SET1          _mm512_set1_pd
+#  define V512_LOAD          _mm512_loadu_pd
+#  define V512_STORE         _mm512_storeu_pd
+#  define V512_ADD           _mm512_add_pd
+#  define V512_MUL           _mm512_mul_pd
+#else
+#  define V256               __m256
+#  define V256_WIDTH         8
+#  define V256_SET1          _mm256_set1_ps
+#  define V256_LOAD          _mm256_loadu_ps
+#  define V256_STORE         _mm256_storeu_ps
+#  define V256_ADD           _mm256_add_ps
+#  define V256_MUL           _mm256_mul_ps
+#  define V512               __m512
+#  define V512_WIDTH         16
+#  define V512_SET1          _mm512_set1_ps
+#  define V512_LOAD          _mm512_loadu_ps
+#  define V512_STORE         _mm512_storeu_ps
+#  define V512_ADD           _mm512_add_ps
+#  define V512_MUL           _mm512_mul_ps
+#endif
+
+/* Instruction sets that the kernels may use */
+
+#define SIMD_NONE   0
+#define SIMD_AVX2   1
+#define SIMD_AVX512 2
+
+/*******************************************************************************
+ * Function simd_level - Return the widest instruction set supported by the
+ *    CPU and the operating system. The query is done once.
+ ******************************************************************************/
+
+static int simd_level(void) {
+   static int level = -1;
+
+   if (level < 0) {
+      __builtin_cpu_init();
+      level = __builtin_cpu_supports("avx512f") ? SIMD_AVX512 :
+              __builtin_cpu_supports("avx2") ? SIMD_AVX2 : SIMD_NONE;
+   }
+   return level;
+}
+
+/*******************************************************************************
+ * Kernels for vectors of W bits. They process the first entries that fill
+ * whole vectors, or whole blocks of SUM_LANES entries if they return a
+ * squared norm in the partial sums of sum, and return the number of entries
+ * processed.
+ ******************************************************************************/
+
+/* y = alpha*x + beta*y; z = z + y; sum += z.*z */
+
+#define AXPBY_ACCUM_KERNEL(W, ISA) \
+__attribute__((target(ISA))) \
+static PRIMME_INT axpby_accum_v ## W(PRIMME_INT n, REAL alpha, REAL *x, \
+      REAL beta, REAL *y, REAL *z, REAL *sum) { \
+   V ## W va = V ## W ## _SET1(alpha), vb = V ## W ## _SET1(beta), vy, vz; \
+   PRIMME_INT i; \
+   int k; \
+   for (i=0; i+SUM_LANES<=n; i+=SUM_LANES) { \
+      for (k=0; k<SUM_LANES; k+=V ## W ## _WIDTH) { \
+         vy = V ## W ## _ADD(V ## W ## _MUL(vb, V ## W ## _LOAD(&y[i+k])), \
+                             V ## W ## _MUL(va, V ## W ## _LOAD(&x[i+k]))); \
+         vz = V ## W ## _ADD(V ## W ## _LOAD(&z[i+k]), vy); \
+         V ## W ## _STORE(&y[i+k], vy); \
+         V ## W ## _STORE(&z[i+k], vz); \
+         V ## W ## _STORE(&sum[k], V ## W ## _ADD(V ## W ## _LOAD(&sum[k]), \
+                  V ## W ## _MUL(vz, vz))); \
+      } \
+   } \
+   return i; \
+}
+
+/* y = y + alpha*x; sum += y.*y */
+
+#define AXPY_SQNORM_KERNEL(W, ISA) \
+__attribute__((target(ISA))) \
+static PRIMME_INT axpy_sqnorm_v ## W(PRIMME_INT n, REAL alpha, REAL *x, \
+      REAL *y, REAL *sum) { \
+   V ## W va = V ## W ## _SET1(alpha), vy; \
+   PRIMME_INT i; \
+   int k; \
+   for (i=0; i+SUM_LANES<=n; i+=SUM_LANES) { \
+      for (k=0; k<SUM_LANES; k+=V ## W ## _WIDTH) { \
+         vy = V ## W ## _ADD(V ## W ## _LOAD(&y[i+k]), \
+                             V ## W ## _MUL(va, V ## W ## _LOAD(&x[i+k]))); \
+         V ## W ## _STORE(&y[i+k], vy); \
+         V ## W ## _STORE(&sum[k], V ## W ## _ADD(V ## W ## _LOAD(&sum[k]), \
+                  V ## W ## _MUL(vy, vy))); \
+      } \
+   } \
+   return i; \
+}
+
+/* delta = gamma*delta + eta*d; sol = sol + delta; w = w + beta*d */
+
+#define UPDATE_QMR_KERNEL(W, ISA) \
+__attribute__((target(ISA))) \
+static PRIMME_INT update_qmr_v ## W(PRIMME_INT n, REAL gamma, REAL eta, \
+      REAL beta, REAL *d, REAL *delta, REAL *sol, REAL *w) { \
+   V ## W vg = V ## W ## _SET1(gamma), ve = V ## W ## _SET1(eta); \
+   V ## W vb = V ## W ## _SET1(beta), vd, vdelta; \
+   PRIMME_INT i; \
+   for (i=0; i+V ## W ## _WIDTH<=n; i+=V ## W ## _WIDTH) { \
+      vd = V ## W ## _LOAD(&d[i]); \
+      vdelta = V ## W ## _ADD(V ## W ## _MUL(vg, V ## W ## _LOAD(&delta[i])), \
+                              V ## W ## _MUL(ve, vd)); \
+      V ## W ## _STORE(&delta[i], vdelta); \
+      V ## W ## _STORE(&sol[i], V ## W ## _ADD(V ## W ## _LOAD(&sol[i]), \
+               vdelta)); \
+      V ## W ## _STORE(&w[i], V ## W ## _ADD(V ## W ## _LOAD(&w[i]), \
+               V ## W ## _MUL(vb, vd))); \
+   } \
+   return i; \
+}
+
+AXPBY_ACCUM_KERNEL(256, "avx2")
+AXPBY_ACCUM_KERNEL(512, "avx512f")
+AXPY_SQNORM_KERNEL(256, "avx2")
+AXPY_SQNORM_KERNEL(512, "avx512f")
+UPDATE_QMR_KERNEL(256, "avx2")
+UPDATE_QMR_KERNEL(512, "avx512f")
+
+#endif /* USE_SIMD_X86 */
+
 /******************************************************************************
  * Function Num_copy_matrix - Copy the matrix x into y
  *
@@ -62,7 +226,7 @@ TEMPLATE_PLEASE
 void Num_copy_matrix_Sprimme(SCALAR *x, PRIMME_INT m, PRIMME_INT n, PRIMME_INT
       ldx, SCALAR *y, PRIMME_INT ldy) {
 
-   PRIMME_INT i,j;
+   PRIMME_INT i;
 
    assert(m == 0 || n == 0 || (ldx >= m && ldy >= m));
 
@@ -83,16 +247,14 @@ void Num_copy_matrix_Sprimme(SCALAR *x, PRIMME_INT m, PRIMME_INT n, PRIMME_INT
    /* Copy the matrix some columns forward */
    else if (ldx == ldy && y > x && y-x > ldx) {
       for (i=n-1; i>=0; i--)
-         for (j=0; j<m; j++)
-            y[i*ldy+j] = x[i*ldx+j];
+         memcpy(&y[i*ldy], &x[i*ldx], sizeof(SCALAR)*m);
    }
 
    /* Copy the matrix some columns backward, and other cases */
    else {
       /* TODO: assert x and y don't overlap */
       for (i=0; i<n; i++)
-         for (j=0; j<m; j++)
-            y[i*ldy+j] = x[i*ldx+j];
+         memmove(&y[i*ldy], &x[i*ldx], sizeof(SCALAR)*m);
    }
 
 }
@@ -112,8 +274,6 @@ void Num_copy_matrix_Sprimme(SCALAR *x, PRIMME_INT m, PRIMME_INT n, PRIMME_INT
  * ldy         The leading dimension of y
  *
  * NOTE: x(xin) and y(yin) *cannot* overlap
- * WARNING: compilers weren't able to optimize xin or yin being NULL;
- *    please use Num_copy_matrix as much as possible.
  *
  ******************************************************************************/
 
@@ -122,12 +282,10 @@ void Num_copy_matrix_columns_Sprimme(SCALAR *x, PRIMME_INT m, int *xin, int n,
       PRIMME_INT ldx, SCALAR *y, int *yin, PRIMME_INT ldy) {
 
    int i;
-   PRIMME_INT j;
 
    /* TODO: assert x and y don't overlap */
    for (i=0; i<n; i++)
-      for (j=0; j<m; j++)
-         y[(yin?yin[i]:i)*ldy+j] = x[(xin?xin[i]:i)*ldx+j];
+      memcpy(&y[(yin?yin[i]:i)*ldy], &x[(xin?xin[i]:i)*ldx], sizeof(SCALAR)*m);
 }
 
 /******************************************************************************
@@ -146,11 +304,17 @@ TEMPLATE_PLEASE
 void Num_zero_matrix_Sprimme(SCALAR *x, PRIMME_INT m, PRIMME_INT n,
       PRIMME_INT ldx) {
 
-   PRIMME_INT i,j;
+   PRIMME_INT i;
 
-   for (i=0; i<n; i++)
-      for (j=0; j<m; j++)
-         x[i*ldx+j] = 0.0;
+   /* All bits zero is the zero of the IEEE floating-point types */
+
+   if (ldx == m) {
+      memset(x, 0, sizeof(SCALAR)*m*n);
+   }
+   else {
+      for (i=0; i<n; i++)
+         memset(&x[i*ldx], 0, sizeof(SCALAR)*m);
+   }
 } 
 
 
@@ -354,7 +518,7 @@ void permute_vecs_Sprimme(SCALAR *vecs, PRIMME_INT m, int n, PRIMME_INT ld,
       }
 
       /* Copy the vector to a buffer for swapping */
-      Num_copy_Sprimme(m, &vecs[currentIndex*ld], 1, rwork, 1);
+      memcpy(rwork, &vecs[currentIndex*ld], sizeof(SCALAR)*m);
 
       destinationIndex = currentIndex;
       /* Copy vector perm[destinationIndex] into position destinationIndex */
@@ -362,15 +526,15 @@ void permute_vecs_Sprimme(SCALAR *vecs, PRIMME_INT m, int n, PRIMME_INT ld,
       while (perm[destinationIndex] != currentIndex) {
 
          sourceIndex = perm[destinationIndex];
-         Num_copy_Sprimme(m, &vecs[sourceIndex*ld], 1, 
-            &vecs[destinationIndex*ld], 1);
+         memcpy(&vecs[destinationIndex*ld], &vecs[sourceIndex*ld],
+               sizeof(SCALAR)*m);
          tempIndex = perm[destinationIndex];
          perm[destinationIndex] = destinationIndex;
          destinationIndex = tempIndex;
       }
 
       /* Copy the vector from the buffer to where it belongs */
-      Num_copy_Sprimme(m, rwork, 1, &vecs[destinationIndex*ld], 1);
+      memcpy(&vecs[destinationIndex*ld], rwork, sizeof(SCALAR)*m);
       perm[destinationIndex] = destinationIndex;
 
       currentIndex++;
@@ -543,8 +707,149 @@ int compute_submatrix_Sprimme(SCALAR *X, int nX, int ldX,
 
    Num_hemm_Sprimme("L", "U", nH, nX, 1.0, H, ldH, X, ldX, 0.0, rwork, nH);
    
-   Num_gemm_Sprimme("C", "N", nX, nX, nH, 1.0, X, ldX, rwork, nH, 0.0, R, 
+   Num_gemmt_Sprimme("U", "C", "N", nX, nH, 1.0, X, ldX, rwork, nH, 0.0, R, 
       ldR);
 
    return 0;
 }
+
+/******************************************************************************
+ * Function sum_lanes - Return the sum of the SUM_LANES partial sums
+ ******************************************************************************/
+
+static REAL sum_lanes(REAL *sum) {
+   REAL s = 0.0;
+   int k;
+
+   for (k=0; k<SUM_LANES; k++) s += sum[k];
+   return s;
+}
+
+/******************************************************************************
+ * Function Num_axpby_accum - Update y = alpha*x + beta*y and accumulate the
+ *    result in z = z + y, in a single pass
+ *
+ * PARAMETERS
+ * ---------------------------
+ * m           The length of the vectors
+ * alpha       Real factor of x
+ * x           Input vector
+ * beta        Real factor of y
+ * y           Input/output vector
+ * z           Input/output vector
+ *
+ * RETURN
+ * ------
+ * The squared 2-norm of the updated z
+ *
+ * NOTE: x, y and z *cannot* overlap
+ *
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+REAL Num_axpby_accum_Sprimme(PRIMME_INT m, REAL alpha, SCALAR *x, REAL beta,
+      SCALAR *y, SCALAR *z) {
+
+   REAL *rx = (REAL*)x, *ry = (REAL*)y, *rz = (REAL*)z;
+   REAL sum[SUM_LANES];
+   PRIMME_INT i=0, n=m*(PRIMME_INT)(sizeof(SCALAR)/sizeof(REAL));
+
+   for (i=0; i<SUM_LANES; i++) sum[i] = 0.0;
+   i = 0;
+
+#ifdef USE_SIMD_X86
+   switch(simd_level()) {
+   case SIMD_AVX512: i = axpby_accum_v512(n, alpha, rx, beta, ry, rz, sum); break;
+   case SIMD_AVX2:   i = axpby_accum_v256(n, alpha, rx, beta, ry, rz, sum); break;
+   }
+#endif
+
+   for (; i<n; i++) {
+      ry[i] = beta*ry[i] + alpha*rx[i];
+      rz[i] += ry[i];
+      sum[i%SUM_LANES] += rz[i]*rz[i];
+   }
+
+   return sum_lanes(sum);
+}
+
+/******************************************************************************
+ * Function Num_axpy_sqnorm - Update y = y + alpha*x and return the squared
+ *    2-norm of the updated y, in a single pass
+ *
+ * PARAMETERS
+ * ---------------------------
+ * m           The length of the vectors
+ * alpha       Real factor of x
+ * x           Input vector
+ * y           Input/output vector
+ *
+ * NOTE: x and y *cannot* overlap
+ *
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+REAL Num_axpy_sqnorm_Sprimme(PRIMME_INT m, REAL alpha, SCALAR *x, SCALAR *y) {
+
+   REAL *rx = (REAL*)x, *ry = (REAL*)y;
+   REAL sum[SUM_LANES];
+   PRIMME_INT i=0, n=m*(PRIMME_INT)(sizeof(SCALAR)/sizeof(REAL));
+
+   for (i=0; i<SUM_LANES; i++) sum[i] = 0.0;
+   i = 0;
+
+#ifdef USE_SIMD_X86
+   switch(simd_level()) {
+   case SIMD_AVX512: i = axpy_sqnorm_v512(n, alpha, rx, ry, sum); break;
+   case SIMD_AVX2:   i = axpy_sqnorm_v256(n, alpha, rx, ry, sum); break;
+   }
+#endif
+
+   for (; i<n; i++) {
+      ry[i] = ry[i] + alpha*rx[i];
+      sum[i%SUM_LANES] += ry[i]*ry[i];
+   }
+
+   return sum_lanes(sum);
+}
+
+/******************************************************************************
+ * Function Num_update_qmr - Update the vectors of the QMR recurrence in
+ *    inner_solve in a single pass:
+ *
+ *       delta = gamma*delta + eta*d; sol = sol + delta; w = w + beta*d
+ *
+ * PARAMETERS
+ * ---------------------------
+ * m           The length of the vectors
+ * gamma, eta, beta  Real factors
+ * d           Input vector
+ * delta, sol, w  Input/output vectors
+ *
+ * NOTE: d, delta, sol and w *cannot* overlap
+ *
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+void Num_update_qmr_Sprimme(PRIMME_INT m, REAL gamma, REAL eta, REAL beta,
+      SCALAR *d, SCALAR *delta, SCALAR *sol, SCALAR *w) {
+
+   REAL *rd = (REAL*)d, *rdelta = (REAL*)delta, *rsol = (REAL*)sol;
+   REAL *rw = (REAL*)w;
+   PRIMME_INT i=0, n=m*(PRIMME_INT)(sizeof(SCALAR)/sizeof(REAL));
+
+#ifdef USE_SIMD_X86
+   switch(simd_level()) {
+   case SIMD_AVX512:
+      i = update_qmr_v512(n, gamma, eta, beta, rd, rdelta, rsol, rw); break;
+   case SIMD_AVX2:
+      i = update_qmr_v256(n, gamma, eta, beta, rd, rdelta, rsol, rw); break;
+   }
+#endif
+
+   for (; i<n; i++) {
+      rdelta[i] = gamma*rdelta[i] + eta*rd[i];
+      rsol[i] += rdelta[i];
+      rw[i] = rw[i] + beta*rd[i];
+   }
+}
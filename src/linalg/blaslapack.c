@@ -100,6 +100,71 @@ void Num_gemm_Sprimme(const char *transa, const char *transb, int m, int n,
 
 }
 
+/*******************************************************************************
+ * Subroutine Num_gemmt_Sprimme - C = op(A)*op(B), with C size n x n, updating
+ *    only the upper (uplo "U") or lower (uplo "L") triangular part of C. It is
+ *    meant for products known to be Hermitian, such as V'*A*V.
+ *
+ *    It calls xGEMMT if the BLAS provides it (compile with -DUSE_GEMMT);
+ *    otherwise the triangle is computed by panels of PRIMME_GEMMT_BLOCK
+ *    columns with xGEMM, and only the diagonal blocks are computed in full.
+ ******************************************************************************/
+
+#ifndef PRIMME_GEMMT_BLOCK
+#  define PRIMME_GEMMT_BLOCK 64
+#endif
+
+TEMPLATE_PLEASE
+void Num_gemmt_Sprimme(const char *uplo, const char *transa,
+      const char *transb, int n, int k, SCALAR alpha, SCALAR *a, int lda,
+      SCALAR *b, int ldb, SCALAR beta, SCALAR *c, int ldc) {
+
+#if defined(USE_GEMMT) && !defined(NUM_CRAY)
+   PRIMME_BLASINT ln = n;
+   PRIMME_BLASINT lk = k;
+   PRIMME_BLASINT llda = lda;
+   PRIMME_BLASINT lldb = ldb;
+   PRIMME_BLASINT lldc = ldc;
+
+   /* Zero dimension matrix may cause problems */
+   if (n == 0) return;
+
+   /* Quick exit */
+   if (k == 0) {
+      Num_zero_matrix_Sprimme(c, n, n, ldc);
+      return;
+   }
+
+   XGEMMT(uplo, transa, transb, &ln, &lk, &alpha, a, &llda, b, &lldb, &beta,
+         c, &lldc);
+
+#else
+   int j, jb;
+   int notransa = (*transa == 'n' || *transa == 'N');
+   int notransb = (*transb == 'n' || *transb == 'N');
+   int upper = (*uplo == 'u' || *uplo == 'U');
+
+   for (j=0; j<n; j+=PRIMME_GEMMT_BLOCK) {
+      jb = min(PRIMME_GEMMT_BLOCK, n-j);
+
+      /* C(0:j+jb-1,j:j+jb-1) or C(j:n-1,j:j+jb-1) */
+
+      if (upper) {
+         Num_gemm_Sprimme(transa, transb, j+jb, jb, k, alpha, a, lda,
+               notransb ? &b[(size_t)ldb*j] : &b[j], ldb, beta,
+               &c[(size_t)ldc*j], ldc);
+      }
+      else {
+         Num_gemm_Sprimme(transa, transb, n-j, jb, k, alpha,
+               notransa ? &a[j] : &a[(size_t)lda*j], lda,
+               notransb ? &b[(size_t)ldb*j] : &b[j], ldb, beta,
+               &c[(size_t)ldc*j+j], ldc);
+      }
+   }
+#endif
+
+}
+
 /*******************************************************************************
  * Subroutine Num_gemm_Sprimme - C = A*B or B*A where A is Hermitian,
  *    where C size m x n.
@@ -442,6 +507,127 @@ void Num_heev_Sprimme(const char *jobz, const char *uplo, int n, SCALAR *a,
 #  endif
 #endif
 
+/*******************************************************************************
+ * Subroutine Num_hetrd_Sprimme - reduce a Hermitian matrix to real symmetric
+ *    tridiagonal form, A = Q*T*Q', with xHETRD
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+#ifndef NUM_ESSL
+void Num_hetrd_Sprimme(const char *uplo, int n, SCALAR *a, int lda, REAL *d,
+      REAL *e, SCALAR *tau, SCALAR *work, int ldwork, int *info) {
+
+   PRIMME_BLASINT ln = n;
+   PRIMME_BLASINT llda = lda;
+   PRIMME_BLASINT lldwork = ldwork;
+   PRIMME_BLASINT linfo = 0;
+
+   /* Zero dimension matrix may cause problems */
+   if (n == 0) return;
+
+#ifdef NUM_CRAY
+   _fcd uplo_fcd;
+
+   uplo_fcd = _cptofcd(uplo, strlen(uplo));
+   XHETRD(uplo_fcd, &ln, a, &llda, d, e, tau, work, &lldwork, &linfo);
+#else
+   XHETRD(uplo, &ln, a, &llda, d, e, tau, work, &lldwork, &linfo);
+#endif
+   *info = (int)linfo;
+}
+#endif
+
+/*******************************************************************************
+ * Subroutine Num_stemr_Sprimme - eigenpairs il to iu (1-based), or all if
+ *    range is "A", of a real symmetric tridiagonal matrix with xSTEMR (MRRR).
+ *    d and e are overwritten; work should have 18*n positions.
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+#ifndef NUM_ESSL
+void Num_stemr_Sprimme(const char *jobz, const char *range, int n, REAL *d,
+      REAL *e, int il, int iu, int *m, REAL *w, SCALAR *z, int ldz,
+      REAL *work, int lwork, int *info) {
+
+   PRIMME_BLASINT ln = n;
+   PRIMME_BLASINT lil = il;
+   PRIMME_BLASINT liu = iu;
+   PRIMME_BLASINT lm = 0;
+   PRIMME_BLASINT lldz = ldz;
+   PRIMME_BLASINT lnzc = *range == 'I' ? iu - il + 1 : n;
+   PRIMME_BLASINT ltryrac = 0;
+   PRIMME_BLASINT llwork = lwork;
+   PRIMME_BLASINT lliwork = max(1, 10*n);
+   PRIMME_BLASINT *lisuppz, *liwork;
+   PRIMME_BLASINT linfo = 0;
+   REAL vl = 0.0, vu = 0.0;
+
+   /* Zero dimension matrix may cause problems */
+   if (n == 0) return;
+
+   if (MALLOC_PRIMME(2*n + lliwork, &lisuppz) != 0) {
+      *info = -1;
+      return;
+   }
+   liwork = lisuppz + 2*n;
+
+#ifdef NUM_CRAY
+   _fcd jobz_fcd, range_fcd;
+
+   jobz_fcd = _cptofcd(jobz, strlen(jobz));
+   range_fcd = _cptofcd(range, strlen(range));
+
+   XSTEMR(jobz_fcd, range_fcd, &ln, d, e, &vl, &vu, &lil, &liu, &lm, w, z,
+         &lldz, &lnzc, lisuppz, &ltryrac, work, &llwork, liwork, &lliwork,
+         &linfo);
+#else
+   XSTEMR(jobz, range, &ln, d, e, &vl, &vu, &lil, &liu, &lm, w, z, &lldz,
+         &lnzc, lisuppz, &ltryrac, work, &llwork, liwork, &lliwork, &linfo);
+#endif
+   free(lisuppz);
+   *m = (int)lm;
+   *info = (int)linfo;
+}
+#endif
+
+/*******************************************************************************
+ * Subroutine Num_unmtr_Sprimme - apply the Q from Num_hetrd_Sprimme to a
+ *    matrix with xUNMTR
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+#ifndef NUM_ESSL
+void Num_unmtr_Sprimme(const char *side, const char *uplo, const char *trans,
+      int m, int n, SCALAR *a, int lda, SCALAR *tau, SCALAR *c, int ldc,
+      SCALAR *work, int ldwork, int *info) {
+
+   PRIMME_BLASINT lm = m;
+   PRIMME_BLASINT ln = n;
+   PRIMME_BLASINT llda = lda;
+   PRIMME_BLASINT lldc = ldc;
+   PRIMME_BLASINT lldwork = ldwork;
+   PRIMME_BLASINT linfo = 0;
+
+   /* Zero dimension matrix may cause problems */
+   if (m == 0 || n == 0) return;
+
+#ifdef NUM_CRAY
+   _fcd side_fcd, uplo_fcd, trans_fcd;
+
+   side_fcd = _cptofcd(side, strlen(side));
+   uplo_fcd = _cptofcd(uplo, strlen(uplo));
+   trans_fcd = _cptofcd(trans, strlen(trans));
+
+   XUNMTR(side_fcd, uplo_fcd, trans_fcd, &lm, &ln, a, &llda, tau, c, &lldc,
+         work, &lldwork, &linfo);
+#else
+   XUNMTR(side, uplo, trans, &lm, &ln, a, &llda, tau, c, &lldc, work,
+         &lldwork, &linfo);
+#endif
+   *info = (int)linfo;
+}
+#endif
+
 /*******************************************************************************
  * Subroutines for dense singular value decomposition
  ******************************************************************************/
@@ -597,6 +783,102 @@ void Num_hetrs_Sprimme(const char *uplo, int n, int nrhs, SCALAR *a,
    *info = (int)linfo;
 }
 
+/*******************************************************************************
+ * Subroutine Num_getrf_Sprimme - LU factorization with partial pivoting
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+void Num_getrf_Sprimme(int m, int n, SCALAR *a, int lda, int *ipivot,
+      int *info) {
+
+   PRIMME_BLASINT lm = m;
+   PRIMME_BLASINT ln = n;
+   PRIMME_BLASINT llda = lda;
+   PRIMME_BLASINT *lipivot;
+   PRIMME_BLASINT linfo = 0;
+   int i;
+
+   /* Zero dimension matrix may cause problems */
+   if (m == 0 || n == 0) return;
+
+   if (sizeof(int) != sizeof(PRIMME_BLASINT)) {
+      if (MALLOC_PRIMME(min(m, n), &lipivot) != 0) {
+         *info = -1;
+         return;
+      }
+   } else {
+      lipivot = (PRIMME_BLASINT *)ipivot; /* cast avoid compiler warning */
+   }
+
+   XGETRF(&lm, &ln, a, &llda, lipivot, &linfo);
+
+   if (sizeof(int) != sizeof(PRIMME_BLASINT)) {
+      if (ipivot) for(i=0; i<min(m, n); i++)
+         ipivot[i] = (int)lipivot[i];
+      free(lipivot);
+   }
+   *info = (int)linfo;
+}
+
+/*******************************************************************************
+ * Subroutine Num_gecon_Sprimme - estimate the reciprocal of the condition
+ *    number of a matrix in the 1-norm ("1") or the infinity-norm ("I") from its
+ *    LU factors computed by Num_getrf. anorm is the norm of the original
+ *    matrix. work should have size 4*n and iwork size n.
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+void Num_gecon_Sprimme(const char *norm, int n, SCALAR *a, int lda, REAL anorm,
+      REAL *rcond, SCALAR *work, int *iwork, int *info) {
+
+   PRIMME_BLASINT ln = n;
+   PRIMME_BLASINT llda = lda;
+   PRIMME_BLASINT *liwork;
+   PRIMME_BLASINT linfo = 0;
+#ifdef NUM_CRAY
+   _fcd norm_fcd;
+#endif
+
+   /* Zero dimension matrix may cause problems */
+   if (n == 0) {
+      *rcond = 1.0;
+      *info = 0;
+      return;
+   }
+
+   if (sizeof(int) != sizeof(PRIMME_BLASINT)) {
+      if (MALLOC_PRIMME(n, &liwork) != 0) {
+         *info = -1;
+         return;
+      }
+   } else {
+      liwork = (PRIMME_BLASINT *)iwork; /* cast avoid compiler warning */
+   }
+
+#ifdef NUM_CRAY
+   norm_fcd = _cptofcd(norm, strlen(norm));
+#  ifndef USE_COMPLEX
+   XGECON(norm_fcd, &ln, a, &llda, &anorm, rcond, work, liwork, &linfo);
+#  else
+   XGECON(norm_fcd, &ln, a, &llda, &anorm, rcond, work, (REAL*)&work[2*n],
+         &linfo);
+#  endif
+#else
+#  ifndef USE_COMPLEX
+   XGECON(norm, &ln, a, &llda, &anorm, rcond, work, liwork, &linfo);
+#  else
+   /* The complex version takes 2*n SCALARs and 2*n REALs */
+   XGECON(norm, &ln, a, &llda, &anorm, rcond, work, (REAL*)&work[2*n],
+         &linfo);
+#  endif
+#endif
+
+   if (sizeof(int) != sizeof(PRIMME_BLASINT)) {
+      free(liwork);
+   }
+   *info = (int)linfo;
+}
+
 /*******************************************************************************
  * Subroutine Num_trsm_Sprimme - b = op(A)\b
  ******************************************************************************/
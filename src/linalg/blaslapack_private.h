@@ -78,6 +78,7 @@
 #define XCOPY     LAPACK_FUNCTION(scopy , ccopy , dcopy , zcopy )   
 #define XSWAP     LAPACK_FUNCTION(sswap , cswap , dswap , zswap )
 #define XGEMM     LAPACK_FUNCTION(sgemm , cgemm , dgemm , zgemm )
+#define XGEMMT    LAPACK_FUNCTION(sgemmt, cgemmt, dgemmt, zgemmt)
 #define XTRMM     LAPACK_FUNCTION(strmm , ctrmm , dtrmm , ztrmm )
 #define XTRSM     LAPACK_FUNCTION(strsm , ctrsm , dtrsm , ztrsm )
 #define XHEMM     LAPACK_FUNCTION(ssymm , chemm , dsymm , zhemm )
@@ -88,9 +89,14 @@
 #define XSCAL     LAPACK_FUNCTION(sscal , cscal , dscal , zscal )
 #define XLARNV    LAPACK_FUNCTION(slarnv, clarnv, dlarnv, zlarnv)
 #define XHEEV     LAPACK_FUNCTION(ssyev , cheev , dsyev , zheev )
+#define XHETRD    LAPACK_FUNCTION(ssytrd, chetrd, dsytrd, zhetrd)
+#define XSTEMR    LAPACK_FUNCTION(sstemr, cstemr, dstemr, zstemr)
+#define XUNMTR    LAPACK_FUNCTION(sormtr, cunmtr, dormtr, zunmtr)
 #define XGESVD    LAPACK_FUNCTION(sgesvd, cgesvd, dgesvd, zgesvd)
 #define XHETRF    LAPACK_FUNCTION(ssytrf, chetrf, dsytrf, zhetrf)
 #define XHETRS    LAPACK_FUNCTION(ssytrs, chetrs, dsytrs, zhetrs)
+#define XGETRF    LAPACK_FUNCTION(sgetrf, cgetrf, dgetrf, zgetrf)
+#define XGECON    LAPACK_FUNCTION(sgecon, cgecon, dgecon, zgecon)
 #define XLAMCH    LAPACK_FUNCTION(slamch, clamch, dlamch, zlamch)
 
 #ifdef NUM_ESSL
@@ -122,9 +128,14 @@
 #define XSCAL  LAPACK_FUNCTION(SSCAL  , zscal )
 #define XLARNV LAPACK_FUNCTION(SLARNV ,       )
 #define XSYEV  LAPACK_FUNCTION(SSYEV  , zheev )
+#define XHETRD LAPACK_FUNCTION(SSYTRD , zhetrd)
+#define XSTEMR LAPACK_FUNCTION(SSTEMR , zstemr)
+#define XUNMTR LAPACK_FUNCTION(SORMTR , zunmtr)
 #define XGESVD LAPACK_FUNCTION(SGESVD , zhetrf)
 #define XSYTRF LAPACK_FUNCTION(SSYTRF , zgesvd)
 #define XSYTRS LAPACK_FUNCTION(SSYTRS , zhetrs)
+#define XGETRF LAPACK_FUNCTION(SGETRF , zgetrf)
+#define XGECON LAPACK_FUNCTION(SGECON , zgecon)
 
 #endif /* NUM_CRAY */
 
@@ -141,6 +152,9 @@ extern "C" {
 void XCOPY(PRIMME_BLASINT *n, SCALAR *x, PRIMME_BLASINT *incx, SCALAR *y, PRIMME_BLASINT *incy);
 void XSWAP(PRIMME_BLASINT *n, SCALAR *x, PRIMME_BLASINT *incx, SCALAR *y, PRIMME_BLASINT *incy);
 void XGEMM(STRING transa, STRING transb, PRIMME_BLASINT *m, PRIMME_BLASINT *n, PRIMME_BLASINT *k, SCALAR *alpha, SCALAR *a, PRIMME_BLASINT *lda, SCALAR *b, PRIMME_BLASINT *ldb, SCALAR *beta, SCALAR *c, PRIMME_BLASINT *ldc);
+#ifdef USE_GEMMT
+void XGEMMT(STRING uplo, STRING transa, STRING transb, PRIMME_BLASINT *n, PRIMME_BLASINT *k, SCALAR *alpha, SCALAR *a, PRIMME_BLASINT *lda, SCALAR *b, PRIMME_BLASINT *ldb, SCALAR *beta, SCALAR *c, PRIMME_BLASINT *ldc);
+#endif
 void XGEMV(STRING transa, PRIMME_BLASINT *m, PRIMME_BLASINT *n, SCALAR *alpha, SCALAR *a, PRIMME_BLASINT *lda, SCALAR *x, PRIMME_BLASINT *incx, SCALAR *beta, SCALAR *y, PRIMME_BLASINT *incy);
 void XTRMM(STRING side, STRING uplo, STRING transa, STRING diag, PRIMME_BLASINT *m, PRIMME_BLASINT *n, SCALAR *alpha, SCALAR *a, PRIMME_BLASINT *lda, SCALAR *b, PRIMME_BLASINT *ldb);
 void XTRSM(STRING side, STRING uplo, STRING transa, STRING diag, PRIMME_BLASINT *m, PRIMME_BLASINT *n, SCALAR *alpha, SCALAR *a, PRIMME_BLASINT *lda, SCALAR *b, PRIMME_BLASINT *ldb);
@@ -155,11 +169,20 @@ void XGESVD(STRING jobu, STRING jobvt, PRIMME_BLASINT *m, PRIMME_BLASINT *n, SCA
 void XHEEV(STRING jobz, STRING uplo, PRIMME_BLASINT *n, SCALAR *a, PRIMME_BLASINT *lda, REAL *w, SCALAR *work, PRIMME_BLASINT *ldwork, REAL *rwork, PRIMME_BLASINT *info);
 void XGESVD(STRING jobu, STRING jobvt, PRIMME_BLASINT *m, PRIMME_BLASINT *n, SCALAR *a, PRIMME_BLASINT *lda, REAL *s, SCALAR *u, PRIMME_BLASINT *ldu, SCALAR *vt, PRIMME_BLASINT *ldvt, SCALAR *work, PRIMME_BLASINT *ldwork, REAL *rwork, PRIMME_BLASINT *info);
 #endif
+void XHETRD(STRING uplo, PRIMME_BLASINT *n, SCALAR *a, PRIMME_BLASINT *lda, REAL *d, REAL *e, SCALAR *tau, SCALAR *work, PRIMME_BLASINT *ldwork, PRIMME_BLASINT *info);
+void XSTEMR(STRING jobz, STRING range, PRIMME_BLASINT *n, REAL *d, REAL *e, REAL *vl, REAL *vu, PRIMME_BLASINT *il, PRIMME_BLASINT *iu, PRIMME_BLASINT *m, REAL *w, SCALAR *z, PRIMME_BLASINT *ldz, PRIMME_BLASINT *nzc, PRIMME_BLASINT *isuppz, PRIMME_BLASINT *tryrac, REAL *work, PRIMME_BLASINT *lwork, PRIMME_BLASINT *iwork, PRIMME_BLASINT *liwork, PRIMME_BLASINT *info);
+void XUNMTR(STRING side, STRING uplo, STRING trans, PRIMME_BLASINT *m, PRIMME_BLASINT *n, SCALAR *a, PRIMME_BLASINT *lda, SCALAR *tau, SCALAR *c, PRIMME_BLASINT *ldc, SCALAR *work, PRIMME_BLASINT *ldwork, PRIMME_BLASINT *info);
 SCALAR XLAMCH(STRING cmach);
 void XSCAL(PRIMME_BLASINT *n, SCALAR *alpha, SCALAR *x, PRIMME_BLASINT *incx);
 void XLARNV(PRIMME_BLASINT *idist, PRIMME_BLASINT *iseed, PRIMME_BLASINT *n, SCALAR *x);
 void XHETRF(STRING uplo, PRIMME_BLASINT *n, SCALAR *a, PRIMME_BLASINT *lda, PRIMME_BLASINT *ipivot, SCALAR *work, PRIMME_BLASINT *ldwork, PRIMME_BLASINT *info);
 void XHETRS(STRING uplo, PRIMME_BLASINT *n, PRIMME_BLASINT *nrhs, SCALAR *a, PRIMME_BLASINT *lda, PRIMME_BLASINT *ipivot, SCALAR *b, PRIMME_BLASINT *ldb, PRIMME_BLASINT *info);
+void XGETRF(PRIMME_BLASINT *m, PRIMME_BLASINT *n, SCALAR *a, PRIMME_BLASINT *lda, PRIMME_BLASINT *ipivot, PRIMME_BLASINT *info);
+#ifndef USE_COMPLEX
+void XGECON(STRING norm, PRIMME_BLASINT *n, SCALAR *a, PRIMME_BLASINT *lda, SCALAR *anorm, SCALAR *rcond, SCALAR *work, PRIMME_BLASINT *iwork, PRIMME_BLASINT *info);
+#else
+void XGECON(STRING norm, PRIMME_BLASINT *n, SCALAR *a, PRIMME_BLASINT *lda, REAL *anorm, REAL *rcond, SCALAR *work, REAL *rwork, PRIMME_BLASINT *info);
+#endif
 
 #ifdef NUM_ESSL
 #  ifdef USE_DOUBLE
@@ -40,6 +40,7 @@
 #include <assert.h>  
 #include "numerical.h"
 #include "../eigs/ortho.h"
+#include "../eigs/arena.h"
 #include "wtime.h"
 #include "primme_interface.h"
 #include "primme_svds_interface.h"
@@ -57,15 +58,31 @@ static void applyPreconditionerSVDS(void *x, PRIMME_INT *ldx, void *y,
       PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *ierr);
 static void matrixMatvecSVDS(void *x_, PRIMME_INT *ldx, void *y_,
       PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *ierr);
+static void matrixMatvecUser(void *x, PRIMME_INT *ldx, void *y,
+      PRIMME_INT *ldy, int *blockSize, int *transpose,
+      primme_svds_params *primme_svds, int *ierr);
 static void Num_scalInv_Smatrix(SCALAR *x, PRIMME_INT m, int n, PRIMME_INT ldx, REAL *factors,
                                        primme_svds_params *primme_svds);
 static int allocate_workspace_svds(primme_svds_params *primme_svds, int allocate);
+static void release_workspace_svds(primme_svds_params *primme_svds);
+static int shifts_size_svds(primme_svds_params *primme_svds);
+static int call_primme_stages(REAL *svals, SCALAR *svecs, REAL *resNorms,
+      primme_svds_params *primme_svds);
+static size_t matrixMatvecStreaming_worksize(int blockSize, int AtA,
+      primme_svds_params *primme_svds);
+static int matrixMatvecStreaming(SCALAR *x, PRIMME_INT ldx, SCALAR *y,
+      PRIMME_INT ldy, int blockSize, int AtA, SCALAR *rwork, size_t rworkSize,
+      primme_svds_params *primme_svds);
 static int globalSum_Rprimme_svds(REAL *sendBuf, REAL *recvBuf, int count, 
       primme_svds_params *primme_svds);
 static void convTestFunAugmented(double *eval, void *evec, double *rNorm, int *isConv,
    primme_params *primme, int *ierr);
 static void convTestFunATA(double *eval, void *evec, double *rNorm, int *isConv,
    primme_params *primme, int *ierr);
+static void monitorFunSVDS(void *basisEvals, int *basisSize, int *basisFlags,
+      int *iblock, int *blockSize, void *blockNorms, int *numConverged,
+      void *lockedEvals, int *numLocked, void *lockedNorms,
+      primme_event *event, int *stop, primme_params *primme, int *ierr);
 
 /*******************************************************************************
  * Subroutine Sprimme_svds - This routine is a front end used to perform 
@@ -107,8 +124,7 @@ static void convTestFunATA(double *eval, void *evec, double *rNorm, int *isConv,
 int Sprimme_svds(REAL *svals, SCALAR *svecs, REAL *resNorms, 
       primme_svds_params *primme_svds) {
 
-   int ret, allocatedTargetShifts;
-   SCALAR *svecs0;
+   int ret;
 
    /* ------------------ */
    /* Set some defaults  */
@@ -142,6 +158,27 @@ int Sprimme_svds(REAL *svals, SCALAR *svecs, REAL *resNorms,
       return ALLOCATE_WORKSPACE_FAILURE;
    }
 
+   ret = call_primme_stages(svals, svecs, resNorms, primme_svds);
+   release_workspace_svds(primme_svds);
+   return ret;
+}
+
+/*******************************************************************************
+ * Function call_primme_stages - Call the eigensolver on the first and the
+ *    second stage with the workspace already allocated.
+ *
+ * Return Value
+ * ------------
+ * The same as Sprimme_svds
+ *
+ ******************************************************************************/
+
+static int call_primme_stages(REAL *svals, SCALAR *svecs, REAL *resNorms,
+      primme_svds_params *primme_svds) {
+
+   int ret, allocatedTargetShifts;
+   SCALAR *svecs0;
+
    /* --------------- */
    /* Execute stage 1 */
    /* --------------- */
@@ -196,7 +233,8 @@ static SCALAR* copy_last_params_from_svds(primme_svds_params *primme_svds, int s
    primme_params *primme;
    primme_svds_operator method;
    SCALAR *aux, *out_svecs = svecs;
-   int n, nMax, i, cut;
+   int n, nMax, i, shiftsSize;
+   size_t cut;   /* SCALARs of workspace for matrixMatvecSVDS */
    const double machEps = Num_lamch_Rprimme("E");
 
    primme = stage == 0 ? &primme_svds->primme : &primme_svds->primmeStage2;
@@ -246,6 +284,8 @@ static SCALAR* copy_last_params_from_svds(primme_svds_params *primme_svds, int s
       break;
    }
 
+   if (primme_svds->monitorFun) primme->monitorFun = monitorFunSVDS;
+
    /* Set properly initial vectors. Now svecs = [Uc U0 Vc V0], where          */
    /* Uc, m x numOrthoConst, left constrain vectors;                          */
    /* U0, m x initSize, left initial vectors;                                 */
@@ -270,13 +310,12 @@ static SCALAR* copy_last_params_from_svds(primme_svds_params *primme_svds, int s
    case primme_svds_op_augmented:
       /* Shuffle svecs so that svecs = [V; U] */
       assert(primme->nLocal == primme_svds->mLocal+primme_svds->nLocal);
-      CHKERRS(MALLOC_PRIMME(primme->nLocal*n, &aux), NULL);
+      aux = (SCALAR*)primme_svds->realWork + shifts_size_svds(primme_svds);
       Num_copy_Sprimme(primme->nLocal*n, svecs, 1, aux, 1);
       Num_copy_matrix_Sprimme(&aux[primme_svds->mLocal*n], primme_svds->nLocal,
          n, primme_svds->nLocal, svecs, primme->nLocal);
       Num_copy_matrix_Sprimme(aux, primme_svds->mLocal, n, primme_svds->mLocal,
          &svecs[primme_svds->nLocal], primme->nLocal);
-      free(aux);
       break;
    case primme_svds_op_none:
       break;
@@ -290,17 +329,26 @@ static SCALAR* copy_last_params_from_svds(primme_svds_params *primme_svds, int s
    primme->intWork = primme_svds->intWork;
    primme->intWorkSize = primme_svds->intWorkSize;
    /* If matrixMatvecSVDS is used, it needs extra space to compute A*A' or A'*A */
-   if ((primme->matrixMatvec == matrixMatvecSVDS) &&
+   /* or to stream the rows of A                                             */
+   if (primme->matrixMatvec == matrixMatvecSVDS && primme_svds->readRowBlock
+         && method == primme_svds_op_AtA) {
+      cut = matrixMatvecStreaming_worksize(primme->maxBlockSize, 1,
+            primme_svds);
+   }
+   else if ((primme->matrixMatvec == matrixMatvecSVDS) &&
        (method == primme_svds_op_AtA || method == primme_svds_op_AAt)) {
-      cut = primme->maxBlockSize * (method == primme_svds_op_AtA ?
+      cut = (size_t)primme->maxBlockSize * (method == primme_svds_op_AtA ?
                      primme_svds->mLocal : primme_svds->nLocal);
    }
    else {
       cut = 0;
    }
-   primme->realWork = (SCALAR*)primme_svds->realWork + cut;
-   assert(primme_svds->realWorkSize >= cut*sizeof(SCALAR));
-   primme->realWorkSize = primme_svds->realWorkSize - cut*sizeof(SCALAR);
+   /* The target shifts are stored at the beginning of the workspace */
+   shiftsSize = shifts_size_svds(primme_svds);
+   primme->realWork = (SCALAR*)primme_svds->realWork + shiftsSize + cut;
+   assert(primme_svds->realWorkSize >= (shiftsSize+cut)*sizeof(SCALAR));
+   primme->realWorkSize = primme_svds->realWorkSize
+      - (shiftsSize+cut)*sizeof(SCALAR);
  
    if ((stage == 0 && primme_svds->numTargetShifts > 0) ||
        (stage == 1 && primme->targetShifts == NULL &&
@@ -309,8 +357,7 @@ static SCALAR* copy_last_params_from_svds(primme_svds_params *primme_svds, int s
       if (stage == 0 &&
             (method == primme_svds_op_AtA || method == primme_svds_op_AAt)) {
          *allocatedTargetShifts = 1;
-         CHKERRS(MALLOC_PRIMME(primme_svds->numSvals, &primme->targetShifts),
-            NULL);
+         primme->targetShifts = (double*)primme_svds->realWork;
          for (i=0; i<primme->numTargetShifts; i++) {
             primme->targetShifts[i] = 
                primme_svds->targetShifts[i]*primme_svds->targetShifts[i];
@@ -325,8 +372,7 @@ static SCALAR* copy_last_params_from_svds(primme_svds_params *primme_svds, int s
 
       assert(method == primme_svds_op_augmented);
       *allocatedTargetShifts = 1;
-      CHKERRS(MALLOC_PRIMME(primme_svds->numSvals, &primme->targetShifts),
-            NULL);
+      primme->targetShifts = (double*)primme_svds->realWork;
 
       /* primme was configured to find the closest but greater values than */
       /* some shift. The eigensolver is not able to distinguish eigenvalues*/
@@ -353,7 +399,7 @@ static SCALAR* copy_last_params_from_svds(primme_svds_params *primme_svds, int s
          primme_svds->target == primme_svds_smallest &&
          primme->targetShifts == NULL) {
 
-      CHKERRS(MALLOC_PRIMME(1, &primme->targetShifts), NULL);
+      primme->targetShifts = (double*)primme_svds->realWork;
       *allocatedTargetShifts = 1;
       primme->targetShifts[0] = 0.0;
       primme->numTargetShifts = 1;
@@ -369,14 +415,14 @@ static SCALAR* copy_last_params_from_svds(primme_svds_params *primme_svds, int s
       if (primme_svds->m >= primme_svds->n) {
          Num_larnv_Sprimme(2, primme->iseed, primme_svds->mLocal,
                &svecs[primme_svds->nLocal]);
-         CHKERRMS((primme_svds->matrixMatvec(&svecs[primme_svds->nLocal],
+         CHKERRMS((matrixMatvecUser(&svecs[primme_svds->nLocal],
                      &primme_svds->mLocal, svecs, &primme_svds->nLocal, &ONE,
                      &TRANS, primme_svds, &ierr), ierr), NULL,
                "Error returned by 'matrixMatvec' %d", ierr);
       }
       else {
          Num_larnv_Sprimme(2, primme->iseed, primme_svds->nLocal, svecs);
-         CHKERRMS((primme_svds->matrixMatvec(svecs, &primme_svds->nLocal,
+         CHKERRMS((matrixMatvecUser(svecs, &primme_svds->nLocal,
                      &svecs[primme_svds->nLocal], &primme_svds->mLocal, &ONE,
                      &NOTRANS, primme_svds, &ierr), ierr), NULL,
                "Error returned by 'matrixMatvec' %d", ierr);
@@ -412,13 +458,11 @@ static SCALAR* copy_last_params_from_svds(primme_svds_params *primme_svds, int s
 
       /* Orthogonalize orthogonal constrain vectors */
 
-      SCALAR *rwork; 
-      CHKERRS(MALLOC_PRIMME(2*primme->numOrthoConst, &rwork), NULL);
+      SCALAR *rwork = (SCALAR*)primme_svds->realWork + shiftsSize;
       size_t rworkSize =  2*primme->numOrthoConst;
       CHKERRS(ortho_Sprimme(out_svecs, primme->nLocal, NULL, 0, 0,
                primme->numOrthoConst-1, NULL, 0, 0, primme->nLocal,
                primme->iseed, machEps, rwork, &rworkSize, primme), NULL);
-      free(rwork);
    }
 
    return out_svecs;
@@ -456,6 +500,10 @@ static int allocate_workspace_svds(primme_svds_params *primme_svds, int allocate
    primme_params primme;
    int intWorkSize=0;         /* Size of int work space */
    size_t realWorkSize=0;     /* Size of real work space */
+   size_t scratchSize;        /* Size of the space to shuffle svecs */
+   int nMax;                  /* Maximum number of columns in svecs */
+   int placement, hugePages;  /* Placement applied to realWork */
+   size_t ldBytes;            /* Bytes in a column of primme's V */
 
    /* Require workspace for 1st stage */
    if (primme_svds->method != primme_svds_op_none) {
@@ -464,7 +512,12 @@ static int allocate_workspace_svds(primme_svds_params *primme_svds, int allocate
       intWorkSize = primme.intWorkSize;
       realWorkSize = primme.realWorkSize;
       /* If matrixMatvecSVDS is used, it needs extra space to compute A*A' or A'*A */
+      /* or to stream the rows of A                                          */
       if ((primme.matrixMatvec == NULL || primme.matrixMatvec == matrixMatvecSVDS) &&
+          primme_svds->readRowBlock && primme_svds->method == primme_svds_op_AtA)
+         realWorkSize += sizeof(SCALAR) * matrixMatvecStreaming_worksize(
+                           primme.maxBlockSize, 1, primme_svds);
+      else if ((primme.matrixMatvec == NULL || primme.matrixMatvec == matrixMatvecSVDS) &&
           (primme_svds->method == primme_svds_op_AtA || primme_svds->method == primme_svds_op_AAt))
          realWorkSize += primme.maxBlockSize * sizeof(SCALAR) *
                            (primme_svds->method == primme_svds_op_AtA ?
@@ -484,6 +537,20 @@ static int allocate_workspace_svds(primme_svds_params *primme_svds, int allocate
       realWorkSize = max(realWorkSize, primme.realWorkSize);
    }
 
+   /* Require workspace for copy_last_params_from_svds and _to_svds to    */
+   /* shuffle and normalize svecs, and for the target shifts of primme.   */
+   /* The workspace is free before and after calling the eigensolver.    */
+   nMax = max(primme_svds->initSize, primme_svds->numSvals)
+      + primme_svds->numOrthoConst;
+   scratchSize = (size_t)4*nMax;
+   if (primme_svds->method == primme_svds_op_augmented
+         || primme_svds->methodStage2 == primme_svds_op_augmented) {
+      scratchSize = max(scratchSize,
+            (size_t)(primme_svds->mLocal+primme_svds->nLocal)*nMax);
+   }
+   realWorkSize = max(realWorkSize, scratchSize*sizeof(SCALAR))
+      + shifts_size_svds(primme_svds)*sizeof(SCALAR);
+
    if (!allocate) {
       primme_svds->intWorkSize  = intWorkSize;
       primme_svds->realWorkSize = realWorkSize;
@@ -497,18 +564,44 @@ static int allocate_workspace_svds(primme_svds_params *primme_svds, int allocate
          && primme_svds->realWorkSize < realWorkSize) {
       return -20;
    }
-   else if (primme_svds->realWork == NULL) {
+   if (primme_svds->intWork != NULL && primme_svds->intWorkSize < intWorkSize) {
+      return -21;
+   }
+
+   /* The eigensolver places the workspace as asked in primme.workspaceParams */
+
+   ldBytes = (size_t)primme_svds->primme.nLocal*sizeof(SCALAR);
+
+   /* Take the missing workspace from the arena, growing it if needed */
+
+   if (primme_svds->arena
+         && (primme_svds->realWork == NULL || primme_svds->intWork == NULL)) {
+      CHKERRMS(primme_arena_reserve(primme_svds->arena,
+               primme_svds->realWork == NULL ? realWorkSize : 0,
+               primme_svds->intWork == NULL ? intWorkSize : 0, ldBytes,
+               &primme_svds->primme.workspaceParams),
+            MALLOC_FAILURE, "Failed to allocate %zd bytes\n", realWorkSize);
+      if (primme_svds->realWork == NULL) {
+         primme_svds->realWork = primme_svds->arena->realWork;
+         primme_svds->realWorkSize = primme_svds->arena->realWorkSize;
+      }
+      if (primme_svds->intWork == NULL) {
+         primme_svds->intWork = primme_svds->arena->intWork;
+         primme_svds->intWorkSize = primme_svds->arena->intWorkSize;
+      }
+   }
+
+   if (primme_svds->realWork == NULL) {
       primme_svds->realWorkSize = realWorkSize;
       if (primme_svds->printLevel >= 5) fprintf(primme_svds->outputFile, 
          "Allocating real workspace: %ld bytes\n", primme_svds->realWorkSize);
-      CHKERRMS(MALLOC_PRIMME(realWorkSize, (char**)&primme_svds->realWork),
+      CHKERRMS(primme_workspace_alloc(realWorkSize, ldBytes,
+               &primme_svds->primme.workspaceParams, &primme_svds->realWork,
+               &placement, &hugePages),
             MALLOC_FAILURE, "Failed to allocate %zd bytes\n", realWorkSize);
    }
 
-   if (primme_svds->intWork != NULL && primme_svds->intWorkSize < intWorkSize) {
-      return -21;
-   }
-   else if (primme_svds->intWork == NULL) {
+   if (primme_svds->intWork == NULL) {
       primme_svds->intWorkSize = intWorkSize;
       if (primme_svds->printLevel >= 5) fprintf(primme_svds->outputFile, 
          "Allocating integer workspace: %d bytes\n", primme_svds->intWorkSize);
@@ -519,6 +612,32 @@ static int allocate_workspace_svds(primme_svds_params *primme_svds, int allocate
 
    return 0;
 }
+
+/******************************************************************************
+ * Subroutine release_workspace_svds - Detach the workspace taken from
+ *    primme_svds.arena, so that primme_svds_free does not free it and later
+ *    calls take it again from the arena.
+ ******************************************************************************/
+
+static void release_workspace_svds(primme_svds_params *primme_svds) {
+
+   if (primme_svds->arena == NULL) return;
+   if (primme_svds->realWork == primme_svds->arena->realWork)
+      primme_svds->realWork = NULL;
+   if (primme_svds->intWork == primme_svds->arena->intWork)
+      primme_svds->intWork = NULL;
+}
+
+/******************************************************************************
+ * Function shifts_size_svds - Return the number of SCALARs at the beginning
+ *    of primme_svds.realWork that store the target shifts of primme.
+ ******************************************************************************/
+
+static int shifts_size_svds(primme_svds_params *primme_svds) {
+
+   int n = max(max(primme_svds->numSvals, primme_svds->numTargetShifts), 1);
+   return (n*sizeof(double) + sizeof(SCALAR) - 1)/sizeof(SCALAR);
+}
  
 int copy_last_params_to_svds(primme_svds_params *primme_svds, int stage,
       REAL *svals, SCALAR *svecs, REAL *rnorms, int allocatedTargetShifts) {
@@ -553,6 +672,14 @@ int copy_last_params_to_svds(primme_svds_params *primme_svds, int stage,
    primme_svds->stats.numMatvecs         += primme->stats.numMatvecs;
    primme_svds->stats.numPreconds        += primme->stats.numPreconds;
    primme_svds->stats.elapsedTime        += primme->stats.elapsedTime;
+   primme_svds->stats.numGlobalSum       += primme->stats.numGlobalSum;
+   primme_svds->stats.bytesGlobalSum     += primme->stats.volumeGlobalSum *
+                                               sizeof(REAL);
+   primme_svds->stats.numOrthoInnerProds += primme->stats.numOrthoInnerProds;
+   primme_svds->stats.timeMatvec         += primme->stats.timeMatvec;
+   primme_svds->stats.timePrecond        += primme->stats.timePrecond;
+   primme_svds->stats.timeOrtho          += primme->stats.timeOrtho;
+   primme_svds->stats.timeGlobalSum      += primme->stats.timeGlobalSum;
 
 
    if (primme->aNorm > 0.0) {
@@ -582,7 +709,17 @@ int copy_last_params_to_svds(primme_svds_params *primme_svds, int stage,
    switch(method) {
    case primme_svds_op_AtA:
       /* Transform svecs to [Uc A*V/Sigma Vc V] */
-      CHKERRMS((primme_svds->matrixMatvec(
+      if (primme_svds->readRowBlock) {
+         /* Compute A*V with a last pass over the rows of A */
+         CHKERRS(matrixMatvecStreaming(
+               &svecs[primme_svds->mLocal*nMax+primme->nLocal*primme_svds->numOrthoConst],
+               primme_svds->nLocal,
+               &svecs[primme_svds->mLocal*primme_svds->numOrthoConst],
+               primme_svds->mLocal, primme_svds->initSize, 0,
+               (SCALAR*)primme_svds->realWork,
+               primme_svds->realWorkSize/sizeof(SCALAR), primme_svds), -1);
+      }
+      else CHKERRMS((matrixMatvecUser(
             &svecs[primme_svds->mLocal*nMax+primme->nLocal*primme_svds->numOrthoConst],
             &primme_svds->nLocal, &svecs[primme_svds->mLocal*primme_svds->numOrthoConst],
             &primme_svds->mLocal, &primme_svds->initSize, &notrans, primme_svds,
@@ -598,7 +735,7 @@ int copy_last_params_to_svds(primme_svds_params *primme_svds, int stage,
       Num_copy_matrix_Sprimme(&svecs[primme_svds->mLocal*nMax], primme_svds->nLocal,
             primme_svds->numOrthoConst, primme_svds->nLocal,
             &svecs[primme_svds->mLocal*n], primme_svds->nLocal);
-      CHKERRMS((primme_svds->matrixMatvec(
+      CHKERRMS((matrixMatvecUser(
             &svecs[primme_svds->mLocal*primme_svds->numOrthoConst], &primme_svds->mLocal,
             &svecs[primme_svds->mLocal*n+primme->nLocal*primme_svds->numOrthoConst],
             &primme_svds->nLocal, &primme_svds->initSize, &trans, primme_svds,
@@ -612,16 +749,15 @@ int copy_last_params_to_svds(primme_svds_params *primme_svds, int stage,
       assert(primme->nLocal == primme_svds->mLocal+primme_svds->nLocal);
 
       /* Shuffle svecs from [Vc V; Uc U] to [Uc U Vc V] */
-      CHKERRS(MALLOC_PRIMME(primme->nLocal*n, &aux), -1);
+      aux = (SCALAR*)primme_svds->realWork + shifts_size_svds(primme_svds);
       Num_copy_Sprimme(primme->nLocal*n, svecs, 1, aux, 1);
       Num_copy_matrix_Sprimme(aux, primme_svds->nLocal, n, primme->nLocal,
          &svecs[primme_svds->mLocal*n], primme_svds->nLocal);
       Num_copy_matrix_Sprimme(&aux[primme_svds->nLocal], primme_svds->mLocal, n,
          primme->nLocal, svecs, primme_svds->mLocal);
-      free(aux);
 
       /* Normalize every column in U and V */
-      CHKERRS(MALLOC_PRIMME(4*n, &norms2_), -1);
+      norms2_ = (REAL*)aux;
       norms2 = norms2_ + 2*n;
       for (i=0; i<n; i++) {
          norms2_[i] = REAL_PART(Num_dot_Sprimme(primme_svds->mLocal,
@@ -642,7 +778,6 @@ int copy_last_params_to_svds(primme_svds_params *primme_svds, int stage,
          Num_scal_Sprimme(primme_svds->nLocal, 1.0/sqrt(norms2[n+i]),
                &svecs[primme_svds->mLocal*n+primme_svds->nLocal*i], 1);
       }
-      free(norms2_);
       break;
    case primme_svds_op_none:
       break;
@@ -658,8 +793,8 @@ int copy_last_params_to_svds(primme_svds_params *primme_svds, int stage,
    primme->intWork = NULL;
    primme->realWork = NULL;
 
+   /* Zero also the reference to the shifts stored in the workspace */
    if (allocatedTargetShifts) {
-      free(primme->targetShifts);
       primme->targetShifts = NULL;
    }
 
@@ -696,7 +831,7 @@ int copy_last_params_to_svds(primme_svds_params *primme_svds, int stage,
  *  primme_svds              the main structure of parameters 
  *
  * return value -   0    If input parameters in primme are appropriate
- *              -4..-19  Inappropriate input parameters were found
+ *              -4..-22  Inappropriate input parameters were found
  *
  ******************************************************************************/
 static int primme_svds_check_input(REAL *svals, SCALAR *svecs, REAL *resNorms, 
@@ -710,7 +845,8 @@ static int primme_svds_check_input(REAL *svals, SCALAR *svecs, REAL *resNorms,
       ret = -5;
    else if (primme_svds->numProcs < 1)
       ret = -6;
-   else if (primme_svds->matrixMatvec == NULL) 
+   else if (primme_svds->matrixMatvec == NULL &&
+         primme_svds->readRowBlock == NULL) 
       ret = -7;
    else if (primme_svds->applyPreconditioner == NULL && 
          primme_svds->precondition == 1) 
@@ -744,6 +880,12 @@ static int primme_svds_check_input(REAL *svals, SCALAR *svecs, REAL *resNorms,
    else if (resNorms == NULL)
       ret = -19;
    /* Booked -20 and -21*/
+   else if (primme_svds->readRowBlock && (
+            primme_svds->method != primme_svds_op_AtA ||
+            primme_svds->methodStage2 != primme_svds_op_none ||
+            primme_svds->nLocal != primme_svds->n ||
+            primme_svds->rowBlockSize < 1))
+      ret = -22;
 
    return ret;
    /***************************************************************************/
@@ -768,10 +910,18 @@ static void matrixMatvecSVDS(void *x_, PRIMME_INT *ldx, void *y_,
       for (i=0, bs=min((*blockSize-i), primme->maxBlockSize); bs>0;
                i+= bs, bs=min((*blockSize-i), primme->maxBlockSize))
       {
-         primme_svds->matrixMatvec(&x[*ldx*i], ldx, primme_svds->realWork,
+         if (primme_svds->readRowBlock) {
+            *ierr = matrixMatvecStreaming(&x[*ldx*i], *ldx, &y[*ldy*i], *ldy,
+                  bs, 1, (SCALAR*)primme_svds->realWork,
+                  matrixMatvecStreaming_worksize(primme->maxBlockSize, 1,
+                     primme_svds), primme_svds);
+            if (*ierr != 0) return;
+            continue;
+         }
+         matrixMatvecUser(&x[*ldx*i], ldx, primme_svds->realWork,
                &primme_svds->mLocal, &bs, &notrans, primme_svds, ierr);
          if (*ierr != 0) return;
-         primme_svds->matrixMatvec(primme_svds->realWork, &primme_svds->mLocal,
+         matrixMatvecUser(primme_svds->realWork, &primme_svds->mLocal,
             &y[*ldy*i], ldy, &bs, &trans, primme_svds, ierr);
          if (*ierr != 0) return;
       }
@@ -780,19 +930,19 @@ static void matrixMatvecSVDS(void *x_, PRIMME_INT *ldx, void *y_,
       for (i=0, bs=min((*blockSize-i), primme->maxBlockSize); bs>0;
                i+= bs, bs=min((*blockSize-i), primme->maxBlockSize))
       {
-         primme_svds->matrixMatvec(&x[*ldx*i], ldx, primme_svds->realWork,
+         matrixMatvecUser(&x[*ldx*i], ldx, primme_svds->realWork,
                &primme_svds->nLocal, &bs, &trans, primme_svds, ierr);
          if (*ierr != 0) return;
-         primme_svds->matrixMatvec(primme_svds->realWork, &primme_svds->nLocal,
+         matrixMatvecUser(primme_svds->realWork, &primme_svds->nLocal,
             &y[*ldy*i], ldy, &bs, &notrans, primme_svds, ierr);
          if (*ierr != 0) return;
       }
       break;
    case primme_svds_op_augmented:
-      primme_svds->matrixMatvec(&x[primme_svds->nLocal], ldx, y, ldy, blockSize,
+      matrixMatvecUser(&x[primme_svds->nLocal], ldx, y, ldy, blockSize,
             &trans, primme_svds, ierr);
          if (*ierr != 0) return;
-      primme_svds->matrixMatvec(x, ldx, &y[primme_svds->nLocal],
+      matrixMatvecUser(x, ldx, &y[primme_svds->nLocal],
          ldy, blockSize, &notrans, primme_svds, ierr);
          if (*ierr != 0) return;
       break;
@@ -801,6 +951,170 @@ static void matrixMatvecSVDS(void *x_, PRIMME_INT *ldx, void *y_,
    }
 }
 
+/*******************************************************************************
+ * Subroutine matrixMatvecStreaming - Computes y = A'*A*x or y = A*x reading
+ *    the local rows of A in blocks of primme_svds.rowBlockSize rows with
+ *    primme_svds.readRowBlock. The next block is requested before the
+ *    products with the current block are computed, and both are overlapped
+ *    when compiled with OpenMP. In parallel, A'*A*x is reduced among processes
+ *    with primme_svds.globalSumReal.
+ *
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * x           The input vectors, of size nLocal x blockSize
+ * ldx         The leading dimension of x
+ * ldy         The leading dimension of y
+ * blockSize   The number of columns of x and y
+ * AtA         If nonzero, compute y = A'*A*x; otherwise y = A*x
+ * rwork       Workspace
+ * rworkSize   Size of rwork, see matrixMatvecStreaming_worksize
+ *
+ * OUTPUT ARRAYS
+ * -------------
+ * y           The output vectors, of size nLocal x blockSize if AtA, and
+ *             mLocal x blockSize otherwise
+ *
+ * RETURN VALUE
+ * ------------
+ * error code
+ ******************************************************************************/
+
+static int matrixMatvecStreaming(SCALAR *x, PRIMME_INT ldx, SCALAR *y,
+      PRIMME_INT ldy, int blockSize, int AtA, SCALAR *rwork, size_t rworkSize,
+      primme_svds_params *primme_svds) {
+
+   PRIMME_INT i, iNext, ld = primme_svds->rowBlockSize;
+   PRIMME_INT m = primme_svds->mLocal, n = primme_svds->nLocal;
+   int nr, nrNext, cur, ierr = 0, count;
+   SCALAR *A[2], *Ax, *y0 = y;   /* Row blocks, A_i*x and local A'*A*x */
+   double t0, t1;
+   PRIMME_INT ldy0 = ldy;
+
+   assert(rworkSize >= matrixMatvecStreaming_worksize(blockSize, AtA,
+            primme_svds));
+   (void)rworkSize; /* unused argument when NDEBUG */
+
+   A[0] = rwork;
+   A[1] = A[0] + ld*n;
+   Ax = A[1] + ld*n;
+   if (AtA && primme_svds->numProcs > 1) {
+      y0 = Ax + ld*blockSize;
+      ldy0 = n;
+   }
+   if (AtA) Num_zero_matrix_Sprimme(y0, n, blockSize, ldy0);
+
+   /* Read the first block */
+
+   i = 0;
+   nr = (int)min(ld, m);
+   if (nr > 0) {
+      CHKERRMS((primme_svds->readRowBlock(&i, &nr, A[0], &ld, primme_svds,
+                  &ierr), ierr), -1,
+            "Error returned by 'readRowBlock' %d", ierr);
+   }
+
+   for (cur=0; i<m; i+=nr, nr=nrNext, cur=1-cur) {
+      iNext = i + nr;
+      nrNext = (int)min(ld, m-iNext);
+
+      #ifdef _OPENMP
+      #pragma omp parallel sections num_threads(2)
+      #endif
+      {
+         /* Prefetch the next block into the other buffer */
+
+         #ifdef _OPENMP
+         #pragma omp section
+         #endif
+         if (nrNext > 0) {
+            primme_svds->readRowBlock(&iNext, &nrNext, A[1-cur], &ld,
+                  primme_svds, &ierr);
+         }
+
+         /* Compute y += A_i'*(A_i*x) or y_i = A_i*x */
+
+         #ifdef _OPENMP
+         #pragma omp section
+         #endif
+         if (AtA) {
+            t0 = primme_wTimer(0);
+            Num_gemm_Sprimme("N", "N", nr, blockSize, n, 1.0, A[cur], ld, x,
+                  ldx, 0.0, Ax, ld);
+            t1 = primme_wTimer(0);
+            Num_gemm_Sprimme("C", "N", n, blockSize, nr, 1.0, A[cur], ld, Ax,
+                  ld, 1.0, y0, ldy0);
+            primme_svds->stats.timeMatvecA += t1 - t0;
+            primme_svds->stats.timeMatvecAt += primme_wTimer(0) - t1;
+         }
+         else {
+            t0 = primme_wTimer(0);
+            Num_gemm_Sprimme("N", "N", nr, blockSize, n, 1.0, A[cur], ld, x,
+                  ldx, 0.0, &y[i], ldy);
+            primme_svds->stats.timeMatvecA += primme_wTimer(0) - t0;
+         }
+      }
+      CHKERRMS(ierr, -1, "Error returned by 'readRowBlock' %d", ierr);
+   }
+
+   /* Reduce A'*A*x among processes */
+
+   if (y0 != y) {
+      count = n*blockSize;
+#ifdef USE_COMPLEX
+      count *= 2;
+#endif
+      CHKERRS(globalSum_Rprimme_svds((REAL*)y0, (REAL*)&y0[n*blockSize],
+               count, primme_svds), -1);
+      Num_copy_matrix_Sprimme(&y0[n*blockSize], n, blockSize, n, y, ldy);
+   }
+
+   primme_svds->stats.numMatvecsA += blockSize;
+   if (AtA) primme_svds->stats.numMatvecsAt += blockSize;
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Function matrixMatvecStreaming_worksize - return the number of SCALARs
+ *    required by matrixMatvecStreaming: two row blocks of A, A_i*x and, in
+ *    parallel, the local and the reduced A'*A*x.
+ ******************************************************************************/
+
+static size_t matrixMatvecStreaming_worksize(int blockSize, int AtA,
+      primme_svds_params *primme_svds) {
+
+   size_t ld = (size_t)primme_svds->rowBlockSize;
+   size_t n = (size_t)primme_svds->nLocal;
+
+   return 2*ld*n + (AtA ? ld*blockSize : 0) +
+      (AtA && primme_svds->numProcs > 1 ? 2*n*blockSize : 0);
+}
+
+/*******************************************************************************
+ * Subroutine matrixMatvecUser - Calls primme_svds.matrixMatvec and records
+ *    the number of vectors and the time of the products with A and A'
+ *    separately.
+ ******************************************************************************/
+
+static void matrixMatvecUser(void *x, PRIMME_INT *ldx, void *y,
+      PRIMME_INT *ldy, int *blockSize, int *transpose,
+      primme_svds_params *primme_svds, int *ierr) {
+
+   double t0 = primme_wTimer(0);
+
+   primme_svds->matrixMatvec(x, ldx, y, ldy, blockSize, transpose,
+         primme_svds, ierr);
+
+   if (*transpose) {
+      primme_svds->stats.numMatvecsAt += *blockSize;
+      primme_svds->stats.timeMatvecAt += primme_wTimer(0) - t0;
+   }
+   else {
+      primme_svds->stats.numMatvecsA += *blockSize;
+      primme_svds->stats.timeMatvecA += primme_wTimer(0) - t0;
+   }
+}
+
 static void applyPreconditionerSVDS(void *x, PRIMME_INT *ldx, void *y,
       PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *ierr) {
 
@@ -836,11 +1150,16 @@ static int globalSum_Rprimme_svds(REAL *sendBuf, REAL *recvBuf, int count,
       primme_svds_params *primme_svds) {
 
    int ierr;
+   double t0;
 
    if (primme_svds && primme_svds->globalSumReal) {
+      t0 = primme_wTimer(0);
       CHKERRMS((primme_svds->globalSumReal(sendBuf, recvBuf, &count,
                   primme_svds, &ierr), ierr), -1,
             "Error returned by 'globalSumReal' %d", ierr);
+      primme_svds->stats.timeGlobalSum += primme_wTimer(0) - t0;
+      primme_svds->stats.numGlobalSum++;
+      primme_svds->stats.bytesGlobalSum += count*sizeof(REAL);
    }
    else {
       Num_copy_Rprimme(count, sendBuf, 1, recvBuf, 1);
@@ -911,3 +1230,84 @@ static void convTestFunAugmented(double *eval, void *evec, double *rNorm, int *i
       && *eval >= aNorm*machEps;
    *ierr = 0;
 } 
+
+/*******************************************************************************
+ * Subroutine monitorFunSVDS - This routine implements primme_params.
+ *    monitorFun and calls primme_svds.monitorFun after transforming the
+ *    eigenvalues and residual norms of the current stage into singular values
+ *    and estimations of the singular triplet residual norms.
+ *
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * See primme_params.monitorFun
+ *
+ * OUTPUT PARAMETERS
+ * ----------------------------------
+ * stop        if it isn't zero the solver finishes
+ * ierr        error code
+ ******************************************************************************/
+
+static void monitorFunSVDS(void *basisEvals, int *basisSize, int *basisFlags,
+      int *iblock, int *blockSize, void *blockNorms, int *numConverged,
+      void *lockedEvals, int *numLocked, void *lockedNorms,
+      primme_event *event, int *stop, primme_params *primme, int *ierr) {
+
+   primme_svds_params *primme_svds = (primme_svds_params *) primme->matrix;
+   int stage = &primme_svds->primme == primme ? 0 : 1;
+   primme_svds_operator method = stage == 0 ?
+      primme_svds->method : primme_svds->methodStage2;
+   REAL *basisSvals=NULL, *blockNormsS=NULL, *lockedSvals=NULL,
+        *lockedNormsS=NULL;
+   int i;
+
+   *ierr = 0;
+   if (MALLOC_PRIMME(max(1, *basisSize), &basisSvals) != 0 ||
+       MALLOC_PRIMME(max(1, *blockSize), &blockNormsS) != 0 ||
+       MALLOC_PRIMME(max(1, *numLocked), &lockedSvals) != 0 ||
+       MALLOC_PRIMME(max(1, *numLocked), &lockedNormsS) != 0) {
+      *ierr = MALLOC_FAILURE;
+   }
+
+   /* Transform the eigenvalues into singular values and the residual norms */
+   /* of the eigenpairs into the residual norms of the singular triplets    */
+
+   for (i=0; *ierr == 0 && i<*basisSize; i++) {
+      basisSvals[i] = ((REAL*)basisEvals)[i];
+      if (method != primme_svds_op_augmented) {
+         basisSvals[i] = sqrt(max(0.0, basisSvals[i]));
+      }
+   }
+   for (i=0; *ierr == 0 && i<*numLocked; i++) {
+      lockedSvals[i] = ((REAL*)lockedEvals)[i];
+      lockedNormsS[i] = ((REAL*)lockedNorms)[i];
+      if (method != primme_svds_op_augmented) {
+         lockedSvals[i] = sqrt(max(0.0, lockedSvals[i]));
+         if (lockedSvals[i] > 0.0) lockedNormsS[i] /= lockedSvals[i];
+      }
+      else {
+         lockedNormsS[i] *= sqrt(2.0);
+      }
+   }
+   for (i=0; *ierr == 0 && blockNorms && i<*blockSize; i++) {
+      blockNormsS[i] = ((REAL*)blockNorms)[i];
+      if (method != primme_svds_op_augmented) {
+         REAL sval = basisSvals[iblock[i]];
+         if (sval > 0.0) blockNormsS[i] /= sval;
+      }
+      else {
+         blockNormsS[i] *= sqrt(2.0);
+      }
+   }
+
+   if (*ierr == 0) {
+      primme_svds->monitorFun(basisSvals, basisSize, basisFlags, iblock,
+            blockSize, blockNorms ? blockNormsS : NULL, numConverged,
+            lockedSvals, numLocked, lockedNormsS, event, stop, &stage,
+            primme_svds, ierr);
+   }
+
+   if (basisSvals) free(basisSvals);
+   if (blockNormsS) free(blockNormsS);
+   if (lockedSvals) free(lockedSvals);
+   if (lockedNormsS) free(lockedNormsS);
+}
@@ -40,6 +40,7 @@
 #include "numerical.h"
 #include "primme_svds_interface.h"
 #include "primme_interface.h"
+#include "../eigs/arena.h"
 
 /* Only define these functions ones */
 #ifdef USE_DOUBLE
@@ -84,6 +85,10 @@ void primme_svds_initialize(primme_svds_params *primme_svds) {
    primme_svds->matrixMatvec            = NULL;
    primme_svds->applyPreconditioner     = NULL;
 
+   /* Streaming access to the rows of A */
+   primme_svds->readRowBlock            = NULL;
+   primme_svds->rowBlockSize            = 0;
+
    /* Other important parameters users may set */
    primme_svds->aNorm                   = 0.0L;
    primme_svds->eps                     = 0.0;
@@ -94,6 +99,7 @@ void primme_svds_initialize(primme_svds_params *primme_svds) {
    primme_svds->maxMatvecs              = INT_MAX;
    primme_svds->printLevel              = 1;
    primme_svds->outputFile              = stdout;
+   primme_svds->monitorFun              = NULL;
    primme_svds->locking                 = -1;
    primme_svds->numOrthoConst           = 0;
 
@@ -102,7 +108,18 @@ void primme_svds_initialize(primme_svds_params *primme_svds) {
    primme_svds->stats.numRestarts       = 0;
    primme_svds->stats.numMatvecs        = 0;
    primme_svds->stats.numPreconds       = 0;
+   primme_svds->stats.numGlobalSum      = 0;
+   primme_svds->stats.bytesGlobalSum    = 0;
+   primme_svds->stats.numMatvecsA       = 0;
+   primme_svds->stats.numMatvecsAt      = 0;
+   primme_svds->stats.numOrthoInnerProds= 0.0;
    primme_svds->stats.elapsedTime       = 0.0L;
+   primme_svds->stats.timeMatvec        = 0.0;
+   primme_svds->stats.timeMatvecA       = 0.0;
+   primme_svds->stats.timeMatvecAt      = 0.0;
+   primme_svds->stats.timePrecond       = 0.0;
+   primme_svds->stats.timeOrtho         = 0.0;
+   primme_svds->stats.timeGlobalSum     = 0.0;
 
    /* Internally used variables */
    primme_svds->iseed[0] = -1;   /* To set iseed, we first need procID           */ 
@@ -113,6 +130,7 @@ void primme_svds_initialize(primme_svds_params *primme_svds) {
    primme_svds->realWorkSize            = 0;
    primme_svds->intWork                 = NULL;
    primme_svds->realWork                = NULL;
+   primme_svds->arena                   = NULL;
 
    primme_initialize(&primme_svds->primme);
    primme_initialize(&primme_svds->primmeStage2);
@@ -123,6 +141,11 @@ int primme_svds_set_method(primme_svds_preset_method method,
       primme_preset_method methodStage1, primme_preset_method methodStage2,
       primme_svds_params *primme_svds) {
 
+   /* Streaming the rows of A only supports A'*A without a second stage */
+   if (primme_svds->readRowBlock && method != primme_svds_augmented) {
+      method = primme_svds_normalequations;
+   }
+
    /* Set method and methodStage2 in primme_svds_params */
    switch(method) {
    case primme_svds_default:
@@ -131,7 +154,8 @@ int primme_svds_set_method(primme_svds_preset_method method,
       primme_svds->methodStage2 = primme_svds_op_augmented;
       break;
    case primme_svds_normalequations:
-      primme_svds->method = primme_svds->n <= primme_svds->m ? primme_svds_op_AtA : primme_svds_op_AAt;
+      primme_svds->method = primme_svds->n <= primme_svds->m ||
+         primme_svds->readRowBlock ? primme_svds_op_AtA : primme_svds_op_AAt;
       primme_svds->methodStage2 = primme_svds_op_none;
       break;
    case primme_svds_augmented:
@@ -164,6 +188,15 @@ void primme_svds_set_defaults(primme_svds_params *primme_svds) {
       primme_svds->numProcs = 1;
    }
 
+   /* When streaming the rows of A, the right vectors are not distributed; */
+   /* other values of nLocal are rejected by check_input                   */
+   if (primme_svds->readRowBlock) {
+      if (primme_svds->nLocal == 0) primme_svds->nLocal = primme_svds->n;
+      if (primme_svds->rowBlockSize <= 0) {
+         primme_svds->rowBlockSize = (int)max(1, min(primme_svds->mLocal, 1024));
+      }
+   }
+
    /* Set svds method if none set */
    if (primme_svds->method == primme_svds_op_none) {
       primme_svds_set_method(primme_svds_default, PRIMME_DEFAULT_METHOD,
@@ -217,12 +250,16 @@ static void copy_params_from_svds(primme_svds_params *primme_svds, int stage) {
    primme->maxMatvecs = primme_svds->maxMatvecs;
    primme->printLevel = primme_svds->printLevel;
    primme->outputFile = primme_svds->outputFile;
+   primme->arena = primme_svds->arena;
    primme->numOrthoConst = primme_svds->numOrthoConst;
 
    /* ---------------------------------------------- */
    /* Set some parameters only for parallel programs */
    /* ---------------------------------------------- */
-   if (primme_svds->numProcs > 1 && primme_svds->globalSumReal != NULL) {
+   /* NOTE: when streaming the rows of A every process keeps the whole V and */
+   /*       only the products with A are reduced among processes            */
+   if (primme_svds->numProcs > 1 && primme_svds->globalSumReal != NULL
+         && primme_svds->readRowBlock == NULL) {
       primme->procID = primme_svds->procID;
       primme->numProcs = primme_svds->numProcs;
       primme->commInfo = primme_svds->commInfo;
@@ -354,6 +391,7 @@ fprintf(outputFile, "// ---------------------------------------------------\n"
    fprintf(outputFile, "\n");
 
    PRINT(precondition, %d);
+   PRINT(rowBlockSize, %d);
 
    PRINTIF(method, primme_svds_op_none);
    PRINTIF(method, primme_svds_op_AtA);
@@ -390,8 +428,13 @@ fprintf(outputFile, "// ---------------------------------------------------\n"
 
 void primme_svds_free(primme_svds_params *params) {
     
-   free(params->intWork);
-   free(params->realWork);
+   /* The workspace taken from an arena is freed by primme_arena_free */
+   if (params->arena == NULL || params->intWork != params->arena->intWork)
+      free(params->intWork);
+   if (params->arena == NULL || params->realWork != params->arena->realWork)
+      free(params->realWork);
+   params->intWork = NULL;
+   params->realWork = NULL;
    params->intWorkSize  = 0;
    params->realWorkSize = 0;
 }
@@ -32,23 +32,54 @@
 #include <unistd.h>
 #include <string.h>
 #include <math.h>
+#include <stdint.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "mmio.h"
 #include "primme.h"
 #include "csr.h"
 
 static int readfullMTX(const char *mtfile, SCALAR **A, int **JA, int **IA, int *m, int *n, int *nnz);
+static int isBinaryCSR(const char *fileName);
+static int readBinaryCSR(const char *fileName, CSRMatrix *matrix);
 #ifndef USE_DOUBLECOMPLEX
 static int readUpperMTX(const char *mtfile, double **A, int **JA, int **IA, int *n, int *nnz);
-int ssrcsr(int *job, int *value2, int *nrow, double *a, int *ja, int *ia, 
-   int *nzmax, double *ao, int *jao, int *iao, int *indu, int *iwk, int *ierr);
 #endif
+static int readMTXEntries(const char *mtfile, long offset, int nnz,
+      int numValues, int *I, int *J, SCALAR *A);
+static int COOtoCSR(int m, int n, int nnz, int *I, int *J, SCALAR *A,
+      int mirror, int **IA, int **JA, SCALAR **AA, int *nnzOut);
+static int generateMatrix(const char *name, CSRMatrix *matrix);
 
 int readMatrixNative(const char* matrixFileName, CSRMatrix **matrix_, double *fnorm) {
    int ret;
    CSRMatrix *matrix;
 
    matrix = (CSRMatrix*)primme_calloc(1, sizeof(CSRMatrix), "CSRMatrix");
-   if (!strcmp("mtx", &matrixFileName[strlen(matrixFileName)-3])) {  
+   matrix->map = NULL;
+   matrix->mapSize = 0;
+   if (!strncmp(matrixFileName, "gen:", 4)) {
+      /* matrix generated in memory, see generateMatrix */
+      ret = generateMatrix(matrixFileName, matrix);
+      if (ret < 0) {
+         fprintf(stderr, "ERROR: Could not generate matrix\n");
+         return(-1);
+      }
+   }
+   else if (isBinaryCSR(matrixFileName)) {
+      /* binary CSR, see writeMatrixBinary */
+      ret = readBinaryCSR(matrixFileName, matrix);
+      if (ret < 0) {
+         fprintf(stderr, "ERROR: Could not read matrix file\n");
+         return(-1);
+      }
+   }
+   else if (!strcmp("mtx", &matrixFileName[strlen(matrixFileName)-3])) {  
       /* coordinate format storing both lower and upper triangular parts */
       ret = readfullMTX(matrixFileName, &matrix->AElts, &matrix->JA, 
          &matrix->IA, &matrix->m, &matrix->n, &matrix->nnz);
@@ -62,6 +93,7 @@ int readMatrixNative(const char* matrixFileName, CSRMatrix **matrix_, double *fn
 #ifndef USE_DOUBLECOMPLEX
       ret = readUpperMTX(matrixFileName, &matrix->AElts, &matrix->JA,
          &matrix->IA, &matrix->n, &matrix->nnz);
+      matrix->m = matrix->n;
 #else
       /* TODO: support this in complex arithmetic */
       ret = -1;
@@ -87,19 +119,10 @@ int readMatrixNative(const char* matrixFileName, CSRMatrix **matrix_, double *fn
    return 0;
 }
 
-static int *my_comp_ctx[2];
-static int my_comp(const void *a, const void *b)
-{
-   const int ia = *(int*)a, ib = *(int*)b;
-   int **p = my_comp_ctx;
-   return p[0][ia] != p[0][ib] ? p[0][ia] - p[0][ib] : p[1][ia] - p[1][ib];
-}
-
 static int readfullMTX(const char *mtfile, SCALAR **AA, int **JA, int **IA, int *m, int *n, int *nnz) { 
-   int i,j, k, nzmax;
-   int *I, *J, *perm;
+   int *I, *J;
    SCALAR *A;
-   double re, im;
+   long offset;
    FILE *matrixFile;
    MM_typecode type;
 
@@ -122,66 +145,31 @@ static int readfullMTX(const char *mtfile, SCALAR **AA, int **JA, int **IA, int
    }
 
    if (mm_read_mtx_crd_size(matrixFile, m, n, nnz) != 0) return -1;
-
-   nzmax = *nnz;
-   if (mm_is_symmetric(type) || mm_is_hermitian(type) || mm_is_skew(type)) nzmax *= 2;
-   A = (SCALAR *)primme_calloc(nzmax, sizeof(SCALAR), "A");
-   J = (int *)primme_calloc(nzmax, sizeof(int), "J");
-   I = (int *)primme_calloc(nzmax, sizeof(int), "I");
+   offset = ftell(matrixFile);
+   fclose(matrixFile);
 
    /* Read matrix in COO */
-   im = 0.0;
-   for (k=0, i=0; k<*nnz; k++, i++) {
-      if (mm_read_mtx_crd_entry(matrixFile, &I[i], &J[i], &re, &im, type)!=0) return -1;
-      if (mm_is_pattern(type)) A[i] = 1;
-      else if (mm_is_real(type)) A[i] = re;
-      else A[i] = re + IMAGINARY*im;
-      if (I[i] != J[i]) {
-         if ((mm_is_symmetric(type) || mm_is_hermitian(type))) {
-            I[i+1] = J[i]; J[i+1] = I[i]; A[i+1] = CONJ(A[i]); i++;
-         }
-         else if (mm_is_skew(type)) {
-            I[i+1] = J[i]; J[i+1] = I[i]; A[i+1] = -A[i]; i++;
-         }
-      }
+   A = (SCALAR *)primme_calloc(*nnz, sizeof(SCALAR), "A");
+   J = (int *)primme_calloc(*nnz, sizeof(int), "J");
+   I = (int *)primme_calloc(*nnz, sizeof(int), "I");
+   if (readMTXEntries(mtfile, offset, *nnz,
+            mm_is_pattern(type) ? 0 : (mm_is_complex(type) ? 2 : 1),
+            I, J, A) != 0) {
+      free(A); free(J); free(I);
+      return -1;
    }
-   nzmax = *nnz = i;
-
-   /* Sort COO by columns */
-   perm = (int *)primme_calloc(nzmax, sizeof(int), "perm");
-   for (i=0; i<nzmax; i++) perm[i] = i;
-   my_comp_ctx[0] = I;
-   my_comp_ctx[1] = J;
-   qsort(perm, nzmax, sizeof(int), my_comp);
-
-   /* Collapse columns */
-   *IA = (int *)primme_calloc(*m+1, sizeof(int), "IA");
-   (*IA)[0] = 1;
-   for (i=0, j=1; i<nzmax; i++)
-      while (j < I[perm[i]]) (*IA)[j++] = i+1;
-   while (j <= *m) (*IA)[j++] = nzmax+1;
-
-   /* Copy rows and values sorted */
-   *JA = I;
-   for (i=0; i<nzmax; i++) (*JA)[i] = J[perm[i]];
-   free(J);
-   *AA = (SCALAR *)primme_calloc(nzmax, sizeof(SCALAR), "AA");
-   for (i=0; i<nzmax; i++) (*AA)[i] = A[perm[i]];
-   free(A);
-   free(perm);
 
-   fclose(matrixFile);
-
-   return 0;
+   /* Convert to CSR, adding the other triangular part if it is implicit */
+   return COOtoCSR(*m, *n, *nnz, I, J, A,
+         mm_is_symmetric(type) || mm_is_hermitian(type) ? 1 :
+         (mm_is_skew(type) ? -1 : 0), IA, JA, AA, nnz);
 }
 
 #ifndef USE_DOUBLECOMPLEX
 static int readUpperMTX(const char *mtfile, double **A, int **JA, int **IA, int *n, int *nnz) { 
-   int i, k, nzmax;
-   int job, value2;
-   int row, nextRow;
-   int ierror;
-   int *iwk1, *iwk2;
+   int *I, *J;
+   double *V;
+   long offset;
    FILE *matrixFile;
 
    matrixFile = fopen(mtfile, "r");
@@ -190,48 +178,1061 @@ static int readUpperMTX(const char *mtfile, double **A, int **JA, int **IA, int
       return(-1);  
    }
 
-   i = 0;
-   nextRow = 0;
    if (fscanf(matrixFile, "%d %d\n", n, nnz) != 2) return -1;
    fprintf(stderr, "%d %d\n", *n, *nnz);
+   offset = ftell(matrixFile);
+   fclose(matrixFile);
+
+   V = (double *)primme_calloc(*nnz, sizeof(double), "V");
+   J = (int *)primme_calloc(*nnz, sizeof(int), "J");
+   I = (int *)primme_calloc(*nnz, sizeof(int), "I");
+   if (readMTXEntries(mtfile, offset, *nnz, 1, I, J, V) != 0) {
+      free(V); free(J); free(I);
+      return -1;
+   }
+
+   /* Add the strictly lower triangular part */
+   return COOtoCSR(*n, *n, *nnz, I, J, V, 1, IA, JA, A, nnz);
+}
+#endif
+
+/******************************************************************************
+ * Parallel MatrixMarket reader
+ *
+ * The entries of the file are parsed in parallel: the file is mapped into
+ * memory and split into chunks at line boundaries; every chunk counts its
+ * entries and then parses them into its range of the COO arrays. The CSR is
+ * built with a counting sort by row, and the columns in every row are
+ * sorted afterwards.
+ *
+******************************************************************************/
+
+/* Minimum size in bytes of a chunk of entries */
+#ifndef MTX_MIN_CHUNK_SIZE
+#define MTX_MIN_CHUNK_SIZE (1<<20)
+#endif
+
+/* Parses an integer. Returns the position after it, or NULL if there is
+   no number */
+
+static const char *parseInt(const char *p, const char *end, int *v) {
+   int neg = 0, r = 0;
+   const char *s;
+
+   while (p < end && (*p == ' ' || *p == '\t')) p++;
+   if (p < end && (*p == '-' || *p == '+')) neg = (*p++ == '-');
+   for (s=p; p < end && *p >= '0' && *p <= '9'; p++) r = r*10 + (*p - '0');
+   if (p == s) return NULL;
+   *v = neg ? -r : r;
+   return p;
+}
+
+/* Parses a floating point number. Numbers with up to 19 significant digits
+   and a decimal exponent in [-22,22] with a mantissa under 2^53 are
+   converted exactly with a single multiplication or division; the rest of
+   them (and inf and nan) are converted by strtod. Returns the position after
+   the number, or NULL if there is no number */
+
+static const char *parseDouble(const char *p, const char *end, double *v) {
+   static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+      1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19,
+      1e20, 1e21, 1e22};
+   uint64_t mant = 0;
+   int neg = 0, digits = 0, exp10 = 0, exact = 1, any = 0;
+   const char *s;
 
-   nzmax = 2*(*nnz) - *n;
-   *A = (double *)primme_calloc(nzmax, sizeof(double), "A");
-   *JA =   (int *)primme_calloc(nzmax, sizeof(int), "JA");
-   *IA = (int *)primme_calloc(*n+1, sizeof(int), "IA");
-
-   iwk1 = (int *)primme_calloc(*n+1, sizeof(int), "iwk1");
-   iwk2 = (int *)primme_calloc(*n+1, sizeof(int), "iwk2");
-
-   for (k=1; k <= *nnz; k++) {
-      int tja; double ta;
-      if (fscanf(matrixFile, "%d %d %lf\n", &row, &tja, &ta) != 3) return -1;
-      (*JA)[k-1]=tja;
-      (*A)[k-1] = ta;
-      if (i != row) {
-         i = row;
-         nextRow = nextRow + 1;
-         (*IA)[nextRow-1] = k;
+   while (p < end && (*p == ' ' || *p == '\t')) p++;
+   s = p;
+   if (p < end && (*p == '-' || *p == '+')) neg = (*p++ == '-');
+   for (; p < end && *p >= '0' && *p <= '9'; p++, any=1) {
+      if (digits < 19) {
+         mant = mant*10 + (*p - '0');
+         if (mant) digits++;
+      }
+      else {
+         exp10++;
+         exact = 0;
+      }
+   }
+   if (p < end && *p == '.') {
+      for (p++; p < end && *p >= '0' && *p <= '9'; p++, any=1) {
+         if (digits < 19) {
+            mant = mant*10 + (*p - '0');
+            if (mant) digits++;
+            exp10--;
+         }
+         else {
+            exact = 0;
+         }
+      }
+   }
+   if (any && p < end && (*p == 'e' || *p == 'E')) {
+      int e;
+      const char *q = parseInt(p+1, end, &e);
+      if (q && q > p+1 && p[1] != ' ' && p[1] != '\t') {
+         if (e > 9999 || e < -9999) exact = 0;
+         else exp10 += e;
+         p = q;
       }
    }
 
-   (*IA)[*n] = (*IA)[0] + *nnz;
-   fclose(matrixFile);
+   if (any && exact && mant < ((uint64_t)1<<53) && exp10 >= -22 && exp10 <= 22) {
+      double d = (double)mant;
+      d = exp10 < 0 ? d / powers[-exp10] : d * powers[exp10];
+      *v = neg ? -d : d;
+      return p;
+   }
+   else {
+      /* Fall back on strtod with a null-terminated copy of the token */
+      char buf[64], *q;
+      size_t k;
+      for (p=s; p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n'; p++);
+      k = p - s;
+      if (k == 0 || k >= sizeof(buf)) return NULL;
+      memcpy(buf, s, k);
+      buf[k] = 0;
+      *v = strtod(buf, &q);
+      return q == buf + k ? p : NULL;
+   }
+}
+
+/* Returns whether the line starting at p has an entry, i.e., it is not
+   empty or a comment */
+
+static int isEntryLine(const char *p, const char *end) {
+   while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+   return p < end && *p != '\n' && *p != '%';
+}
+
+/* Reads nnz entries with numValues values each (0 for pattern) after the
+   first offset bytes of the file mtfile */
+
+static int readMTXEntries(const char *mtfile, long offset, int nnz,
+      int numValues, int *I, int *J, SCALAR *A) {
+
+   int fd, c, numChunks, maxThreads = 1, err = 0;
+   struct stat st;
+   char *map;
+   const char *data, *end, **chunks;
+   int *start;
+
+   /* Map the file */
+
+   fd = open(mtfile, O_RDONLY);
+   if (fd < 0) return -1;
+   if (fstat(fd, &st) != 0 || (off_t)offset > st.st_size) {
+      close(fd);
+      return -1;
+   }
+   if (st.st_size == 0) {
+      close(fd);
+      return nnz == 0 ? 0 : -1;
+   }
+   map = (char*)mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if (map == MAP_FAILED) return -1;
+   data = map + offset;
+   end = map + st.st_size;
+
+   /* Split the entries into chunks at line boundaries */
+
+#ifdef _OPENMP
+   maxThreads = omp_get_max_threads();
+#endif
+   numChunks = min(4*maxThreads, (int)((end - data)/MTX_MIN_CHUNK_SIZE) + 1);
+   chunks = (const char **)primme_calloc(numChunks+1, sizeof(const char*),
+         "chunks");
+   start = (int *)primme_calloc(numChunks+1, sizeof(int), "start");
+   chunks[0] = data;
+   for (c=1; c<numChunks; c++) {
+      const char *p = max(data + (end - data)/numChunks*c, chunks[c-1]);
+      while (p < end && *p != '\n') p++;
+      chunks[c] = p < end ? p+1 : end;
+   }
+   chunks[numChunks] = end;
+
+   /* Count the entries in every chunk */
+
+   #ifdef _OPENMP
+   #pragma omp parallel for schedule(dynamic)
+   #endif
+   for (c=0; c<numChunks; c++) {
+      const char *p;
+      int k = 0;
+      for (p=chunks[c]; p < chunks[c+1]; p++) {
+         if (isEntryLine(p, chunks[c+1])) k++;
+         while (p < chunks[c+1] && *p != '\n') p++;
+      }
+      start[c+1] = k;
+   }
+   for (c=0, start[0]=0; c<numChunks; c++) start[c+1] += start[c];
+   if (start[numChunks] != nnz) {
+      fprintf(stderr, "Found %d entries, but %d were expected\n",
+            start[numChunks], nnz);
+      err = 1;
+   }
+
+   /* Parse the entries of every chunk */
+
+   if (!err) {
+      #ifdef _OPENMP
+      #pragma omp parallel for schedule(dynamic) reduction(|:err)
+      #endif
+      for (c=0; c<numChunks; c++) {
+         const char *p, *q = chunks[c+1];
+         int k = start[c];
+         for (p=chunks[c]; p < q && !err; p++) {
+            double re = 1.0, im = 0.0;
+            if (isEntryLine(p, q)) {
+               if (!(p = parseInt(p, q, &I[k])) || !(p = parseInt(p, q, &J[k]))
+                     || (numValues > 0 && !(p = parseDouble(p, q, &re)))
+                     || (numValues > 1 && !(p = parseDouble(p, q, &im)))) {
+                  err = 1;
+                  break;
+               }
+#ifdef USE_COMPLEX
+               A[k++] = re + IMAGINARY*im;
+#else
+               A[k++] = re;
+#endif
+            }
+            while (p < q && *p != '\n') p++;
+         }
+      }
+   }
+
+   free(chunks);
+   free(start);
+   munmap(map, st.st_size);
+
+   return err ? -1 : 0;
+}
+
+/* Sorts the entries of a row by column (Shell sort) */
+
+static void sortRow(int *ja, SCALAR *a, int len) {
+   int h, i, k;
+
+   for (h=1; h < len/3; h = 3*h+1);
+   for (; h > 0; h /= 3) {
+      for (i=h; i<len; i++) {
+         int j = ja[i];
+         SCALAR v = a[i];
+         for (k=i; k>=h && ja[k-h] > j; k-=h) {
+            ja[k] = ja[k-h];
+            a[k] = a[k-h];
+         }
+         ja[k] = j;
+         a[k] = v;
+      }
+   }
+}
+
+/* Builds a CSR with Fortran indexing from nnz COO entries. If mirror is 1
+   the entries out of the diagonal are also added transposed and conjugated,
+   and if it is -1, transposed and negated. The COO arrays are freed */
+
+static int COOtoCSR(int m, int n, int nnz, int *I, int *J, SCALAR *A,
+      int mirror, int **IA, int **JA, SCALAR **AA, int *nnzOut) {
+
+   int i, k, err = 0;
+   int *next;
+
+   /* Count the entries in every row */
+
+   *IA = (int *)primme_calloc(m+1, sizeof(int), "IA");
+   next = (int *)primme_calloc(m+1, sizeof(int), "next");
+   #ifdef _OPENMP
+   #pragma omp parallel for
+   #endif
+   for (i=0; i<=m; i++) next[i] = 0;
+   #ifdef _OPENMP
+   #pragma omp parallel for reduction(|:err)
+   #endif
+   for (k=0; k<nnz; k++) {
+      if (I[k] < 1 || I[k] > m || J[k] < 1 || J[k] > n
+            || (mirror && I[k] != J[k] && J[k] > m)) {
+         err = 1;
+         continue;
+      }
+      #ifdef _OPENMP
+      #pragma omp atomic
+      #endif
+      next[I[k]]++;
+      if (mirror && I[k] != J[k]) {
+         #ifdef _OPENMP
+         #pragma omp atomic
+         #endif
+         next[J[k]]++;
+      }
+   }
+   if (err) {
+      fprintf(stderr, "Entry out of range\n");
+      free(*IA); free(next); free(I); free(J); free(A);
+      return -1;
+   }
+   (*IA)[0] = 1;
+   for (i=0; i<m; i++) {
+      (*IA)[i+1] = (*IA)[i] + next[i+1];
+      next[i+1] = (*IA)[i] - 1;
+   }
+   *nnzOut = (*IA)[m] - 1;
+
+   /* Place the entries in their rows */
+
+   *JA = (int *)primme_calloc(*nnzOut, sizeof(int), "JA");
+   *AA = (SCALAR *)primme_calloc(*nnzOut, sizeof(SCALAR), "AA");
+   #ifdef _OPENMP
+   #pragma omp parallel for
+   #endif
+   for (k=0; k<nnz; k++) {
+      int p;
+      #ifdef _OPENMP
+      #pragma omp atomic capture
+      #endif
+      p = next[I[k]]++;
+      (*JA)[p] = J[k];
+      (*AA)[p] = A[k];
+      if (mirror && I[k] != J[k]) {
+         #ifdef _OPENMP
+         #pragma omp atomic capture
+         #endif
+         p = next[J[k]]++;
+         (*JA)[p] = I[k];
+         (*AA)[p] = mirror > 0 ? CONJ(A[k]) : -A[k];
+      }
+   }
+   free(next); free(I); free(J); free(A);
+
+   /* Sort the columns in every row */
+
+   #ifdef _OPENMP
+   #pragma omp parallel for schedule(dynamic, 256)
+   #endif
+   for (i=0; i<m; i++) {
+      sortRow(&(*JA)[(*IA)[i]-1], &(*AA)[(*IA)[i]-1], (*IA)[i+1] - (*IA)[i]);
+   }
+
+   return 0;
+}
+
+/******************************************************************************
+ * Synthetic matrices
+ *
+ * readMatrixNative generates the matrix in memory when its name is
+ * gen:KIND:ARG1:ARG2..., with KIND and arguments
+ *
+ *   lap2d:NX[:NY]                5-point Laplacian on a NX x NY grid
+ *   lap3d:NX[:NY:NZ]             7-point Laplacian on a NX x NY x NZ grid
+ *   banded:N:W[:SEED]            random Hermitian matrix with W diagonals
+ *                                at each side of the main diagonal
+ *   powerlaw:N:DEG[:GAMMA[:SEED]]  I + Laplacian of a random graph with
+ *                                average degree DEG and a power law degree
+ *                                distribution with exponent GAMMA (2.5)
+ *   svd:M:N[:lin|geo[:SEED]]     M x N matrix with singular values 1..K
+ *                                (lin), or 10^(-6i/(K-1)), i=0..K-1 (geo),
+ *                                with K = min(M,N), mixed by random Givens
+ *                                rotations of rows and columns
+ *
+ * The random numbers come from a fixed generator (splitmix64) seeded with
+ * SEED (1 by default), so a name gives the same matrix on every machine.
+ *
+******************************************************************************/
+
+/* Maximum number of arguments of a generated matrix */
+#define GEN_MAX_ARGS 5
+
+static double genRandom(uint64_t *state) {
+   uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+   z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+   z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+   z ^= z >> 31;
+   return (double)(z >> 11) * (1.0/9007199254740992.0);
+}
+
+/* Adds the entries with the same column in every row of a sorted CSR */
+
+static void sumDuplicates(int m, int *IA, int *JA, SCALAR *A, int *nnz) {
+   int i, j, p = 0;
+
+   for (i=0; i<m; i++) {
+      int start = IA[i]-1, end = IA[i+1]-1;
+      IA[i] = p+1;
+      for (j=start; j<end; j++) {
+         if (p > IA[i]-1 && JA[p-1] == JA[j]) {
+            A[p-1] += A[j];
+         }
+         else {
+            JA[p] = JA[j];
+            A[p] = A[j];
+            p++;
+         }
+      }
+   }
+   IA[m] = p+1;
+   *nnz = p;
+}
+
+/* Allocates the COO arrays for nnz entries */
+
+static void allocCOO(long nnz, int **I, int **J, SCALAR **A) {
+   *I = (int *)primme_calloc(max(nnz, 1), sizeof(int), "I");
+   *J = (int *)primme_calloc(max(nnz, 1), sizeof(int), "J");
+   *A = (SCALAR *)primme_calloc(max(nnz, 1), sizeof(SCALAR), "A");
+}
+
+/* Laplacian with Dirichlet boundary conditions on a grid of nx x ny x nz */
+/* (lower triangular part)                                               */
+
+static long genLaplacian(int nx, int ny, int nz, int **I, int **J, SCALAR **A) {
+   long n = (long)nx*ny*nz, k, p = 0;
+   int dim = 1 + (ny > 1) + (nz > 1);
+
+   allocCOO(n*(dim+1), I, J, A);
+   for (k=0; k<n; k++) {
+      int x = (int)(k%nx), y = (int)((k/nx)%ny), z = (int)(k/((long)nx*ny));
+      (*I)[p] = (*J)[p] = (int)k+1; (*A)[p++] = 2.0*dim;
+      if (x > 0)  {(*I)[p] = (int)k+1; (*J)[p] = (int)k;         (*A)[p++] = -1.0;}
+      if (y > 0)  {(*I)[p] = (int)k+1; (*J)[p] = (int)(k+1-nx);    (*A)[p++] = -1.0;}
+      if (z > 0)  {(*I)[p] = (int)k+1; (*J)[p] = (int)(k+1-(long)nx*ny); (*A)[p++] = -1.0;}
+   }
+   return p;
+}
+
+/* Random band matrix (lower triangular part) */
+
+static long genBanded(int n, int w, uint64_t seed, int **I, int **J, SCALAR **A) {
+   long p = 0;
+   int i, j;
+
+   allocCOO((long)n*(w+1), I, J, A);
+   for (i=0; i<n; i++) {
+      (*I)[p] = (*J)[p] = i+1;
+      (*A)[p++] = 2.0*w*genRandom(&seed);
+      for (j=max(0, i-w); j<i; j++) {
+         (*I)[p] = i+1;
+         (*J)[p] = j+1;
+         (*A)[p] = 2.0*genRandom(&seed) - 1.0;
+#ifdef USE_COMPLEX
+         (*A)[p] += (2.0*genRandom(&seed) - 1.0)*IMAGINARY;
+#endif
+         p++;
+      }
+   }
+   return p;
+}
+
+/* I + Laplacian of a Chung-Lu graph, node i with weight (i+1)^(-1/(gamma-1)) */
+/* (lower triangular part, repeated edges add up)                            */
+
+static long genPowerLaw(int n, double deg, double gamma, uint64_t seed,
+      int **I, int **J, SCALAR **A) {
+   long numEdges = (long)(n*deg/2), p = 0, e;
+   double *cdf;
+   int i;
+
+   cdf = (double *)primme_calloc(n, sizeof(double), "cdf");
+   for (i=0; i<n; i++) {
+      cdf[i] = (i > 0 ? cdf[i-1] : 0.0) + pow(i+1.0, -1.0/(gamma-1.0));
+   }
+   allocCOO(n + numEdges, I, J, A);
+   for (i=0; i<n; i++) {
+      (*I)[p] = (*J)[p] = i+1;
+      (*A)[p++] = 1.0;
+   }
+   for (e=0; e<numEdges; e++) {
+      int ends[2], k;
+      for (k=0; k<2; k++) {
+         /* Binary search of a random point in the cumulative weights */
+         double r = genRandom(&seed)*cdf[n-1];
+         int lo = 0, hi = n-1;
+         while (lo < hi) {
+            int mid = (lo + hi)/2;
+            if (cdf[mid] <= r) lo = mid+1; else hi = mid;
+         }
+         ends[k] = lo;
+      }
+      if (ends[0] == ends[1]) continue;
+      (*I)[p] = max(ends[0], ends[1])+1;
+      (*J)[p] = min(ends[0], ends[1])+1;
+      (*A)[p++] = -1.0;
+      (*A)[ends[0]] += 1.0;
+      (*A)[ends[1]] += 1.0;
+   }
+   free(cdf);
+   return p;
+}
+
+/* Applies a Givens rotation to random pairs of rows (or columns if trans) */
+/* of a COO matrix; every entry turns into two                           */
+
+static long givensCOO(int m, int trans, uint64_t *seed, long nnz, int **I,
+      int **J, SCALAR **A) {
+   int *I0 = *I, *J0 = *J, *perm, *pos, i;
+   SCALAR *A0 = *A;
+   double *c, *s;
+   long k, p = 0;
+
+   /* Pair perm[2i] with perm[2i+1], rotation angle of pair i */
+
+   perm = (int *)primme_calloc(m, sizeof(int), "perm");
+   pos = (int *)primme_calloc(m, sizeof(int), "pos");
+   c = (double *)primme_calloc(m/2+1, sizeof(double), "c");
+   s = (double *)primme_calloc(m/2+1, sizeof(double), "s");
+   for (i=0; i<m; i++) perm[i] = i;
+   for (i=m-1; i>0; i--) {
+      int j = (int)(genRandom(seed)*(i+1)), t = perm[i];
+      perm[i] = perm[j];
+      perm[j] = t;
+   }
+   for (i=0; i<m; i++) pos[perm[i]] = i;
+   for (i=0; i<m/2; i++) {
+      double theta = 6.283185307179586*genRandom(seed);
+      c[i] = cos(theta);
+      s[i] = sin(theta);
+   }
 
-   job = 3;
-   value2 = 1;
+   allocCOO(2*nnz, I, J, A);
+   for (k=0; k<nnz; k++) {
+      int r = (trans ? J0[k] : I0[k]) - 1, q = pos[r], other;
+      double cr, sr;
+      if (q/2 >= m/2) {
+         /* Unpaired row */
+         (*I)[p] = I0[k]; (*J)[p] = J0[k]; (*A)[p++] = A0[k];
+         continue;
+      }
+      other = perm[q^1];
+      cr = c[q/2];
+      sr = (q&1) ? -s[q/2] : s[q/2];
+      /* [first; second] <- [c s; -s c]*[first; second] */
+      (*I)[p] = I0[k]; (*J)[p] = J0[k]; (*A)[p++] = cr*A0[k];
+      if (trans) {
+         (*I)[p] = I0[k]; (*J)[p] = other+1;
+      }
+      else {
+         (*I)[p] = other+1; (*J)[p] = J0[k];
+      }
+      (*A)[p++] = -sr*A0[k];
+   }
+   free(I0); free(J0); free(A0);
+   free(perm); free(pos); free(c); free(s);
+   return p;
+}
+
+/* Singular values on the diagonal, mixed by rotations of rows and columns */
+
+static long genSVD(int m, int n, int geo, uint64_t seed, int **I, int **J,
+      SCALAR **A) {
+   int k = min(m, n), i;
+   long nnz;
+
+   allocCOO(k, I, J, A);
+   for (i=0; i<k; i++) {
+      (*I)[i] = (*J)[i] = i+1;
+      (*A)[i] = geo ? (k > 1 ? pow(10.0, -6.0*i/(k-1)) : 1.0) : (double)(i+1);
+   }
+   nnz = givensCOO(m, 0, &seed, k, I, J, A);
+   return givensCOO(n, 1, &seed, nnz, I, J, A);
+}
+
+static int generateMatrix(const char *name, CSRMatrix *matrix) {
+   char kind[32], word[32] = "";
+   double arg[GEN_MAX_ARGS], m = 0, n = 0;
+   int numArgs = 0, mirror = 1, *I = NULL, *J = NULL;
+   const char *p;
+   SCALAR *A = NULL;
+   long nnz = -1;
+
+   /* Split the name in gen:KIND:ARG1:ARG2... */
+
+   if (sscanf(name, "gen:%31[^:]", kind) != 1) return -1;
+   for (p = strchr(name+4, ':'); p && numArgs < GEN_MAX_ARGS; p = strchr(p+1, ':')) {
+      char *end;
+      double v = strtod(p+1, &end);
+      if (end == p+1) sscanf(p+1, "%31[^:]", word);
+      else arg[numArgs++] = v;
+   }
+#  define ARG(I, D) (numArgs > (I) ? arg[I] : (D))
+
+   if (numArgs < 1 || arg[0] < 1) {
+      fprintf(stderr, "ERROR: Invalid matrix '%s'\n", name);
+      return -1;
+   }
+   if (!strcmp(kind, "lap2d") || !strcmp(kind, "lap3d")) {
+      double nx = arg[0], ny = ARG(1, nx), nz = !strcmp(kind, "lap3d") ? ARG(2, nx) : 1;
+      m = n = nx*ny*nz;
+      if (ny >= 1 && nz >= 1 && n <= INT_MAX)
+         nnz = genLaplacian((int)nx, (int)ny, (int)nz, &I, &J, &A);
+   }
+   else if (!strcmp(kind, "banded") && numArgs >= 2) {
+      m = n = arg[0];
+      if (n <= INT_MAX && arg[1] >= 0 && arg[1] < n && n*(arg[1]+1) <= INT_MAX)
+         nnz = genBanded((int)n, (int)arg[1], (uint64_t)ARG(2, 1), &I, &J, &A);
+   }
+   else if (!strcmp(kind, "powerlaw") && numArgs >= 2) {
+      m = n = arg[0];
+      if (n <= INT_MAX && arg[1] > 0 && ARG(2, 2.5) > 1 && n*(arg[1]/2+1) <= INT_MAX)
+         nnz = genPowerLaw((int)n, arg[1], ARG(2, 2.5), (uint64_t)ARG(3, 1),
+               &I, &J, &A);
+   }
+   else if (!strcmp(kind, "svd") && numArgs >= 2) {
+      m = arg[0];
+      n = arg[1];
+      mirror = 0;
+      if (n >= 1 && m <= INT_MAX && n <= INT_MAX && 4*min(m, n) <= INT_MAX)
+         nnz = genSVD((int)m, (int)n, !strcmp(word, "geo"), (uint64_t)ARG(2, 1),
+               &I, &J, &A);
+   }
+#  undef ARG
+
+   if (nnz < 0) {
+      fprintf(stderr, "ERROR: Invalid matrix '%s'\n", name);
+      return -1;
+   }
+   if (COOtoCSR((int)m, (int)n, (int)nnz, I, J, A, mirror, &matrix->IA,
+            &matrix->JA, &matrix->AElts, &matrix->nnz) != 0) {
+      return -1;
+   }
+   sumDuplicates((int)m, matrix->IA, matrix->JA, matrix->AElts, &matrix->nnz);
+   matrix->m = (int)m;
+   matrix->n = (int)n;
+   return 0;
+}
+
+/******************************************************************************
+ * Binary CSR format
+ *
+ * The file is a 128-byte header followed by the arrays IA, JA and AElts,
+ * each starting at a 64-byte aligned offset and stored exactly as in
+ * CSRMatrix (32-bit integers with Fortran indexing, and double or double
+ * complex values), in the byte order of the machine that wrote it. So
+ * readMatrixNative maps the file into memory and points the matrix arrays
+ * into it, with no parsing. The mapping is private, so changes to the
+ * arrays (e.g., shiftCSRMatrix) are not written back to the file.
+ *
+ * The checksum is a position-dependent sum of the 32-bit words of the
+ * three arrays; it is checked on every read.
+ *
+******************************************************************************/
+
+#define CSR_BINARY_MAGIC   "PRIMMCSR"
+#define CSR_BINARY_VERSION 1
+#define CSR_BINARY_ALIGN   64
+
+typedef struct {
+   char magic[8];        /* CSR_BINARY_MAGIC */
+   uint32_t version;     /* CSR_BINARY_VERSION; also detects byte order */
+   uint32_t flags;       /* CSR_BINARY_COMPLEX | CSR_BINARY_HERMITIAN */
+   int64_t m, n, nnz;    /* rows, columns and nonzeros */
+   uint64_t checksum;    /* checksum of IA, JA and AElts */
+   uint64_t offIA, offJA, offA; /* offsets of the arrays from the beginning */
+   char reserved[56];    /* zero; pads the header to 128 bytes */
+} CSRBinaryHeader;
+
+typedef struct {
+   uint64_t s1, s2;
+} CSRChecksum;
+
+static void updateChecksum(CSRChecksum *c, const void *buf, size_t bytes) {
+   const uint32_t *w = (const uint32_t*)buf;
+   size_t i, n = bytes/sizeof(uint32_t);
+   uint64_t s1 = c->s1, s2 = c->s2;
+
+   for (i=0; i<n; i++) {
+      s1 += w[i];
+      s2 += s1;
+   }
+   c->s1 = s1;
+   c->s2 = s2;
+}
 
-   ssrcsr(&job, &value2, n, *A, *JA, *IA, &nzmax, *A, *JA, *IA, iwk1, iwk2,
-      &ierror);
-   *nnz = 2*(*nnz) - *n;
+static uint64_t finalChecksum(const CSRChecksum *c) {
+   return c->s2 ^ ((c->s1 << 32) | (c->s1 >> 32));
+}
+
+static uint64_t alignOffset(uint64_t off) {
+   return (off + CSR_BINARY_ALIGN - 1) / CSR_BINARY_ALIGN * CSR_BINARY_ALIGN;
+}
 
-   free(iwk1);
-   free(iwk2);
+static int isBinaryCSR(const char *fileName) {
+   char magic[8];
+   FILE *f;
+   int ret;
 
-   return(0);
+   f = fopen(fileName, "rb");
+   if (f == NULL) return 0;
+   ret = fread(magic, 1, 8, f) == 8 && !memcmp(magic, CSR_BINARY_MAGIC, 8);
+   fclose(f);
+   return ret;
 }
+
+static int readBinaryCSR(const char *fileName, CSRMatrix *matrix) {
+   int fd;
+   struct stat st;
+   void *map;
+   size_t size, valueSize;
+   const CSRBinaryHeader *h;
+   CSRChecksum c = {0, 0};
+
+   fd = open(fileName, O_RDONLY);
+   if (fd < 0) return -1;
+   if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CSRBinaryHeader)) {
+      close(fd);
+      return -1;
+   }
+   size = (size_t)st.st_size;
+   map = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if (map == MAP_FAILED) return -1;
+   h = (const CSRBinaryHeader*)map;
+
+   /* Check the header */
+
+   valueSize = (h->flags & CSR_BINARY_COMPLEX) ? 2*sizeof(double)
+                                               : sizeof(double);
+   if (h->version != CSR_BINARY_VERSION) {
+      fprintf(stderr, "Binary CSR version %u not supported (wrong byte order?)\n",
+            (unsigned int)h->version);
+      munmap(map, size);
+      return -1;
+   }
+   if (h->m < 0 || h->n < 0 || h->nnz < 0 || h->m >= INT_MAX
+         || h->n > INT_MAX || h->nnz > INT_MAX
+         || h->offIA % CSR_BINARY_ALIGN || h->offJA % CSR_BINARY_ALIGN
+         || h->offA % CSR_BINARY_ALIGN
+         || h->offIA + (uint64_t)(h->m+1)*sizeof(int) > size
+         || h->offJA + (uint64_t)h->nnz*sizeof(int) > size
+         || h->offA + (uint64_t)h->nnz*valueSize > size) {
+      fprintf(stderr, "Invalid binary CSR header\n");
+      munmap(map, size);
+      return -1;
+   }
+#ifndef USE_COMPLEX
+   if (h->flags & CSR_BINARY_COMPLEX) {
+      fprintf(stderr, "Complex matrix not supported in real arithmetic\n");
+      munmap(map, size);
+      return -1;
+   }
 #endif
 
+   updateChecksum(&c, (char*)map + h->offIA, (h->m+1)*sizeof(int));
+   updateChecksum(&c, (char*)map + h->offJA, h->nnz*sizeof(int));
+   updateChecksum(&c, (char*)map + h->offA, h->nnz*valueSize);
+   if (finalChecksum(&c) != h->checksum) {
+      fprintf(stderr, "Binary CSR checksum mismatch\n");
+      munmap(map, size);
+      return -1;
+   }
+
+   matrix->m = (int)h->m;
+   matrix->n = (int)h->n;
+   matrix->nnz = (int)h->nnz;
+   matrix->IA = (int*)((char*)map + h->offIA);
+   matrix->JA = (int*)((char*)map + h->offJA);
+   if (valueSize == sizeof(SCALAR)) {
+      matrix->AElts = (SCALAR*)((char*)map + h->offA);
+   }
+   else {
+      /* Real values in complex arithmetic */
+      const double *a = (const double*)((char*)map + h->offA);
+      int i;
+      matrix->AElts = (SCALAR*)primme_calloc(matrix->nnz, sizeof(SCALAR),
+            "AElts");
+      for (i=0; i<matrix->nnz; i++) matrix->AElts[i] = a[i];
+   }
+   matrix->map = map;
+   matrix->mapSize = size;
+
+   return 0;
+}
+
+static int writePadded(FILE *f, const void *buf, size_t bytes, uint64_t off,
+      uint64_t *pos, CSRChecksum *c) {
+   static const char zeros[CSR_BINARY_ALIGN] = {0};
+
+   while (*pos < off) {
+      size_t k = min(off - *pos, sizeof(zeros));
+      if (fwrite(zeros, 1, k, f) != k) return -1;
+      *pos += k;
+   }
+   if (bytes > 0 && fwrite(buf, 1, bytes, f) != bytes) return -1;
+   updateChecksum(c, buf, bytes);
+   *pos += bytes;
+   return 0;
+}
+
+/******************************************************************************
+ * Writes a CSR matrix in the binary format read by readMatrixNative.
+ * If flags has CSR_BINARY_COMPLEX the values are written as double complex,
+ * otherwise only their real parts are written.
+ *
+******************************************************************************/
+int writeMatrixBinary(const char* matrixFileName, const CSRMatrix *matrix, int flags) {
+   CSRBinaryHeader h;
+   CSRChecksum c = {0, 0};
+   uint64_t pos = 0;
+   FILE *f;
+   int ret = 0;
+
+#ifndef USE_COMPLEX
+   if (flags & CSR_BINARY_COMPLEX) return -1;
+#endif
+
+   memset(&h, 0, sizeof(h));
+   memcpy(h.magic, CSR_BINARY_MAGIC, 8);
+   h.version = CSR_BINARY_VERSION;
+   h.flags = flags;
+   h.m = matrix->m;
+   h.n = matrix->n;
+   h.nnz = matrix->nnz;
+   h.offIA = alignOffset(sizeof(CSRBinaryHeader));
+   h.offJA = alignOffset(h.offIA + (uint64_t)(h.m+1)*sizeof(int));
+   h.offA = alignOffset(h.offJA + (uint64_t)h.nnz*sizeof(int));
+
+   f = fopen(matrixFileName, "wb");
+   if (f == NULL) return -1;
+
+   /* Write the header at the end, when the checksum is known */
+
+   if (writePadded(f, matrix->IA, (matrix->m+1)*sizeof(int), h.offIA, &pos, &c)
+         || writePadded(f, matrix->JA, matrix->nnz*sizeof(int), h.offJA, &pos, &c)
+         || writePadded(f, NULL, 0, h.offA, &pos, &c)) {
+      ret = -1;
+   }
+   else if ((flags & CSR_BINARY_COMPLEX) || sizeof(SCALAR) == sizeof(double)) {
+      ret = writePadded(f, matrix->AElts, matrix->nnz*sizeof(SCALAR), pos,
+            &pos, &c);
+   }
+   else {
+      /* Write the real parts by chunks */
+      double buf[1024];
+      int i, j, k;
+      for (i=0; i<matrix->nnz && ret == 0; i+=k) {
+         k = min(matrix->nnz - i, 1024);
+         for (j=0; j<k; j++) buf[j] = REAL_PART(matrix->AElts[i+j]);
+         ret = writePadded(f, buf, k*sizeof(double), pos, &pos, &c);
+      }
+   }
+
+   h.checksum = finalChecksum(&c);
+   if (ret == 0 && (fseek(f, 0, SEEK_SET) != 0
+            || fwrite(&h, sizeof(h), 1, f) != 1)) {
+      ret = -1;
+   }
+   if (fclose(f) != 0) ret = -1;
+
+   return ret;
+}
+
+/******************************************************************************
+ * Reverse Cuthill-McKee reordering
+ *
+ * The nodes are the rows and the edges are the entries out of the diagonal
+ * (the matrix pattern is supposed to be symmetric, otherwise the pattern of
+ * the rows is used). Every connected component is numbered by a breadth-first
+ * search from a pseudo-peripheral node, visiting the neighbors by increasing
+ * degree, and the final order is reversed.
+ *
+******************************************************************************/
+
+/* Maximum number of searches for a pseudo-peripheral node per component */
+#ifndef RCM_MAX_ROOT_SEARCHES
+#define RCM_MAX_ROOT_SEARCHES 8
+#endif
+
+/* Breadth-first search from root with the unnumbered nodes (mark < 0).
+   Returns the number of levels and the nodes by levels in queue; on return
+   *lastLevel is the start of the last level in queue */
+
+static int rcmLevels(const CSRMatrix *matrix, int root, int *mark, int *queue,
+      int *size, int *lastLevel) {
+   int head, tail, levelEnd, numLevels, i, j;
+
+   queue[0] = root;
+   mark[root] = 0;
+   for (head=0, tail=1, numLevels=0; head < tail; numLevels++) {
+      *lastLevel = head;
+      for (levelEnd=tail; head < levelEnd; head++) {
+         i = queue[head];
+         for (j=matrix->IA[i]-1; j<matrix->IA[i+1]-1; j++) {
+            int k = matrix->JA[j]-1;
+            if (mark[k] < 0) {
+               mark[k] = 0;
+               queue[tail++] = k;
+            }
+         }
+      }
+   }
+   for (i=0; i<tail; i++) mark[queue[i]] = -1;
+   *size = tail;
+   return numLevels;
+}
+
+/* Replaces the matrix by P*A*P', where the row and column i of the result
+   are the row and column perm[i] of A, and inv is the inverse of perm */
+
+static void permuteCSRMatrix(CSRMatrix *matrix, const int *perm, const int *inv) {
+   int n = matrix->n, i, *IA, *JA;
+   SCALAR *A;
+
+   IA = (int *)primme_calloc(n+1, sizeof(int), "IA");
+   JA = (int *)primme_calloc(matrix->nnz, sizeof(int), "JA");
+   A = (SCALAR *)primme_calloc(matrix->nnz, sizeof(SCALAR), "A");
+   IA[0] = 1;
+   for (i=0; i<n; i++) {
+      IA[i+1] = IA[i] + matrix->IA[perm[i]+1] - matrix->IA[perm[i]];
+   }
+
+   #ifdef _OPENMP
+   #pragma omp parallel for schedule(dynamic, 256)
+   #endif
+   for (i=0; i<n; i++) {
+      int j, p = IA[i]-1, q = matrix->IA[perm[i]]-1, len = IA[i+1]-IA[i];
+      for (j=0; j<len; j++) {
+         JA[p+j] = inv[matrix->JA[q+j]-1]+1;
+         A[p+j] = matrix->AElts[q+j];
+      }
+      sortRow(&JA[p], &A[p], len);
+   }
+
+   freeCSRMatrixArrays(matrix);
+   matrix->IA = IA;
+   matrix->JA = JA;
+   matrix->AElts = A;
+}
+
+/******************************************************************************
+ * Reorders symmetrically a square CSR matrix with reverse Cuthill-McKee.
+ * On return, the row and column i of the matrix were the row and column
+ * (*perm)[i] of the original one; perm is allocated by this function.
+ *
+******************************************************************************/
+int reorderCSRMatrixRCM(CSRMatrix *matrix, int **perm_) {
+   int n = matrix->n, i, j, k, c, head, tail, *perm, *deg, *byDeg, *mark,
+       *queue, *inv;
+
+   if (matrix->m != n) return -1;
+
+   /* Sort the nodes by degree (counting sort) */
+
+   deg = (int *)primme_calloc(n, sizeof(int), "deg");
+   byDeg = (int *)primme_calloc(n+1, sizeof(int), "byDeg");
+   mark = (int *)primme_calloc(n, sizeof(int), "mark");
+   queue = (int *)primme_calloc(n, sizeof(int), "queue");
+   perm = (int *)primme_calloc(n, sizeof(int), "perm");
+   for (i=0; i<=n; i++) byDeg[i] = 0;
+   for (i=0; i<n; i++) {
+      deg[i] = matrix->IA[i+1] - matrix->IA[i];
+      for (j=matrix->IA[i]-1; j<matrix->IA[i+1]-1; j++) {
+         if (matrix->JA[j]-1 == i) deg[i]--;
+      }
+      deg[i] = min(max(deg[i], 0), n-1);
+      byDeg[deg[i]+1]++;
+      mark[i] = -1;
+   }
+   for (i=0; i<n; i++) byDeg[i+1] += byDeg[i];
+   for (i=0; i<n; i++) queue[byDeg[deg[i]]++] = i;
+   memcpy(byDeg, queue, sizeof(int)*n);
+
+   /* Number every connected component */
+
+   for (c=0, k=0; k<n; ) {
+      int root, size, last, numLevels;
+
+      /* Start from the unnumbered node with the smallest degree, and move */
+      /* to a node with minimum degree in the last level while the number  */
+      /* of levels increases (George-Liu)                                  */
+
+      while (mark[byDeg[c]] >= 0) c++;
+      root = byDeg[c];
+      numLevels = rcmLevels(matrix, root, mark, queue, &size, &last);
+      for (i=0; i<RCM_MAX_ROOT_SEARCHES; i++) {
+         int x = queue[last], l, s, nl;
+         for (j=last+1; j<size; j++) if (deg[queue[j]] < deg[x]) x = queue[j];
+         nl = rcmLevels(matrix, x, mark, queue, &s, &l);
+         if (nl <= numLevels) break;
+         root = x;
+         numLevels = nl;
+         last = l;
+      }
+
+      /* Cuthill-McKee from root */
+
+      perm[k] = root;
+      mark[root] = k;
+      for (head=k, tail=k+1; head < tail; head++) {
+         int node = perm[head], first = tail;
+         for (j=matrix->IA[node]-1; j<matrix->IA[node+1]-1; j++) {
+            int x = matrix->JA[j]-1;
+            if (mark[x] < 0) {
+               mark[x] = tail;
+               perm[tail++] = x;
+            }
+         }
+         /* Sort the new nodes by degree (insertion sort) */
+         for (i=first+1; i<tail; i++) {
+            int x = perm[i];
+            for (j=i; j>first && deg[perm[j-1]] > deg[x]; j--) perm[j] = perm[j-1];
+            perm[j] = x;
+         }
+      }
+      k = tail;
+   }
+
+   /* Reverse the order */
+
+   for (i=0; i<n/2; i++) {
+      j = perm[i];
+      perm[i] = perm[n-1-i];
+      perm[n-1-i] = j;
+   }
+   free(deg); free(byDeg); free(mark); free(queue);
+
+   /* Apply the permutation to rows and columns */
+
+   inv = (int *)primme_calloc(n, sizeof(int), "inv");
+   for (i=0; i<n; i++) inv[perm[i]] = i;
+   permuteCSRMatrix(matrix, perm, inv);
+   free(inv);
+
+   *perm_ = perm;
+   return 0;
+}
+
+/******************************************************************************
+ * Computes the bandwidth, max |i-j| with A_ij != 0, and the profile,
+ * \sum_i (i - min {j <= i : A_ij != 0}), of a CSR matrix
+ *
+******************************************************************************/
+void bandwidthCSRMatrix(const CSRMatrix *matrix, int *bandwidth, double *profile) {
+   int i, j, bw = 0;
+   double pr = 0.0;
+
+   for (i=0; i < matrix->m; i++) {
+      int first = i;
+      for (j=matrix->IA[i]-1; j < matrix->IA[i+1]-1; j++) {
+         int c = matrix->JA[j]-1;
+         bw = max(bw, abs(i - c));
+         first = min(first, c);
+      }
+      pr += i - first;
+   }
+   *bandwidth = bw;
+   *profile = pr;
+}
+
+/******************************************************************************
+ * Real flops and bytes moved by a product with a single vector, with x and y
+ * read or written once
+ *
+******************************************************************************/
+void CSRMatrixTraffic(const CSRMatrix *matrix, double *flops, double *bytes) {
+   *flops = 2.0*FLOPS_SCALAR*matrix->nnz;
+   *bytes = (double)matrix->nnz*(sizeof(SCALAR) + sizeof(int))
+      + (double)(matrix->m + 1)*sizeof(int)
+      + (double)matrix->m*sizeof(SCALAR) + (double)matrix->n*sizeof(SCALAR);
+}
+
 /******************************************************************************
  * Computed the Frobenius norm of a CSR matrix 
  *
@@ -283,10 +1284,25 @@ void shiftCSRMatrix(double shift, CSRMatrix *matrix) {
 
 }
 
+/******************************************************************************
+ * Frees the arrays of a CSR matrix, or unmaps them if they come from a
+ * binary file
+ *
+******************************************************************************/
+void freeCSRMatrixArrays(CSRMatrix *matrix) {
+   char *map = (char*)matrix->map;
+
+#define IN_MAP(P) (map && (char*)(P) >= map && (char*)(P) < map + matrix->mapSize)
+   if (!IN_MAP(matrix->AElts)) free(matrix->AElts);
+   if (!IN_MAP(matrix->IA)) free(matrix->IA);
+   if (!IN_MAP(matrix->JA)) free(matrix->JA);
+#undef IN_MAP
+   if (map) munmap(map, matrix->mapSize);
+   matrix->map = NULL;
+}
+
 void freeCSRMatrix(CSRMatrix *matrix) {
    if (!matrix) return;
-   free(matrix->AElts);
-   free(matrix->IA);
-   free(matrix->JA);
+   freeCSRMatrixArrays(matrix);
    free(matrix);
 }
@@ -37,11 +37,22 @@ typedef struct {
    int m; /* number of rows */
    int n; /* number of columns */
    int nnz;
+   void *map;      /* file mapping holding the arrays (see readMatrixNative) */
+   size_t mapSize; /* size of map in bytes */
 } CSRMatrix;
 
+/* Flags of the binary CSR format */
+#define CSR_BINARY_COMPLEX   1 /* values are double complex, otherwise double */
+#define CSR_BINARY_HERMITIAN 2 /* matrix is symmetric/Hermitian */
+
 int readMatrixNative(const char* matrixFileName, CSRMatrix **matrix_, double *fnorm);
+int writeMatrixBinary(const char* matrixFileName, const CSRMatrix *matrix, int flags);
+int reorderCSRMatrixRCM(CSRMatrix *matrix, int **perm);
+void bandwidthCSRMatrix(const CSRMatrix *matrix, int *bandwidth, double *profile);
+void CSRMatrixTraffic(const CSRMatrix *matrix, double *flops, double *bytes);
 double frobeniusNorm(const CSRMatrix *matrix);
 void shiftCSRMatrix(double shift, CSRMatrix *matrix);
+void freeCSRMatrixArrays(CSRMatrix *matrix);
 void freeCSRMatrix(CSRMatrix *matrix);
 
 #define CSR_H
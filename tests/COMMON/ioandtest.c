@@ -28,8 +28,13 @@
  ******************************************************************************/
 
 #include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 #include <math.h>
 #include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include "primme.h"
 #include "num.h"
 #include "ioandtest.h"
@@ -87,6 +92,15 @@ int check_solution(const char *checkXFileName, primme_params *primme, double *ev
            fprintf(stderr, "Warning: discrepancy in primme." #F ", %d should be close to %d\n", (int)primme-> F , (int)primme0. F ); \
            retX = 1; \
         }
+#  define CHECK_PRIMME_PARAM_NONZERO(F) \
+        if ((primme0. F > 0) != (primme-> F > 0)) { \
+           fprintf(stderr, "Warning: discrepancy in primme." #F ", %d should be nonzero like %d\n", (int)primme-> F , (int)primme0. F ); \
+           retX = 1; \
+        }
+
+   /* With checkInterface 2 the iterations depend on timings, for instance */
+   /* with precondParams.async, so the estimate of ||A|| and the counters  */
+   /* are not compared; only the presence of factorizations is checked    */
 
    if (primme0.n && checkInterface) {
       CHECK_PRIMME_PARAM(n);
@@ -110,16 +124,23 @@ int check_solution(const char *checkXFileName, primme_params *primme, double *ev
       CHECK_PRIMME_PARAM(correctionParams.projectors.SkewQ);
       CHECK_PRIMME_PARAM(correctionParams.projectors.SkewX);
       CHECK_PRIMME_PARAM(correctionParams.convTest);
-      CHECK_PRIMME_PARAM_DOUBLE(aNorm);
       CHECK_PRIMME_PARAM_DOUBLE(eps);
       CHECK_PRIMME_PARAM_DOUBLE(correctionParams.relTolBase);
       CHECK_PRIMME_PARAM(initSize);
-      CHECK_PRIMME_PARAM_TOL(stats.numMatvecs, 40);
+      if (checkInterface == 2) {
+         CHECK_PRIMME_PARAM_NONZERO(stats.numFactorizations);
+      }
+      else {
+         CHECK_PRIMME_PARAM_DOUBLE(aNorm);
+         CHECK_PRIMME_PARAM_TOL(stats.numMatvecs, 40);
+         CHECK_PRIMME_PARAM_TOL(stats.numFactorizations, 40);
+      }
    }
 
 #  undef CHECK_PRIMME_PARAM
 #  undef CHECK_PRIMME_PARAM_DOUBLE
 #  undef CHECK_PRIMME_PARAM_TOL
+#  undef CHECK_PRIMME_PARAM_NONZERO
 
    i = max(cols, primme->initSize);
    h = (SCALAR *)primme_calloc(i*2, sizeof(SCALAR), "h"); h0 = &h[i];
@@ -191,67 +212,359 @@ int check_solution(const char *checkXFileName, primme_params *primme, double *ev
    return retX; 
 }
 
+/******************************************************************************
+ * Vector files
+ *
+ * The vectors are stored by columns with the rows in the global order (for
+ * singular vectors, all the columns of U and then all of V), after a header
+ * with the arithmetic, the dimensions and the number of columns, and
+ * followed by a section with some of the members of primme_params or
+ * primme_svds_params, as lines "name = value". Unknown members are ignored
+ * when reading, so adding members does not invalidate older files.
+ *
+ * Every process reads and writes only its own rows, with pread and pwrite.
+ * If there is a permutation, the rows are sorted by their global index and
+ * moved in blocks of consecutive rows through a buffer.
+ *
+ * Files written before this format, with the whole primme_params struct
+ * after the vectors, can still be read.
+ *
+******************************************************************************/
+
+#define VEC_FILE_MAGIC   "PRIMMEVX"
+#define VEC_FILE_VERSION 1
+
+/* Maximum number of rows moved by a single read or write with permutation */
+#ifndef VEC_FILE_BLOCK_ROWS
+#define VEC_FILE_BLOCK_ROWS 65536
+#endif
+
+typedef struct {
+   char magic[8];          /* VEC_FILE_MAGIC */
+   uint32_t version;       /* VEC_FILE_VERSION */
+   uint32_t scalarSize;    /* sizeof(SCALAR) */
+   int64_t m, n;           /* rows of the left and right vectors (m = 0 for eigenvectors) */
+   int64_t cols;           /* number of columns */
+   uint64_t dataOffset;    /* offset of the vectors */
+   uint64_t paramsOffset;  /* offset of the parameters */
+   uint64_t paramsSize;    /* size in bytes of the parameters */
+} VecFileHeader;
+
+typedef struct {
+   const char *name;
+   size_t offset;
+   char type;              /* 'i' int or enum, 'l' PRIMME_INT, 'd' double */
+} VecFileParam;
+
+#define PARAM(S, F, T) {#F, offsetof(S, F), T}
+
+static const VecFileParam primmeFileParams[] = {
+   PARAM(primme_params, n, 'l'),
+   PARAM(primme_params, numEvals, 'i'),
+   PARAM(primme_params, target, 'i'),
+   PARAM(primme_params, numTargetShifts, 'i'),
+   PARAM(primme_params, dynamicMethodSwitch, 'i'),
+   PARAM(primme_params, locking, 'i'),
+   PARAM(primme_params, numOrthoConst, 'i'),
+   PARAM(primme_params, maxBasisSize, 'i'),
+   PARAM(primme_params, minRestartSize, 'i'),
+   PARAM(primme_params, maxBlockSize, 'i'),
+   PARAM(primme_params, initSize, 'i'),
+   PARAM(primme_params, aNorm, 'd'),
+   PARAM(primme_params, eps, 'd'),
+   PARAM(primme_params, restartingParams.scheme, 'i'),
+   PARAM(primme_params, restartingParams.maxPrevRetain, 'i'),
+   PARAM(primme_params, correctionParams.precondition, 'i'),
+   PARAM(primme_params, correctionParams.robustShifts, 'i'),
+   PARAM(primme_params, correctionParams.maxInnerIterations, 'i'),
+   PARAM(primme_params, correctionParams.projectors.LeftQ, 'i'),
+   PARAM(primme_params, correctionParams.projectors.LeftX, 'i'),
+   PARAM(primme_params, correctionParams.projectors.RightQ, 'i'),
+   PARAM(primme_params, correctionParams.projectors.RightX, 'i'),
+   PARAM(primme_params, correctionParams.projectors.SkewQ, 'i'),
+   PARAM(primme_params, correctionParams.projectors.SkewX, 'i'),
+   PARAM(primme_params, correctionParams.convTest, 'i'),
+   PARAM(primme_params, correctionParams.relTolBase, 'd'),
+   PARAM(primme_params, stats.numOuterIterations, 'l'),
+   PARAM(primme_params, stats.numMatvecs, 'l'),
+   PARAM(primme_params, stats.numFactorizations, 'l'),
+   {NULL, 0, 0}
+};
+
+static const VecFileParam primmeSvdsFileParams[] = {
+   PARAM(primme_svds_params, m, 'l'),
+   PARAM(primme_svds_params, n, 'l'),
+   PARAM(primme_svds_params, numSvals, 'i'),
+   PARAM(primme_svds_params, target, 'i'),
+   PARAM(primme_svds_params, numTargetShifts, 'i'),
+   PARAM(primme_svds_params, method, 'i'),
+   PARAM(primme_svds_params, methodStage2, 'i'),
+   PARAM(primme_svds_params, locking, 'i'),
+   PARAM(primme_svds_params, numOrthoConst, 'i'),
+   PARAM(primme_svds_params, maxBasisSize, 'i'),
+   PARAM(primme_svds_params, maxBlockSize, 'i'),
+   PARAM(primme_svds_params, initSize, 'i'),
+   PARAM(primme_svds_params, aNorm, 'd'),
+   PARAM(primme_svds_params, eps, 'd'),
+   PARAM(primme_svds_params, stats.numOuterIterations, 'l'),
+   PARAM(primme_svds_params, stats.numMatvecs, 'l'),
+   {NULL, 0, 0}
+};
+
+#undef PARAM
+
+/* Reads or writes all bytes, retrying short transfers */
+
+static int preadAll(int fd, void *buf, size_t bytes, off_t offset) {
+   char *p = (char*)buf;
+   while (bytes > 0) {
+      ssize_t r = pread(fd, p, bytes, offset);
+      if (r <= 0) return -1;
+      p += r; bytes -= r; offset += r;
+   }
+   return 0;
+}
+
+static int pwriteAll(int fd, const void *buf, size_t bytes, off_t offset) {
+   const char *p = (const char*)buf;
+   while (bytes > 0) {
+      ssize_t r = pwrite(fd, p, bytes, offset);
+      if (r <= 0) return -1;
+      p += r; bytes -= r; offset += r;
+   }
+   return 0;
+}
+
+/* Returns the local rows sorted by their global index perm[i] */
+
+static int *sortedRows(const int *perm, int nLocal) {
+   int *order, *count, i, maxg = 0;
+
+   /* Counting sort, as perm is a permutation of a subset of the rows */
+   for (i=0; i<nLocal; i++) maxg = max(maxg, perm[i]);
+   order = (int*)primme_calloc(nLocal, sizeof(int), "order");
+   count = (int*)primme_calloc(maxg+2, sizeof(int), "count");
+   for (i=0; i<maxg+2; i++) count[i] = 0;
+   for (i=0; i<nLocal; i++) count[perm[i]+1]++;
+   for (i=0; i<=maxg; i++) count[i+1] += count[i];
+   for (i=0; i<nLocal; i++) order[count[perm[i]]++] = i;
+   free(count);
+   return order;
+}
+
+/* Reads (write == 0) or writes the local rows of cols columns with n rows
+   stored from the given offset of the file. The local row i is the global
+   row perm[i], or i if perm is NULL */
+
+static int transferVectors(int fd, int write, off_t offset, PRIMME_INT n,
+      int cols, int nLocal, const int *perm, SCALAR *X, int ldX) {
+
+   int i, j, k, l, *order = NULL, ret = 0;
+   SCALAR *buf = NULL;
+
+   if (perm && nLocal > 0) {
+      order = sortedRows(perm, nLocal);
+      buf = (SCALAR*)primme_calloc(VEC_FILE_BLOCK_ROWS, sizeof(SCALAR), "buf");
+   }
+
+   for (i=0; i<cols && ret == 0; i++) {
+      off_t col = offset + (off_t)i*n*sizeof(SCALAR);
+
+      if (!order) {
+         ret = write ? pwriteAll(fd, &X[ldX*i], sizeof(SCALAR)*nLocal, col)
+                     : preadAll(fd, &X[ldX*i], sizeof(SCALAR)*nLocal, col);
+         continue;
+      }
+
+      for (j=0; j<nLocal && ret == 0; j=k) {
+         int g0 = perm[order[j]];
+         if (write) {
+            /* Write the largest block of consecutive rows starting at j */
+            for (k=j+1; k<nLocal && k-j<VEC_FILE_BLOCK_ROWS
+                  && perm[order[k]] == g0+k-j; k++);
+            for (l=j; l<k; l++) buf[l-j] = X[ldX*i+order[l]];
+            ret = pwriteAll(fd, buf, sizeof(SCALAR)*(k-j),
+                  col + (off_t)g0*sizeof(SCALAR));
+         }
+         else {
+            /* Read the block of rows [g0, g0+VEC_FILE_BLOCK_ROWS) that
+               contains rows starting at j, including the ones from others */
+            for (k=j+1; k<nLocal && perm[order[k]] < g0+VEC_FILE_BLOCK_ROWS; k++);
+            ret = preadAll(fd, buf, sizeof(SCALAR)*(perm[order[k-1]]-g0+1),
+                  col + (off_t)g0*sizeof(SCALAR));
+            for (l=j; l<k; l++) X[ldX*i+order[l]] = buf[perm[order[l]]-g0];
+         }
+      }
+   }
+
+   free(order);
+   free(buf);
+   return ret;
+}
+
+/* Writes the parameters in the table as lines "name = value" */
+
+static char *formatParams(const VecFileParam *t, const void *params, uint64_t *size) {
+   size_t len = 0, cap = 4096;
+   char *s = (char*)malloc(cap);
+
+   for (; t->name; t++) {
+      const char *p = (const char*)params + t->offset;
+      if (cap - len < 256) s = (char*)realloc(s, cap *= 2);
+      switch(t->type) {
+      case 'i': len += sprintf(s+len, "%s = %d\n", t->name, *(const int*)p); break;
+      case 'l': len += sprintf(s+len, "%s = %lld\n", t->name, (long long)*(const PRIMME_INT*)p); break;
+      case 'd': len += sprintf(s+len, "%s = %.17g\n", t->name, *(const double*)p); break;
+      }
+   }
+   *size = len;
+   return s;
+}
+
+/* Sets the members in the table from the lines "name = value" */
+
+static void parseParams(const VecFileParam *t0, char *s, void *params) {
+   char *line, *next, *eq;
+   const VecFileParam *t;
+
+   for (line=s; line && *line; line=next) {
+      if ((next = strchr(line, '\n'))) *next++ = 0;
+      if (!(eq = strstr(line, " = "))) continue;
+      *eq = 0;
+      for (t=t0; t->name && strcmp(t->name, line); t++);
+      if (!t->name) continue;
+      switch(t->type) {
+      case 'i': *(int*)((char*)params + t->offset) = (int)strtol(eq+3, NULL, 10); break;
+      case 'l': *(PRIMME_INT*)((char*)params + t->offset) = (PRIMME_INT)strtoll(eq+3, NULL, 10); break;
+      case 'd': *(double*)((char*)params + t->offset) = strtod(eq+3, NULL); break;
+      }
+   }
+}
+
+/* Opens a vector file for reading and reads its header. If the file has
+   the legacy format, it returns header->version == 0 */
+
+static int openVecFile(const char *fileName, VecFileHeader *header) {
+   int fd = open(fileName, O_RDONLY);
+
+   if (fd < 0) return -1;
+   memset(header, 0, sizeof(*header));
+   if (preadAll(fd, header, sizeof(*header), 0) != 0
+         || memcmp(header->magic, VEC_FILE_MAGIC, 8)) {
+      header->version = 0;
+   }
+   return fd;
+}
+
+/* Reads the parameters after the vectors in a file with the new format */
+
+static int readVecFileParams(int fd, const VecFileHeader *header,
+      const VecFileParam *t, void *params) {
+   char *s = (char*)malloc(header->paramsSize+1);
+
+   if (preadAll(fd, s, header->paramsSize, header->paramsOffset) != 0) {
+      free(s);
+      return -1;
+   }
+   s[header->paramsSize] = 0;
+   parseParams(t, s, params);
+   free(s);
+   return 0;
+}
+
+/* Sets the offsets in the header of a file with cols columns of m and n rows */
+
+static void initVecFileHeader(VecFileHeader *header, PRIMME_INT m, PRIMME_INT n,
+      int cols) {
+   memset(header, 0, sizeof(*header));
+   memcpy(header->magic, VEC_FILE_MAGIC, 8);
+   header->version = VEC_FILE_VERSION;
+   header->scalarSize = sizeof(SCALAR);
+   header->m = m;
+   header->n = n;
+   header->cols = cols;
+   header->dataOffset = sizeof(VecFileHeader);
+   header->paramsOffset = header->dataOffset
+      + (uint64_t)cols*(m + n)*sizeof(SCALAR);
+}
+
+/* Writes the header and the parameters (only process 0) */
+
+static int writeVecFileHeader(int fd, VecFileHeader *header,
+      const VecFileParam *t, const void *params) {
+   char *s;
+   int ret;
+
+   s = formatParams(t, params, &header->paramsSize);
+   ret = pwriteAll(fd, header, sizeof(*header), 0) != 0
+      || pwriteAll(fd, s, header->paramsSize, header->paramsOffset) != 0;
+   free(s);
+   return ret ? -1 : 0;
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "readBinaryEvecsAndPrimmeParams"
 int readBinaryEvecsAndPrimmeParams(const char *fileName, SCALAR *X, SCALAR **Xout,
                                           int n, int Xcols, int *Xcolsout, int nLocal,
                                           int *perm, primme_params *primme_out) {
 
-#  define FREAD(A, B, C, D) { ASSERT_MSG(fread(A, B, C, D) == (size_t)C, -1, "Unexpected end of file\n"); }
+   VecFileHeader h;
+   int fd, cols;
 
-   FILE *f;
-   SCALAR d;
-   int i, j, cols;
-
-   ASSERT_MSG((f = fopen(fileName, "rb")),
+   ASSERT_MSG((fd = openVecFile(fileName, &h)) >= 0,
                   -1, "Could not open file %s\n", fileName);
 
-   /* Check number size */
-   /* NOTE: 2*IMAGINARY*IMAGINARY+1 is -1 in complex arith and 1 in real arith */
-   FREAD(&d, sizeof(d), 1, f);
-   ASSERT_MSG((int)(REAL_PART(d*(2.*IMAGINARY*IMAGINARY + 1.))) == (int)sizeof(d),
-                  -1, "Mismatch arithmetic in file %s\n", fileName);
+   if (h.version == 0) {
+      /* Legacy format: the number size, the matrix size and the number of */
+      /* columns as SCALARs, then X, sizeof(primme_params) and the struct  */
+      SCALAR d[3];
+      ASSERT_MSG(preadAll(fd, d, sizeof(d), 0) == 0, -1, "Unexpected end of file\n");
+      /* NOTE: 2*IMAGINARY*IMAGINARY+1 is -1 in complex arith and 1 in real arith */
+      ASSERT_MSG((int)(REAL_PART(d[0]*(2.*IMAGINARY*IMAGINARY + 1.))) == (int)sizeof(SCALAR),
+                     -1, "Mismatch arithmetic in file %s\n", fileName);
+      h.n = REAL_PART(d[1]);
+      h.cols = REAL_PART(d[2]);
+      h.dataOffset = sizeof(d);
+      h.paramsOffset = h.dataOffset + h.cols*h.n*sizeof(SCALAR);
+   }
+   else {
+      ASSERT_MSG(h.version <= VEC_FILE_VERSION && h.m == 0, -1,
+                     "Unsupported file %s\n", fileName);
+      ASSERT_MSG(h.scalarSize == sizeof(SCALAR),
+                     -1, "Mismatch arithmetic in file %s\n", fileName);
+   }
    /* Check matrix size */
-   FREAD(&d, sizeof(d), 1, f);
-   ASSERT_MSG(((int)REAL_PART(d)) == n,
-                  -1, "Mismatch matrix size in file %s\n", fileName);
+   ASSERT_MSG(h.n == n, -1, "Mismatch matrix size in file %s\n", fileName);
 
    /* Read X */
-   FREAD(&d, sizeof(d), 1, f); cols = REAL_PART(d);
+   cols = (int)h.cols;
    if (Xcols > 0 && (X || Xout)) {
       if (!X) *Xout = X = (SCALAR*)malloc(sizeof(SCALAR)*min(cols, Xcols)*nLocal);
       if (Xcolsout) *Xcolsout = min(cols, Xcols);
-      if (!perm) {
-         for (i=0; i<min(cols, Xcols); i++) {
-            fseek(f, (i*n + 3)*sizeof(d), SEEK_SET);
-            FREAD(&X[nLocal*i], sizeof(d), nLocal, f);
-         }
-      }
-      else {
-         for (i=0; i<min(cols, Xcols); i++) {
-            for (j=0; j<nLocal; j++) {
-               fseek(f, (i*n + perm[j] + 3)*sizeof(d), SEEK_SET);
-               FREAD(&X[nLocal*i+j], sizeof(d), 1, f);
-            }
-         }
-      }
+      ASSERT_MSG(transferVectors(fd, 0, h.dataOffset, n, min(cols, Xcols),
+                     nLocal, perm, X, nLocal) == 0, -1, "Unexpected end of file\n");
    }
-   fseek(f, (cols*n + 3)*sizeof(d), SEEK_SET);
 
    /* Read primme_params */
    if (primme_out) {
-      FREAD(&d, sizeof(d), 1, f);
-      if ((int)REAL_PART(d) == (int)sizeof(*primme_out)) {
-         FREAD(primme_out, sizeof(*primme_out), 1, f);
+      if (h.version == 0) {
+         SCALAR d;
+         ASSERT_MSG(preadAll(fd, &d, sizeof(d), h.paramsOffset) == 0, -1, "Unexpected end of file\n");
+         if ((int)REAL_PART(d) != (int)sizeof(*primme_out)
+               || preadAll(fd, primme_out, sizeof(*primme_out),
+                  h.paramsOffset + sizeof(d)) != 0) {
+            primme_out->n = 0;
+         }
+      }
+      else {
+         memset(primme_out, 0, sizeof(*primme_out));
+         ASSERT_MSG(readVecFileParams(fd, &h, primmeFileParams, primme_out) == 0,
+                        -1, "Unexpected end of file\n");
       }
-      else
-         primme_out->n = 0;
    }
 
-   fclose(f);
+   close(fd);
    return 0;
-
-#  undef FREAD
 }
 
 #undef __FUNCT__
@@ -259,56 +572,37 @@ int readBinaryEvecsAndPrimmeParams(const char *fileName, SCALAR *X, SCALAR **Xou
 int writeBinaryEvecsAndPrimmeParams(const char *fileName, SCALAR *X, int *perm,
                                            primme_params *primme) {
 
-#  define FWRITE(A, B, C, D) { ASSERT_MSG(fwrite(A, B, C, D) == (size_t)C, -1, "Unexpected error writing on %s\n", fileName); }
-
-   FILE *f;
-   SCALAR d;
-   int i, j;
-
-   ASSERT_MSG((f = fopen(fileName, "wb")),
-                  -1, "Could not open file %s\n", fileName);
+   VecFileHeader h;
+   int fd = -1, ierr = 0, one = 1;
 
-   /* Write number size */
+   /* Process 0 creates the file; the global sum waits for it before the */
+   /* rest of processes open it                                          */
    if (primme->procID == 0) {
-      /* NOTE: 2*IMAGINARY*IMAGINARY+1 is -1 in complex arith and 1 in real arith */
-      d = (2.*REAL_PART(IMAGINARY*IMAGINARY) + 1.)*sizeof(d);
-      FWRITE(&d, sizeof(d), 1, f);
-      /* Write matrix size */
-      d = primme->n;
-      FWRITE(&d, sizeof(d), 1, f);
-      /* Write number of columns */
-      d = primme->initSize;
-      FWRITE(&d, sizeof(d), 1, f);
+      fd = open(fileName, O_WRONLY|O_CREAT|O_TRUNC, 0666);
    }
+   if (primme->numProcs > 1 && primme->globalSumReal) {
+      double ok = (primme->procID != 0 || fd >= 0) ? 1.0 : 0.0, allOk;
+      primme->globalSumReal(&ok, &allOk, &one, primme, &ierr);
+      ASSERT_MSG(ierr == 0 && allOk == primme->numProcs,
+                     -1, "Could not open file %s\n", fileName);
+      if (primme->procID != 0) fd = open(fileName, O_WRONLY);
+   }
+   ASSERT_MSG(fd >= 0, -1, "Could not open file %s\n", fileName);
 
    /* Write X */
-   if (!perm) {
-      for (i=0; i<primme->initSize; i++) {
-         fseek(f, (i*primme->n + 3)*sizeof(d), SEEK_SET);
-         FWRITE(&X[primme->nLocal*i], sizeof(d), primme->nLocal, f);
-      }
-   }
-   else {
-      for (i=0; i<primme->initSize; i++) {
-         for (j=0; j<primme->nLocal; j++) {
-            fseek(f, (i*primme->n + perm[j] + 3)*sizeof(d), SEEK_SET);
-            FWRITE(&X[primme->nLocal*i+j], sizeof(d), 1, f);
-         }
-      }
-   }
+   initVecFileHeader(&h, 0, primme->n, primme->initSize);
+   ASSERT_MSG(transferVectors(fd, 1, h.dataOffset, primme->n, primme->initSize,
+                  primme->nLocal, perm, X, primme->nLocal) == 0,
+                  -1, "Unexpected error writing on %s\n", fileName);
 
-   /* Write primme_params */
+   /* Write the header and primme_params */
    if (primme->procID == 0) {
-      fseek(f, sizeof(d)*(primme->n*primme->initSize + 3), SEEK_SET);
-      d = sizeof(*primme);
-      FWRITE(&d, sizeof(d), 1, f);
-      FWRITE(primme, sizeof(*primme), 1, f);
+      ASSERT_MSG(writeVecFileHeader(fd, &h, primmeFileParams, primme) == 0,
+                     -1, "Unexpected error writing on %s\n", fileName);
    }
 
-   fclose(f);
+   ASSERT_MSG(close(fd) == 0, -1, "Unexpected error writing on %s\n", fileName);
    return 0;
-
-#  undef FWRITE
 }
 
 #undef __FUNCT__
@@ -439,70 +733,69 @@ int readBinaryEvecsAndPrimmeSvdsParams(const char *fileName, SCALAR *X, SCALAR *
                                        int m, int n, int Xcols, int *Xcolsout, int mLocal, int nLocal,
                                        int *perm, primme_svds_params *primme_svds_out) {
 
-#  define FREAD(A, B, C, D) { ASSERT_MSG(fread(A, B, C, D) == (size_t)C, -1, "Unexpected end of file\n"); }
-
-   FILE *f;
-   SCALAR d;
-   int i, j, cols;
+   VecFileHeader h;
+   int fd, cols;
 
-   ASSERT_MSG((f = fopen(fileName, "rb")),
+   ASSERT_MSG((fd = openVecFile(fileName, &h)) >= 0,
                   -1, "Could not open file %s\n", fileName);
 
-   /* Check number size */
-   /* NOTE: 2*IMAGINARY*IMAGINARY+1 is -1 in complex arith and 1 in real arith */
-   FREAD(&d, sizeof(d), 1, f);
-   ASSERT_MSG((int)(REAL_PART(d*(2.*IMAGINARY*IMAGINARY + 1.))) == (int)sizeof(d),
-                  -1, "Mismatch arithmetic in file %s\n", fileName);
+   if (h.version == 0) {
+      /* Legacy format: the number size, the matrix sizes and the number of */
+      /* columns as SCALARs, then U, V, sizeof(primme_svds_params) and the  */
+      /* struct                                                             */
+      SCALAR d[4];
+      ASSERT_MSG(preadAll(fd, d, sizeof(d), 0) == 0, -1, "Unexpected end of file\n");
+      /* NOTE: 2*IMAGINARY*IMAGINARY+1 is -1 in complex arith and 1 in real arith */
+      ASSERT_MSG((int)(REAL_PART(d[0]*(2.*IMAGINARY*IMAGINARY + 1.))) == (int)sizeof(SCALAR),
+                     -1, "Mismatch arithmetic in file %s\n", fileName);
+      h.m = REAL_PART(d[1]);
+      h.n = REAL_PART(d[2]);
+      h.cols = REAL_PART(d[3]);
+      h.dataOffset = sizeof(d);
+      h.paramsOffset = h.dataOffset + h.cols*(h.m+h.n)*sizeof(SCALAR);
+   }
+   else {
+      ASSERT_MSG(h.version <= VEC_FILE_VERSION, -1, "Unsupported file %s\n", fileName);
+      ASSERT_MSG(h.scalarSize == sizeof(SCALAR),
+                     -1, "Mismatch arithmetic in file %s\n", fileName);
+   }
    /* Check matrix size */
-   FREAD(&d, sizeof(d), 1, f);
-   ASSERT_MSG(((int)REAL_PART(d)) == m,
-                  -1, "Mismatch matrix size in file %s\n", fileName);
-   FREAD(&d, sizeof(d), 1, f);
-   ASSERT_MSG(((int)REAL_PART(d)) == n,
+   ASSERT_MSG(h.m == m && h.n == n,
                   -1, "Mismatch matrix size in file %s\n", fileName);
 
    /* Read X = [U V] */
-   FREAD(&d, sizeof(d), 1, f); cols = REAL_PART(d);
+   cols = (int)h.cols;
    if (Xcols > 0 && (X || Xout)) {
-      if (!X) *Xout = X = (SCALAR*)malloc(sizeof(SCALAR)*min(cols, Xcols)*(mLocal+nLocal));
-      if (Xcolsout) *Xcolsout = min(cols, Xcols);
-      if (!perm) {
-         assert(n == nLocal && m == mLocal);
-         FREAD(X, sizeof(d), mLocal*min(cols, Xcols), f);
-         fseek(f, (cols*m + 4)*sizeof(d), SEEK_SET);
-         FREAD(&X[mLocal*min(cols, Xcols)], sizeof(d), nLocal*min(cols, Xcols), f);
-      }
-      else {
-         for (i=0; i<min(cols, Xcols); i++) {
-            for (j=0; j<mLocal; j++) {
-               fseek(f, (i*m + perm[j] + 4)*sizeof(d), SEEK_SET);
-               FREAD(&X[mLocal*i+j], sizeof(d), 1, f);
-            }
-         }
-         for (i=0; i<min(cols, Xcols); i++) {
-            for (j=0; j<nLocal; j++) {
-               fseek(f, (min(cols, Xcols)*m + i*n + perm[j] + 4)*sizeof(d), SEEK_SET);
-               FREAD(&X[min(cols, Xcols)*mLocal + nLocal*i+j], sizeof(d), 1, f);
-            }
-         }
-      }
+      int c = min(cols, Xcols);
+      if (!X) *Xout = X = (SCALAR*)malloc(sizeof(SCALAR)*c*(mLocal+nLocal));
+      if (Xcolsout) *Xcolsout = c;
+      ASSERT_MSG(transferVectors(fd, 0, h.dataOffset, m, c, mLocal, perm,
+                     X, mLocal) == 0
+            && transferVectors(fd, 0, h.dataOffset + (off_t)cols*m*sizeof(SCALAR),
+                     n, c, nLocal, perm, &X[mLocal*c], nLocal) == 0,
+                  -1, "Unexpected end of file\n");
    }
-   fseek(f, (cols*(m+n) + 4)*sizeof(d), SEEK_SET);
 
-   /* Read primme_params */
+   /* Read primme_svds_params */
    if (primme_svds_out) {
-      FREAD(&d, sizeof(d), 1, f);
-      if ((int)REAL_PART(d) == (int)sizeof(*primme_svds_out)) {
-         FREAD(primme_svds_out, sizeof(*primme_svds_out), 1, f);
+      if (h.version == 0) {
+         SCALAR d;
+         ASSERT_MSG(preadAll(fd, &d, sizeof(d), h.paramsOffset) == 0, -1, "Unexpected end of file\n");
+         if ((int)REAL_PART(d) != (int)sizeof(*primme_svds_out)
+               || preadAll(fd, primme_svds_out, sizeof(*primme_svds_out),
+                  h.paramsOffset + sizeof(d)) != 0) {
+            primme_svds_out->m = primme_svds_out->n = 0;
+         }
+      }
+      else {
+         memset(primme_svds_out, 0, sizeof(*primme_svds_out));
+         ASSERT_MSG(readVecFileParams(fd, &h, primmeSvdsFileParams, primme_svds_out) == 0,
+                        -1, "Unexpected end of file\n");
       }
-      else
-         primme_svds_out->m = primme_svds_out-> n = 0;
    }
 
-   fclose(f);
+   close(fd);
    return 0;
-
-#  undef FREAD
 }
 
 
@@ -511,60 +804,39 @@ int readBinaryEvecsAndPrimmeSvdsParams(const char *fileName, SCALAR *X, SCALAR *
 int writeBinaryEvecsAndPrimmeSvdsParams(const char *fileName, SCALAR *X, int *perm,
                                     primme_svds_params *primme_svds) {
 
-#  define FWRITE(A, B, C, D) { ASSERT_MSG(fwrite(A, B, C, D) == (size_t)C, -1, "Unexpected error writing on %s\n", fileName); }
-
-   FILE *f;
-   SCALAR d;
-   int i, j;
-
-   ASSERT_MSG((f = fopen(fileName, "wb")),
-                  -1, "Could not open file %s\n", fileName);
+   VecFileHeader h;
+   int fd = -1, ierr = 0, one = 1;
+   int cols = primme_svds->initSize;
 
-   /* Write number size */
+   /* Process 0 creates the file; the global sum waits for it before the */
+   /* rest of processes open it                                          */
    if (primme_svds->procID == 0) {
-      /* NOTE: 2*IMAGINARY*IMAGINARY+1 is -1 in complex arith and 1 in real arith */
-      d = (2.*REAL_PART(IMAGINARY*IMAGINARY) + 1.)*sizeof(d);
-      FWRITE(&d, sizeof(d), 1, f);
-      /* Write matrix size */
-      d = primme_svds->m;
-      FWRITE(&d, sizeof(d), 1, f);
-      d = primme_svds->n;
-      FWRITE(&d, sizeof(d), 1, f);
-      /* Write number of columns */
-      d = primme_svds->initSize;
-      FWRITE(&d, sizeof(d), 1, f);
+      fd = open(fileName, O_WRONLY|O_CREAT|O_TRUNC, 0666);
    }
-
-   /* Write X = [U V] */
-   if (!perm) {
-      assert(primme_svds->n == primme_svds->nLocal && primme_svds->m == primme_svds->mLocal);
-      FWRITE(X, sizeof(d), (primme_svds->m+primme_svds->n)*primme_svds->initSize, f);
-   }
-   else {
-      for (i=0; i<primme_svds->initSize; i++) {
-         for (j=0; j<primme_svds->mLocal; j++) {
-            fseek(f, (i*primme_svds->m + perm[j] + 4)*sizeof(d), SEEK_SET);
-            FWRITE(&X[primme_svds->mLocal*i+j], sizeof(d), 1, f);
-         }
-      }
-      for (i=0; i<primme_svds->initSize; i++) {
-         for (j=0; j<primme_svds->nLocal; j++) {
-            fseek(f, (primme_svds->m*primme_svds->initSize + i*primme_svds->n + perm[primme_svds->mLocal+j] + 4)*sizeof(d), SEEK_SET);
-            FWRITE(&X[primme_svds->mLocal*primme_svds->initSize+primme_svds->nLocal*i+j], sizeof(d), 1, f);
-         }
-      }
+   if (primme_svds->numProcs > 1 && primme_svds->globalSumReal) {
+      double ok = (primme_svds->procID != 0 || fd >= 0) ? 1.0 : 0.0, allOk;
+      primme_svds->globalSumReal(&ok, &allOk, &one, primme_svds, &ierr);
+      ASSERT_MSG(ierr == 0 && allOk == primme_svds->numProcs,
+                     -1, "Could not open file %s\n", fileName);
+      if (primme_svds->procID != 0) fd = open(fileName, O_WRONLY);
    }
+   ASSERT_MSG(fd >= 0, -1, "Could not open file %s\n", fileName);
 
-   /* Write primme_svds_params */
+   /* Write X = [U V] */
+   initVecFileHeader(&h, primme_svds->m, primme_svds->n, cols);
+   ASSERT_MSG(transferVectors(fd, 1, h.dataOffset, primme_svds->m, cols,
+                  primme_svds->mLocal, perm, X, primme_svds->mLocal) == 0
+         && transferVectors(fd, 1, h.dataOffset + (off_t)cols*primme_svds->m*sizeof(SCALAR),
+                  primme_svds->n, cols, primme_svds->nLocal, perm,
+                  &X[primme_svds->mLocal*cols], primme_svds->nLocal) == 0,
+                  -1, "Unexpected error writing on %s\n", fileName);
+
+   /* Write the header and primme_svds_params */
    if (primme_svds->procID == 0) {
-      fseek(f, sizeof(d)*((primme_svds->m+primme_svds->n)*primme_svds->initSize + 4), SEEK_SET);
-      d = sizeof(*primme_svds);
-      FWRITE(&d, sizeof(d), 1, f);
-      FWRITE(primme_svds, sizeof(*primme_svds), 1, f);
+      ASSERT_MSG(writeVecFileHeader(fd, &h, primmeSvdsFileParams, primme_svds) == 0,
+                     -1, "Unexpected error writing on %s\n", fileName);
    }
 
-   fclose(f);
+   ASSERT_MSG(close(fd) == 0, -1, "Unexpected error writing on %s\n", fileName);
    return 0;
-
-#  undef FWRITE
 }
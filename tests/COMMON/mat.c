@@ -32,9 +32,17 @@
 #include <unistd.h>
 #include <string.h>
 #include <math.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "native.h"
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
 
 static void getDiagonal(const CSRMatrix *matrix, double *diag);
+static void getILUTLevels(const CSRMatrix *factors, int lower,
+      int *numLevels, int **levels, int **rows);
 
 #ifdef __cplusplus
 extern "C" {
@@ -45,13 +53,11 @@ void FORTRAN_FUNCTION(amux)(int*, double*, double*, double*, int*, int*);
 void FORTRAN_FUNCTION(atmuxr)(int*, int*, double*, double*, double*, int*, int*);
 void FORTRAN_FUNCTION(ilut)(int*, double*, int*, int*, int*, double*, double*, int*, int*, int*,
                             double*, double*, int*, int*, int*, int*);
-void FORTRAN_FUNCTION(lusol0)(int*, double*, double*, double*, int*, int*);
 #else
 void FORTRAN_FUNCTION(zamux)(int*, SCALAR*, SCALAR*, SCALAR*, int*, int*);
 void FORTRAN_FUNCTION(zatmuxr)(int*, int*, SCALAR*, SCALAR*, SCALAR*, int*, int*);
 void FORTRAN_FUNCTION(zilut)(int*, SCALAR*, int*, int*, int*, double*, SCALAR*, int*, int*, int*,
                              SCALAR*, int*, int*);
-void FORTRAN_FUNCTION(zlusol)(int*, SCALAR*, SCALAR*, SCALAR*, int*, int*);
 #endif
 
 #ifdef __cplusplus
@@ -88,6 +94,57 @@ void CSRMatrixMatvec(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *bl
    *ierr = 0;
 }
 
+#ifdef USE_MPI
+/******************************************************************************
+ * Applies the matrix vector multiplication on a block of vectors distributed
+ * by rows among the processes. Every process stores the whole matrix and the
+ * rows n*procID/numProcs to n*(procID+1)/numProcs-1, as set in the driver.
+ * The vectors are gathered in every process before calling amux().
+ *
+******************************************************************************/
+
+void CSRMatrixMatvecMPI(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
+      int *blockSize, primme_params *primme, int *ierr) {
+   
+   int i, p;
+   int n = (int)primme->n;
+   int nLocal = (int)primme->nLocal;
+   int *counts, *displs;
+   SCALAR *xvec, *yvec, *xg;
+   CSRMatrix *matrix;
+   MPI_Comm comm = *(MPI_Comm *)primme->commInfo;
+   
+   matrix = (CSRMatrix *)primme->matrix;
+   xvec = (SCALAR *)x;
+   yvec = (SCALAR *)y;
+   counts = (int *)primme_calloc(2*primme->numProcs, sizeof(int), "counts");
+   displs = counts + primme->numProcs;
+   xg = (SCALAR *)primme_calloc(n, sizeof(SCALAR), "xg");
+
+   /* Count real and imaginary parts as MPI_DOUBLE */
+
+   for (p=0; p<primme->numProcs; p++) {
+      displs[p] = (int)((PRIMME_INT)n*p/primme->numProcs)*(int)(sizeof(SCALAR)/sizeof(double));
+      counts[p] = (int)((PRIMME_INT)n*(p+1)/primme->numProcs)*(int)(sizeof(SCALAR)/sizeof(double)) - displs[p];
+   }
+
+   *ierr = 0;
+   for (i=0;i<*blockSize && *ierr == 0;i++) {
+      *ierr = MPI_Allgatherv(&xvec[*ldx*i], counts[primme->procID], MPI_DOUBLE,
+            xg, counts, displs, MPI_DOUBLE, comm);
+#ifndef USE_DOUBLECOMPLEX
+      FORTRAN_FUNCTION(amux)
+#else
+      FORTRAN_FUNCTION(zamux)
+#endif
+            (&nLocal, xg, &yvec[*ldy*i], matrix->AElts, matrix->JA,
+             &matrix->IA[(PRIMME_INT)n*primme->procID/primme->numProcs]);
+   }
+   free(counts);
+   free(xg);
+}
+#endif
+
 void CSRMatrixMatvecSVD(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
       int *blockSize, int *trans, primme_svds_params *primme_svds, int *ierr) {
    
@@ -125,6 +182,36 @@ void CSRMatrixMatvecSVD(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
    *ierr = 0;
 }
 
+/******************************************************************************
+ * Copies the rows firstRow:firstRow+numRows-1 of the CSR matrix into the
+ * dense column-major block A with leading dimension ldA (readRowBlock)
+ *
+******************************************************************************/
+
+void CSRMatrixReadRowBlockSVD(PRIMME_INT *firstRow, int *numRows, void *A,
+      PRIMME_INT *ldA, primme_svds_params *primme_svds, int *ierr) {
+
+   int i, j;
+   SCALAR *Avec = (SCALAR *)A;
+   CSRMatrix *matrix = (CSRMatrix *)primme_svds->matrix;
+
+   for (j=0; j < matrix->n; j++) {
+      for (i=0; i < *numRows; i++) {
+         Avec[(*ldA)*j+i] = 0.0;
+      }
+   }
+
+   /* IA and JA are indexed using C indexing, but their contents */
+   /* assume Fortran indexing.                                   */
+
+   for (i=0; i < *numRows; i++) {
+      for (j=matrix->IA[*firstRow+i]; j <= matrix->IA[*firstRow+i+1]-1; j++) {
+         Avec[(*ldA)*(matrix->JA[j-1]-1)+i] = matrix->AElts[j-1];
+      }
+   }
+   *ierr = 0;
+}
+
 
 /******************************************************************************
  * Applies the (already inverted) diagonal preconditioner
@@ -151,15 +238,19 @@ static void ApplyInvDiagPrecNativeGen(SCALAR *xvec, int ldx, SCALAR *yvec,
    int i, j;
    const double minDenominator = 1e-14*(aNorm >= 0.0L ? aNorm : 1.);
 
+   /* The denominators are computed in the same loop, without a buffer; */
+   /* dividing by a real number, the loop is vectorized also in complex  */
+
    for (i=0; i<bs; i++) {
       double shift = shifts ? shifts[i] : 0.0;
+      SCALAR *x = &xvec[ldx*i], *y = &yvec[ldy*i];
       #ifdef _OPENMP
       #pragma omp parallel for
       #endif
       for (j=0; j<nLocal; j++) {
          double d = diag[j] - shift;
          d = (fabs(d) > minDenominator) ? d : copysign(minDenominator, d);
-         yvec[ldy*i+j] = xvec[ldx*i+j]/d;
+         y[j] = x[j]/d;
       }
    }
 }
@@ -198,22 +289,44 @@ void ApplyInvDavidsonDiagPrecNative(void *x, PRIMME_INT *ldx, void *y, PRIMME_IN
  *    y(i) = U^(-1)*( L^(-1)*x(i)), i=1:blockSize, 
  *    with L,U = ilut(A-shift) 
  * 
- * It calls the SPARSKIT lusol0 function for each block vector.
+ * The factors are computed by the SPARSKIT ilut function. The rows of L and U
+ * are grouped in level sets when the factors are created: the rows in a level
+ * only depend on rows in previous levels, so the rows of a level are solved
+ * in parallel with OpenMP. Every row is solved for all block vectors at once.
+ * The result is the same as the SPARSKIT lusol0 function for each vector.
+ * With byLevels the levels are used even with one thread or few rows per
+ * level, for instance to test them against the sequential solve.
  *
 ******************************************************************************/
 
-int createILUTPrecNative(const CSRMatrix *matrix, double shift, int level,
-                         double threshold, double filter, CSRMatrix **prec) {
+/* Minimum average number of rows per level to solve the levels in parallel */
+#ifndef ILUT_MIN_LEVEL_ROWS
+#define ILUT_MIN_LEVEL_ROWS 256
+#endif
+
+int createILUTPrecNative(const CSRMatrix *matrix_, double shift, int level,
+                         double threshold, double filter, int byLevels,
+                         ILUTPrecNative **prec) {
+   ILUTPrecNative *ilut;
+   CSRMatrix *factors, shifted, *matrix = &shifted;
+
+   /* Factorize A - shift*I from a copy of the values, so that the matrix */
+   /* is not modified while other threads may be using it                 */
+
+   shifted = *matrix_;
+   if (shift != 0.0) {
+      shifted.AElts = (SCALAR *)primme_calloc(matrix_->nnz, sizeof(SCALAR),
+                                              "AElts");
+      memcpy(shifted.AElts, matrix_->AElts, sizeof(SCALAR)*matrix_->nnz);
+      shiftCSRMatrix(-shift, &shifted);
+   }
+
 #ifdef USE_DOUBLECOMPLEX
    int ierr;
    int lenFactors;
    SCALAR *W;
    int *iW;
-   CSRMatrix *factors;
 
-   if (shift != 0.0) {
-      shiftCSRMatrix(-shift, (CSRMatrix*)matrix);
-   }
 
    /* Work arrays */
    W = (SCALAR *)primme_calloc(matrix->n+1, sizeof(SCALAR), "W");
@@ -229,36 +342,25 @@ int createILUTPrecNative(const CSRMatrix *matrix, double shift, int level,
    factors->IA = (int *)primme_calloc(matrix->n+1, sizeof(int), "Iilu");
    factors->n = matrix->n;
    factors->nnz = lenFactors;
+   factors->map = NULL;
    
    FORTRAN_FUNCTION(zilut)
          ((int*)&matrix->n, (SCALAR*)matrix->AElts, (int*)matrix->JA,
           (int*)matrix->IA, &level, &threshold,
           factors->AElts, factors->JA, factors->IA, &lenFactors, W, iW, &ierr);
    
-   if (ierr != 0)  {
-      fprintf(stderr, "ZILUT factorization could not be completed\n");
-      return(-1);
-   }
-
-   if (shift != 0.0L) {
-      shiftCSRMatrix(shift, (CSRMatrix*)matrix);
-   }
-
    /* free workspace */
    free(W); free(iW);
 
-   *prec = factors;
-   return 0;
+   if (ierr != 0)  {
+      fprintf(stderr, "ZILUT factorization could not be completed\n");
+   }
 #else
    int ierr;
    int lenFactors;
    double *W1, *W2;
    int *iW1, *iW2, *iW3;
-   CSRMatrix *factors;
 
-   if (shift != 0.0) {
-      shiftCSRMatrix(-shift, (CSRMatrix*)matrix);
-   }
 
    /* Work arrays */
    W1 = (double *)primme_calloc( matrix->n+1,  sizeof(double), "W1");
@@ -275,6 +377,7 @@ int createILUTPrecNative(const CSRMatrix *matrix, double shift, int level,
    factors->IA = (int *)primme_calloc(matrix->n+1, sizeof(int), "Iilu");
    factors->n = matrix->n;
    factors->nnz = lenFactors;
+   factors->map = NULL;
    
    FORTRAN_FUNCTION(ilut)
         ((int*)&matrix->n, (double*)matrix->AElts, (int*)matrix->JA,
@@ -282,42 +385,211 @@ int createILUTPrecNative(const CSRMatrix *matrix, double shift, int level,
          factors->AElts, factors->JA, factors->IA, &lenFactors, 
          W1, W2, iW1, iW2, iW3, &ierr);
    
+   /* free workspace */
+   free(W1); free(W2); free(iW1); free(iW2); free(iW3);
+
    if (ierr != 0)  {
       fprintf(stderr, "ILUT factorization could not be completed\n");
-      return(-1);
    }
+#endif
 
-   if (shift != 0.0L) {
-      shiftCSRMatrix(shift, (CSRMatrix*)matrix);
+   if (shift != 0.0) {
+      free(shifted.AElts);
+   }
+   if (ierr != 0) {
+      freeCSRMatrix(factors);
+      return(-1);
    }
 
-   /* free workspace */
-   free(W1); free(W2); free(iW1); free(iW2); free(iW3);
+   /* Compute the level sets of the triangular solves */
 
-   *prec = factors;
+   ilut = (ILUTPrecNative *)primme_calloc(1, sizeof(ILUTPrecNative), "ilut");
+   ilut->factors = factors;
+   ilut->byLevels = byLevels;
+   getILUTLevels(factors, 1, &ilut->numLevelsL, &ilut->levelsL, &ilut->rowsL);
+   getILUTLevels(factors, 0, &ilut->numLevelsU, &ilut->levelsU, &ilut->rowsU);
+
+   *prec = ilut;
    return 0;
-#endif
 }
 
-void ApplyILUTPrecNative(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *ierr) {
-   int i;
-   int n = (int)primme->n;
-   SCALAR *xvec, *yvec;
-   CSRMatrix *prec;
-   
-   prec = (CSRMatrix *)primme->preconditioner;
-   xvec = (SCALAR *)x;
-   yvec = (SCALAR *)y;
+void freeILUTPrecNative(ILUTPrecNative *prec) {
+   freeCSRMatrix(prec->factors);
+   free(prec->levelsL); free(prec->rowsL);
+   free(prec->levelsU); free(prec->rowsU);
+   free(prec);
+}
 
-   for (i=0; i<*blockSize; i++) {
-#ifdef USE_DOUBLECOMPLEX
-      FORTRAN_FUNCTION(zlusol)
-#else
-      FORTRAN_FUNCTION(lusol0)
+/******************************************************************************
+ * Computes the level sets of the lower (L) or the upper (U) triangular factor
+ * in the SPARSKIT MSR format. The level of a row is one more than the largest
+ * level of the rows it depends on. The rows of level k are
+ * rows[levels[k]:levels[k+1]-1], in increasing order.
+ *
+******************************************************************************/
+
+static void getILUTLevels(const CSRMatrix *factors, int lower,
+      int *numLevels, int **levels, int **rows) {
+   int i, j, k, first, last, n = factors->n;
+   const int *jlu = factors->JA, *ju = factors->IA;
+   int *depth;
+
+   /* JA and IA contents assume Fortran indexing. Row i of L is in      */
+   /* jlu(i):ju(i)-1, and row i of U is in ju(i):jlu(i+1)-1             */
+
+   depth = (int *)primme_calloc(n, sizeof(int), "depth");
+   *numLevels = 0;
+   for (j=0; j<n; j++) {
+      i = lower ? j : n-1-j;
+      first = lower ? jlu[i] : ju[i];
+      last = lower ? ju[i] : jlu[i+1];
+      depth[i] = 0;
+      for (k=first-1; k<last-1; k++) {
+         depth[i] = max(depth[i], depth[jlu[k]-1] + 1);
+      }
+      *numLevels = max(*numLevels, depth[i] + 1);
+   }
+
+   /* Sort the rows by level */
+
+   *levels = (int *)primme_calloc(*numLevels+1, sizeof(int), "levels");
+   *rows = (int *)primme_calloc(n, sizeof(int), "rows");
+   for (k=0; k<=*numLevels; k++) (*levels)[k] = 0;
+   for (i=0; i<n; i++) (*levels)[depth[i]+1]++;
+   for (k=0; k<*numLevels; k++) (*levels)[k+1] += (*levels)[k];
+   for (i=0; i<n; i++) (*rows)[(*levels)[depth[i]]++] = i;
+   for (k=*numLevels; k>0; k--) (*levels)[k] = (*levels)[k-1];
+   (*levels)[0] = 0;
+
+   free(depth);
+}
+
+/* Solve row i of L for bs vectors: y(i) = x(i) - L(i,:)*y */
+
+static void solveILUTLowerRow(const CSRMatrix *factors, int i, SCALAR *x,
+      PRIMME_INT ldx, SCALAR *y, PRIMME_INT ldy, int bs) {
+   int k, b, j;
+   SCALAR a;
+
+   for (b=0; b<bs; b++) y[ldy*b+i] = x[ldx*b+i];
+   for (k=factors->JA[i]-1; k<factors->IA[i]-1; k++) {
+      a = factors->AElts[k];
+      j = factors->JA[k]-1;
+      for (b=0; b<bs; b++) y[ldy*b+i] -= a*y[ldy*b+j];
+   }
+}
+
+/* Solve row i of U for bs vectors: y(i) = U(i,i)^(-1)*(y(i) - U(i,:)*y) */
+
+static void solveILUTUpperRow(const CSRMatrix *factors, int i, SCALAR *y,
+      PRIMME_INT ldy, int bs) {
+   int k, b, j;
+   SCALAR a;
+
+   for (k=factors->IA[i]-1; k<factors->JA[i+1]-1; k++) {
+      a = factors->AElts[k];
+      j = factors->JA[k]-1;
+      for (b=0; b<bs; b++) y[ldy*b+i] -= a*y[ldy*b+j];
+   }
+   /* The diagonal is stored inverted */
+   for (b=0; b<bs; b++) y[ldy*b+i] *= factors->AElts[i];
+}
+
+/* Solve L*U*y = x for bs vectors */
+
+static void solveILUT(const ILUTPrecNative *prec, SCALAR *xvec,
+      PRIMME_INT ldx, SCALAR *yvec, PRIMME_INT ldy, int bs) {
+   int i, k, r, parL=0, parU=0;
+   const CSRMatrix *factors = prec->factors;
+   int n = factors->n;
+
+   /* Solve by levels only if there are enough rows per level */
+
+   if (prec->byLevels) {
+      parL = parU = 1;
+   }
+#ifdef _OPENMP
+   else if (omp_get_max_threads() > 1) {
+      parL = n >= ILUT_MIN_LEVEL_ROWS*prec->numLevelsL;
+      parU = n >= ILUT_MIN_LEVEL_ROWS*prec->numLevelsU;
+   }
 #endif
-             (&n, &xvec[*ldx*i], &yvec[*ldy*i],
-              prec->AElts, prec->JA, prec->IA);
+
+   /* Forward solve */
+
+   if (parL) {
+      #ifdef _OPENMP
+      #pragma omp parallel private(k, r)
+      #endif
+      for (k=0; k<prec->numLevelsL; k++) {
+         #ifdef _OPENMP
+         #pragma omp for
+         #endif
+         for (r=prec->levelsL[k]; r<prec->levelsL[k+1]; r++) {
+            solveILUTLowerRow(factors, prec->rowsL[r], xvec, ldx, yvec, ldy,
+                  bs);
+         }
+      }
+   }
+   else {
+      for (i=0; i<n; i++) {
+         solveILUTLowerRow(factors, i, xvec, ldx, yvec, ldy, bs);
+      }
+   }
+
+   /* Backward solve */
+
+   if (parU) {
+      #ifdef _OPENMP
+      #pragma omp parallel private(k, r)
+      #endif
+      for (k=0; k<prec->numLevelsU; k++) {
+         #ifdef _OPENMP
+         #pragma omp for
+         #endif
+         for (r=prec->levelsU[k]; r<prec->levelsU[k+1]; r++) {
+            solveILUTUpperRow(factors, prec->rowsU[r], yvec, ldy, bs);
+         }
+      }
    }
+   else {
+      for (i=n-1; i>=0; i--) {
+         solveILUTUpperRow(factors, i, yvec, ldy, bs);
+      }
+   }
+}
+
+void ApplyILUTPrecNative(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *ierr) {
+   solveILUT((ILUTPrecNative *)primme->preconditioner, (SCALAR *)x, *ldx,
+         (SCALAR *)y, *ldy, *blockSize);
+   *ierr = 0;
+}
+
+/******************************************************************************
+ * Factorize, apply and free ILUT(A-shift) for the shifts chosen by PRIMME
+ * (see primme.precondFactorize). The options of the factorization and the
+ * matrix are in primme.preconditioner. The factorization may be called from a thread other
+ * than the solver's, so it does not modify the matrix.
+ *
+******************************************************************************/
+
+void ILUTFactorizeNative(double *shift, void **factors, primme_params *primme, int *ierr) {
+   ILUTOptionsNative *opts = (ILUTOptionsNative *)primme->preconditioner;
+   ILUTPrecNative *prec = NULL;
+
+   *ierr = createILUTPrecNative(opts->matrix, *shift,
+         opts->level, opts->threshold, opts->filter, opts->byLevels, &prec);
+   *factors = prec;
+}
+
+void ApplyILUTFactorsNative(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, void *factors, primme_params *primme, int *ierr) {
+   solveILUT((ILUTPrecNative *)factors, (SCALAR *)x, *ldx, (SCALAR *)y,
+         *ldy, *blockSize);
+   *ierr = 0;
+}
+
+void FreeILUTFactorsNative(void *factors, primme_params *primme, int *ierr) {
+   freeILUTPrecNative((ILUTPrecNative *)factors);
    *ierr = 0;
 }
 
@@ -30,19 +30,49 @@
 #define NATIVE_H
 
 #include "csr.h"
+#include "sell.h"
 #include "primme_svds.h"
 
 void CSRMatrixMatvec(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *ierr);
+#ifdef USE_MPI
+void CSRMatrixMatvecMPI(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *ierr);
+#endif
 int createInvDiagPrecNative(const CSRMatrix *matrix, double shift, double **prec);
 void ApplyInvDiagPrecNative(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, 
                                         primme_params *primme, int *ierr);
 void ApplyInvDavidsonDiagPrecNative(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, 
                                         primme_params *primme, int *ierr);
+/* ILUT factors and the level sets of their triangular solves */
+typedef struct {
+   CSRMatrix *factors;   /* L and U in the SPARSKIT MSR format */
+   int numLevelsL;       /* Rows of level k of L are                */
+   int *levelsL, *rowsL; /*    rowsL[levelsL[k]:levelsL[k+1]-1]     */
+   int numLevelsU;       /* Rows of level k of U are                */
+   int *levelsU, *rowsU; /*    rowsU[levelsU[k]:levelsU[k+1]-1]     */
+   int byLevels;         /* if 1, always solve by levels            */
+} ILUTPrecNative;
+
 int createILUTPrecNative(const CSRMatrix *matrix, double shift, int level,
-                         double threshold, double filter, CSRMatrix **prec);
+                         double threshold, double filter, int byLevels,
+                         ILUTPrecNative **prec);
+void freeILUTPrecNative(ILUTPrecNative *prec);
 void ApplyILUTPrecNative(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *ierr);
+/* Options of ILUT(A-shift) for the shifts chosen by PRIMME */
+typedef struct {
+   const CSRMatrix *matrix;   /* A */
+   int level;
+   double threshold;
+   double filter;
+   int byLevels;
+} ILUTOptionsNative;
+
+void ILUTFactorizeNative(double *shift, void **factors, primme_params *primme, int *ierr);
+void ApplyILUTFactorsNative(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, void *factors, primme_params *primme, int *ierr);
+void FreeILUTFactorsNative(void *factors, primme_params *primme, int *ierr);
 void CSRMatrixMatvecSVD(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
       int *blockSize, int *trans, primme_svds_params *primme_svds, int *ierr);
+void CSRMatrixReadRowBlockSVD(PRIMME_INT *firstRow, int *numRows, void *A,
+      PRIMME_INT *ldA, primme_svds_params *primme_svds, int *ierr);
 int createInvNormalPrecNative(const CSRMatrix *matrix, double shift, double **prec);
 void ApplyInvNormalPrecNative(void *x, PRIMME_INT *ldx, void *y,
       PRIMME_INT *ldy, int *blockSize, int *mode,
@@ -66,6 +66,7 @@ int readMatrixAndPrecondParaSails(const char* matrixFileName, double shift,
    }
    else {
       matrix = (CSRMatrix *)primme_calloc(1, sizeof(CSRMatrix), "CSRMatrix");
+      matrix->map = NULL;
    }
    MPI_Bcast(&matrix->nnz, 1, MPI_INT, 0, MPI_COMM_WORLD);
    MPI_Bcast(&matrix->m, 1, MPI_INT, 0, MPI_COMM_WORLD);
@@ -157,7 +158,7 @@ int readMatrixAndPrecondParaSails(const char* matrixFileName, double shift,
    }
    else {
       // Free A as it is not further needed
-      free(matrix->AElts); free(matrix->IA); free(matrix->JA);
+      freeCSRMatrixArrays(matrix);
    }
 
    free(mask); free(map); free(fg2or); free(or2fg); free(matrix);
@@ -277,7 +278,7 @@ static ParaSails* generate_precond(CSRMatrix *matrix, double shift, int n, int p
                             matrix->IA, matrix->JA, matrix->AElts, comm);
 
    // Free A to make room for preconditioner
-   free(matrix->AElts); free(matrix->IA); free(matrix->JA);
+   freeCSRMatrixArrays(matrix);
    
    // Create parasails preconditioner
    A_p = ParaSailsCreate(comm, rangeStart, rangeEnd, isymm);
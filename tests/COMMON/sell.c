@@ -0,0 +1,280 @@
+/*******************************************************************************
+ *   PRIMME PReconditioned Iterative MultiMethod Eigensolver
+ *   Copyright (C) 2016 College of William & Mary,
+ *   James R. McCombs, Eloy Romero Alcalde, Andreas Stathopoulos, Lingfei Wu
+ *
+ *   This file is part of PRIMME.
+ *
+ *   PRIMME is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   PRIMME is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *******************************************************************************
+ * File: sell.c
+ *
+ * Purpose - Matrix-vector products with matrices in SELL-C-sigma format.
+ *
+ *           The loops over the SELL_C rows of a slice have no dependencies
+ *           and fixed length, so the compiler turns them into SIMD
+ *           instructions (with gathers for x), unlike the loops over the
+ *           short rows of CSR.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "sell.h"
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#  define SELL_SIMD _Pragma("omp simd")
+#else
+#  define SELL_SIMD
+#endif
+
+typedef struct {
+   int len;   /* number of nonzeros in the row */
+   int row;   /* row index */
+} SELLRow;
+
+/* Sorts rows by decreasing length, and by index for the same length */
+
+static int compareRows(const void *a, const void *b) {
+   const SELLRow *x = (const SELLRow *)a, *y = (const SELLRow *)b;
+   if (x->len != y->len) return y->len - x->len;
+   return x->row - y->row;
+}
+
+/******************************************************************************
+ * Builds the SELL-C-sigma version of a CSR matrix. Rows are sorted by length
+ * in windows of sigma rows (rounded up to a multiple of SELL_C); sigma = 1
+ * keeps the order of the rows. The SELL matrix takes the CSR matrix, which
+ * is freed with it.
+ *
+******************************************************************************/
+int createSELLMatrix(CSRMatrix *matrix, int sigma, SELLMatrix **sell_) {
+   int m = matrix->m, i, s;
+   SELLMatrix *sell;
+   SELLRow *rows;
+
+   if (sigma > 1) sigma = (sigma + SELL_C - 1)/SELL_C*SELL_C;
+   else sigma = 1;
+
+   sell = (SELLMatrix *)primme_calloc(1, sizeof(SELLMatrix), "SELLMatrix");
+   sell->m = m;
+   sell->n = matrix->n;
+   sell->nnz = matrix->nnz;
+   sell->sigma = sigma;
+   sell->numSlices = (m + SELL_C - 1)/SELL_C;
+   sell->csr = matrix;
+
+   /* Sort the rows by length in every window */
+
+   rows = (SELLRow *)primme_calloc(m, sizeof(SELLRow), "rows");
+   for (i=0; i<m; i++) {
+      rows[i].len = matrix->IA[i+1] - matrix->IA[i];
+      rows[i].row = i;
+   }
+   if (sigma > 1) {
+      for (i=0; i<m; i+=sigma) {
+         qsort(&rows[i], min(sigma, m-i), sizeof(SELLRow), compareRows);
+      }
+   }
+   sell->rowPerm = (int *)primme_calloc(m, sizeof(int), "rowPerm");
+   for (i=0; i<m; i++) sell->rowPerm[i] = rows[i].row;
+
+   /* The width of a slice is its longest row */
+
+   sell->sliceStart = (long *)primme_calloc(sell->numSlices+1, sizeof(long),
+         "sliceStart");
+   sell->sliceStart[0] = 0;
+   for (s=0; s<sell->numSlices; s++) {
+      int width = 0;
+      for (i=s*SELL_C; i<min((s+1)*SELL_C, m); i++) {
+         width = max(width, rows[i].len);
+      }
+      sell->sliceStart[s+1] = sell->sliceStart[s] + (long)width*SELL_C;
+   }
+   free(rows);
+
+   /* Copy the entries; padding repeats the last column of the row, so it */
+   /* does not load other parts of x                                      */
+
+   sell->cols = (int *)primme_calloc(sell->sliceStart[sell->numSlices],
+         sizeof(int), "cols");
+   sell->vals = (SCALAR *)primme_calloc(sell->sliceStart[sell->numSlices],
+         sizeof(SCALAR), "vals");
+
+   #ifdef _OPENMP
+   #pragma omp parallel for schedule(static)
+   #endif
+   for (s=0; s<sell->numSlices; s++) {
+      long p = sell->sliceStart[s];
+      int width = (int)((sell->sliceStart[s+1] - p)/SELL_C), r, j;
+      for (r=0; r<SELL_C; r++) {
+         int k = s*SELL_C + r, first = 0, len = 0, c = 0;
+         if (k < m) {
+            first = matrix->IA[sell->rowPerm[k]] - 1;
+            len = matrix->IA[sell->rowPerm[k]+1] - 1 - first;
+         }
+         for (j=0; j<width; j++) {
+            if (j < len) {
+               c = matrix->JA[first+j] - 1;
+               sell->vals[p+(long)j*SELL_C+r] = matrix->AElts[first+j];
+            }
+            else {
+               sell->vals[p+(long)j*SELL_C+r] = 0.0;
+            }
+            sell->cols[p+(long)j*SELL_C+r] = c;
+         }
+      }
+   }
+
+   *sell_ = sell;
+   return 0;
+}
+
+void freeSELLMatrix(SELLMatrix *sell) {
+   free(sell->sliceStart);
+   free(sell->cols);
+   free(sell->vals);
+   free(sell->rowPerm);
+   freeCSRMatrix(sell->csr);
+   free(sell);
+}
+
+/******************************************************************************
+ * Kernels for a slice s: y = A(slice,:)*x with one vector, and with nb
+ * vectors reusing every loaded entry of A for all of them
+ *
+******************************************************************************/
+
+static void multiplySlice(const SELLMatrix *sell, int s, const SCALAR *x,
+      SCALAR *y) {
+   const int *col = &sell->cols[sell->sliceStart[s]];
+   const SCALAR *val = &sell->vals[sell->sliceStart[s]];
+   int width = (int)((sell->sliceStart[s+1] - sell->sliceStart[s])/SELL_C),
+       rows = min(SELL_C, sell->m - s*SELL_C), j, r;
+   SCALAR t[SELL_C];
+
+   for (r=0; r<SELL_C; r++) t[r] = 0.0;
+   for (j=0; j<width; j++, col+=SELL_C, val+=SELL_C) {
+      SELL_SIMD
+      for (r=0; r<SELL_C; r++) t[r] += val[r]*x[col[r]];
+   }
+   for (r=0; r<rows; r++) y[sell->rowPerm[s*SELL_C+r]] = t[r];
+}
+
+static void multiplySliceBlock(const SELLMatrix *sell, int s, const SCALAR *x,
+      PRIMME_INT ldx, SCALAR *y, PRIMME_INT ldy, int nb) {
+   const int *col = &sell->cols[sell->sliceStart[s]];
+   const SCALAR *val = &sell->vals[sell->sliceStart[s]];
+   int width = (int)((sell->sliceStart[s+1] - sell->sliceStart[s])/SELL_C),
+       rows = min(SELL_C, sell->m - s*SELL_C), j, r, b;
+   SCALAR t[SELL_MAX_RHS][SELL_C];
+
+   for (b=0; b<nb; b++) for (r=0; r<SELL_C; r++) t[b][r] = 0.0;
+   for (j=0; j<width; j++, col+=SELL_C, val+=SELL_C) {
+      for (b=0; b<nb; b++) {
+         const SCALAR *xb = &x[ldx*b];
+         SELL_SIMD
+         for (r=0; r<SELL_C; r++) t[b][r] += val[r]*xb[col[r]];
+      }
+   }
+   for (b=0; b<nb; b++) {
+      for (r=0; r<rows; r++) y[ldy*b+sell->rowPerm[s*SELL_C+r]] = t[b][r];
+   }
+}
+
+static void multiplySELL(const SELLMatrix *sell, const SCALAR *x,
+      PRIMME_INT ldx, SCALAR *y, PRIMME_INT ldy, int blockSize) {
+   int b, s;
+
+   for (b=0; b<blockSize; b+=SELL_MAX_RHS) {
+      int nb = min(SELL_MAX_RHS, blockSize-b);
+      #ifdef _OPENMP
+      #pragma omp parallel for schedule(static)
+      #endif
+      for (s=0; s<sell->numSlices; s++) {
+         if (nb == 1) {
+            multiplySlice(sell, s, &x[ldx*b], &y[ldy*b]);
+         }
+         else {
+            multiplySliceBlock(sell, s, &x[ldx*b], ldx, &y[ldy*b], ldy, nb);
+         }
+      }
+   }
+}
+
+/* y = A'*x; rows of y may be updated by any slice, so it is sequential */
+
+static void multiplySELLTrans(const SELLMatrix *sell, const SCALAR *x,
+      PRIMME_INT ldx, SCALAR *y, PRIMME_INT ldy, int blockSize) {
+   int b, s, i, j, r;
+
+   for (b=0; b<blockSize; b++) {
+      const SCALAR *xb = &x[ldx*b];
+      SCALAR *yb = &y[ldy*b];
+      for (i=0; i<sell->n; i++) yb[i] = 0.0;
+      for (s=0; s<sell->numSlices; s++) {
+         const int *col = &sell->cols[sell->sliceStart[s]];
+         const SCALAR *val = &sell->vals[sell->sliceStart[s]];
+         int width = (int)((sell->sliceStart[s+1] - sell->sliceStart[s])/SELL_C),
+             rows = min(SELL_C, sell->m - s*SELL_C);
+         SCALAR t[SELL_C];
+         for (r=0; r<rows; r++) t[r] = xb[sell->rowPerm[s*SELL_C+r]];
+         for (j=0; j<width; j++, col+=SELL_C, val+=SELL_C) {
+            for (r=0; r<rows; r++) yb[col[r]] += CONJ(val[r])*t[r];
+         }
+      }
+   }
+}
+
+/******************************************************************************
+ * Applies the matrix vector multiplication on a block of vectors
+ *
+******************************************************************************/
+void SELLMatrixMatvec(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *ierr) {
+   multiplySELL((SELLMatrix *)primme->matrix, (SCALAR *)x, *ldx, (SCALAR *)y,
+         *ldy, *blockSize);
+   *ierr = 0;
+}
+
+void SELLMatrixMatvecSVD(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
+      int *blockSize, int *trans, primme_svds_params *primme_svds, int *ierr) {
+   if (*trans == 0) {
+      multiplySELL((SELLMatrix *)primme_svds->matrix, (SCALAR *)x, *ldx,
+            (SCALAR *)y, *ldy, *blockSize);
+   } else {
+      multiplySELLTrans((SELLMatrix *)primme_svds->matrix, (SCALAR *)x, *ldx,
+            (SCALAR *)y, *ldy, *blockSize);
+   }
+   *ierr = 0;
+}
+
+/******************************************************************************
+ * Real flops and bytes moved by a product with a single vector, counting
+ * the padding, and x and y read or written once
+ *
+******************************************************************************/
+void SELLMatrixTraffic(const SELLMatrix *sell, double *flops, double *bytes) {
+   *flops = 2.0*FLOPS_SCALAR*sell->nnz;
+   *bytes = (double)sell->sliceStart[sell->numSlices]*(sizeof(SCALAR) + sizeof(int))
+      + (double)(sell->numSlices + 1)*sizeof(long)
+      + (double)sell->m*(sizeof(int) + sizeof(SCALAR))
+      + (double)sell->n*sizeof(SCALAR);
+}
@@ -0,0 +1,75 @@
+/*******************************************************************************
+ *   PRIMME PReconditioned Iterative MultiMethod Eigensolver
+ *   Copyright (C) 2016 College of William & Mary,
+ *   James R. McCombs, Eloy Romero Alcalde, Andreas Stathopoulos, Lingfei Wu
+ *
+ *   This file is part of PRIMME.
+ *
+ *   PRIMME is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   PRIMME is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *******************************************************************************
+ * File: sell.h
+ *
+ * Purpose - Definitions of SELL-C-sigma (sliced ELLPACK) functions used by
+ *           the driver.
+ *
+ ******************************************************************************/
+
+#ifndef SELL_H
+
+#include "csr.h"
+#include "primme_svds.h"
+
+/* Rows per slice, C; the kernels are unrolled on it */
+#ifndef SELL_C
+#define SELL_C 8
+#endif
+
+/* Default window of rows sorted by length, sigma */
+#ifndef SELL_SIGMA
+#define SELL_SIGMA 256
+#endif
+
+/* Maximum number of vectors multiplied at once */
+#ifndef SELL_MAX_RHS
+#define SELL_MAX_RHS 4
+#endif
+
+/* The rows, sorted by decreasing length in windows of sigma rows, are       */
+/* grouped in slices of SELL_C rows. Every slice is stored as a dense block  */
+/* of SELL_C x (longest row in the slice), column-major, padded with zeros.  */
+
+typedef struct {
+   int m;            /* number of rows */
+   int n;            /* number of columns */
+   int nnz;          /* nonzeros, without padding */
+   int sigma;        /* window of rows sorted by length */
+   int numSlices;    /* number of slices */
+   long *sliceStart; /* entries of slice s are [sliceStart[s], sliceStart[s+1]) */
+   int *cols;        /* column of every entry (C indexing) */
+   SCALAR *vals;     /* value of every entry */
+   int *rowPerm;     /* row of the matrix for the row i of the slices */
+   CSRMatrix *csr;   /* the matrix in CSR, for the preconditioners */
+} SELLMatrix;
+
+int createSELLMatrix(CSRMatrix *matrix, int sigma, SELLMatrix **sell);
+void freeSELLMatrix(SELLMatrix *sell);
+void SELLMatrixMatvec(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *ierr);
+void SELLMatrixMatvecSVD(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
+      int *blockSize, int *trans, primme_svds_params *primme_svds, int *ierr);
+void SELLMatrixTraffic(const SELLMatrix *sell, double *flops, double *bytes);
+
+#define SELL_H
+#endif
@@ -203,6 +203,7 @@ int read_solver_params(char *configFileName, char *outputFileName,
             OPTIONParams(restarting, scheme, primme_dtr)
          );
 
+         READ_FIELDParams(projection, distMinSize, "%d");
          READ_FIELDParams(restarting, maxPrevRetain, "%d");
 
          READ_FIELDParams(correction, precondition, "%d");
@@ -224,6 +225,19 @@ int read_solver_params(char *configFileName, char *outputFileName,
          READ_FIELDParams(correction, projectors.RightX, "%d");
          READ_FIELDParams(correction, projectors.SkewX , "%d");
 
+         READ_FIELD_OPParams(workspace, placement,
+            OPTIONParams(workspace, placement, primme_placement_default)
+            OPTIONParams(workspace, placement, primme_placement_firsttouch)
+            OPTIONParams(workspace, placement, primme_placement_interleave)
+         );
+         READ_FIELDParams(workspace, hugePages, "%d");
+
+         READ_FIELDParams(precond, cacheSize, "%d");
+         READ_FIELDParams(precond, shiftQuantum, "%lf");
+         READ_FIELDParams(precond, maxShiftDrift, "%lf");
+         READ_FIELDParams(precond, maxTimeRatio, "%lf");
+         READ_FIELDParams(precond, async, "%d");
+
          if (ret == 0) {
             fprintf(stderr, 
                "ERROR(read_solver_params): Invalid parameter '%s'\n", ident);
@@ -359,6 +373,24 @@ int read_driver_params(char *configFileName, driver_params *driver) {
                else if (strcmp(stringValue, "rsb") == 0) {
                   driver->matrixChoice = driver_rsb;
                }
+               else if (strcmp(stringValue, "sell") == 0) {
+                  driver->matrixChoice = driver_sell;
+               }
+               else {
+                  fprintf(stderr, 
+                     "ERROR(read_driver_params): Invalid parameter '%s'\n", ident);
+               }
+            }
+         }
+         else if (strcmp(ident, "driver.reorder") == 0) {
+            ret = fscanf(configFile, "%s", stringValue);
+            if (ret == 1) {
+               if (strcmp(stringValue, "none") == 0) {
+                  driver->reorder = driver_order_none;
+               }
+               else if (strcmp(stringValue, "rcm") == 0) {
+                  driver->reorder = driver_order_rcm;
+               }
                else {
                   fprintf(stderr, 
                      "ERROR(read_driver_params): Invalid parameter '%s'\n", ident);
@@ -387,6 +419,9 @@ int read_driver_params(char *configFileName, driver_params *driver) {
                else if (strcmp(stringValue, "bjacobi") == 0) {
                   driver->PrecChoice = driver_bjacobi;
                }
+               else if (strcmp(stringValue, "ilut_i") == 0) {
+                  driver->PrecChoice = driver_ilut_i;
+               }
                else {
                   fprintf(stderr, 
                      "ERROR(read_driver_params): Invalid parameter '%s'\n", ident);
@@ -408,6 +443,19 @@ int read_driver_params(char *configFileName, driver_params *driver) {
          else if (strcmp(ident, "driver.filter") == 0) {
             ret = fscanf(configFile, "%lf", &driver->filter);
          }
+         else if (strcmp(ident, "driver.ilutByLevels") == 0) {
+            ret = fscanf(configFile, "%d", &driver->ilutByLevels);
+         }
+         /* Tuning parameters */
+         else if (strcmp(ident, "driver.tune") == 0) {
+            ret = fscanf(configFile, "%d", &driver->tune);
+         }
+         else if (strcmp(ident, "driver.tuneMatvecs") == 0) {
+            ret = fscanf(configFile, "%d", &driver->tuneMatvecs);
+         }
+         else if (strcmp(ident, "driver.tuneCacheFile") == 0) {
+            ret = fscanf(configFile, "%s", driver->tuneCacheFileName);
+         }
          else if (strncmp(ident, "driver.", 7) == 0) {
             fprintf(stderr, 
               "ERROR(read_driver_params): Invalid parameter '%s'\n", ident);
@@ -439,8 +487,9 @@ int read_driver_params(char *configFileName, driver_params *driver) {
 
 void driver_display_params(driver_params driver, FILE *outputFile) {
 
-const char *strPrecChoice[] = {"noprecond", "jacobi", "davidsonjacobi", "ilut", "normal", "bjacobi"};
-const char *strMatrixChoice[] = {"default", "native", "petsc", "parasails", "rsb"};
+const char *strPrecChoice[] = {"noprecond", "jacobi", "davidsonjacobi", "ilut", "normal", "bjacobi", "ilut_i"};
+const char *strMatrixChoice[] = {"default", "native", "petsc", "parasails", "rsb", "sell"};
+const char *strReorder[] = {"none", "rcm"};
  
 fprintf(outputFile, "// ---------------------------------------------------\n"
                     "//                 driver configuration               \n"
@@ -450,6 +499,7 @@ fprintf(outputFile, "driver.partId        = %s\n", driver.partId);
 fprintf(outputFile, "driver.partDir       = %s\n", driver.partDir);
 fprintf(outputFile, "driver.matrixFile    = %s\n", driver.matrixFileName);
 fprintf(outputFile, "driver.matrixChoice  = %s\n", strMatrixChoice[driver.matrixChoice]);
+fprintf(outputFile, "driver.reorder       = %s\n", strReorder[driver.reorder]);
 fprintf(outputFile, "driver.initialGuessesFile = %s\n", driver.initialGuessesFileName);
 fprintf(outputFile, "driver.initialGuessesPert = %e\n", driver.initialGuessesPert);
 fprintf(outputFile, "driver.saveXFile     = %s\n", driver.saveXFileName);
@@ -460,7 +510,11 @@ fprintf(outputFile, "driver.shift         = %e\n", driver.shift);
 fprintf(outputFile, "driver.isymm         = %d\n", driver.isymm);
 fprintf(outputFile, "driver.level         = %d\n", driver.level);
 fprintf(outputFile, "driver.threshold     = %f\n", driver.threshold);
-fprintf(outputFile, "driver.filter        = %f\n\n", driver.filter);
+fprintf(outputFile, "driver.filter        = %f\n", driver.filter);
+fprintf(outputFile, "driver.ilutByLevels  = %d\n", driver.ilutByLevels);
+fprintf(outputFile, "driver.tune          = %d\n", driver.tune);
+fprintf(outputFile, "driver.tuneMatvecs   = %d\n", driver.tuneMatvecs);
+fprintf(outputFile, "driver.tuneCacheFile = %s\n\n", driver.tuneCacheFileName);
 
 }
 
@@ -581,6 +635,7 @@ int read_solver_params_svds(char *configFileName, char *outputFileName,
          READ_FIELD(maxBasisSize, "%d");
          READ_FIELD(maxBlockSize, "%d");
          READ_FIELD(maxMatvecs, "%" PRIMME_INT_P);
+         READ_FIELD(rowBlockSize, "%d");
 
          READ_FIELD_OP(target,
             OPTION(target, primme_svds_smallest)
@@ -708,14 +763,18 @@ void broadCast(primme_params *primme, primme_preset_method *method,
       MPI_Bcast(driver->initialGuessesFileName, 1024, MPI_CHAR, 0, comm);
       MPI_Bcast(driver->saveXFileName, 1024, MPI_CHAR, 0, comm);
       MPI_Bcast(driver->checkXFileName, 1024, MPI_CHAR, 0, comm);
+      MPI_Bcast(&driver->checkInterface, 1, MPI_INT, 0, comm);
       MPI_Bcast(&driver->initialGuessesPert, 1, MPI_DOUBLE, 0, comm);
       MPI_Bcast(&driver->matrixChoice, 1, MPI_INT, 0, comm);
+      MPI_Bcast(&driver->reorder, 1, MPI_INT, 0, comm);
       MPI_Bcast(&driver->PrecChoice, 1, MPI_INT, 0, comm);
       MPI_Bcast(&driver->isymm, 1, MPI_INT, 0, comm);
       MPI_Bcast(&driver->level, 1, MPI_INT, 0, comm);
       MPI_Bcast(&driver->threshold, 1, MPI_DOUBLE, 0, comm);
       MPI_Bcast(&driver->filter, 1, MPI_DOUBLE, 0, comm);
+   MPI_Bcast(&driver->ilutByLevels, 1, MPI_INT, 0, comm);
       MPI_Bcast(&driver->shift, 1, MPI_DOUBLE, 0, comm);
+      MPI_Bcast(&driver->tune, 1, MPI_INT, 0, comm);
    }
 
    MPI_Bcast(&(primme->numEvals), 1, MPI_INT, 0, comm);
@@ -744,6 +803,7 @@ void broadCast(primme_params *primme, primme_preset_method *method,
    MPI_Bcast(&(primme->initBasisMode), 1, MPI_INT, 0, comm);
 
    MPI_Bcast(&(primme->projectionParams.projection), 1, MPI_INT, 0, comm);
+   MPI_Bcast(&(primme->projectionParams.distMinSize), 1, MPI_INT, 0, comm);
    MPI_Bcast(&(primme->restartingParams.scheme), 1, MPI_INT, 0, comm);
    MPI_Bcast(&(primme->restartingParams.maxPrevRetain), 1, MPI_INT, 0, comm);
 
@@ -759,6 +819,13 @@ void broadCast(primme_params *primme, primme_preset_method *method,
    MPI_Bcast(&(primme->correctionParams.projectors.SkewQ),  1, MPI_INT, 0,comm);
    MPI_Bcast(&(primme->correctionParams.projectors.SkewX),  1, MPI_INT, 0,comm);
    MPI_Bcast(&(primme->correctionParams.projectors.SkewX),  1, MPI_INT, 0,comm);
+   MPI_Bcast(&(primme->workspaceParams.placement), 1, MPI_INT, 0, comm);
+   MPI_Bcast(&(primme->workspaceParams.hugePages), 1, MPI_INT, 0, comm);
+   MPI_Bcast(&(primme->precondParams.cacheSize), 1, MPI_INT, 0, comm);
+   MPI_Bcast(&(primme->precondParams.shiftQuantum), 1, MPI_DOUBLE, 0, comm);
+   MPI_Bcast(&(primme->precondParams.maxShiftDrift), 1, MPI_DOUBLE, 0, comm);
+   MPI_Bcast(&(primme->precondParams.maxTimeRatio), 1, MPI_DOUBLE, 0, comm);
+   MPI_Bcast(&(primme->precondParams.async), 1, MPI_INT, 0, comm);
 
    MPI_Bcast(method, 1, MPI_INT, 0, comm);
 }
@@ -780,11 +847,13 @@ void broadCast_svds(primme_svds_params *primme_svds, primme_svds_preset_method *
    MPI_Bcast(driver->checkXFileName, 1024, MPI_CHAR, 0, comm);
    MPI_Bcast(&driver->initialGuessesPert, 1, MPI_DOUBLE, 0, comm);
    MPI_Bcast(&driver->matrixChoice, 1, MPI_INT, 0, comm);
+   MPI_Bcast(&driver->reorder, 1, MPI_INT, 0, comm);
    MPI_Bcast(&driver->PrecChoice, 1, MPI_INT, 0, comm);
    MPI_Bcast(&driver->isymm, 1, MPI_INT, 0, comm);
    MPI_Bcast(&driver->level, 1, MPI_INT, 0, comm);
    MPI_Bcast(&driver->threshold, 1, MPI_DOUBLE, 0, comm);
    MPI_Bcast(&driver->filter, 1, MPI_DOUBLE, 0, comm);
+   MPI_Bcast(&driver->ilutByLevels, 1, MPI_INT, 0, comm);
    MPI_Bcast(&driver->shift, 1, MPI_DOUBLE, 0, comm);
 
    MPI_Bcast(&(primme_svds->numSvals), 1, MPI_INT, 0, comm);
@@ -806,6 +875,7 @@ void broadCast_svds(primme_svds_params *primme_svds, primme_svds_preset_method *
    MPI_Bcast(&(primme_svds->aNorm), 1, MPI_DOUBLE, 0, comm);
    MPI_Bcast(&(primme_svds->eps), 1, MPI_DOUBLE, 0, comm);
    MPI_Bcast(&(primme_svds->printLevel), 1, MPI_INT, 0, comm);
+   MPI_Bcast(&(primme_svds->rowBlockSize), 1, MPI_INT, 0, comm);
    MPI_Bcast(&(primme_svds->method), 1, MPI_INT, 0, comm);
    MPI_Bcast(&(primme_svds->methodStage2), 1, MPI_INT, 0, comm);
    MPI_Bcast(&(primme_svds->precondition), 1, MPI_INT, 0, comm);
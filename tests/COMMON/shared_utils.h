@@ -41,7 +41,8 @@ typedef enum {
    driver_native,
    driver_petsc,
    driver_parasails,
-   driver_rsb
+   driver_rsb,
+   driver_sell     /* native with the matrix in SELL-C-sigma */
 } driver_mat;
 
 typedef enum {
@@ -50,9 +51,15 @@ typedef enum {
    driver_jacobi_i,     /* Diag(A-shift_i), shifts provided by primme every step */
    driver_ilut,         /* ILUT(A-shift)  , shift provided once by user */
    driver_normal,       /* precond based on A*A, only for SVD */
-   driver_bjacobi       /* block jacobi */
+   driver_bjacobi,      /* block jacobi */
+   driver_ilut_i        /* ILUT(A-shift_i), factorizations kept by primme */
 } driver_prec;
 
+typedef enum {
+   driver_order_none,   /* rows in the order of the file */
+   driver_order_rcm     /* reverse Cuthill-McKee */
+} driver_order;
+
 typedef struct driver_params {
 
    char outputFileName[512];
@@ -64,9 +71,11 @@ typedef struct driver_params {
    char saveXFileName[1024];
    double initialGuessesPert;
    char checkXFileName[1024];
-   int checkInterface;
+   int checkInterface; /* 1: check primme_params too; 2: except aNorm and */
+                       /* the counters, which depend on timings          */
 
    driver_mat matrixChoice;
+   driver_order reorder;
 
    int weightedPart;
 
@@ -76,7 +85,13 @@ typedef struct driver_params {
    int level;
    double threshold;
    double filter;
+   int ilutByLevels;    /* 1: solve the ILUT factors always by levels */
    double shift;
+
+   /* Tuning of the method, block size and basis size (see COMMON/tune.c) */
+   int tune;
+   int tuneMatvecs;
+   char tuneCacheFileName[1024];
    
 } driver_params;
 
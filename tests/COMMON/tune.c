@@ -0,0 +1,398 @@
+/*******************************************************************************
+ *   PRIMME PReconditioned Iterative MultiMethod Eigensolver
+ *   Copyright (C) 2016 College of William & Mary,
+ *   James R. McCombs, Eloy Romero Alcalde, Andreas Stathopoulos, Lingfei Wu
+ *
+ *   This file is part of PRIMME.
+ *
+ *   PRIMME is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   PRIMME is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *******************************************************************************
+ * File: tune.c
+ *
+ * Purpose - Choice of the preset method, block size and basis size by
+ *           short trial solves on the operator.
+ *
+ *           Every configuration runs a few matvecs in a child process;
+ *           unless the library is built with -DNDEBUG, a solve that stops
+ *           before converging ends on an assert, so the child reports its
+ *           progress through shared memory from monitorFun. The time to
+ *           solution of every trial is projected from the matvecs per
+ *           converged pair, or from the rate of decrease of the residual
+ *           norm, and the time per matvec of the trial. The best
+ *           configuration is kept in a cache file, a line per problem,
+ *           keyed by a signature of the problem and the operator.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "tune.h"
+#include "num.h"
+/* wtime.h header file is included so primme's timimg functions can be used */
+#include "../../src/include/wtime.h"
+
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#  define MAP_ANONYMOUS MAP_ANON
+#endif
+
+#if defined(USE_DOUBLECOMPLEX)
+#  define TUNE_ARITH "doublecomplex"
+#elif defined(USE_FLOATCOMPLEX)
+#  define TUNE_ARITH "floatcomplex"
+#elif defined(USE_FLOAT)
+#  define TUNE_ARITH "float"
+#else
+#  define TUNE_ARITH "double"
+#endif
+
+#define TUNE_NUM_METHODS 3
+static const primme_preset_method tuneMethods[TUNE_NUM_METHODS] = {
+   PRIMME_DEFAULT_MIN_MATVECS, PRIMME_DEFAULT_MIN_TIME, PRIMME_DYNAMIC};
+static const char *tuneMethodNames[TUNE_NUM_METHODS] = {
+   "PRIMME_DEFAULT_MIN_MATVECS", "PRIMME_DEFAULT_MIN_TIME", "PRIMME_DYNAMIC"};
+
+typedef struct {
+   int method;             /* index in tuneMethods */
+   int maxBlockSize;
+   int maxBasisSize;
+   int minRestartSize;
+   int maxPrevRetain;
+} tune_config;
+
+/* Progress of a trial, written by its process in shared memory */
+
+typedef struct {
+   int finished;             /* 1 if Sprimme returned */
+   int ret;                  /* value returned by Sprimme; it may be zero */
+                             /* with fewer than numEvals pairs converged  */
+   int numConverged;         /* pairs converged so far */
+   PRIMME_INT matvecs;       /* matvecs so far */
+   double time;              /* seconds since the trial started */
+   PRIMME_INT convMatvecs;   /* matvecs when the last pair converged */
+   PRIMME_INT anchorMatvecs; /* matvecs at the first residual norm after */
+                             /* the last convergence, or -1              */
+   double anchorNorm;        /* that residual norm */
+   double norm;              /* smallest residual norm of the last block */
+   double tol;               /* convergence tolerance, eps*||A|| */
+   double t0;                /* time at the start */
+} tune_trial;
+
+static tune_trial *trial;    /* progress of the trial run by this process */
+
+static void tuneMonitor(void *basisEvals, int *basisSize, int *basisFlags,
+      int *iblock, int *blockSize, void *blockNorms, int *numConverged,
+      void *lockedEvals, int *numLocked, void *lockedNorms,
+      primme_event *event, int *stop, primme_params *primme, int *ierr) {
+   int i;
+
+   trial->matvecs = primme->stats.numMatvecs;
+   trial->time = primme_get_wtime() - trial->t0;
+   /* Without locking, the pairs converged may decrease after verifying */
+   if (*numConverged > trial->numConverged) {
+      trial->convMatvecs = trial->matvecs;
+      trial->anchorMatvecs = -1;
+   }
+   trial->numConverged = *numConverged;
+   if (*event == primme_event_outer_iteration && blockNorms && *blockSize > 0) {
+      double norm = HUGE_VAL;
+      for (i=0; i<*blockSize; i++) {
+         norm = min(norm, (double)((REAL*)blockNorms)[i]);
+      }
+      trial->norm = norm;
+      trial->tol = primme->eps*(primme->aNorm > 0.0 ? primme->aNorm
+            : primme->stats.estimateLargestSVal);
+      if (trial->anchorMatvecs < 0) {
+         trial->anchorMatvecs = trial->matvecs;
+         trial->anchorNorm = norm;
+      }
+   }
+   *ierr = 0;
+}
+
+/******************************************************************************
+ * Projects the matvecs to converge numEvals pairs: the current pair takes
+ * the matvecs for its residual norm to reach the tolerance at the rate
+ * observed since the last convergence, and every other pair takes the
+ * average matvecs of the converged ones. Returns the projected seconds.
+ *
+******************************************************************************/
+static double projectTime(const tune_trial *t, int numEvals,
+      double *projMatvecs) {
+   double cur = -1.0, perPair, mv;
+
+   if (t->matvecs <= 0) return HUGE_VAL;
+   if (t->finished && t->ret == 0 && t->numConverged >= numEvals) {
+      mv = t->matvecs;
+   }
+   else {
+      if (t->anchorMatvecs >= 0 && t->norm <= t->tol) {
+         cur = 0.0;
+      }
+      else if (t->anchorMatvecs >= 0 && t->matvecs > t->anchorMatvecs
+            && t->norm < t->anchorNorm) {
+         cur = log(t->norm/t->tol)/log(t->anchorNorm/t->norm)
+            *(t->matvecs - t->anchorMatvecs);
+      }
+      if (t->numConverged > 0) perPair = (double)t->convMatvecs/t->numConverged;
+      else if (cur >= 0.0) perPair = t->matvecs + cur;
+      else return HUGE_VAL;
+      if (cur < 0.0) cur = perPair;
+      mv = t->matvecs + cur + max(numEvals - t->numConverged - 1, 0)*perPair;
+   }
+   *projMatvecs = mv;
+   return mv*t->time/t->matvecs;
+}
+
+/* Sets the method and sizes of a configuration in a copy of primme; the */
+/* sizes left to zero take the defaults of primme_set_method             */
+
+static void setConfig(primme_params *primme, int method, int blockSize,
+      int basisSize, primme_params *p, tune_config *c) {
+   *p = *primme;
+   p->maxBlockSize = blockSize;
+   p->maxBasisSize = basisSize;
+   p->minRestartSize = 0;
+   p->restartingParams.maxPrevRetain = -1;
+   primme_set_method(tuneMethods[method], p);
+   c->method = method;
+   c->maxBlockSize = p->maxBlockSize;
+   c->maxBasisSize = p->maxBasisSize;
+   c->minRestartSize = p->minRestartSize;
+   c->maxPrevRetain = p->restartingParams.maxPrevRetain;
+}
+
+/* Solves with p and at most maxMatvecs in a child process */
+
+static int runTrial(primme_params *p, PRIMME_INT maxMatvecs, tune_trial *t) {
+   pid_t pid;
+   int status;
+
+   memset(t, 0, sizeof(*t));
+   t->anchorMatvecs = -1;
+   fflush(p->outputFile);
+   fflush(stdout);
+   if ((pid = fork()) < 0) return -1;
+   if (pid == 0) {
+      double *evals, *rnorms;
+      SCALAR *evecs;
+      int ret;
+
+      /* Hide the message of the assert when the trial stops */
+      if (freopen("/dev/null", "w", stderr) == NULL) _exit(1);
+      p->maxMatvecs = maxMatvecs;
+      p->printLevel = 0;
+      p->outputFile = stderr;
+      p->monitorFun = tuneMonitor;
+      p->initSize = 0;
+      p->numOrthoConst = 0;
+      evals = (double *)primme_calloc(p->numEvals, sizeof(double), "evals");
+      rnorms = (double *)primme_calloc(p->numEvals, sizeof(double), "rnorms");
+      evecs = (SCALAR *)primme_calloc(p->nLocal*p->numEvals, sizeof(SCALAR),
+            "evecs");
+      trial = t;
+      t->t0 = primme_get_wtime();
+      ret = Sprimme(evals, evecs, rnorms, p);
+      t->time = primme_get_wtime() - t->t0;
+      t->matvecs = p->stats.numMatvecs;
+      t->numConverged = p->initSize;
+      t->ret = ret;
+      t->finished = 1;
+      _exit(0);
+   }
+   if (waitpid(pid, &status, 0) < 0) return -1;
+   return 0;
+}
+
+/******************************************************************************
+ * Writes in fp moments of the operator invariant to symmetric permutations:
+ * e'Ae/n, ||Ae||^2/n and (Ae)'A(Ae)/n, with e the vector of ones
+ *
+******************************************************************************/
+static int fingerprint(primme_params *primme, double *fp) {
+   SCALAR *x, *y;
+   PRIMME_INT i, ld = primme->nLocal;
+   int one = 1, ierr = 0;
+
+   x = (SCALAR *)primme_calloc(ld, sizeof(SCALAR), "x");
+   y = (SCALAR *)primme_calloc(ld, sizeof(SCALAR), "y");
+   for (i=0; i<ld; i++) x[i] = 1.0;
+   primme->matrixMatvec(x, &ld, y, &ld, &one, primme, &ierr);
+   if (ierr == 0) {
+      fp[0] = fp[1] = 0.0;
+      for (i=0; i<ld; i++) {
+         fp[0] += REAL_PART(y[i]);
+         fp[1] += REAL_PART(CONJ(y[i])*y[i]);
+      }
+      primme->matrixMatvec(y, &ld, x, &ld, &one, primme, &ierr);
+   }
+   if (ierr == 0) {
+      fp[2] = 0.0;
+      for (i=0; i<ld; i++) fp[2] += REAL_PART(CONJ(y[i])*x[i]);
+      for (i=0; i<3; i++) fp[i] /= primme->n;
+   }
+   free(x);
+   free(y);
+   return ierr;
+}
+
+/* Reads the configuration of the last line with the signature sig */
+
+static int readCache(const char *fileName, const char *sig, tune_config *c) {
+   FILE *f;
+   char line[4096], s[2048], m[64];
+   int i, found = 0;
+   tune_config l;
+
+   if ((f = fopen(fileName, "r")) == NULL) return 0;
+   while (fgets(line, sizeof(line), f)) {
+      if (line[0] == '#') continue;
+      if (sscanf(line, "%2047s %63s %d %d %d %d", s, m, &l.maxBlockSize,
+               &l.maxBasisSize, &l.minRestartSize, &l.maxPrevRetain) != 6
+            || strcmp(s, sig) != 0) continue;
+      for (i=0; i<TUNE_NUM_METHODS && strcmp(m, tuneMethodNames[i]); i++);
+      if (i >= TUNE_NUM_METHODS) continue;
+      l.method = i;
+      *c = l;
+      found = 1;
+   }
+   fclose(f);
+   return found;
+}
+
+static int writeCache(const char *fileName, const char *sig,
+      const tune_config *c, double time) {
+   FILE *f;
+
+   if ((f = fopen(fileName, "a")) == NULL) return -1;
+   if (ftell(f) == 0) {
+      fprintf(f, "# signature method maxBlockSize maxBasisSize minRestartSize"
+            " maxPrevRetain projectedTime\n");
+   }
+   fprintf(f, "%s %s %d %d %d %d %g\n", sig, tuneMethodNames[c->method],
+         c->maxBlockSize, c->maxBasisSize, c->minRestartSize,
+         c->maxPrevRetain, time);
+   fclose(f);
+   return 0;
+}
+
+/******************************************************************************
+ * Subroutine tune_params - set the method and the members maxBlockSize,
+ *    maxBasisSize, minRestartSize and restartingParams.maxPrevRetain with
+ *    the configuration in driver->tuneCacheFileName for this problem, or
+ *    else with the configuration of the trials with the shortest projected
+ *    time, which is appended to the cache file.
+ *
+ *    The trials take the methods DEFAULT_MIN_MATVECS, DEFAULT_MIN_TIME and
+ *    DYNAMIC, block sizes 1, 2, ... TUNE_MAX_BLOCK up to numEvals, and the
+ *    default basis size of primme_set_method and twice that.
+ *
+ ******************************************************************************/
+#undef __FUNCT__
+#define __FUNCT__ "tune_params"
+int tune_params(driver_params *driver, primme_params *primme,
+      primme_preset_method *method) {
+#ifdef USE_MPI
+   fprintf(stderr, "ERROR: tuning is not supported with MPI!\n");
+   return -1;
+#else
+   char sig[1024];
+   tune_config c, best;
+   tune_trial *t;
+   primme_params p;
+   double fp[3], bestTime = HUGE_VAL, time, projMatvecs;
+   PRIMME_INT budget;
+   int i, b, s, maxBlock;
+   FILE *out = primme->outputFile;
+
+   ASSERT_MSG(fingerprint(primme, fp) == 0, -1, "matrixMatvec failed\n");
+   snprintf(sig, sizeof(sig), "%s:n=%" PRIMME_INT_P ":k=%d:t=%d:s=%g:eps=%g"
+         ":j=%d:p=%d,%g:fp=%.6e,%.6e,%.6e", TUNE_ARITH, primme->n,
+         primme->numEvals, (int)primme->target, primme->numTargetShifts > 0 ?
+         primme->targetShifts[0] : 0.0, primme->eps,
+         (int)primme->projectionParams.projection, (int)driver->PrecChoice,
+         driver->shift, fp[0], fp[1], fp[2]);
+
+   if (driver->tuneCacheFileName[0]
+         && readCache(driver->tuneCacheFileName, sig, &best)) {
+      fprintf(out, "Tuning: %s read from %s\n", sig, driver->tuneCacheFileName);
+   }
+   else {
+      budget = driver->tuneMatvecs > 0 ? driver->tuneMatvecs
+         : TUNE_MATVECS + TUNE_MATVECS_EVAL*primme->numEvals;
+      t = (tune_trial *)mmap(NULL, sizeof(tune_trial), PROT_READ|PROT_WRITE,
+            MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+      ASSERT_MSG(t != MAP_FAILED, -1, "mmap failed\n");
+
+      fprintf(out, "Tuning: %s, trials of %" PRIMME_INT_P " matvecs\n", sig,
+            budget);
+      fprintf(out, "Tuning: %-26s %5s %5s %7s %6s %7s %5s %9s %9s %9s\n",
+            "method", "block", "basis", "restart", "retain", "matvecs",
+            "conv", "time", "projMV", "projTime");
+      maxBlock = min(TUNE_MAX_BLOCK, max(1, primme->numEvals));
+      for (i=0; i<TUNE_NUM_METHODS; i++) for (b=1; b<=maxBlock; b*=2)
+            for (s=0; s<2; s++) {
+         setConfig(primme, i, b, 0, &p, &c);
+         if (s == 1) {
+            if (c.maxBasisSize >= primme->n) continue;
+            setConfig(primme, i, b, min(primme->n, 2*c.maxBasisSize), &p, &c);
+         }
+         if (runTrial(&p, budget, t) != 0) {
+            munmap(t, sizeof(tune_trial));
+            ASSERT_MSG(0, -1, "fork failed\n");
+         }
+         projMatvecs = 0.0;
+         time = projectTime(t, primme->numEvals, &projMatvecs);
+         fprintf(out, "Tuning: %-26s %5d %5d %7d %6d %7" PRIMME_INT_P
+               " %5d %9.3g %9.3g %9.3g\n", tuneMethodNames[i],
+               c.maxBlockSize, c.maxBasisSize, c.minRestartSize,
+               c.maxPrevRetain, t->matvecs, t->numConverged, t->time,
+               projMatvecs, time);
+         if (time < bestTime) {
+            bestTime = time;
+            best = c;
+         }
+      }
+      munmap(t, sizeof(tune_trial));
+
+      if (bestTime == HUGE_VAL) {
+         fprintf(out, "Tuning: no trial converged or reduced the residual\n");
+         return 0;
+      }
+      if (driver->tuneCacheFileName[0]) {
+         ASSERT_MSG(writeCache(driver->tuneCacheFileName, sig, &best,
+                  bestTime) == 0, -1, "Could not write '%s'\n",
+               driver->tuneCacheFileName);
+      }
+   }
+
+   *method = tuneMethods[best.method];
+   primme->maxBlockSize = best.maxBlockSize;
+   primme->maxBasisSize = best.maxBasisSize;
+   primme->minRestartSize = best.minRestartSize;
+   primme->restartingParams.maxPrevRetain = best.maxPrevRetain;
+   fprintf(out, "Tuning: selected %s, maxBlockSize %d, maxBasisSize %d, "
+         "minRestartSize %d, maxPrevRetain %d\n", tuneMethodNames[best.method],
+         best.maxBlockSize, best.maxBasisSize, best.minRestartSize,
+         best.maxPrevRetain);
+   fflush(out);
+   return 0;
+#endif
+}
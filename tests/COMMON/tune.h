@@ -0,0 +1,52 @@
+/*******************************************************************************
+ *   PRIMME PReconditioned Iterative MultiMethod Eigensolver
+ *   Copyright (C) 2016 College of William & Mary,
+ *   James R. McCombs, Eloy Romero Alcalde, Andreas Stathopoulos, Lingfei Wu
+ *
+ *   This file is part of PRIMME.
+ *
+ *   PRIMME is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   PRIMME is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *******************************************************************************
+ * File: tune.h
+ *
+ * Purpose - Definitions of the tuning of the method, block size and basis
+ *           size used by the driver.
+ *
+ ******************************************************************************/
+
+#ifndef TUNE_H
+
+#include "primme.h"
+#include "shared_utils.h"
+
+/* Default matvecs of every trial is TUNE_MATVECS + TUNE_MATVECS_EVAL*numEvals */
+#ifndef TUNE_MATVECS
+#define TUNE_MATVECS 200
+#endif
+#ifndef TUNE_MATVECS_EVAL
+#define TUNE_MATVECS_EVAL 20
+#endif
+
+/* Largest block size tried */
+#ifndef TUNE_MAX_BLOCK
+#define TUNE_MAX_BLOCK 4
+#endif
+
+int tune_params(driver_params *driver, primme_params *primme,
+      primme_preset_method *method);
+
+#define TUNE_H
+#endif
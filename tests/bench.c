@@ -0,0 +1,437 @@
+/*******************************************************************************
+ *   PRIMME PReconditioned Iterative MultiMethod Eigensolver
+ *   Copyright (C) 2016 College of William & Mary,
+ *   James R. McCombs, Eloy Romero Alcalde, Andreas Stathopoulos, Lingfei Wu
+ *
+ *   This file is part of PRIMME.
+ *
+ *   PRIMME is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   PRIMME is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *******************************************************************************
+ * File: bench.c
+ *
+ * Purpose - benchmark of the preset methods on a set of matrices. Calling
+ *           format:
+ *
+ *             bench [options] Matrix1 [Matrix2 ...]
+ *
+ *  The matrices are any name accepted by the native driver: MTX files,
+ *  binary CSR files, or matrices generated in memory such as gen:lap3d:100
+ *  (see COMMON/csr.c). Square matrices are solved with primme and
+ *  rectangular ones with primme_svds, for every combination of method,
+ *  block size and projection. The results are written in JSON, a run per
+ *  object, with the time, the counters and the time of every phase. Every
+ *  run is solved in a child process: unless the library is built with
+ *  -DNDEBUG a failed solve (e.g., maximum number of matvecs reached) stops
+ *  on an assert, and the run is recorded with "ret": null and the signal.
+ *
+ *  Options (lists are separated by commas):
+ *    -o FILE        output file (standard output)
+ *    -k NUM         number of eigenvalues/singular values (10)
+ *    -e EPS         tolerance, primme.eps (1e-8)
+ *    -x NUM         maximum number of matvecs (100000)
+ *    -t TARGET      smallest, largest, closest_geq, closest_leq or
+ *                   closest_abs (smallest); svds take closest_abs for the
+ *                   three closest targets
+ *    -c SHIFT       target shift for the closest targets (0)
+ *    -p PREC        noprecond or jacobi (noprecond)
+ *    -f FORMAT      native or sell (native)
+ *    -m LIST        methods without PRIMME_, e.g., DYNAMIC,JDQMR, or all
+ *                   (DYNAMIC,DEFAULT_MIN_MATVECS,JDQMR_ETol)
+ *    -s LIST        svds methods without primme_svds_, or all
+ *                   (hybrid,normalequations)
+ *    -b LIST        maximum block sizes (1)
+ *    -j LIST        projections without primme_proj_ (default); harmonic
+ *                   and refined only run with the closest targets
+ *    -r NUM         repetitions of every run (1)
+ *
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "native.h"
+#include "primme.h"
+/* wtime.h header file is included so primme's timimg functions can be used */
+#include "../src/include/wtime.h"
+
+static const char *methodNames[] = {"DEFAULT_METHOD", "DYNAMIC",
+   "DEFAULT_MIN_TIME", "DEFAULT_MIN_MATVECS", "Arnoldi", "GD", "GD_plusK",
+   "GD_Olsen_plusK", "JD_Olsen_plusK", "RQI", "JDQR", "JDQMR", "JDQMR_ETol",
+   "SUBSPACE_ITERATION", "LOBPCG_OrthoBasis", "LOBPCG_OrthoBasis_Window"};
+static const char *svdsMethodNames[] = {"default", "hybrid", "normalequations",
+   "augmented"};
+static const char *projNames[] = {"default", "RR", "harmonic", "refined"};
+static const char *targetNames[] = {"smallest", "largest", "closest_geq",
+   "closest_leq", "closest_abs"};
+
+#define NAMES(A) (A), (int)(sizeof(A)/sizeof(A[0]))
+
+/* Maximum number of values in a list option */
+#define BENCH_MAX_LIST 32
+
+typedef struct {
+   FILE *out;
+   int numVals;
+   double eps;
+   int maxMatvecs;
+   int target;         /* index in targetNames, as primme_target */
+   double shift;
+   int jacobi;
+   int sell;
+   int methods[BENCH_MAX_LIST], numMethods;
+   int svdsMethods[BENCH_MAX_LIST], numSvdsMethods;
+   int blocks[BENCH_MAX_LIST], numBlocks;
+   int projs[BENCH_MAX_LIST], numProjs;
+   int repeat;
+   int numRuns;        /* runs written so far */
+   int child;          /* if nonzero, this is the process of a run */
+} bench_params;
+
+/* Parses a list of names into their indices in names; "all" selects all */
+
+static int parseNames(const char *list, const char **names, int numNames,
+      int *v, int *n) {
+   char buf[1024], *tok;
+   int i;
+
+   if (!strcmp(list, "all")) {
+      for (i=0; i<numNames; i++) v[i] = i;
+      *n = numNames;
+      return 0;
+   }
+   strncpy(buf, list, sizeof(buf)-1);
+   buf[sizeof(buf)-1] = '\0';
+   for (*n=0, tok=strtok(buf, ","); tok; tok=strtok(NULL, ",")) {
+      for (i=0; i<numNames && strcmp(tok, names[i]); i++);
+      if (i >= numNames || *n >= BENCH_MAX_LIST) {
+         fprintf(stderr, "ERROR: Invalid value '%s'\n", tok);
+         return -1;
+      }
+      v[(*n)++] = i;
+   }
+   return 0;
+}
+
+static int parseInts(const char *list, int *v, int *n) {
+   char buf[1024], *tok;
+
+   strncpy(buf, list, sizeof(buf)-1);
+   buf[sizeof(buf)-1] = '\0';
+   for (*n=0, tok=strtok(buf, ","); tok; tok=strtok(NULL, ",")) {
+      if (*n >= BENCH_MAX_LIST || (v[*n] = atoi(tok)) < 1) {
+         fprintf(stderr, "ERROR: Invalid value '%s'\n", tok);
+         return -1;
+      }
+      (*n)++;
+   }
+   return 0;
+}
+
+static void printStats(FILE *out, const primme_stats *s) {
+   fprintf(out, "{\"iterations\": %" PRIMME_INT_P ", \"restarts\": %" PRIMME_INT_P
+         ", \"matvecs\": %" PRIMME_INT_P ", \"preconds\": %" PRIMME_INT_P
+         ", \"globalSums\": %" PRIMME_INT_P ", \"orthoInnerProds\": %.0f"
+         ", \"elapsedTime\": %g, \"timeMatvec\": %g, \"timePrecond\": %g"
+         ", \"timeOrtho\": %g, \"timeGlobalSum\": %g, \"timeSolveH\": %g"
+         ", \"timeRestart\": %g, \"timeResetUpdateVWXR\": %g"
+         ", \"timeLocking\": %g, \"timeUpdateVWXR\": %g"
+         ", \"timeInnerSolve\": %g, \"timeConvergence\": %g"
+         ", \"estimateFlops\": %g, \"estimateBytes\": %g}",
+         s->numOuterIterations, s->numRestarts, s->numMatvecs,
+         s->numPreconds, s->numGlobalSum, s->numOrthoInnerProds,
+         s->elapsedTime, s->timeMatvec, s->timePrecond, s->timeOrtho,
+         s->timeGlobalSum, s->timeSolveH, s->timeRestart,
+         s->timeResetUpdateVWXR, s->timeLocking, s->timeUpdateVWXR,
+         s->timeInnerSolve, s->timeConvergence, s->estimateFlops,
+         s->estimateBytes);
+}
+
+static void beginRun(bench_params *b, const char *matrixName,
+      const CSRMatrix *matrix, const char *solver, const char *method,
+      int blockSize, const char *proj, int rep) {
+   fprintf(b->out, "%s\n    {\"matrix\": \"%s\", \"m\": %d, \"n\": %d, \"nnz\": %d"
+         ", \"format\": \"%s\", \"precond\": \"%s\", \"solver\": \"%s\""
+         ", \"method\": \"%s\", \"maxBlockSize\": %d, \"projection\": \"%s\""
+         ", \"target\": \"%s\", \"shift\": %g, \"numVals\": %d, \"eps\": %g"
+         ", \"repetition\": %d",
+         b->numRuns ? "," : "", matrixName, matrix->m, matrix->n, matrix->nnz,
+         b->sell ? "sell" : "native", b->jacobi ? "jacobi" : "noprecond",
+         solver, method, blockSize, proj, targetNames[b->target],
+         b->shift, b->numVals, b->eps, rep);
+   b->numRuns++;
+}
+
+/* Forks the process that solves a run; returns nonzero in that process, or */
+/* in this one if fork fails. The parent records runs killed by a signal.  */
+
+static int startRun(bench_params *b) {
+   pid_t pid;
+   int status;
+
+   fflush(b->out);
+   if ((pid = fork()) < 0) return 1;
+   if (pid == 0) {
+      b->child = 1;
+      return 1;
+   }
+   if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status)) {
+      fprintf(b->out, ", \"ret\": null, \"signal\": %d}",
+            WIFSIGNALED(status) ? WTERMSIG(status) : 0);
+   }
+   return 0;
+}
+
+static void endRun(bench_params *b) {
+   fprintf(b->out, "}");
+   fflush(b->out);
+   if (b->child) _exit(0);
+}
+
+static void benchEigs(bench_params *b, const char *matrixName,
+      CSRMatrix *matrix, void *op, double aNorm, double *diag) {
+   int i, j, k, rep, ret;
+   double *evals, *rnorms, t;
+   SCALAR *evecs;
+
+   evals = (double *)primme_calloc(b->numVals, sizeof(double), "evals");
+   rnorms = (double *)primme_calloc(b->numVals, sizeof(double), "rnorms");
+   evecs = (SCALAR *)primme_calloc((size_t)matrix->n*b->numVals, sizeof(SCALAR),
+         "evecs");
+
+   for (i=0; i<b->numMethods; i++) for (j=0; j<b->numBlocks; j++)
+         for (k=0; k<b->numProjs; k++) for (rep=0; rep<b->repeat; rep++) {
+      primme_params primme;
+
+      /* The harmonic and refined projections look for interior values */
+
+      if ((b->projs[k] == primme_proj_harmonic
+               || b->projs[k] == primme_proj_refined)
+            && b->target < primme_closest_geq) continue;
+
+      beginRun(b, matrixName, matrix, "eigs", methodNames[b->methods[i]],
+            b->blocks[j], projNames[b->projs[k]], rep);
+      if (!startRun(b)) continue;
+
+      primme_initialize(&primme);
+      primme.n = matrix->n;
+      primme.matrix = op;
+      primme.matrixMatvec = b->sell ? SELLMatrixMatvec : CSRMatrixMatvec;
+      if (diag) {
+         primme.preconditioner = diag;
+         primme.applyPreconditioner = ApplyInvDavidsonDiagPrecNative;
+         primme.correctionParams.precondition = 1;
+      }
+      primme.numEvals = min(b->numVals, matrix->n);
+      primme.target = (primme_target)b->target;
+      primme.numTargetShifts = 1;
+      primme.targetShifts = &b->shift;
+      primme.eps = b->eps;
+      primme.aNorm = aNorm;
+      primme.maxMatvecs = b->maxMatvecs;
+      primme.maxBlockSize = b->blocks[j];
+      primme.projectionParams.projection = (primme_projection)b->projs[k];
+      primme.printLevel = 0;
+      primme_set_method((primme_preset_method)b->methods[i], &primme);
+
+      t = primme_get_wtime();
+      ret = Sprimme(evals, evecs, rnorms, &primme);
+      t = primme_get_wtime() - t;
+
+      fprintf(b->out, ", \"ret\": %d, \"converged\": %d, \"time\": %g"
+            ", \"stats\": ", ret, primme.initSize, t);
+      printStats(b->out, &primme.stats);
+      primme_free(&primme);
+      endRun(b);
+   }
+
+   free(evals); free(rnorms); free(evecs);
+}
+
+static void benchSvds(bench_params *b, const char *matrixName,
+      CSRMatrix *matrix, void *op, double aNorm, double *diag) {
+   int i, j, rep, ret, numVals = min(b->numVals, min(matrix->m, matrix->n));
+   double *svals, *rnorms, t;
+   SCALAR *svecs;
+
+   svals = (double *)primme_calloc(numVals, sizeof(double), "svals");
+   rnorms = (double *)primme_calloc(numVals, sizeof(double), "rnorms");
+   svecs = (SCALAR *)primme_calloc(((size_t)matrix->m+matrix->n)*numVals,
+         sizeof(SCALAR), "svecs");
+
+   for (i=0; i<b->numSvdsMethods; i++) for (j=0; j<b->numBlocks; j++)
+         for (rep=0; rep<b->repeat; rep++) {
+      primme_svds_params primme_svds;
+
+      beginRun(b, matrixName, matrix, "svds",
+            svdsMethodNames[b->svdsMethods[i]], b->blocks[j], "default", rep);
+      if (!startRun(b)) continue;
+
+      primme_svds_initialize(&primme_svds);
+      primme_svds.m = matrix->m;
+      primme_svds.n = matrix->n;
+      primme_svds.matrix = op;
+      primme_svds.matrixMatvec = b->sell ? SELLMatrixMatvecSVD : CSRMatrixMatvecSVD;
+      if (diag) {
+         primme_svds.preconditioner = diag;
+         primme_svds.applyPreconditioner = ApplyInvDavidsonNormalPrecNative;
+      }
+      primme_svds.numSvals = numVals;
+      primme_svds.target = b->target == primme_smallest ? primme_svds_smallest
+         : (b->target == primme_largest ? primme_svds_largest
+               : primme_svds_closest_abs);
+      primme_svds.numTargetShifts = 1;
+      primme_svds.targetShifts = &b->shift;
+      primme_svds.eps = b->eps;
+      primme_svds.aNorm = aNorm;
+      primme_svds.maxMatvecs = b->maxMatvecs;
+      primme_svds.maxBlockSize = b->blocks[j];
+      primme_svds.printLevel = 0;
+      primme_svds_set_method((primme_svds_preset_method)b->svdsMethods[i],
+            PRIMME_DEFAULT_METHOD, PRIMME_DEFAULT_METHOD, &primme_svds);
+
+      t = primme_get_wtime();
+      ret = Sprimme_svds(svals, svecs, rnorms, &primme_svds);
+      t = primme_get_wtime() - t;
+
+      fprintf(b->out, ", \"ret\": %d, \"converged\": %d, \"time\": %g"
+            ", \"iterations\": %" PRIMME_INT_P ", \"matvecs\": %" PRIMME_INT_P
+            ", \"matvecsA\": %" PRIMME_INT_P ", \"matvecsAt\": %" PRIMME_INT_P
+            ", \"preconds\": %" PRIMME_INT_P ", \"timeMatvecA\": %g"
+            ", \"timeMatvecAt\": %g, \"timePrecond\": %g, \"timeOrtho\": %g"
+            ", \"stage1\": ", ret, primme_svds.initSize, t,
+            primme_svds.stats.numOuterIterations, primme_svds.stats.numMatvecs,
+            primme_svds.stats.numMatvecsA, primme_svds.stats.numMatvecsAt,
+            primme_svds.stats.numPreconds, primme_svds.stats.timeMatvecA,
+            primme_svds.stats.timeMatvecAt, primme_svds.stats.timePrecond,
+            primme_svds.stats.timeOrtho);
+      printStats(b->out, &primme_svds.primme.stats);
+      if (primme_svds.methodStage2 != primme_svds_op_none) {
+         fprintf(b->out, ", \"stage2\": ");
+         printStats(b->out, &primme_svds.primmeStage2.stats);
+      }
+      primme_svds_free(&primme_svds);
+      endRun(b);
+   }
+
+   free(svals); free(rnorms); free(svecs);
+}
+
+int main(int argc, char *argv[]) {
+   bench_params b;
+   int i;
+
+   memset(&b, 0, sizeof(b));
+   b.out = stdout;
+   b.numVals = 10;
+   b.eps = 1e-8;
+   b.maxMatvecs = 100000;
+   b.repeat = 1;
+   parseNames("DYNAMIC,DEFAULT_MIN_MATVECS,JDQMR_ETol", NAMES(methodNames),
+         b.methods, &b.numMethods);
+   parseNames("hybrid,normalequations", NAMES(svdsMethodNames), b.svdsMethods,
+         &b.numSvdsMethods);
+   parseNames("default", NAMES(projNames), b.projs, &b.numProjs);
+   b.blocks[0] = 1;
+   b.numBlocks = 1;
+
+   /* Options */
+
+   for (i=1; i+1<argc && argv[i][0] == '-'; i+=2) {
+      const char *v = argv[i+1];
+      int err = 0;
+      if (!strcmp(argv[i], "-o")) {
+         if ((b.out = fopen(v, "w")) == NULL) {
+            fprintf(stderr, "ERROR: Could not open '%s'\n", v);
+            return -1;
+         }
+      }
+      else if (!strcmp(argv[i], "-k")) err = (b.numVals = atoi(v)) < 1;
+      else if (!strcmp(argv[i], "-e")) err = (b.eps = atof(v)) <= 0.0;
+      else if (!strcmp(argv[i], "-x")) err = (b.maxMatvecs = atoi(v)) < 1;
+      else if (!strcmp(argv[i], "-r")) err = (b.repeat = atoi(v)) < 1;
+      else if (!strcmp(argv[i], "-c")) b.shift = atof(v);
+      else if (!strcmp(argv[i], "-t")) {
+         int t[BENCH_MAX_LIST], n;
+         err = parseNames(v, NAMES(targetNames), t, &n) || n != 1;
+         b.target = t[0];
+      }
+      else if (!strcmp(argv[i], "-p")) {
+         b.jacobi = !strcmp(v, "jacobi");
+         err = !b.jacobi && strcmp(v, "noprecond");
+      }
+      else if (!strcmp(argv[i], "-f")) {
+         b.sell = !strcmp(v, "sell");
+         err = !b.sell && strcmp(v, "native");
+      }
+      else if (!strcmp(argv[i], "-m"))
+         err = parseNames(v, NAMES(methodNames), b.methods, &b.numMethods);
+      else if (!strcmp(argv[i], "-s"))
+         err = parseNames(v, NAMES(svdsMethodNames), b.svdsMethods, &b.numSvdsMethods);
+      else if (!strcmp(argv[i], "-j"))
+         err = parseNames(v, NAMES(projNames), b.projs, &b.numProjs);
+      else if (!strcmp(argv[i], "-b"))
+         err = parseInts(v, b.blocks, &b.numBlocks);
+      else err = 1;
+      if (err) {
+         fprintf(stderr, "ERROR: Invalid option %s %s\n", argv[i], v);
+         return -1;
+      }
+   }
+   if (i >= argc) {
+      fprintf(stderr, "Usage: %s [options] Matrix1 [Matrix2 ...]\n"
+            "See bench.c for the options\n", argv[0]);
+      return -1;
+   }
+
+#ifdef USE_DOUBLECOMPLEX
+   fprintf(b.out, "{\"arithmetic\": \"doublecomplex\", \"runs\": [");
+#else
+   fprintf(b.out, "{\"arithmetic\": \"double\", \"runs\": [");
+#endif
+
+   for (; i<argc; i++) {
+      CSRMatrix *matrix;
+      SELLMatrix *sell = NULL;
+      double aNorm, *diag = NULL;
+      int square;
+
+      if (readMatrixNative(argv[i], &matrix, &aNorm) != 0) return -1;
+      square = matrix->m == matrix->n;
+      if (b.jacobi) {
+         if (square) createInvDiagPrecNative(matrix, 0.0, &diag);
+         else createInvNormalPrecNative(matrix, 0.0, &diag);
+      }
+      if (b.sell) createSELLMatrix(matrix, SELL_SIGMA, &sell);
+      if (square) {
+         benchEigs(&b, argv[i], matrix, sell ? (void*)sell : (void*)matrix,
+               aNorm, diag);
+      }
+      else {
+         benchSvds(&b, argv[i], matrix, sell ? (void*)sell : (void*)matrix,
+               aNorm, diag);
+      }
+      if (sell) freeSELLMatrix(sell);
+      else freeCSRMatrix(matrix);
+      free(diag);
+   }
+
+   fprintf(b.out, "\n]}\n");
+   if (b.out != stdout) fclose(b.out);
+   return 0;
+}
@@ -0,0 +1,73 @@
+/*******************************************************************************
+ *   PRIMME PReconditioned Iterative MultiMethod Eigensolver
+ *   Copyright (C) 2016 College of William & Mary,
+ *   James R. McCombs, Eloy Romero Alcalde, Andreas Stathopoulos, Lingfei Wu
+ *
+ *   This file is part of PRIMME.
+ *
+ *   PRIMME is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   PRIMME is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *******************************************************************************
+ * File: csrconvert.c
+ *
+ * Purpose - converts a MatrixMarket matrix into the binary CSR format that
+ *           the drivers map into memory instead of parsing. Calling format:
+ *
+ *             csrconvert MatrixFileName.mtx BinaryFileName
+ *
+ *  The values are stored as double unless the MatrixMarket file is complex.
+ *  The drivers recognize the binary format by its content, so it can be
+ *  passed in driver.matrixFile with any file name.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "mmio.h"
+#include "csr.h"
+
+int main(int argc, char *argv[]) {
+   CSRMatrix *matrix;
+   MM_typecode type;
+   FILE *f;
+   int flags;
+
+   if (argc != 3) {
+      fprintf(stderr, "Usage: %s MatrixFileName.mtx BinaryFileName\n", argv[0]);
+      return -1;
+   }
+
+   /* Get the arithmetic and the symmetry from the banner */
+
+   f = fopen(argv[1], "r");
+   if (f == NULL || mm_read_banner(f, &type) != 0) {
+      fprintf(stderr, "ERROR: Could not read the banner of '%s'\n", argv[1]);
+      return -1;
+   }
+   fclose(f);
+   flags = (mm_is_complex(type) ? CSR_BINARY_COMPLEX : 0)
+         | (mm_is_symmetric(type) || mm_is_hermitian(type) ? CSR_BINARY_HERMITIAN : 0);
+
+   if (readMatrixNative(argv[1], &matrix, NULL) != 0) return -1;
+   if (writeMatrixBinary(argv[2], matrix, flags) != 0) {
+      fprintf(stderr, "ERROR: Could not write '%s'\n", argv[2]);
+      return -1;
+   }
+   printf("%s: %d x %d, %d nonzeros, %s%s\n", argv[2], matrix->m, matrix->n,
+         matrix->nnz, (flags & CSR_BINARY_COMPLEX) ? "complex" : "real",
+         (flags & CSR_BINARY_HERMITIAN) ? ", symmetric/Hermitian" : "");
+   freeCSRMatrix(matrix);
+
+   return 0;
+}
@@ -33,8 +33,9 @@
  *                            as well as preconditioning information (eg., 
  *                            ParaSails parameters).
  *                            Currently, for reading the input matrix,
- *                            full coordinate format (.mtx) and upper triangular 
- *                            coordinate format (.U) are supported.
+ *                            full coordinate format (.mtx), upper triangular 
+ *                            coordinate format (.U) and the binary CSR
+ *                            written by csrconvert are supported.
  *
  *         Example file:  DriverConf
  *
@@ -75,6 +76,7 @@ PetscLogEvent PRIMME_GLOBAL_SUM;
 #include "primme.h"
 #include "shared_utils.h"
 #include "ioandtest.h"
+#include "tune.h"
 /* wtime.h header file is included so primme's timimg functions can be used */
 #include "../../src/include/wtime.h"
 
@@ -209,6 +211,12 @@ static int real_main (int argc, char *argv[]) {
    /* --------------------------------------- */
    if (setMatrixAndPrecond(&driver, &primme, &permutation) != 0) return -1;
 
+   /* ------------------------------------------------- */
+   /* Optional: pick the method and sizes from a cache  */
+   /* or by short trial solves                          */
+   /* ------------------------------------------------- */
+   if (driver.tune && tune_params(&driver, &primme, &method) != 0) return -1;
+
    /* --------------------------------------- */
    /* Pick one of the default methods(if set) */
    /* --------------------------------------- */
@@ -259,7 +267,7 @@ static int real_main (int argc, char *argv[]) {
       int cols, i=0;
       ASSERT_MSG(readBinaryEvecsAndPrimmeParams(driver.initialGuessesFileName, evecs, NULL, primme.n,
                                                 min(primme.initSize+primme.numOrthoConst, primme.numEvals),
-                                                &cols, primme.nLocal, permutation, &primme) != 0, 1, "");
+                                                &cols, primme.nLocal, permutation, NULL) == 0, 1, "");
       primme.numOrthoConst = min(primme.numOrthoConst, cols);
 
       /* Perturb the initial guesses by a vector with some norm  */
@@ -337,9 +345,27 @@ static int real_main (int argc, char *argv[]) {
       fprintf(primme.outputFile, "Restarts   : %-" PRIMME_INT_P "\n", primme.stats.numRestarts);
       fprintf(primme.outputFile, "Matvecs    : %-" PRIMME_INT_P "\n", primme.stats.numMatvecs);
       fprintf(primme.outputFile, "Preconds   : %-" PRIMME_INT_P "\n", primme.stats.numPreconds);
+      if (primme.stats.numFactorizations > 0)
+         fprintf(primme.outputFile, "Factorized : %-" PRIMME_INT_P "\n", primme.stats.numFactorizations);
       fprintf(primme.outputFile, "Time matvecs  : %f\n",  primme.stats.timeMatvec);
+#ifdef USE_NATIVE
+      if ((driver.matrixChoice == driver_native || driver.matrixChoice == driver_sell)
+            && primme.stats.timeMatvec > 0.0) {
+         double flops, bytes, rate;
+         if (driver.matrixChoice == driver_sell)
+            SELLMatrixTraffic((SELLMatrix*)primme.matrix, &flops, &bytes);
+         else
+            CSRMatrixTraffic((CSRMatrix*)primme.matrix, &flops, &bytes);
+         rate = primme.stats.numMatvecs/primme.stats.timeMatvec;
+         fprintf(primme.outputFile, "Matvec GFLOP/s: %f\n", flops*rate*1e-9);
+         fprintf(primme.outputFile, "Matvec GB/s   : %f\n", bytes*rate*1e-9);
+      }
+#endif
       fprintf(primme.outputFile, "Time precond  : %f\n",  primme.stats.timePrecond);
+      if (primme.stats.numFactorizations > 0)
+         fprintf(primme.outputFile, "Time factorize: %f\n",  primme.stats.timeFactorize);
       fprintf(primme.outputFile, "Time ortho  : %f\n",  primme.stats.timeOrtho);
+      if (primme.printLevel >= 3) primme_display_stats(primme);
       if (primme.locking && primme.intWork && primme.intWork[0] == 1) {
          fprintf(primme.outputFile, "\nA locking problem has occurred.\n");
          fprintf(primme.outputFile,
@@ -415,8 +441,10 @@ static int setMatrixAndPrecond(driver_params *driver, primme_params *primme, int
       } else {
 #        ifdef USE_PETSC
             driver->matrixChoice = driver_petsc;
-#        else
+#        elif defined(USE_PARASAILS)
             driver->matrixChoice = driver_parasails;
+#        else
+            driver->matrixChoice = driver_native;
 #        endif
       }
    }
@@ -425,51 +453,121 @@ static int setMatrixAndPrecond(driver_params *driver, primme_params *primme, int
       assert(0);
       break;
    case driver_native:
+   case driver_sell:
 #if !defined(USE_NATIVE)
       fprintf(stderr, "ERROR: NATIVE is needed!\n");
       return -1;
 #else
 #  if defined(USE_MPI)
-      if (numProcs != 1) {
-         fprintf(stderr, "ERROR: MPI is not supported with NATIVE, use other!\n");
+      if (numProcs != 1 && driver->matrixChoice == driver_sell) {
+         fprintf(stderr, "ERROR: MPI is not supported with SELL, use native!\n");
+         return -1;
+      }
+      if (numProcs != 1 && driver->PrecChoice != driver_noprecond
+               && driver->PrecChoice != driver_jacobi
+               && driver->PrecChoice != driver_jacobi_i) {
+         fprintf(stderr, "ERROR: MPI with NATIVE only supports Jacobi, use other!\n");
          return -1;
       }
       *(MPI_Comm*)primme->commInfo = MPI_COMM_WORLD;
 #  endif
       {
-         CSRMatrix *matrix, *prec;
+         CSRMatrix *matrix;
+         ILUTPrecNative *prec;
          double *diag;
-         /* Fix to use a single thread */
+         /* Fix to use a single thread, unless OMP_NUM_THREADS is set */
          #ifdef _OPENMP
-         omp_set_num_threads(1);
+         if (!getenv("OMP_NUM_THREADS")) omp_set_num_threads(1);
          #endif
           
          if (readMatrixNative(driver->matrixFileName, &matrix, &aNorm) !=0 )
             return -1;
+         if (driver->reorder == driver_order_rcm) {
+            int bw0, bw1;
+            double pr0, pr1, t0;
+            t0 = primme_get_wtime();
+            bandwidthCSRMatrix(matrix, &bw0, &pr0);
+            if (reorderCSRMatrixRCM(matrix, permutation) != 0) {
+               fprintf(stderr, "ERROR: RCM reordering needs a square matrix!\n");
+               return -1;
+            }
+            bandwidthCSRMatrix(matrix, &bw1, &pr1);
+            if (primme->outputFile) {
+               fprintf(primme->outputFile, "Reordering          : rcm, bandwidth %d -> %d, profile %g -> %g, %f seconds\n",
+                     bw0, bw1, pr0, pr1, primme_get_wtime() - t0);
+            }
+         }
          primme->matrix = matrix;
          primme->matrixMatvec = CSRMatrixMatvec;
+         if (driver->matrixChoice == driver_sell) {
+            SELLMatrix *sell;
+            if (createSELLMatrix(matrix, SELL_SIGMA, &sell) != 0) return -1;
+            primme->matrix = sell;
+            primme->matrixMatvec = SELLMatrixMatvec;
+         }
          primme->n = primme->nLocal = matrix->n;
+#  if defined(USE_MPI)
+         /* Every process keeps the whole matrix and owns the rows     */
+         /* n*procID/numProcs to n*(procID+1)/numProcs-1, see          */
+         /* CSRMatrixMatvecMPI. permutation has their original indices */
+         if (numProcs > 1) {
+            int i, r0, *perm;
+            primme->numProcs = numProcs;
+            MPI_Comm_rank(MPI_COMM_WORLD, &primme->procID);
+            r0 = (int)(primme->n*primme->procID/numProcs);
+            primme->nLocal = primme->n*(primme->procID+1)/numProcs - r0;
+            primme->matrix = matrix;
+            primme->matrixMatvec = CSRMatrixMatvecMPI;
+            perm = (int *)primme_calloc(primme->nLocal, sizeof(int), "perm");
+            for (i=0; i<primme->nLocal; i++)
+               perm[i] = *permutation ? (*permutation)[r0+i] : r0+i;
+            if (*permutation) free(*permutation);
+            *permutation = perm;
+         }
+#  endif
          switch(driver->PrecChoice) {
          case driver_noprecond:
             primme->preconditioner = NULL;
             primme->applyPreconditioner = NULL;
             break;
          case driver_jacobi:
-            createInvDiagPrecNative(matrix, driver->shift, &diag);
-            primme->preconditioner = diag;
-            primme->applyPreconditioner = ApplyInvDiagPrecNative;
-            break;
          case driver_jacobi_i:
-            createInvDiagPrecNative(matrix, 0.0, &diag);
+            createInvDiagPrecNative(matrix,
+                  driver->PrecChoice == driver_jacobi ? driver->shift : 0.0,
+                  &diag);
+            /* Keep the local rows */
+            memmove(diag, &diag[primme->n*primme->procID/primme->numProcs],
+                  sizeof(double)*primme->nLocal);
             primme->preconditioner = diag;
-            primme->applyPreconditioner = ApplyInvDavidsonDiagPrecNative;
+            primme->applyPreconditioner =
+               driver->PrecChoice == driver_jacobi ? ApplyInvDiagPrecNative
+                                                   : ApplyInvDavidsonDiagPrecNative;
             break;
          case driver_ilut:
-            createILUTPrecNative(matrix, driver->shift, driver->level, driver->threshold,
-                                 driver->filter, &prec);
+            if (createILUTPrecNative(matrix, driver->shift, driver->level,
+                     driver->threshold, driver->filter, driver->ilutByLevels,
+                     &prec) != 0) {
+               return -1;
+            }
             primme->preconditioner = prec;
             primme->applyPreconditioner = ApplyILUTPrecNative;
             break;
+         case driver_ilut_i:
+            {
+               ILUTOptionsNative *opts;
+               opts = (ILUTOptionsNative *)primme_calloc(1,
+                     sizeof(ILUTOptionsNative), "opts");
+               opts->level = driver->level;
+               opts->threshold = driver->threshold;
+               opts->filter = driver->filter;
+               opts->byLevels = driver->ilutByLevels;
+               opts->matrix = matrix;
+               primme->preconditioner = opts;
+               primme->precondFactorize = ILUTFactorizeNative;
+               primme->precondApplyFactors = ApplyILUTFactorsNative;
+               primme->precondFreeFactors = FreeILUTFactorsNative;
+            }
+            break;
          default:
             fprintf(stderr, "ERROR: preconditioner is not supported with NATIVE, use other!\n");
             return -1;
@@ -628,22 +726,29 @@ static int destroyMatrixAndPrecond(driver_params *driver, primme_params *primme,
       assert(0);
       break;
    case driver_native:
+   case driver_sell:
 #if !defined(USE_NATIVE)
       fprintf(stderr, "ERROR: NATIVE is needed!\n");
       return -1;
 #else
-      freeCSRMatrix((CSRMatrix*)primme->matrix);
+      if (driver->matrixChoice == driver_sell) {
+         freeSELLMatrix((SELLMatrix*)primme->matrix);
+      }
+      else {
+         freeCSRMatrix((CSRMatrix*)primme->matrix);
+      }
 
       switch(driver->PrecChoice) {
       case driver_noprecond:
          break;
       case driver_jacobi:
       case driver_jacobi_i:
+      case driver_ilut_i:
          free(primme->preconditioner);
          break;
       case driver_ilut:
          if (primme->preconditioner) {
-            freeCSRMatrix((CSRMatrix*)primme->preconditioner);
+            freeILUTPrecNative((ILUTPrecNative*)primme->preconditioner);
          }
          break;
       default:
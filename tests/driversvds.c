@@ -283,7 +283,7 @@ static int real_main (int argc, char *argv[]) {
          driver.initialGuessesFileName, svecs, NULL, primme_svds.m, primme_svds.n,
          min(primme_svds.initSize+primme_svds.numOrthoConst,
              primme_svds.numSvals), &cols, primme_svds.mLocal, primme_svds.nLocal,
-         permutation, &primme_svds) != 0, 1, "");
+         permutation, NULL) == 0, 1, "");
       primme_svds.numOrthoConst = min(primme_svds.numOrthoConst, cols);
       primme_svds.initSize = min(primme_svds.initSize, cols - primme_svds.numOrthoConst);
       n = primme_svds.initSize+primme_svds.numOrthoConst;
@@ -372,13 +372,43 @@ static int real_main (int argc, char *argv[]) {
          fprintf(primme_svds.outputFile, pre "Restarts    : %-" PRIMME_INT_P "\n", (A).numRestarts);\
          fprintf(primme_svds.outputFile, pre "Matvecs     : %-" PRIMME_INT_P "\n", (A).numMatvecs);\
          fprintf(primme_svds.outputFile, pre "Preconds    : %-" PRIMME_INT_P "\n", (A).numPreconds);\
-         fprintf(primme_svds.outputFile, pre "ElapsedTime : %-f\n", (A).elapsedTime);}
+         fprintf(primme_svds.outputFile, pre "GlobalSums  : %-" PRIMME_INT_P "\n", (A).numGlobalSum);\
+         fprintf(primme_svds.outputFile, pre "OrthoInProds: %-.0f\n", (A).numOrthoInnerProds);\
+         fprintf(primme_svds.outputFile, pre "ElapsedTime : %-f\n", (A).elapsedTime);\
+         fprintf(primme_svds.outputFile, pre "MatvecTime  : %-f\n", (A).timeMatvec);\
+         fprintf(primme_svds.outputFile, pre "PrecondTime : %-f\n", (A).timePrecond);\
+         fprintf(primme_svds.outputFile, pre "OrthoTime   : %-f\n", (A).timeOrtho);\
+         fprintf(primme_svds.outputFile, pre "GSumTime    : %-f\n", (A).timeGlobalSum);}
 
       if (primme_svds.methodStage2 != primme_svds_op_none) {
          PRINT_STATS(primme_svds.primme.stats, "1st ");
          PRINT_STATS(primme_svds.primmeStage2.stats, "2sd ");
       }
       PRINT_STATS(primme_svds.stats, "");
+      fprintf(primme_svds.outputFile, "GSumBytes   : %-" PRIMME_INT_P "\n", primme_svds.stats.bytesGlobalSum);
+      fprintf(primme_svds.outputFile, "Matvecs A   : %-" PRIMME_INT_P "\n", primme_svds.stats.numMatvecsA);
+      fprintf(primme_svds.outputFile, "Matvecs A'  : %-" PRIMME_INT_P "\n", primme_svds.stats.numMatvecsAt);
+      fprintf(primme_svds.outputFile, "Time A      : %-f\n", primme_svds.stats.timeMatvecA);
+      fprintf(primme_svds.outputFile, "Time A'     : %-f\n", primme_svds.stats.timeMatvecAt);
+#ifdef USE_NATIVE
+      if (driver.matrixChoice == driver_native || driver.matrixChoice == driver_sell) {
+         double flops, bytes;
+         if (driver.matrixChoice == driver_sell)
+            SELLMatrixTraffic((SELLMatrix*)primme_svds.matrix, &flops, &bytes);
+         else
+            CSRMatrixTraffic((CSRMatrix*)primme_svds.matrix, &flops, &bytes);
+         if (primme_svds.stats.timeMatvecA > 0.0) {
+            double rate = primme_svds.stats.numMatvecsA/primme_svds.stats.timeMatvecA;
+            fprintf(primme_svds.outputFile, "GFLOP/s A   : %-f\n", flops*rate*1e-9);
+            fprintf(primme_svds.outputFile, "GB/s A      : %-f\n", bytes*rate*1e-9);
+         }
+         if (primme_svds.stats.timeMatvecAt > 0.0) {
+            double rate = primme_svds.stats.numMatvecsAt/primme_svds.stats.timeMatvecAt;
+            fprintf(primme_svds.outputFile, "GFLOP/s A'  : %-f\n", flops*rate*1e-9);
+            fprintf(primme_svds.outputFile, "GB/s A'     : %-f\n", bytes*rate*1e-9);
+         }
+      }
+#endif
       if (primme_svds.locking && primme_svds.intWork && primme_svds.intWork[0] == 1) {
          fprintf(primme_svds.outputFile, "\nA locking problem has occurred.\n");
          fprintf(primme_svds.outputFile,
@@ -456,6 +486,7 @@ static int setMatrixAndPrecond(driver_params *driver,
       assert(0);
       break;
    case driver_native:
+   case driver_sell:
 #if !defined(USE_NATIVE)
       fprintf(stderr, "ERROR: NATIVE is needed!\n");
       return -1;
@@ -477,8 +508,37 @@ static int setMatrixAndPrecond(driver_params *driver,
           
          if (readMatrixNative(driver->matrixFileName, &matrix, &aNorm) !=0 )
             return -1;
+         if (driver->reorder == driver_order_rcm) {
+            int bw0, bw1;
+            double pr0, pr1, t0;
+            t0 = primme_get_wtime();
+            bandwidthCSRMatrix(matrix, &bw0, &pr0);
+            if (reorderCSRMatrixRCM(matrix, permutation) != 0) {
+               fprintf(stderr, "ERROR: RCM reordering needs a square matrix!\n");
+               return -1;
+            }
+            bandwidthCSRMatrix(matrix, &bw1, &pr1);
+            if (primme_svds->outputFile) {
+               fprintf(primme_svds->outputFile, "Reordering          : rcm, bandwidth %d -> %d, profile %g -> %g, %f seconds\n",
+                     bw0, bw1, pr0, pr1, primme_get_wtime() - t0);
+            }
+         }
          primme_svds->matrix = matrix;
          primme_svds->matrixMatvec = CSRMatrixMatvecSVD;
+         if (driver->matrixChoice == driver_sell) {
+            SELLMatrix *sell;
+            if (createSELLMatrix(matrix, SELL_SIGMA, &sell) != 0) return -1;
+            primme_svds->matrix = sell;
+            primme_svds->matrixMatvec = SELLMatrixMatvecSVD;
+         }
+         /* Stream the rows of A if a row block size is given */
+         if (primme_svds->rowBlockSize > 0) {
+            if (driver->matrixChoice != driver_native) {
+               fprintf(stderr, "ERROR: rowBlockSize is only supported with NATIVE!\n");
+               return -1;
+            }
+            primme_svds->readRowBlock = CSRMatrixReadRowBlockSVD;
+         }
          primme_svds->m = primme_svds->mLocal = matrix->m;
          primme_svds->n = primme_svds->nLocal = matrix->n;
          switch(driver->PrecChoice) {
@@ -747,11 +807,17 @@ static int destroyMatrixAndPrecond(driver_params *driver, primme_svds_params *pr
       assert(0);
       break;
    case driver_native:
+   case driver_sell:
 #if !defined(USE_NATIVE)
       fprintf(stderr, "ERROR: NATIVE is needed!\n");
       return -1;
 #else
-      freeCSRMatrix((CSRMatrix*)primme_svds->matrix);
+      if (driver->matrixChoice == driver_sell) {
+         freeSELLMatrix((SELLMatrix*)primme_svds->matrix);
+      }
+      else {
+         freeCSRMatrix((CSRMatrix*)primme_svds->matrix);
+      }
 
       switch(driver->PrecChoice) {
       case driver_noprecond:
@@ -0,0 +1,437 @@
+/*******************************************************************************
+ *   PRIMME PReconditioned Iterative MultiMethod Eigensolver
+ *   Copyright (C) 2016 College of William & Mary,
+ *   James R. McCombs, Eloy Romero Alcalde, Andreas Stathopoulos, Lingfei Wu
+ *
+ *   This file is part of PRIMME.
+ *
+ *   PRIMME is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   PRIMME is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *******************************************************************************
+ * File: kernels.c
+ *
+ * Purpose - benchmark of the dense kernels of the eigensolver, called
+ *           directly on a grid of sizes. Calling format:
+ *
+ *             kernels [options]
+ *
+ *  It is compiled in every arithmetic (kernels_double, kernels_float, ...)
+ *  against the internal headers of the library. For every kernel and every
+ *  number of rows (nLocal), basis size and block size it prints the time per
+ *  call, the GFLOP/s and the bytes moved per flop:
+ *
+ *    Num_update_VWXR         X = V*h, W*h and the residuals R of a block,
+ *                            with their norms, as in every iteration
+ *    Num_reset_update_VWXR   V = V*h and W = W*h in place, keeping half of
+ *                            the basis, and the residuals of a block, as in
+ *                            a restart
+ *    ortho                   orthogonalize a block against the basis
+ *    ortho_single_iteration  X = (I - V*V')*X for a block X
+ *    update_projection       the new columns of H = V'*W
+ *    solve_H                 eigendecomposition of H (RR), basis size only
+ *    compute_submatrix       X'*H*X with X of block size columns
+ *
+ *  The flops and bytes are those of the BLAS calls, counting every operand
+ *  read or written once; ortho counts the inner products it reports in
+ *  stats.numOrthoInnerProds.
+ *
+ *  Options (lists are separated by commas):
+ *    -n LIST        number of rows (1000,10000,100000)
+ *    -m LIST        basis sizes (16,32,64,128)
+ *    -b LIST        block sizes (1,2,4,8)
+ *    -k LIST        kernels (all)
+ *    -t SECONDS     minimum time measured for every point (0.1)
+ *    -o FILE        output file (standard output)
+ *
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "numerical.h"
+#include "auxiliary_eigs.h"
+#include "ortho.h"
+#include "restart.h"
+#include "solve_projection.h"
+#include "update_projection.h"
+#include "wtime.h"
+
+static const char *kernelNames[] = {"Num_update_VWXR", "Num_reset_update_VWXR",
+   "ortho", "ortho_single_iteration", "update_projection", "solve_H",
+   "compute_submatrix"};
+
+enum {
+   kernel_update_VWXR,
+   kernel_reset_update_VWXR,
+   kernel_ortho,
+   kernel_ortho_single_iteration,
+   kernel_update_projection,
+   kernel_solve_H,
+   kernel_compute_submatrix,
+   kernel_count
+};
+
+/* Maximum number of values in a list option */
+#define KERNELS_MAX_LIST 32
+
+typedef struct {
+   FILE *out;
+   int n[KERNELS_MAX_LIST], numN;
+   int m[KERNELS_MAX_LIST], numM;
+   int b[KERNELS_MAX_LIST], numB;
+   int kernels[kernel_count];  /* nonzero if the kernel is selected */
+   double minTime;
+   primme_params primme;
+} kernels_params;
+
+/* The state of a point of the grid: the basis V, W = A*V, and the rest of */
+/* operands of the kernels                                                 */
+
+typedef struct {
+   PRIMME_INT n;    /* rows */
+   int m;           /* basis size */
+   int b;           /* block size */
+   SCALAR *V, *W;   /* n x (m+b); V(:,0:m-1) is orthonormal */
+   SCALAR *X, *Wo, *R; /* n x b */
+   SCALAR *h;       /* m x m permutation */
+   SCALAR *H;       /* (m+b) x (m+b), random Hermitian in the leading m x m */
+   SCALAR *hVecs;   /* m x m, random */
+   REAL *hVals, *norms;
+   SCALAR *rwork;
+   size_t lrwork;
+   int *iwork, liwork;
+} kernels_point;
+
+static int parseInts(const char *list, int *v, int *n) {
+   char buf[1024], *tok;
+
+   strncpy(buf, list, sizeof(buf)-1);
+   buf[sizeof(buf)-1] = '\0';
+   for (*n=0, tok=strtok(buf, ","); tok; tok=strtok(NULL, ",")) {
+      if (*n >= KERNELS_MAX_LIST || (v[*n] = atoi(tok)) < 1) {
+         fprintf(stderr, "ERROR: Invalid value '%s'\n", tok);
+         return -1;
+      }
+      (*n)++;
+   }
+   return 0;
+}
+
+static int parseKernels(const char *list, int *kernels) {
+   char buf[1024], *tok;
+   int i;
+
+   for (i=0; i<kernel_count; i++) kernels[i] = !strcmp(list, "all");
+   if (!strcmp(list, "all")) return 0;
+   strncpy(buf, list, sizeof(buf)-1);
+   buf[sizeof(buf)-1] = '\0';
+   for (tok=strtok(buf, ","); tok; tok=strtok(NULL, ",")) {
+      for (i=0; i<kernel_count && strcmp(tok, kernelNames[i]); i++);
+      if (i >= kernel_count) {
+         fprintf(stderr, "ERROR: Invalid kernel '%s'\n", tok);
+         return -1;
+      }
+      kernels[i] = 1;
+   }
+   return 0;
+}
+
+static void printPoint(kernels_params *k, int kernel, PRIMME_INT n, int m,
+      int b, double t, double flops, double bytes) {
+   char sn[32], sb[32];
+
+   if (n > 0) sprintf(sn, "%" PRIMME_INT_P, n); else strcpy(sn, "-");
+   if (b > 0) sprintf(sb, "%d", b); else strcpy(sb, "-");
+   fprintf(k->out, "%-24s %9s %6d %6s %12.4e %10.3f %10.3f\n",
+         kernelNames[kernel], sn, m, sb, t, flops/t*1e-9, bytes/flops);
+   fflush(k->out);
+}
+
+/******************************************************************************
+ * Allocates the operands of a point of the grid. The columns of V have
+ * disjoint supports, so V(:,0:m-1) is orthonormal without orthogonalizing,
+ * and h is a permutation, so updating V and W in place keeps their values.
+ *
+******************************************************************************/
+
+static void allocPoint(kernels_params *k, PRIMME_INT n, int m, int b,
+      kernels_point *p) {
+   PRIMME_INT i;
+   int j;
+   REAL nrm;
+
+   p->n = n; p->m = m; p->b = b;
+   p->V = (SCALAR *)malloc(sizeof(SCALAR)*n*(m+b));
+   p->W = (SCALAR *)malloc(sizeof(SCALAR)*n*(m+b));
+   p->X = (SCALAR *)malloc(sizeof(SCALAR)*n*b);
+   p->Wo = (SCALAR *)malloc(sizeof(SCALAR)*n*b);
+   p->R = (SCALAR *)malloc(sizeof(SCALAR)*n*b);
+   p->h = (SCALAR *)malloc(sizeof(SCALAR)*m*m);
+   p->H = (SCALAR *)malloc(sizeof(SCALAR)*(m+b)*(m+b));
+   p->hVecs = (SCALAR *)malloc(sizeof(SCALAR)*m*m);
+   p->hVals = (REAL *)malloc(sizeof(REAL)*m);
+   p->norms = (REAL *)malloc(sizeof(REAL)*(m+b));
+
+   Num_larnv_Sprimme(2, k->primme.iseed, n*(m+b), p->W);
+   Num_zero_matrix_Sprimme(p->V, n, m+b, n);
+   for (i=0; i<n; i++) p->V[n*(i%m)+i] = p->W[i];
+   for (j=0; j<m; j++) {
+      nrm = sqrt(REAL_PART(Num_dot_Sprimme(n, &p->V[n*j], 1, &p->V[n*j], 1)));
+      Num_scal_Sprimme(n, 1.0/nrm, &p->V[n*j], 1);
+   }
+   Num_larnv_Sprimme(2, k->primme.iseed, n*b, &p->V[n*m]);
+   Num_larnv_Sprimme(2, k->primme.iseed, n*b, p->X);
+
+   Num_zero_matrix_Sprimme(p->h, m, m, m);
+   for (j=0; j<m; j++) {
+      p->h[m*j+m-1-j] = 1.0;
+      p->hVals[j] = j;
+   }
+   Num_larnv_Sprimme(2, k->primme.iseed, (PRIMME_INT)(m+b)*(m+b), p->H);
+   for (j=0; j<m; j++) p->H[m*j+j] = REAL_PART(p->H[m*j+j]);
+   Num_larnv_Sprimme(2, k->primme.iseed, (PRIMME_INT)m*m, p->hVecs);
+
+   /* Workspace for all kernels */
+
+   p->lrwork = 0;
+   p->liwork = 0;
+   p->lrwork = max(p->lrwork, (size_t)Num_update_VWXR_Sprimme(NULL, NULL, n,
+            m, n, NULL, m, m, NULL, NULL, 0, b, n, NULL, 0, 0, 0, NULL, 0, 0,
+            0, NULL, 0, b, n, NULL, 0, b, n, NULL, NULL, 0, 0, NULL, 0,
+            &k->primme));
+   Num_reset_update_VWXR_Sprimme(NULL, NULL, n, m, n, NULL, m, m, NULL,
+         NULL, 0, m/2, n, NULL, 0, 0, 0, NULL, 0, 0, 0, n, NULL, 0, m/2, n,
+         NULL, 0, b, n, NULL, NULL, 0, 0, 0, 0.0, NULL, &p->lrwork,
+         &k->primme);
+   ortho_Sprimme(NULL, n, NULL, 0, m, m+b-1, NULL, 0, 0, n, NULL, 0.0, NULL,
+         &p->lrwork, &k->primme);
+   ortho_single_iteration_Sprimme(NULL, n, m, n, NULL, NULL, b, n, NULL, NULL,
+         NULL, &p->lrwork, &k->primme);
+   update_projection_Sprimme(NULL, n, NULL, n, NULL, m+b, n, m, b, NULL,
+         &p->lrwork, 1, &k->primme);
+   solve_H_Sprimme(NULL, m, 0, NULL, 0, NULL, 0, NULL, 0, NULL, 0, NULL, NULL,
+         NULL, NULL, 0, 0.0, &p->lrwork, NULL, 0, &p->liwork, &k->primme);
+   compute_submatrix_Sprimme(NULL, b, 0, NULL, m, 0, NULL, 0, NULL,
+         &p->lrwork);
+   p->liwork = max(p->liwork, 2*m);
+   p->rwork = (SCALAR *)malloc(sizeof(SCALAR)*p->lrwork);
+   p->iwork = (int *)malloc(sizeof(int)*p->liwork);
+}
+
+static void freePoint(kernels_point *p) {
+   free(p->V); free(p->W); free(p->X); free(p->Wo); free(p->R); free(p->h);
+   free(p->H); free(p->hVecs);
+   free(p->hVals); free(p->norms); free(p->rwork); free(p->iwork);
+}
+
+/******************************************************************************
+ * Calls a kernel until minTime is reached and returns the time per call.
+ * It also returns the flops and the bytes of a call.
+ *
+******************************************************************************/
+
+static double runKernel(kernels_params *k, int kernel, kernels_point *p,
+      double *flops, double *bytes) {
+   primme_params *primme = &k->primme;
+   PRIMME_INT n = p->n;
+   int m = p->m, b = p->b, r = max(m/2, b), reps;
+   double t, total = 0.0, inner = 0.0;
+   double machEps = Num_lamch_Rprimme("E");
+
+   for (reps=0; total < k->minTime || reps < 2; reps++) {
+      inner = primme->stats.numOrthoInnerProds;
+      if (kernel == kernel_ortho) {
+         Num_larnv_Sprimme(2, primme->iseed, n*b, &p->V[n*m]);
+      }
+      t = primme_get_wtime();
+      switch(kernel) {
+      case kernel_update_VWXR:
+         Num_update_VWXR_Sprimme(p->V, p->W, n, m, n, p->h, m, m, p->hVals,
+               p->X, 0, b, n,
+               NULL, 0, 0, 0,
+               NULL, 0, 0, 0,
+               p->Wo, 0, b, n,
+               p->R, 0, b, n, p->norms,
+               NULL, 0, 0,
+               p->rwork, TO_INT(p->lrwork), primme);
+         break;
+      case kernel_reset_update_VWXR:
+         Num_reset_update_VWXR_Sprimme(p->V, p->W, n, m, n, p->h, r, m,
+               p->hVals,
+               p->V, 0, r, n,
+               NULL, 0, 0, 0,
+               NULL, 0, 0, 0, 0,
+               p->W, 0, r, n,
+               p->R, 0, b, n, p->norms,
+               NULL, 0, 0,
+               0, machEps, p->rwork, &p->lrwork, primme);
+         break;
+      case kernel_ortho:
+         ortho_Sprimme(p->V, n, NULL, 0, m, m+b-1, NULL, 0, 0, n,
+               primme->iseed, machEps, p->rwork, &p->lrwork, primme);
+         break;
+      case kernel_ortho_single_iteration:
+         ortho_single_iteration_Sprimme(p->V, n, m, n, p->X, NULL, b, n,
+               p->norms, &p->norms[b], p->rwork, &p->lrwork, primme);
+         break;
+      case kernel_update_projection:
+         update_projection_Sprimme(p->V, n, p->W, n, p->H, m+b, n, m, b,
+               p->rwork, &p->lrwork, 1, primme);
+         break;
+      case kernel_solve_H:
+         solve_H_Sprimme(p->H, m, m, NULL, 0, NULL, 0, NULL, 0, p->hVecs, m,
+               p->hVals, NULL, NULL, NULL, 0, machEps, &p->lrwork, p->rwork,
+               p->liwork, p->iwork, primme);
+         break;
+      case kernel_compute_submatrix:
+         compute_submatrix_Sprimme(p->hVecs, b, m, p->H, m, m, p->R, b,
+               p->rwork, &p->lrwork);
+         break;
+      }
+      total += primme_get_wtime() - t;
+   }
+   t = total/reps;
+
+   switch(kernel) {
+   case kernel_update_VWXR:
+      *flops = 4.0*n*m*b + 4.0*n*b;
+      *bytes = 2.0*n*m + 3.0*n*b;
+      break;
+   case kernel_reset_update_VWXR:
+      *flops = 4.0*n*m*r + 4.0*n*b;
+      *bytes = 2.0*n*m + 2.0*n*r + 1.0*n*b;
+      break;
+   case kernel_ortho:
+      /* Every inner product is a dot and an axpy of n rows */
+      *flops = 2.0*n*(primme->stats.numOrthoInnerProds - inner);
+      *bytes = 1.0*n*(primme->stats.numOrthoInnerProds - inner);
+      break;
+   case kernel_ortho_single_iteration:
+      *flops = 4.0*n*m*b + 2.0*n*b;
+      *bytes = 1.0*n*m + 2.0*n*b;
+      break;
+   case kernel_update_projection:
+      *flops = 2.0*n*m*b + 1.0*n*b*(b+1);
+      *bytes = 1.0*n*(m+b) + 1.0*n*b;
+      break;
+   case kernel_solve_H:
+      /* The same estimate as primme.stats.estimateFlops */
+      *flops = 9.0*m*m*m;
+      *bytes = 2.0*m*m;
+      break;
+   case kernel_compute_submatrix:
+      *flops = 2.0*m*m*b + 1.0*m*b*(b+1);
+      *bytes = 1.0*m*m + 3.0*m*b + 1.0*b*b;
+      break;
+   }
+   *flops *= FLOPS_SCALAR;
+   *bytes *= sizeof(SCALAR);
+   return t;
+}
+
+int main(int argc, char *argv[]) {
+   kernels_params k;
+   kernels_point p;
+   int i, in, im, ib, kernel;
+   double t, flops, bytes;
+
+   memset(&k, 0, sizeof(k));
+   k.out = stdout;
+   k.minTime = 0.1;
+   parseInts("1000,10000,100000", k.n, &k.numN);
+   parseInts("16,32,64,128", k.m, &k.numM);
+   parseInts("1,2,4,8", k.b, &k.numB);
+   parseKernels("all", k.kernels);
+
+   /* Options */
+
+   for (i=1; i<argc; i+=2) {
+      const char *v = i+1 < argc ? argv[i+1] : NULL;
+      int err = v == NULL;
+      if (err) ;
+      else if (!strcmp(argv[i], "-o")) {
+         if ((k.out = fopen(v, "w")) == NULL) {
+            fprintf(stderr, "ERROR: Could not open '%s'\n", v);
+            return -1;
+         }
+      }
+      else if (!strcmp(argv[i], "-n")) err = parseInts(v, k.n, &k.numN);
+      else if (!strcmp(argv[i], "-m")) err = parseInts(v, k.m, &k.numM);
+      else if (!strcmp(argv[i], "-b")) err = parseInts(v, k.b, &k.numB);
+      else if (!strcmp(argv[i], "-k")) err = parseKernels(v, k.kernels);
+      else if (!strcmp(argv[i], "-t")) err = (k.minTime = atof(v)) < 0.0;
+      else err = 1;
+      if (err) {
+         fprintf(stderr, "ERROR: Invalid option '%s'\n", argv[i]);
+         fprintf(stderr, "Usage: %s [-n LIST] [-m LIST] [-b LIST] [-k LIST] "
+               "[-t SECONDS] [-o FILE]\n", argv[0]);
+         return -1;
+      }
+   }
+
+   primme_initialize(&k.primme);
+   k.primme.target = primme_smallest;
+   k.primme.projectionParams.projection = primme_proj_RR;
+   k.primme.iseed[0] = 1; k.primme.iseed[1] = 2;
+   k.primme.iseed[2] = 3; k.primme.iseed[3] = 5;
+
+   fprintf(k.out, "# %s: sizeof(SCALAR) %d, minimum time %g s\n", argv[0],
+         (int)sizeof(SCALAR), k.minTime);
+   fprintf(k.out, "# %-22s %9s %6s %6s %12s %10s %10s\n", "kernel", "nLocal",
+         "basis", "block", "time", "GFLOP/s", "bytes/flop");
+
+   /* Kernels on nLocal rows */
+
+   for (in=0; in<k.numN; in++) for (im=0; im<k.numM; im++)
+         for (ib=0; ib<k.numB; ib++) {
+      if (k.n[in] < k.m[im] + k.b[ib] || k.b[ib] > k.m[im]) continue;
+      k.primme.n = k.primme.nLocal = k.n[in];
+      k.primme.maxBasisSize = k.m[im] + k.b[ib];
+      k.primme.maxBlockSize = k.b[ib];
+      allocPoint(&k, k.n[in], k.m[im], k.b[ib], &p);
+      for (kernel=0; kernel<kernel_count; kernel++) {
+         if (!k.kernels[kernel] || kernel == kernel_solve_H
+               || kernel == kernel_compute_submatrix) continue;
+         t = runKernel(&k, kernel, &p, &flops, &bytes);
+         printPoint(&k, kernel, p.n, p.m, p.b, t, flops, bytes);
+      }
+      freePoint(&p);
+   }
+
+   /* Kernels on the projected problem, independent of nLocal */
+
+   for (im=0; im<k.numM; im++) for (ib=0; ib<k.numB; ib++) {
+      if (k.b[ib] > k.m[im]) continue;
+      k.primme.n = k.primme.nLocal = k.m[im] + k.b[ib];
+      k.primme.maxBasisSize = k.m[im] + k.b[ib];
+      k.primme.maxBlockSize = k.b[ib];
+      allocPoint(&k, k.m[im] + k.b[ib], k.m[im], k.b[ib], &p);
+      if (k.kernels[kernel_solve_H] && ib == 0) {
+         t = runKernel(&k, kernel_solve_H, &p, &flops, &bytes);
+         printPoint(&k, kernel_solve_H, 0, p.m, 0, t, flops, bytes);
+      }
+      if (k.kernels[kernel_compute_submatrix]) {
+         t = runKernel(&k, kernel_compute_submatrix, &p, &flops, &bytes);
+         printPoint(&k, kernel_compute_submatrix, 0, p.m, p.b, t, flops,
+               bytes);
+      }
+      freePoint(&p);
+   }
+
+   primme_free(&k.primme);
+   if (k.out != stdout) fclose(k.out);
+   return 0;
+}
@@ -0,0 +1,133 @@
+/*******************************************************************************
+ *   PRIMME PReconditioned Iterative MultiMethod Eigensolver
+ *   Copyright (C) 2016 College of William & Mary,
+ *   James R. McCombs, Eloy Romero Alcalde, Andreas Stathopoulos, Lingfei Wu
+ *
+ *   This file is part of PRIMME.
+ *
+ *   PRIMME is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   PRIMME is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *******************************************************************************
+ * File: trace.c
+ *
+ * Purpose - checks primme.traceFile: solves twice a 1-D Laplacian with the
+ *           same file, and checks that every event of the second solve
+ *           starts after every event of the first one ends. Calling format:
+ *
+ *             trace_double TraceFileName
+ *
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "primme.h"
+
+static void LaplacianMatrixMatvec(void *x, PRIMME_INT *ldx, void *y,
+      PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *ierr) {
+
+   int i, j;
+   double *xv, *yv;
+
+   for (j=0; j<*blockSize; j++) {
+      xv = (double *)x + *ldx*j;
+      yv = (double *)y + *ldy*j;
+      for (i=0; i<primme->n; i++) {
+         yv[i] = 2.0*xv[i];
+         if (i > 0) yv[i] -= xv[i-1];
+         if (i < primme->n-1) yv[i] -= xv[i+1];
+      }
+   }
+   *ierr = 0;
+}
+
+/* Read the times of the events in the file from position 'from' to 'to'; */
+/* return the smallest begin and the largest end, and the number of events */
+
+static int readEvents(FILE *f, long from, long to, double *first,
+      double *last) {
+
+   char line[1024], *p;
+   double ts, dur;
+   int n = 0;
+
+   fseek(f, from, SEEK_SET);
+   while (ftell(f) < to && fgets(line, sizeof(line), f)) {
+      if ((p = strstr(line, "\"ts\":")) == NULL
+            || sscanf(p, "\"ts\":%lf,\"dur\":%lf", &ts, &dur) != 2) continue;
+      if (n == 0 || ts < *first) *first = ts;
+      if (n == 0 || ts + dur > *last) *last = ts + dur;
+      n++;
+   }
+   return n;
+}
+
+int main(int argc, char *argv[]) {
+
+   primme_params primme;
+   double evals[4], rnorms[4], *evecs;
+   double first1=0, last1=0, first2=0, last2=0;
+   long pos1, pos2;
+   int n1, n2, ret;
+   FILE *f;
+
+   if (argc != 2) {
+      fprintf(stderr, "Usage: %s TraceFileName\n", argv[0]);
+      return -1;
+   }
+   f = fopen(argv[1], "w+");
+   if (f == NULL) {
+      fprintf(stderr, "ERROR: Could not open '%s'\n", argv[1]);
+      return -1;
+   }
+
+   primme_initialize(&primme);
+   primme.n = 500;
+   primme.numEvals = 4;
+   primme.eps = 1e-9;
+   primme.matrixMatvec = LaplacianMatrixMatvec;
+   primme.target = primme_smallest;
+   primme.printLevel = 0;
+   primme.traceFile = f;
+   primme_set_method(PRIMME_DEFAULT_MIN_TIME, &primme);
+   evecs = (double *)malloc(sizeof(double)*primme.n*primme.numEvals);
+
+   /* Solve twice; the events of each solve are written when it returns */
+
+   ret = dprimme(evals, evecs, rnorms, &primme);
+   pos1 = ftell(f);
+   primme.initSize = 0;
+   if (ret == 0) ret = dprimme(evals, evecs, rnorms, &primme);
+   primme_free(&primme);
+   pos2 = ftell(f);
+   free(evecs);
+   if (ret != 0) {
+      fprintf(stderr, "ERROR: dprimme returned %d\n", ret);
+      return -1;
+   }
+
+   n1 = readEvents(f, 0, pos1, &first1, &last1);
+   n2 = readEvents(f, pos1, pos2, &first2, &last2);
+   fclose(f);
+
+   printf("First solve : %d events from %g to %g us\n", n1, first1, last1);
+   printf("Second solve: %d events from %g to %g us\n", n2, first2, last2);
+   if (n1 == 0 || n2 == 0 || first1 < 0 || first2 < last1) {
+      fprintf(stderr, "ERROR: the events of the solves are not in order\n");
+      return -1;
+   }
+
+   return 0;
+}